@@ -1,12 +1,18 @@
-
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <thread>
 
 #include "Context.h"
 
+#include "Connection.h"
+#include "system_info.h"
+#include "log.h"
+
 #include "connection/Core.h"
 #if !(_WIN32)
 #include <cstdlib>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <wait.h>
 #endif
@@ -15,31 +21,67 @@ using namespace Gadgetron::Server::Connection;
 
 namespace Gadgetron::Server::Connection {
 
+    Gadgetron::Core::StreamContext::Budget budget(const Gadgetron::Core::StreamContext::Args &args) {
+        Gadgetron::Core::StreamContext::Budget budget{
+                args["connection_threads"].as<size_t>(),
+                args["connection_memory"].as<size_t>() << 20
+        };
+
+        // Without explicit budgets, connections running side by side share the machine evenly.
+        auto max_running = args["max_reconstructions"].as<size_t>();
+        if (max_running) {
+            if (!budget.threads) budget.threads = std::max<size_t>(1, std::thread::hardware_concurrency() / max_running);
+            if (!budget.memory) budget.memory = Info::system_memory() / max_running;
+        }
+        return budget;
+    }
+
 #if _WIN32 || !NDEBUG || GADGETRON_DISABLE_FORK
 
     void handle(
             const Gadgetron::Core::StreamContext::Paths& paths,
             const Gadgetron::Core::StreamContext::Args& args,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_finished
     ) {
-        auto thread = std::thread(handle_connection, std::move(stream), paths, args);
+        auto thread = std::thread(
+                [](auto stream, auto paths, auto args, auto on_finished) {
+                    handle_connection(std::move(stream), paths, args);
+                    on_finished();
+                },
+                std::move(stream), paths, args, std::move(on_finished)
+        );
         thread.detach();
     }
 
 #else
 
+    // The memory budget, explicit or shared out among max_reconstructions, is enforced on the connection process;
+    // allocations beyond it fail, rather than pushing the whole node into swap.
+    static void limit_memory(const Gadgetron::Core::StreamContext::Args& args) {
+        auto memory = budget(args).memory;
+        if (!memory) return;
+
+        rlimit limit{ rlim_t(memory), rlim_t(memory) };
+        if (setrlimit(RLIMIT_DATA, &limit)) GWARN_STREAM("Could not limit connection memory to " << memory << " bytes.");
+    }
+
     void handle(
             const Gadgetron::Core::StreamContext::Paths& paths,
             const Gadgetron::Core::StreamContext::Args& args,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_finished
     ) {
         auto pid = fork();
         if (pid == 0) {
+            limit_memory(args);
             handle_connection(std::move(stream), paths, args);
             std::exit(0);
         }
-        auto listen_for_close = [](auto pid) {int status; waitpid(pid,&status,0);};
-        std::thread t(listen_for_close,pid);
+        if (pid < 0) throw std::runtime_error("Failed to fork connection process.");
+
+        auto listen_for_close = [](auto pid, auto on_finished) {int status; waitpid(pid,&status,0); on_finished();};
+        std::thread t(listen_for_close, pid, std::move(on_finished));
         t.detach();
     }
 
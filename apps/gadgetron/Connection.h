@@ -1,14 +1,22 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <iostream>
 
 #include "Context.h"
 
 namespace Gadgetron::Server::Connection {
+
+    /// Handles the connection in a process or thread of its own, and calls on_finished once it is done.
+    /// on_finished is called from another thread.
     void handle(
             const Gadgetron::Core::StreamContext::Paths &paths,
             const Gadgetron::Core::StreamContext::Args &args,
-            std::unique_ptr<std::iostream> stream
+            std::unique_ptr<std::iostream> stream,
+            std::function<void()> on_finished
     );
+
+    /// The threads and memory each connection may use, from the server options.
+    Gadgetron::Core::StreamContext::Budget budget(const Gadgetron::Core::StreamContext::Args &args);
 }
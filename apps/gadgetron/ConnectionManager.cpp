@@ -0,0 +1,148 @@
+#include "ConnectionManager.h"
+
+#include <atomic>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#if !(_WIN32)
+#include <sys/mman.h>
+#endif
+
+using namespace Gadgetron::Server;
+
+namespace {
+
+    struct SharedStatistics {
+        std::atomic<uint64_t> max_running;
+        std::atomic<uint64_t> running;
+        std::atomic<uint64_t> waiting[2];
+        std::atomic<uint64_t> admitted;
+        std::atomic<uint64_t> completed;
+        std::atomic<uint64_t> rejected;
+        std::atomic<uint64_t> total_wait_us;
+    };
+
+    // Connections are forked off in release builds; anonymous shared memory keeps the counts they see live.
+    SharedStatistics &shared_statistics() {
+        static SharedStatistics *statistics = []() {
+#if !(_WIN32)
+            void *memory = mmap(nullptr, sizeof(SharedStatistics), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED) return new (memory) SharedStatistics();
+#endif
+            return new SharedStatistics();
+        }();
+        return *statistics;
+    }
+
+    boost::asio::ip::address normalized(const boost::asio::ip::address &address) {
+        if (address.is_v6() && address.to_v6().is_v4_mapped())
+            return boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, address.to_v6());
+        return address;
+    }
+}
+
+namespace Gadgetron::Server {
+
+    ConnectionManager::Settings ConnectionManager::settings(const boost::program_options::variables_map &args) {
+        Settings settings;
+        settings.max_running = args["max_reconstructions"].as<size_t>();
+        settings.max_waiting = args["max_waiting"].as<size_t>();
+
+        if (args.count("scanner_hosts")) {
+            for (auto &host : args["scanner_hosts"].as<std::vector<std::string>>()) {
+                settings.scanners.push_back(normalized(boost::asio::ip::make_address(host)));
+            }
+        }
+        return settings;
+    }
+
+    ConnectionManager::ConnectionManager(Settings settings) : config(std::move(settings)) {
+        shared_statistics().max_running = config.max_running;
+    }
+
+    ConnectionManager::Priority ConnectionManager::priority(const boost::asio::ip::address &address) const {
+        auto remote = normalized(address);
+        for (auto &scanner : config.scanners) {
+            if (scanner == remote) return Priority::scanner;
+        }
+        return Priority::offline;
+    }
+
+    bool ConnectionManager::submit(Priority priority, Start start) {
+        auto &statistics = shared_statistics();
+
+        if (!config.max_running || running < config.max_running) {
+            this->start(std::move(start), Clock::now());
+            return true;
+        }
+
+        if (config.max_waiting && waiting[0].size() + waiting[1].size() >= config.max_waiting) {
+            statistics.rejected++;
+            return false;
+        }
+
+        auto &queue = waiting[size_t(priority)];
+        queue.push_back(Waiting{ std::move(start), Clock::now() });
+        statistics.waiting[size_t(priority)] = queue.size();
+        return true;
+    }
+
+    void ConnectionManager::start(Start start, Clock::time_point submitted) {
+        auto &statistics = shared_statistics();
+
+        running++;
+        statistics.running = running;
+        statistics.admitted++;
+        statistics.total_wait_us += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - submitted).count();
+
+        start([this]() { finished(); });
+    }
+
+    void ConnectionManager::finished() {
+        auto &statistics = shared_statistics();
+
+        running--;
+        statistics.running = running;
+        statistics.completed++;
+
+        for (auto &queue : waiting) {
+            if (queue.empty()) continue;
+
+            auto next = std::move(queue.front());
+            queue.pop_front();
+            statistics.waiting[&queue - waiting] = queue.size();
+
+            start(std::move(next.start), next.submitted);
+            return;
+        }
+    }
+
+    ConnectionManager::Statistics ConnectionManager::statistics() {
+        auto &statistics = shared_statistics();
+
+        Statistics snapshot{};
+        snapshot.max_running     = statistics.max_running;
+        snapshot.running         = statistics.running;
+        snapshot.waiting_scanner = statistics.waiting[size_t(Priority::scanner)];
+        snapshot.waiting_offline = statistics.waiting[size_t(Priority::offline)];
+        snapshot.admitted        = statistics.admitted;
+        snapshot.completed       = statistics.completed;
+        snapshot.rejected        = statistics.rejected;
+        snapshot.mean_wait_ms    = snapshot.admitted ? 1e-3 * statistics.total_wait_us / snapshot.admitted : 0.0;
+        return snapshot;
+    }
+
+    std::string to_string(const ConnectionManager::Statistics &statistics) {
+        std::stringstream stream;
+        stream << "max_running=" << statistics.max_running
+               << " running=" << statistics.running
+               << " waiting_scanner=" << statistics.waiting_scanner
+               << " waiting_offline=" << statistics.waiting_offline
+               << " admitted=" << statistics.admitted
+               << " completed=" << statistics.completed
+               << " rejected=" << statistics.rejected
+               << " mean_wait_ms=" << std::fixed << std::setprecision(1) << statistics.mean_wait_ms;
+        return stream.str();
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Gadgetron::Server {
+
+    /**
+     * Admits connections to reconstruction, at most max_running at a time. Connections beyond that wait in a queue
+     * per priority; scanner connections start before offline ones, and each queue is first come, first served.
+     *
+     * The manager is not thread safe. Server calls it from its event loop only, and posts the completion of
+     * connections back to that loop.
+     */
+    class ConnectionManager {
+    public:
+        enum class Priority { scanner = 0, offline = 1 };
+
+        struct Settings {
+            size_t max_running = 0; // Unlimited if zero.
+            size_t max_waiting = 0; // Unlimited if zero.
+            std::vector<boost::asio::ip::address> scanners;
+        };
+
+        static Settings settings(const boost::program_options::variables_map &args);
+
+        using Done  = std::function<void()>;
+        using Start = std::function<void(Done)>;
+
+        explicit ConnectionManager(Settings settings);
+
+        /// Connections from the scanner hosts take priority; all others are offline.
+        Priority priority(const boost::asio::ip::address &address) const;
+
+        /// Starts the connection now, or queues it. Returns false if the queue is full, and the connection rejected.
+        /// The connection calls done once it has finished, on the thread calling the manager.
+        bool submit(Priority priority, Start start);
+
+        /// Counts shared with the processes connections run in, so they can answer queries about the server.
+        struct Statistics {
+            uint64_t max_running;
+            uint64_t running;
+            uint64_t waiting_scanner;
+            uint64_t waiting_offline;
+            uint64_t admitted;
+            uint64_t completed;
+            uint64_t rejected;
+            double mean_wait_ms;
+        };
+
+        static Statistics statistics();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Waiting {
+            Start start;
+            Clock::time_point submitted;
+        };
+
+        void start(Start start, Clock::time_point submitted);
+        void finished();
+
+        const Settings config;
+        std::deque<Waiting> waiting[2];
+        size_t running = 0;
+    };
+
+    std::string to_string(const ConnectionManager::Statistics &statistics);
+}
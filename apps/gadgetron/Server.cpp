@@ -6,14 +6,34 @@
 #include <Context.h>
 
 #include "log.h"
+#include "io/primitives.h"
+#include "MessageID.h"
 
 #include "Server.h"
 #include "Connection.h"
+#include "ConnectionManager.h"
 #include "connection/SocketStreamBuf.h"
+#include "connection/Writers.h"
 
 using namespace boost::filesystem;
 using namespace Gadgetron::Server;
 
+namespace {
+
+    void reject(std::iostream &stream) {
+        try {
+            Gadgetron::Server::Connection::Writers::TextWriter{}.serialize(
+                    stream,
+                    "[Server] ERROR: Too many connections waiting; try again later."
+            );
+            Gadgetron::Core::IO::write(stream, Gadgetron::Core::CLOSE);
+            stream.flush();
+        }
+        catch (...) {
+            // The client is gone already.
+        }
+    }
+}
 
 Server::Server(
         const boost::program_options::variables_map &args
@@ -35,12 +55,62 @@ void Server::serve() {
 
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
-    while(true) {
-        auto socket = std::make_unique<boost::asio::ip::tcp::socket>(executor);
-        acceptor.accept(*socket);
+    ConnectionManager manager(ConnectionManager::settings(args));
 
-        GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
+    // Accepting, admitting and finishing connections all happen on this thread, in the event loop below.
+    auto admit = [&](std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
+        auto address  = socket->remote_endpoint().address();
+        auto priority = manager.priority(address);
 
-        Connection::handle(paths, args, Gadgetron::Connection::stream_from_socket(std::move(socket)));
-    }
+        GINFO_FIELDS("Accepted connection", "address", address.to_string(),
+                     "priority", priority == ConnectionManager::Priority::scanner ? "scanner" : "offline");
+
+        // Shared, as a queued connection is started later; or never, if it is rejected.
+        auto stream = std::make_shared<std::unique_ptr<std::iostream>>(Gadgetron::Connection::stream_from_socket(
+                std::move(socket),
+                args["socket_buffer_size"].as<size_t>(),
+                args["coalesce_writes"].as<bool>()));
+
+        auto start = [&, stream](ConnectionManager::Done done) {
+            try {
+                Connection::handle(
+                        paths,
+                        args,
+                        std::move(*stream),
+                        [&executor, done]() { boost::asio::post(executor, done); }
+                );
+            }
+            catch (const std::exception &e) {
+                GERROR_STREAM("Failed to start connection: " << e.what());
+                done();
+            }
+        };
+
+        if (!manager.submit(priority, start)) {
+            GWARN_FIELDS("Rejected connection", "address", address.to_string());
+            reject(**stream);
+        }
+    };
+
+    std::function<void()> accept = [&]() {
+        auto socket = std::make_shared<std::unique_ptr<boost::asio::ip::tcp::socket>>(
+                std::make_unique<boost::asio::ip::tcp::socket>(executor));
+
+        acceptor.async_accept(**socket, [&, socket](const boost::system::error_code &error) {
+            if (error) {
+                GERROR_STREAM("Failed to accept connection: " << error.message());
+            } else {
+                try {
+                    admit(std::move(*socket));
+                }
+                catch (const std::exception &e) {
+                    GERROR_STREAM("Failed to admit connection: " << e.what());
+                }
+            }
+            accept();
+        });
+    };
+
+    accept();
+    executor.run();
 }
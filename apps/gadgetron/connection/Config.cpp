@@ -122,6 +122,9 @@ namespace {
 
         static pugi::xml_node add_node(const Config::Distributed &distributed, pugi::xml_node &node) {
             auto distributed_node = node.append_child("distributed");
+            if (distributed.max_jobs_per_peer)
+                distributed_node.append_attribute("max_jobs_per_peer").set_value((long long unsigned int)distributed.max_jobs_per_peer);
+            distributed_node.append_attribute("retries").set_value((long long unsigned int)distributed.retries);
             add_readers(distributed.readers, distributed_node);
             add_writers(distributed.writers, distributed_node);
             add_node(distributed.distributor, distributed_node);
@@ -134,6 +137,7 @@ namespace {
             auto execute_node = node.append_child("execute");
             execute_node.append_attribute("name").set_value(execute.name.c_str());
             execute_node.append_attribute("type").set_value(execute.type.c_str());
+            if (execute.shared_memory) execute_node.append_attribute("shared_memory").set_value(true);
             return execute_node;
         }
 
@@ -158,9 +162,16 @@ namespace {
             return external_node;
         }
 
+        static void add_queue(const Config::Queue &queue, pugi::xml_node &node) {
+            if (!queue.capacity) return;
+            node.append_attribute("capacity").set_value((long long unsigned int)queue.capacity);
+            node.append_attribute("backpressure").set_value(queue.spin ? "spin" : "block");
+        }
+
         static pugi::xml_node add_node(const Config::Stream &stream, pugi::xml_node &node) {
             auto stream_node = node.append_child("stream");
             stream_node.append_attribute("key").set_value(stream.key.c_str());
+            add_queue(stream.queue, stream_node);
             for (auto n : stream.nodes) {
                 visit([&stream_node](auto &typed_node) { add_node(typed_node, stream_node); }, n);
             }
@@ -170,12 +181,20 @@ namespace {
         static pugi::xml_node add_node(const Config::ParallelProcess& parallelProcess, pugi::xml_node & node){
             auto parallel_node = node.append_child("parallelprocess");
             parallel_node.append_attribute("workers").set_value((long long unsigned int)parallelProcess.workers);
+            add_queue(parallelProcess.queue, parallel_node);
+            if (parallelProcess.max_in_flight)
+                parallel_node.append_attribute("max_in_flight").set_value((long long unsigned int)parallelProcess.max_in_flight);
+            if (!parallelProcess.ordered)
+                parallel_node.append_attribute("order").set_value("unordered");
+            if (parallelProcess.shared_pool)
+                parallel_node.append_attribute("pool").set_value("shared");
             add_node(parallelProcess.stream, parallel_node);
             return parallel_node;
         }
 
         static pugi::xml_node add_node(const Config::PureStream& stream, pugi::xml_node& node){
             auto purestream_node = node.append_child("purestream");
+            if (!stream.fused) purestream_node.append_attribute("fused").set_value(false);
             for (auto& gadget : stream.gadgets){
                 add_node(gadget,purestream_node);
             }
@@ -515,7 +534,9 @@ namespace {
             auto stream = parse_stream(distributed_node.child("stream"));
             auto readers = parse_readers(distributed_node.child("readers"));
             auto writers = parse_writers(distributed_node.child("writers"));
-            return {readers,writers,distributor,stream};
+            auto max_jobs_per_peer = distributed_node.attribute("max_jobs_per_peer").as_ullong(0);
+            auto retries = distributed_node.attribute("retries").as_ullong(3);
+            return {readers,writers,distributor,stream,max_jobs_per_peer,retries};
         }
 
         Config::Stream parse_stream(const pugi::xml_node &stream_node) {
@@ -523,20 +544,48 @@ namespace {
             for (auto &node : stream_node.children()) {
                 nodes.push_back(node_parsers.at(node.name())(node));
             }
-            return Config::Stream{stream_node.attribute("key").value(), nodes};
+            return Config::Stream{stream_node.attribute("key").value(), nodes, parse_queue(stream_node)};
+        }
+
+        static Config::Queue parse_queue(const pugi::xml_node &node) {
+            Config::Queue queue{};
+            queue.capacity = node.attribute("capacity").as_ullong(0);
+
+            std::string backpressure = node.attribute("backpressure").as_string("block");
+            if (backpressure != "block" && backpressure != "spin")
+                throw ConfigNodeError("Unknown backpressure policy; expected 'block' or 'spin'", node);
+            queue.spin = backpressure == "spin";
+
+            return queue;
         }
 
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
             std::vector<Config::Gadget> gadgets;
             boost::transform(purestream_node.children(), std::back_inserter(gadgets),
                 [&,this](auto node) { return this->parse_node<Config::Gadget>(node); });
-            return {gadgets};
+            return {gadgets, purestream_node.attribute("fused").as_bool(true)};
         }
 
         Config::ParallelProcess parse_parallelprocess(const pugi::xml_node& parallelprocess_node)
         {
             size_t workers = std::stoul(parallelprocess_node.attribute("workers").value());
-            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream"))};
+
+            std::string order = parallelprocess_node.attribute("order").as_string("ordered");
+            if (order != "ordered" && order != "unordered")
+                throw ConfigNodeError("Unknown order; expected 'ordered' or 'unordered'", parallelprocess_node);
+
+            std::string pool = parallelprocess_node.attribute("pool").as_string("dedicated");
+            if (pool != "dedicated" && pool != "shared")
+                throw ConfigNodeError("Unknown pool; expected 'dedicated' or 'shared'", parallelprocess_node);
+
+            return Config::ParallelProcess{
+                workers,
+                parse_purestream(parallelprocess_node.child("purestream")),
+                parse_queue(parallelprocess_node),
+                parallelprocess_node.attribute("max_in_flight").as_ullong(0),
+                order == "ordered",
+                pool == "shared"
+            };
         }
 
         Config::PureDistributed parse_puredistributed(const pugi::xml_node& puredistributedprocess_node){
@@ -556,7 +605,8 @@ namespace {
             return Config::Execute {
                 execute_node.attribute("name").value(),
                 execute_node.attribute("type").value(),
-                parse_target(execute_node.attribute("target").value())
+                parse_target(execute_node.attribute("target").value()),
+                execute_node.attribute("shared_memory").as_bool(false)
             };
         }
 
@@ -32,13 +32,20 @@ namespace Gadgetron::Server::Connection {
             std::string dll, classname;
         };
 
+        struct Queue {
+            size_t capacity = 0; // Unbounded if zero.
+            bool spin = false;
+        };
+
         struct Stream {
             std::string key;
             std::vector<Node> nodes;
+            Queue queue{};
         };
 
         struct PureStream{
             std::vector<Gadget> gadgets;
+            bool fused = true;
         };
 
         struct Gadget {
@@ -54,6 +61,7 @@ namespace Gadgetron::Server::Connection {
         struct Execute {
             std::string name, type;
             Core::optional<std::string> target;
+            bool shared_memory = false; // Offer the module a shared memory segment for bulk data.
         };
 
         struct Connect {
@@ -90,6 +98,10 @@ namespace Gadgetron::Server::Connection {
         struct ParallelProcess {
             size_t workers = 0;
             PureStream stream;
+            Queue queue{};
+            size_t max_in_flight = 0; // Unbounded if zero.
+            bool ordered = true;
+            bool shared_pool = false;
         };
 
         struct Distributor : Gadget { using Gadget::Gadget;};
@@ -99,6 +111,8 @@ namespace Gadgetron::Server::Connection {
             std::vector<Writer> writers;
             Distributor distributor;
             Stream stream;
+            size_t max_jobs_per_peer = 0; // Unbounded if zero.
+            size_t retries = 3;
         };
 
         std::vector<Reader> readers;
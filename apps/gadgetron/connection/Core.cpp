@@ -67,6 +67,7 @@ namespace Gadgetron::Server::Connection {
         try {
             sender.send_error_to_client(*stream);
             send_close(*stream);
+            stream->flush();
         }
         catch (std::runtime_error &e) {
             GERROR_STREAM("Finalizing connection to client failed with the following error: " << e.what());
@@ -105,8 +105,7 @@ namespace Gadgetron::Server::Connection {
 
         auto writers = writer_factory();
 
-        for (auto message : messages) {
-
+        auto write = [&](Core::Message message) {
             auto writer = std::find_if(writers.begin(), writers.end(),
                                        [&](auto &writer) { return writer->accepts(message); }
             );
@@ -114,7 +113,22 @@ namespace Gadgetron::Server::Connection {
             if (writer != writers.end()) {
                 (*writer)->write(stream, std::move(message));
             }
+        };
+
+        // Flush only when no more output is ready; a burst of results then leaves in as few writes as possible.
+        try {
+            while (true) {
+                auto message = messages.try_pop();
+                if (!message) {
+                    stream.flush();
+                    message = messages.pop();
+                }
+                write(std::move(*message));
+            }
         }
+        catch (const Core::ChannelClosed &) {}
+
+        stream.flush();
     }
 
     std::vector<std::unique_ptr<Core::Writer>> default_writers();
@@ -3,6 +3,8 @@
 #include "Handlers.h"
 
 #include "system_info.h"
+#include "ConnectionManager.h"
+#include "Multiplexing.h"
 
 #include "io/primitives.h"
 #include "Response.h"
@@ -54,6 +56,13 @@ namespace {
         answers["gadgetron::cuda::runtime"]      = Info::CUDA::cuda_runtime_version;
         answers["gadgetron::cuda::memory"]       = cuda_memory;
         answers["gadgetron::cuda::capabilities"] = cuda_capabilities;
+        answers[Connection::Multiplexing::multiplex_query] = []() { return std::string("1"); };
+        answers["gadgetron::connections"]          = []() { return to_string(ConnectionManager::statistics()); };
+        answers["gadgetron::connections::running"] = []() { return std::to_string(ConnectionManager::statistics().running); };
+        answers["gadgetron::connections::waiting"] = []() {
+            auto statistics = ConnectionManager::statistics();
+            return std::to_string(statistics.waiting_scanner + statistics.waiting_offline);
+        };
     }
 }
 
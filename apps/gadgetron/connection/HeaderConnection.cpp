@@ -4,7 +4,9 @@
 #include <map>
 #include <iostream>
 
+#include "Connection.h"
 #include "StreamConnection.h"
+#include "MultiplexedConnection.h"
 #include "VoidConnection.h"
 #include "Handlers.h"
 #include "Config.h"
@@ -43,10 +45,21 @@ namespace {
         std::function<void(Header)> header_callback;
     };
 
+    class MultiplexHandler : public Handler {
+    public:
+        explicit MultiplexHandler(bool &multiplexed) : multiplexed(multiplexed) {}
+
+        void handle(std::istream &, OutputChannel&) override { multiplexed = true; }
+
+    private:
+        bool &multiplexed;
+    };
+
     class HeaderContext {
     public:
         Gadgetron::Core::optional<Header> header;
         const StreamContext::Paths paths;
+        bool multiplexed = false;
     };
 
     std::map<uint16_t, std::unique_ptr<Handler>> prepare_handlers(
@@ -63,6 +76,7 @@ namespace {
         handlers[FILENAME] = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[CONFIG]   = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[HEADER]   = std::make_unique<HeaderHandler>(header_callback);
+        handlers[MULTIPLEX] = std::make_unique<MultiplexHandler>(context.multiplexed);
         handlers[QUERY]    = std::make_unique<QueryHandler>();
         handlers[CLOSE]    = std::make_unique<CloseHandler>(close);
 
@@ -105,8 +119,21 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
         input_thread.join();
         output_thread.join();
 
-        if (context.header) {
-            StreamConnection::process(stream, StreamContext{context.header.value(), paths, args}, config, error_handler);
+        if (context.header && context.multiplexed) {
+            MultiplexedConnection::process(
+                    stream,
+                    StreamContext{context.header.value(), paths, args, Connection::budget(args)},
+                    config,
+                    error_handler
+            );
+        }
+        else if (context.header) {
+            StreamConnection::process(
+                    stream,
+                    StreamContext{context.header.value(), paths, args, Connection::budget(args)},
+                    config,
+                    error_handler
+            );
         }
         else {
             VoidConnection::process(stream, paths, config, error_handler);
@@ -0,0 +1,239 @@
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "MultiplexedConnection.h"
+#include "Multiplexing.h"
+
+#include "Loader.h"
+
+#include "io/primitives.h"
+#include "Channel.h"
+#include "Context.h"
+#include "MessageID.h"
+
+namespace {
+
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Server::Connection;
+    using namespace Gadgetron::Server::Connection::Multiplexing;
+
+    // Output of every channel passes through a single queue, on its way to the writer thread.
+    struct Outgoing {
+        enum class Kind { message, error, close };
+
+        Kind kind;
+        ChannelID channel;
+        Message message;
+        std::string error;
+    };
+
+    using OutgoingQueue = MPMCChannel<Outgoing>;
+
+    class ChannelOutput : public Channel {
+    public:
+        ChannelOutput(ChannelID id, std::shared_ptr<OutgoingQueue> outgoing) : id(id), outgoing(std::move(outgoing)) {}
+
+    protected:
+        Message pop() override { throw ChannelClosed(); }
+        optional<Message> try_pop() override { throw ChannelClosed(); }
+
+        void push_message(Message message) override {
+            outgoing->push(Outgoing{ Outgoing::Kind::message, id, std::move(message), {} });
+        }
+
+        // The channel is closed once its stream is done, after any errors; see LogicalChannel.
+        void close() override {}
+
+    private:
+        const ChannelID id;
+        const std::shared_ptr<OutgoingQueue> outgoing;
+    };
+
+    class ChannelErrors : public ErrorReporter {
+    public:
+        void operator()(const std::string &location, const std::string &message) override {
+            std::string error("[" + location + "] ERROR: " + message);
+            GERROR_STREAM(error);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                errors.push_back(error);
+            }
+        }
+
+        std::list<std::string> take() {
+            std::lock_guard<std::mutex> guard(mutex);
+            return std::move(errors);
+        }
+
+    private:
+        std::mutex mutex;
+        std::list<std::string> errors;
+    };
+
+    class LogicalChannel {
+    public:
+        LogicalChannel(
+                ChannelID id,
+                std::unique_ptr<Gadgetron::Server::Connection::Stream::Stream> node,
+                const Config &config,
+                std::shared_ptr<OutgoingQueue> outgoing
+        ) {
+            auto channel = Gadgetron::Server::Connection::Stream::make_queue_channel(config.stream.queue);
+            input = std::move(channel.output);
+
+            thread = std::thread(
+                    [id, outgoing](auto node, auto input) {
+                        ChannelErrors errors;
+                        ErrorHandler error_handler{errors, "Channel " + std::to_string(id)};
+
+                        error_handler.handle([&]() {
+                            node->process(
+                                    std::move(input),
+                                    make_channel<ChannelOutput>(id, outgoing).output,
+                                    error_handler
+                            );
+                        });
+
+                        for (auto &error : errors.take()) {
+                            outgoing->push(Outgoing{ Outgoing::Kind::error, id, Message{}, error });
+                        }
+                        outgoing->push(Outgoing{ Outgoing::Kind::close, id, Message{}, {} });
+                    },
+                    std::move(node),
+                    std::move(channel.input)
+            );
+        }
+
+        ~LogicalChannel() {
+            close();
+            thread.join();
+        }
+
+        // A channel closed early, failing on an error, drops input the client sent before it learned of it.
+        void push(Message message) {
+            if (input) input->push_message(std::move(message));
+        }
+
+        void close() {
+            input = none;
+        }
+
+    private:
+        optional<OutputChannel> input;
+        std::thread thread;
+    };
+
+    void process_output(
+            std::iostream &stream,
+            OutgoingQueue &outgoing,
+            const std::vector<std::unique_ptr<Writer>> &writers
+    ) {
+        auto write = [&](Outgoing item) {
+            Frame frame(item.channel);
+
+            switch (item.kind) {
+                case Outgoing::Kind::message: {
+                    auto writer = std::find_if(writers.begin(), writers.end(),
+                                               [&](auto &writer) { return writer->accepts(item.message); }
+                    );
+                    if (writer == writers.end()) return;
+                    (*writer)->write(frame.payload(), std::move(item.message));
+                    break;
+                }
+                case Outgoing::Kind::error:
+                    IO::write(frame.payload(), ERROR);
+                    IO::write_string_to_stream<uint64_t>(frame.payload(), item.error);
+                    break;
+                case Outgoing::Kind::close:
+                    IO::write(frame.payload(), CLOSE);
+                    break;
+            }
+
+            frame.write(stream);
+        };
+
+        // Flush only when no more output is ready, as on a plain connection.
+        try {
+            while (true) {
+                auto item = outgoing.try_pop();
+                if (!item) {
+                    stream.flush();
+                    item = outgoing.pop();
+                }
+                write(std::move(*item));
+            }
+        }
+        catch (const ChannelClosed &) {}
+
+        stream.flush();
+    }
+
+    void process_input(
+            std::iostream &stream,
+            std::map<ChannelID, std::unique_ptr<LogicalChannel>> &channels,
+            std::function<std::unique_ptr<LogicalChannel>(ChannelID)> open,
+            const std::map<uint16_t, std::unique_ptr<Reader>> &readers
+    ) {
+        while (true) {
+            auto id = IO::read<uint16_t>(stream);
+            if (id == CLOSE) return;
+            if (id != FRAME)
+                throw std::runtime_error("Received illegal message id on multiplexed connection: " + std::to_string(id));
+
+            Frame frame(stream);
+
+            auto &channel = channels[frame.channel()];
+            if (!channel) channel = open(frame.channel());
+
+            auto message_id = IO::read<uint16_t>(frame.payload());
+            if (message_id == CLOSE) {
+                channel->close();
+                continue;
+            }
+
+            channel->push(readers.at(message_id)->read(frame.payload()));
+        }
+    }
+}
+
+namespace Gadgetron::Server::Connection::MultiplexedConnection {
+
+    void process(
+            std::iostream &stream,
+            const Core::StreamContext &context,
+            const Config &config,
+            ErrorHandler &error_handler
+    ) {
+        GINFO_STREAM("Connection state: [MULTIPLEXED]");
+
+        Loader loader{context};
+
+        auto readers = loader.load_readers(config);
+        auto writers = default_writers();
+        for (auto &writer : loader.load_writers(config)) writers.emplace_back(std::move(writer));
+
+        auto outgoing = std::make_shared<OutgoingQueue>();
+
+        std::thread output_thread = ErrorHandler(error_handler, "Connection Output Thread").run(
+                [&]() { process_output(stream, *outgoing, writers); }
+        );
+
+        // Channels are kept until the connection closes; the client may still send to channels that failed.
+        std::map<ChannelID, std::unique_ptr<LogicalChannel>> channels;
+
+        auto open = [&](ChannelID id) {
+            GDEBUG_STREAM("Opening multiplexed channel " << id);
+            return std::make_unique<LogicalChannel>(id, loader.load(config.stream), config, outgoing);
+        };
+
+        ErrorHandler(error_handler, "Connection Input Thread").handle(
+                [&]() { process_input(stream, channels, open, readers); }
+        );
+
+        channels.clear();
+        outgoing->close();
+        output_thread.join();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Core.h"
+#include "Config.h"
+
+#include "Context.h"
+
+namespace Gadgetron::Server::Connection::MultiplexedConnection {
+
+    /**
+     * Serves a multiplexed connection (see Multiplexing.h). Every channel opened by the client runs a stream of its
+     * own, built from the config and header sent once for the connection. One thread reads the input of all
+     * channels, and one writes their output.
+     */
+    void process(
+            std::iostream &stream,
+            const Core::StreamContext &context,
+            const Config &config,
+            ErrorHandler &error_handler
+    );
+}
@@ -0,0 +1,82 @@
+#include "Multiplexing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "io/primitives.h"
+#include "MessageID.h"
+
+namespace {
+    constexpr size_t header_size = sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint64_t);
+    constexpr uint64_t read_chunk_size = uint64_t(1) << 20;
+}
+
+namespace Gadgetron::Server::Connection::Multiplexing {
+
+    // The frame header is filled in when the frame is written; the payload follows the space left for it.
+    Frame::Frame(ChannelID channel) : channel_(channel), payload_(&buffer) {
+        buffer.data.resize(header_size);
+    }
+
+    Frame::Frame(std::istream &stream) : payload_(&buffer) {
+        channel_ = Core::IO::read<uint32_t>(stream);
+        auto length = Core::IO::read<uint64_t>(stream);
+        if (length > max_length)
+            throw std::runtime_error("Frame on channel " + std::to_string(channel_) + " is too long: " +
+                                     std::to_string(length) + " bytes");
+
+        // The buffer grows as the payload arrives, so a frame cut short never costs more memory than it delivered.
+        buffer.data.resize(header_size);
+        for (uint64_t remaining = length; remaining;) {
+            auto chunk = std::min<uint64_t>(remaining, read_chunk_size);
+            auto offset = buffer.data.size();
+            buffer.data.resize(offset + chunk);
+            stream.read(buffer.data.data() + offset, chunk);
+            if (uint64_t(stream.gcount()) != chunk)
+                throw std::runtime_error("Frame on channel " + std::to_string(channel_) + " ended early");
+            remaining -= chunk;
+        }
+        buffer.reset_get_area();
+
+        payload_.exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+    }
+
+    uint16_t Frame::message_id() const {
+        if (buffer.data.size() < header_size + sizeof(uint16_t))
+            throw std::runtime_error("Received empty frame on channel " + std::to_string(channel_));
+
+        uint16_t id;
+        std::memcpy(&id, buffer.data.data() + header_size, sizeof(id));
+        return id;
+    }
+
+    void Frame::write(std::ostream &stream) {
+        uint16_t id = Core::FRAME;
+        uint64_t length = buffer.data.size() - header_size;
+        if (length > max_length)
+            throw std::runtime_error("Frame on channel " + std::to_string(channel_) + " is too long: " +
+                                     std::to_string(length) + " bytes");
+
+        auto header = buffer.data.data();
+        std::memcpy(header, &id, sizeof(id));
+        std::memcpy(header + sizeof(id), &channel_, sizeof(channel_));
+        std::memcpy(header + sizeof(id) + sizeof(channel_), &length, sizeof(length));
+
+        stream.write(buffer.data.data(), buffer.data.size());
+    }
+
+    void Frame::Buffer::reset_get_area() {
+        setg(data.data() + header_size, data.data() + header_size, data.data() + data.size());
+    }
+
+    std::streamsize Frame::Buffer::xsputn(const char *s, std::streamsize count) {
+        data.insert(data.end(), s, s + count);
+        return count;
+    }
+
+    Frame::Buffer::int_type Frame::Buffer::overflow(int_type ch) {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) data.push_back(traits_type::to_char_type(ch));
+        return traits_type::not_eof(ch);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace Gadgetron::Server::Connection::Multiplexing {
+
+    using ChannelID = uint32_t;
+
+    /// Answered with "1" by peers that take multiplexed connections; peers that predate them fail the query.
+    constexpr const char *multiplex_query = "gadgetron::capabilities::multiplex";
+
+    /**
+     * A multiplexed connection carries many channels - each a stream of its own - over a single socket. It is
+     * configured like any other connection, with a MULTIPLEX message between config and header; clients ask first,
+     * with a QUERY for multiplex_query, since older peers refuse it. From then on, both ends send only frames, and
+     * finally a CLOSE:
+     *
+     *   uint16 FRAME, uint32 channel, uint64 length, then length bytes holding one message exactly as it would be
+     *   sent on a connection of its own.
+     *
+     * A CLOSE in a frame closes that channel. Channels closing with errors send them as ERROR messages first.
+     *
+     * The length comes off the network; frames longer than max_length are refused on either end.
+     */
+    class Frame {
+    public:
+        static constexpr uint64_t max_length = uint64_t(1) << 34;
+
+        /// An empty frame on the channel; write a single message to the payload.
+        explicit Frame(ChannelID channel);
+
+        /// Reads a frame from the stream; the FRAME message id is already read. Throws on a frame that is too long,
+        /// or cut short.
+        explicit Frame(std::istream &stream);
+
+        Frame(const Frame &) = delete;
+        Frame &operator=(const Frame &) = delete;
+
+        ChannelID channel() const { return channel_; }
+
+        /// The id of the message in the frame; peeked, leaving the message in the payload.
+        uint16_t message_id() const;
+
+        std::iostream &payload() { return payload_; }
+
+        /// Writes the whole frame to the stream, in a single write.
+        void write(std::ostream &stream);
+
+    private:
+        class Buffer : public std::streambuf {
+        public:
+            std::vector<char> data;
+
+            void reset_get_area();
+
+        protected:
+            std::streamsize xsputn(const char *s, std::streamsize count) override;
+            int_type overflow(int_type ch) override;
+        };
+
+        ChannelID channel_;
+        Buffer buffer;
+        std::iostream payload_;
+    };
+}
@@ -0,0 +1,360 @@
+#include "SharedMemoryStream.h"
+
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace bip = boost::interprocess;
+
+namespace {
+    constexpr uint64_t magic   = 0x314d454d53544447; // "GDTSMEM1"
+    constexpr uint64_t version = 1;
+
+    constexpr size_t header_size  = 128;
+    constexpr size_t control_size = 128;
+    constexpr size_t alignment    = 64;
+
+    // Below this, the copies into and out of the ring cost more than the socket does.
+    constexpr size_t shared_threshold = 512 * 1024;
+    constexpr size_t buffer_size      = 64 * 1024;
+
+    enum FrameKind : uint8_t { inline_frame = 0, shared_frame = 1 };
+
+    constexpr size_t frame_header_size  = 1 + sizeof(uint64_t);
+    constexpr size_t shared_header_size = frame_header_size + sizeof(uint64_t);
+
+    size_t segment_size(size_t capacity) {
+        return header_size + 2 * (control_size + capacity);
+    }
+
+    uint64_t round_up(uint64_t value, uint64_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+}
+
+namespace Gadgetron::Connection {
+
+    SharedMemorySegment::SharedMemorySegment(std::string name, Role role, bip::mapped_region region)
+        : name_(std::move(name)), role_(role), region(std::move(region)) {
+        auto header = static_cast<const uint64_t *>(this->region.get_address());
+        if (this->region.get_size() < header_size || header[0] != magic || header[1] != version)
+            throw std::runtime_error("Shared memory segment '" + name_ + "' is not a Gadgetron segment.");
+
+        capacity_ = header[2];
+        if (this->region.get_size() < segment_size(capacity_))
+            throw std::runtime_error("Shared memory segment '" + name_ + "' is truncated.");
+    }
+
+    SharedMemorySegment::~SharedMemorySegment() {
+        if (role_ == Role::creator) remove();
+    }
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::create(size_t capacity) {
+        static std::atomic<unsigned> counter{0};
+
+        capacity = round_up(std::max<size_t>(capacity, 4 * shared_threshold), alignment);
+        auto name = "gadgetron-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+
+        // A segment left behind by a crashed process with the same pid is stale.
+        bip::shared_memory_object::remove(name.c_str());
+
+        bip::shared_memory_object object(bip::create_only, name.c_str(), bip::read_write);
+
+        // Reserve the memory up front. A segment that merely has the size can fail on first touch, when /dev/shm
+        // fills up, with a SIGBUS rather than an error.
+        if (auto error = posix_fallocate(object.get_mapping_handle().handle, 0, off_t(segment_size(capacity)))) {
+            bip::shared_memory_object::remove(name.c_str());
+            throw std::runtime_error("Unable to reserve shared memory: " + std::string(std::strerror(error)));
+        }
+        bip::mapped_region region(object, bip::read_write);
+
+        auto address = static_cast<char *>(region.get_address());
+        auto header  = reinterpret_cast<uint64_t *>(address);
+        header[0] = magic;
+        header[1] = version;
+        header[2] = capacity;
+
+        for (size_t index : {0, 1}) {
+            auto control = address + header_size + index * (control_size + capacity);
+            new (control) std::atomic<uint64_t>(0);
+            new (control + control_size / 2) std::atomic<uint64_t>(0);
+        }
+
+        return std::shared_ptr<SharedMemorySegment>(new SharedMemorySegment(name, Role::creator, std::move(region)));
+    }
+
+    std::shared_ptr<SharedMemorySegment> SharedMemorySegment::open(const std::string &name) {
+        bip::shared_memory_object object(bip::open_only, name.c_str(), bip::read_write);
+        bip::mapped_region region(object, bip::read_write);
+        return std::shared_ptr<SharedMemorySegment>(new SharedMemorySegment(name, Role::peer, std::move(region)));
+    }
+
+    void SharedMemorySegment::remove() {
+        if (removed) return;
+        bip::shared_memory_object::remove(name_.c_str());
+        removed = true;
+    }
+
+    SharedMemorySegment::Ring SharedMemorySegment::ring(size_t index) const {
+        auto control = static_cast<char *>(region.get_address()) + header_size + index * (control_size + capacity_);
+        return Ring{
+            reinterpret_cast<std::atomic<uint64_t> *>(control),
+            reinterpret_cast<std::atomic<uint64_t> *>(control + control_size / 2),
+            control + control_size
+        };
+    }
+
+    SharedMemorySegment::Ring SharedMemorySegment::outbound() const {
+        return ring(role_ == Role::creator ? 0 : 1);
+    }
+
+    SharedMemorySegment::Ring SharedMemorySegment::inbound() const {
+        return ring(role_ == Role::creator ? 1 : 0);
+    }
+
+    class SharedMemoryStream::Buffer : public std::streambuf {
+    public:
+        Buffer(std::streambuf *stream, const SharedMemorySegment &segment)
+            : stream(stream), capacity(segment.capacity()), input_ring(segment.inbound()),
+              output_ring(segment.outbound()), input_buffer(buffer_size), output_buffer(buffer_size) {
+            next_position = output_ring.written->load(std::memory_order_relaxed);
+        }
+
+        void frame_input() { input_framed = true; }
+
+        void frame_output() {
+            stream->pubsync();
+            output_framed = true;
+        }
+
+    protected:
+        int underflow() override;
+        int uflow() override;
+        std::streamsize xsgetn(char *data, std::streamsize length) override;
+
+        int overflow(int ch) override;
+        std::streamsize xsputn(const char *data, std::streamsize length) override;
+        int sync() override;
+
+    private:
+        bool next_frame();
+        void release();
+
+        void put_inline(const char *data, size_t length);
+        bool put_shared(const char *data, size_t length);
+
+        std::streambuf *const stream;
+        const size_t capacity;
+
+        const SharedMemorySegment::Ring input_ring;
+        const SharedMemorySegment::Ring output_ring;
+
+        bool input_framed  = false;
+        bool output_framed = false;
+
+        // Bytes of the current inline frame still in the stream.
+        uint64_t inline_remaining = 0;
+        // End position of the shared frame the get area points into, if any.
+        bool holding_shared     = false;
+        uint64_t shared_release = 0;
+
+        uint64_t next_position;
+
+        std::vector<char> input_buffer;
+        std::vector<char> output_buffer;
+    };
+
+    void SharedMemoryStream::Buffer::release() {
+        if (holding_shared) {
+            input_ring.consumed->store(shared_release, std::memory_order_release);
+            holding_shared = false;
+        }
+        this->setg(nullptr, nullptr, nullptr);
+    }
+
+    bool SharedMemoryStream::Buffer::next_frame() {
+        char header[shared_header_size];
+        if (stream->sgetn(header, frame_header_size) != std::streamsize(frame_header_size)) return false;
+
+        uint64_t length;
+        std::memcpy(&length, header + 1, sizeof(length));
+
+        if (header[0] == inline_frame) {
+            inline_remaining = length;
+            return true;
+        }
+
+        if (header[0] != shared_frame)
+            throw std::runtime_error("Received illegal frame kind from peer: " + std::to_string(int(header[0])));
+
+        if (stream->sgetn(header + frame_header_size, sizeof(uint64_t)) != sizeof(uint64_t)) return false;
+
+        uint64_t position;
+        std::memcpy(&position, header + frame_header_size, sizeof(position));
+
+        // The offset is within the ring; offset + length, from the peer, may well overflow.
+        auto offset = position % capacity;
+        if (length > capacity - offset)
+            throw std::runtime_error("Received shared frame outside the ring from peer.");
+
+        // Pairs with the release store of the writer, made before the descriptor was sent.
+        input_ring.written->load(std::memory_order_acquire);
+
+        auto begin = input_ring.data + offset;
+        this->setg(begin, begin, begin + length);
+        holding_shared = true;
+        shared_release = position + length;
+        return true;
+    }
+
+    int SharedMemoryStream::Buffer::underflow() {
+        if (!input_framed) return stream->sgetc();
+        if (this->gptr() < this->egptr()) return traits_type::to_int_type(*this->gptr());
+
+        while (true) {
+            release();
+
+            if (inline_remaining > 0) {
+                auto length = std::min<uint64_t>(inline_remaining, input_buffer.size());
+                auto read   = stream->sgetn(input_buffer.data(), std::streamsize(length));
+                if (read <= 0) return traits_type::eof();
+
+                inline_remaining -= read;
+                this->setg(input_buffer.data(), input_buffer.data(), input_buffer.data() + read);
+                return traits_type::to_int_type(*this->gptr());
+            }
+
+            if (!next_frame()) return traits_type::eof();
+            if (this->gptr() < this->egptr()) return traits_type::to_int_type(*this->gptr());
+        }
+    }
+
+    int SharedMemoryStream::Buffer::uflow() {
+        if (!input_framed) return stream->sbumpc();
+        return std::streambuf::uflow();
+    }
+
+    std::streamsize SharedMemoryStream::Buffer::xsgetn(char *data, std::streamsize length) {
+        if (!input_framed) return stream->sgetn(data, length);
+
+        std::streamsize total = 0;
+        while (total < length) {
+            auto available = this->egptr() - this->gptr();
+            if (available > 0) {
+                auto count = std::min<std::streamsize>(available, length - total);
+                std::memcpy(data + total, this->gptr(), count);
+                this->setg(this->eback(), this->gptr() + count, this->egptr());
+                total += count;
+
+                // Hand the ring space back as soon as possible; the writer falls back to inline frames without it.
+                if (this->gptr() == this->egptr() && holding_shared) release();
+                continue;
+            }
+
+            // Large inline reads skip the input buffer.
+            auto remaining = uint64_t(length - total);
+            if (inline_remaining > 0 && remaining >= input_buffer.size()) {
+                auto read = stream->sgetn(data + total, std::streamsize(std::min(remaining, inline_remaining)));
+                if (read <= 0) break;
+                inline_remaining -= read;
+                total += read;
+                continue;
+            }
+
+            if (traits_type::eq_int_type(underflow(), traits_type::eof())) break;
+        }
+        return total;
+    }
+
+    void SharedMemoryStream::Buffer::put_inline(const char *data, size_t length) {
+        uint64_t size = length;
+
+        if (frame_header_size + length <= output_buffer.size()) {
+            output_buffer[0] = char(inline_frame);
+            std::memcpy(output_buffer.data() + 1, &size, sizeof(size));
+            std::memcpy(output_buffer.data() + frame_header_size, data, length);
+            stream->sputn(output_buffer.data(), std::streamsize(frame_header_size + length));
+            return;
+        }
+
+        char header[frame_header_size];
+        header[0] = char(inline_frame);
+        std::memcpy(header + 1, &size, sizeof(size));
+        stream->sputn(header, frame_header_size);
+        stream->sputn(data, std::streamsize(length));
+    }
+
+    bool SharedMemoryStream::Buffer::put_shared(const char *data, size_t length) {
+        uint64_t start = round_up(next_position, alignment);
+        if (start % capacity + length > capacity) start = round_up(start, capacity);
+
+        if (start + length - output_ring.consumed->load(std::memory_order_acquire) > capacity) return false;
+
+        std::memcpy(output_ring.data + start % capacity, data, length);
+        next_position = start + length;
+        output_ring.written->store(next_position, std::memory_order_release);
+
+        uint64_t size = length;
+        char header[shared_header_size];
+        header[0] = char(shared_frame);
+        std::memcpy(header + 1, &size, sizeof(size));
+        std::memcpy(header + frame_header_size, &start, sizeof(start));
+        stream->sputn(header, shared_header_size);
+        return true;
+    }
+
+    std::streamsize SharedMemoryStream::Buffer::xsputn(const char *data, std::streamsize length) {
+        if (!output_framed) return stream->sputn(data, length);
+
+        if (size_t(length) < shared_threshold) {
+            put_inline(data, length);
+            return length;
+        }
+
+        // Chunks of a quarter ring, so a large array streams through while the peer is reading it.
+        const size_t chunk_size = capacity / 4;
+        for (std::streamsize position = 0; position < length;) {
+            auto chunk = std::min<size_t>(chunk_size, length - position);
+            if (!put_shared(data + position, chunk)) put_inline(data + position, chunk);
+            position += chunk;
+        }
+        return length;
+    }
+
+    int SharedMemoryStream::Buffer::overflow(int ch) {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return sync() == 0 ? 0 : traits_type::eof();
+        if (!output_framed) return stream->sputc(traits_type::to_char_type(ch));
+
+        char c = traits_type::to_char_type(ch);
+        put_inline(&c, 1);
+        return ch;
+    }
+
+    int SharedMemoryStream::Buffer::sync() {
+        return stream->pubsync();
+    }
+
+    SharedMemoryStream::SharedMemoryStream(
+        std::unique_ptr<std::iostream> stream, std::shared_ptr<SharedMemorySegment> segment)
+        : std::iostream(nullptr), stream(std::move(stream)), segment_(std::move(segment)) {
+        buffer = std::make_unique<Buffer>(this->stream->rdbuf(), *segment_);
+        this->rdbuf(buffer.get());
+    }
+
+    SharedMemoryStream::~SharedMemoryStream() = default;
+
+    void SharedMemoryStream::frame_input() {
+        buffer->frame_input();
+    }
+
+    void SharedMemoryStream::frame_output() {
+        buffer->frame_output();
+    }
+}
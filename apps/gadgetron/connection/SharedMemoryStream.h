@@ -0,0 +1,95 @@
+#pragma once
+
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace Gadgetron::Connection {
+
+    /**
+     * Shared memory for bulk data exchanged with a peer on the same host. The segment holds one ring per direction;
+     * large writes are copied into the ring, and only a small descriptor crosses the stream.
+     *
+     * Layout of the segment, in native byte order:
+     *   0                      uint64 magic, uint64 version, uint64 ring capacity in bytes
+     *   128                    ring 0, written by the creator and read by the peer
+     *   128 + 128 + capacity   ring 1, written by the peer and read by the creator
+     * Each ring starts with a uint64 'written' position at offset 0 and a uint64 'consumed' position at offset 64,
+     * followed by the data at offset 128.
+     *
+     * Positions only ever increase; the data of a position is at (position % capacity) in the ring.
+     */
+    class SharedMemorySegment {
+    public:
+        enum class Role { creator, peer };
+
+        static constexpr size_t default_capacity = 4 * 1024 * 1024;
+
+        /// Creates a uniquely named segment. Its name is removed again when the creator is destroyed.
+        static std::shared_ptr<SharedMemorySegment> create(size_t capacity = default_capacity);
+        /// Maps a segment created by someone else.
+        static std::shared_ptr<SharedMemorySegment> open(const std::string &name);
+
+        ~SharedMemorySegment();
+
+        const std::string &name() const { return name_; }
+        Role role() const { return role_; }
+        size_t capacity() const { return capacity_; }
+
+        /// Removes the name of the segment; mappings stay valid until they are destroyed.
+        void remove();
+
+        struct Ring {
+            std::atomic<uint64_t> *written;
+            std::atomic<uint64_t> *consumed;
+            char *data;
+        };
+
+        Ring outbound() const;
+        Ring inbound() const;
+
+    private:
+        SharedMemorySegment(std::string name, Role role, boost::interprocess::mapped_region region);
+        Ring ring(size_t index) const;
+
+        const std::string name_;
+        const Role role_;
+        boost::interprocess::mapped_region region;
+        size_t capacity_;
+        bool removed = false;
+    };
+
+    /**
+     * Wraps a stream, and passes everything through until framing is enabled for a direction. From then on, the
+     * stream carries frames in that direction:
+     *   uint8 0, uint64 length, followed by length bytes          (inline)
+     *   uint8 1, uint64 length, uint64 position                  (shared; the bytes are in the ring)
+     * Writes of 512 KiB or more go through the ring. The writer never waits for the ring; data that does not fit is
+     * sent inline. The reader stores position + length into 'consumed' once it has read the bytes of a frame.
+     *
+     * Reading and writing may happen on different threads, as with the stream wrapped.
+     */
+    class SharedMemoryStream : public std::iostream {
+    public:
+        SharedMemoryStream(std::unique_ptr<std::iostream> stream, std::shared_ptr<SharedMemorySegment> segment);
+        ~SharedMemoryStream() override;
+
+        /// Everything read from here on is framed. Call between messages.
+        void frame_input();
+        /// Everything written from here on is framed. Call between messages.
+        void frame_output();
+
+        const std::shared_ptr<SharedMemorySegment> &segment() const { return segment_; }
+
+    private:
+        class Buffer;
+
+        std::unique_ptr<std::iostream> stream;
+        std::shared_ptr<SharedMemorySegment> segment_;
+        std::unique_ptr<Buffer> buffer;
+    };
+}
@@ -7,6 +7,9 @@
 #include "Types.h"
 
 #include <boost/asio.hpp>
+
+#include <algorithm>
+#include <array>
 namespace {
     using boost::asio::ip::tcp;
 
@@ -21,10 +24,12 @@ namespace {
 
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size, bool coalesce_writes);
+        ~SocketStreamBuf() override;
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
+        std::streamsize xsgetn(char_type* data, std::streamsize length) override;
 
         int sync() override;
         int underflow() override;
@@ -34,6 +39,7 @@ namespace {
         std::unique_ptr<boost::asio::ip::tcp::socket> socket;
         std::vector<char> input_buffer;
         std::vector<char> output_buffer;
+        const bool coalesce_writes;
 
         /* Other members */
     };
@@ -60,27 +66,76 @@ namespace {
         return 0;
     }
 
+    std::streamsize SocketStreamBuf::xsgetn(char* data, std::streamsize length) {
+        // Hand out what is already buffered, then read large remainders straight into the destination.
+        // Bulk data, such as acquisition samples, thus never passes through the input buffer.
+        auto buffered = std::min<std::streamsize>(length, this->egptr() - this->gptr());
+        std::copy_n(this->gptr(), buffered, data);
+        this->setg(this->eback(), this->gptr() + buffered, this->egptr());
+
+        auto remaining = length - buffered;
+        if (remaining == 0) return length;
+
+        if (remaining < std::streamsize(input_buffer.size()))
+            return buffered + std::streambuf::xsgetn(data + buffered, remaining);
+
+        return buffered + boost::asio::read(*socket, boost::asio::buffer(data + buffered, remaining));
+    }
+
     std::streamsize SocketStreamBuf::xsputn(const char* data, std::streamsize length) {
-        this->overflow();
-        return boost::asio::write(*socket, boost::asio::buffer(data, length));
+        if (!coalesce_writes) {
+            this->overflow();
+            return boost::asio::write(*socket, boost::asio::buffer(data, length));
+        }
+
+        // Small writes only land in the output buffer; many messages thus leave in a single write once flushed.
+        if (length <= this->epptr() - this->pptr()) {
+            std::copy_n(data, length, this->pptr());
+            this->pbump(int(length));
+            return length;
+        }
+
+        // Whatever is pending goes out together with the new data, in one gathered (vectored) write.
+        std::array<boost::asio::const_buffer, 2> buffers{
+            boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())),
+            boost::asio::buffer(data, length)
+        };
+        boost::asio::write(*socket, buffers);
+        this->setp(this->pbase(), this->epptr());
+        return length;
     }
-    SocketStreamBuf::SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
-        : socket(std::move(socket)), input_buffer(buffer_size), output_buffer(buffer_size) {
+
+    SocketStreamBuf::SocketStreamBuf(
+        std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size, bool coalesce_writes)
+        : socket(std::move(socket)), input_buffer(buffer_size), output_buffer(buffer_size),
+          coalesce_writes(coalesce_writes) {
+        // Ask the kernel for matching socket buffers; it is free to cap the sizes, which is fine.
+        boost::system::error_code ignored;
+        this->socket->set_option(boost::asio::socket_base::receive_buffer_size(int(buffer_size)), ignored);
+        this->socket->set_option(boost::asio::socket_base::send_buffer_size(int(buffer_size)), ignored);
         this->setg(input_buffer.data(), input_buffer.data() + buffer_size, input_buffer.data() + buffer_size);
         this->setp(output_buffer.data(), output_buffer.data() + buffer_size);
     }
 
+    SocketStreamBuf::~SocketStreamBuf() {
+        try {
+            this->overflow();
+        } catch (...) {
+            // The peer is gone; there is no one left to deliver the pending output to.
+        }
+    }
+
     using namespace Gadgetron::Connection;
     class SocketStream : public std::iostream {
     public:
-        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket)
-            : std::iostream(new SocketStreamBuf(std::move(socket))) {
+        SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size, bool coalesce_writes)
+            : std::iostream(new SocketStreamBuf(std::move(socket), buffer_size, coalesce_writes)) {
             buffer = std::unique_ptr<SocketStreamBuf>(static_cast<SocketStreamBuf*>(this->rdbuf()));
         }
 
-        SocketStream(const std::string& host, const std::string& service,
+        SocketStream(const std::string& host, const std::string& service, size_t buffer_size, bool coalesce_writes,
             std::shared_ptr<boost::asio::io_service> io_service = std::make_shared<boost::asio::io_service>())
-            : SocketStream(connect_socket(host, service, *io_service)) {
+            : SocketStream(connect_socket(host, service, *io_service), buffer_size, coalesce_writes) {
             this->io_service = io_service;
         }
 
@@ -94,11 +149,11 @@ namespace {
 
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
-    std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
-    return std::make_unique<SocketStream>(std::move(socket));
+    std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size, bool coalesce_writes) {
+    return std::make_unique<SocketStream>(std::move(socket), buffer_size, coalesce_writes);
 }
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
-    const std::string& host, const std::string& service) {
-    return std::make_unique<SocketStream>(host, service);
+    const std::string& host, const std::string& service, size_t buffer_size, bool coalesce_writes) {
+    return std::make_unique<SocketStream>(host, service, buffer_size, coalesce_writes);
 }
@@ -5,6 +5,17 @@
 
 namespace Gadgetron::Connection {
 
-    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
-    std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service);
-}
\ No newline at end of file
+    constexpr size_t default_socket_buffer_size = 256 * 1024;
+
+    /**
+     * By default, every write goes straight to the socket. With coalesce_writes, output is held in the buffer until
+     * it is full or the stream is flushed, and larger writes leave together with the pending output in one vectored
+     * write. Users of a coalescing stream must flush it whenever the peer is expected to see what was written.
+     */
+    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+                                                      size_t buffer_size = default_socket_buffer_size,
+                                                      bool coalesce_writes = false);
+    std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service,
+                                                 size_t buffer_size = default_socket_buffer_size,
+                                                 bool coalesce_writes = false);
+}
@@ -76,7 +76,7 @@ namespace Gadgetron::Server::Connection::StreamConnection {
 
         Loader loader{context};
 
-        auto ichannel = make_channel<MessageChannel>();
+        auto ichannel = Stream::make_queue_channel(config.stream.queue);
         auto ochannel = make_channel<MessageChannel>();
 
         auto node = loader.load(config.stream);
@@ -1,13 +1,21 @@
 
 #include <list>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 
 #include "Distributed.h"
 
-#include "connection/stream/common/Closer.h"
+#include "connection/Multiplexing.h"
 #include "connection/stream/common/Discovery.h"
+#include "connection/stream/common/External.h"
 #include "connection/stream/common/ExternalChannel.h"
 #include "io/iostream_operators.h"
+#include "io/primitives.h"
+#include "MessageID.h"
+#include "MPMCChannel.h"
 
 namespace {
     using namespace Gadgetron;
@@ -15,49 +23,879 @@ namespace {
     using namespace Gadgetron::Core::Distributed;
     using namespace Gadgetron::Server::Connection;
     using namespace Gadgetron::Server::Connection::Stream;
+    using namespace Gadgetron::Server::Connection::Multiplexing;
 
-    class ChannelWrapper {
+    /**
+     * Tracks the outstanding jobs and measured job duration of every peer, and hands out the peer with the least
+     * expected wait - the same measure the distributed worker pool uses. Peers that fail are not used again.
+     */
+    class Peers {
     public:
-        ChannelWrapper(
-                const Address &peer,
+        Peers(const std::vector<Address> &addresses, size_t max_jobs_per_peer);
+
+        size_t acquire();
+        void release(size_t peer, std::chrono::milliseconds duration);
+        void fail(size_t peer);
+
+        /// Fails any acquire, waiting or to come.
+        void shutdown();
+
+        const Address &address(size_t peer) const { return peers[peer].address; }
+
+    private:
+        struct Peer {
+            Address address;
+            size_t outstanding = 0;
+            std::chrono::milliseconds latency = std::chrono::seconds(5);
+            bool failed = false;
+        };
+
+        long long expected_wait(const Peer &peer) const;
+        bool available(const Peer &peer) const;
+
+        const size_t max_jobs_per_peer;
+        std::vector<Peer> peers;
+        bool shutting_down = false;
+        std::mutex mutex;
+        std::condition_variable peer_released;
+    };
+
+    Peers::Peers(
+            const std::vector<Address> &addresses,
+            size_t max_jobs_per_peer
+    ) : max_jobs_per_peer(max_jobs_per_peer) {
+        for (auto &address : addresses) peers.push_back(Peer{address});
+    }
+
+    long long Peers::expected_wait(const Peer &peer) const {
+        return peer.latency.count() * (peer.outstanding + 1);
+    }
+
+    bool Peers::available(const Peer &peer) const {
+        return !peer.failed && (!max_jobs_per_peer || peer.outstanding < max_jobs_per_peer);
+    }
+
+    size_t Peers::acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (shutting_down) throw std::runtime_error("Distributed processing is shutting down.");
+            if (std::all_of(peers.begin(), peers.end(), [](auto &peer) { return peer.failed; }))
+                throw std::runtime_error("No peers available for distributed processing.");
+
+            auto best = peers.end();
+            for (auto it = peers.begin(); it != peers.end(); ++it) {
+                if (!available(*it)) continue;
+                if (best == peers.end() || expected_wait(*it) < expected_wait(*best)) best = it;
+            }
+
+            if (best != peers.end()) {
+                best->outstanding++;
+                return size_t(std::distance(peers.begin(), best));
+            }
+
+            peer_released.wait(lock);
+        }
+    }
+
+    void Peers::release(size_t index, std::chrono::milliseconds duration) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto &peer = peers[index];
+            peer.outstanding--;
+            // Smooth the estimate, so a single odd job does not swing the balance.
+            peer.latency = (3 * peer.latency + duration) / 4;
+        }
+        peer_released.notify_all();
+    }
+
+    void Peers::fail(size_t index) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto &peer = peers[index];
+            peer.outstanding--;
+            peer.failed = true;
+        }
+        peer_released.notify_all();
+    }
+
+    void Peers::shutdown() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            shutting_down = true;
+        }
+        peer_released.notify_all();
+    }
+
+    /**
+     * Places jobs on peers, and moves them off failed ones, on a thread of its own. Waiting for a free peer never
+     * blocks the distributor creating jobs, nor the reader of a peer connection; the jobs already placed must go on
+     * receiving input and delivering output for the peers to free up.
+     */
+    class Scheduler {
+    public:
+        Scheduler() : thread([this]() { run(); }) {}
+        ~Scheduler() { stop(); }
+
+        void post(std::function<void()> task);
+
+        /// Runs the tasks already posted, and drops any posted later.
+        void stop();
+
+    private:
+        void run();
+
+        MPMCChannel<std::function<void()>> tasks;
+        std::once_flag stopped;
+        std::thread thread;
+    };
+
+    void Scheduler::post(std::function<void()> task) {
+        try {
+            tasks.push(std::move(task));
+        }
+        catch (const ChannelClosed &) {}
+    }
+
+    void Scheduler::stop() {
+        std::call_once(stopped, [this]() {
+            tasks.close();
+            thread.join();
+        });
+    }
+
+    void Scheduler::run() {
+        try {
+            while (true) tasks.pop()();
+        }
+        catch (const ChannelClosed &) {}
+    }
+
+    /**
+     * The connection of a single Distributed node to a peer, carrying every job sent there. Each job gets a channel
+     * of its own; what happens on it is passed to the listener of the channel.
+     */
+    class PeerConnection {
+    public:
+        /// Called on a reader thread; blocking here may hold up other channels of the connection.
+        class Listener {
+        public:
+            virtual ~Listener() = default;
+            virtual void message(Message message) = 0;
+            virtual void closed(std::list<std::string> errors) = 0;
+            virtual void failed(const std::string &reason) = 0;
+        };
+
+        virtual ~PeerConnection() = default;
+
+        virtual ChannelID open(std::shared_ptr<Listener> listener) = 0;
+        virtual void send(ChannelID channel, Message message) = 0;
+        virtual void close(ChannelID channel) = 0;
+    };
+
+    /**
+     * A long-lived connection to a peer, multiplexing every job sent there (see Multiplexing.h). The configuration
+     * and header are sent once, when connecting. A single thread reads the output of all the jobs, and sending is
+     * serialized on the socket; jobs have no threads of their own.
+     */
+    class MultiplexedPeer : public PeerConnection {
+    public:
+        MultiplexedPeer(
+                Address address,
+                std::unique_ptr<std::iostream> stream,
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration
         );
+        ~MultiplexedPeer() override;
 
-        void process_input(GenericInputChannel input);
-        void process_output(OutputChannel output);
+        ChannelID open(std::shared_ptr<Listener> listener) override;
+        void send(ChannelID channel, Message message) override;
+        void close(ChannelID channel) override;
 
     private:
-        std::shared_ptr<ExternalChannel> external;
+        void write(Frame &frame);
+        void read();
+        void dispatch(Frame &frame);
+        void drop(ChannelID channel, const std::shared_ptr<Listener> &listener, const std::string &reason);
+        void fail(const std::string &reason);
+
+        const Address address;
+        const std::shared_ptr<Serialization> serialization;
+        std::unique_ptr<std::iostream> stream;
+
+        std::mutex write_mutex;
+        bool broken = false;
+
+        std::mutex mutex;
+        ChannelID next_channel = 1;
+        std::map<ChannelID, std::shared_ptr<Listener>> listeners;
+        std::map<ChannelID, std::list<std::string>> errors;
+
+        std::thread reader;
     };
 
-    ChannelWrapper::ChannelWrapper(
-            const Address &peer,
+    MultiplexedPeer::MultiplexedPeer(
+            Address address,
+            std::unique_ptr<std::iostream> stream,
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration
+    ) : address(std::move(address)),
+        serialization(std::move(serialization)),
+        stream(std::move(stream)) {
+
+        configuration->send_multiplexed(*this->stream);
+        this->stream->flush();
+
+        reader = std::thread([this]() { read(); });
+    }
+
+    MultiplexedPeer::~MultiplexedPeer() {
+        // The peer closes its end once every channel is done; the reader sees it off.
+        try {
+            std::lock_guard<std::mutex> guard(write_mutex);
+            if (!broken) {
+                IO::write(*stream, CLOSE);
+                stream->flush();
+            }
+        }
+        catch (...) {}
+
+        reader.join();
+    }
+
+    ChannelID MultiplexedPeer::open(std::shared_ptr<Listener> listener) {
+        {
+            std::lock_guard<std::mutex> guard(write_mutex);
+            if (broken) throw std::runtime_error("Connection to peer failed.");
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto channel = next_channel++;
+        listeners[channel] = std::move(listener);
+        return channel;
+    }
+
+    void MultiplexedPeer::send(ChannelID channel, Message message) {
+        Frame frame(channel);
+        serialization->write(frame.payload(), std::move(message));
+        write(frame);
+    }
+
+    void MultiplexedPeer::close(ChannelID channel) {
+        Frame frame(channel);
+        serialization->close(frame.payload());
+        write(frame);
+    }
+
+    void MultiplexedPeer::write(Frame &frame) {
+        std::lock_guard<std::mutex> guard(write_mutex);
+        if (broken) throw std::runtime_error("Connection to peer failed.");
+
+        try {
+            frame.write(*stream);
+            stream->flush();
+        }
+        catch (...) {
+            broken = true;
+            throw;
+        }
+    }
+
+    void MultiplexedPeer::read() {
+        std::string reason = "Peer closed the connection.";
+        try {
+            while (true) {
+                auto id = IO::read<uint16_t>(*stream);
+                if (id == CLOSE) break;
+                if (id == TEXT) {
+                    GWARN_STREAM("Peer " << address << " reported: " << IO::read_string_from_stream<uint32_t>(*stream));
+                    continue;
+                }
+                if (id != FRAME)
+                    throw std::runtime_error("Received illegal message id from peer: " + std::to_string(id));
+
+                Frame frame(*stream);
+                dispatch(frame);
+            }
+        }
+        catch (const std::exception &e) {
+            reason = e.what();
+        }
+        fail(reason);
+    }
+
+    void MultiplexedPeer::dispatch(Frame &frame) {
+        std::shared_ptr<Listener> listener;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto it = listeners.find(frame.channel());
+            if (it == listeners.end()) return;
+            listener = it->second;
+        }
+
+        if (frame.message_id() == CLOSE) {
+            std::list<std::string> channel_errors;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                listeners.erase(frame.channel());
+                channel_errors = std::move(errors[frame.channel()]);
+                errors.erase(frame.channel());
+            }
+            listener->closed(std::move(channel_errors));
+            return;
+        }
+
+        // The frame is whole; what is in it concerns its channel alone, and failing to make sense of it must not
+        // take the other channels of the connection down with it.
+        try {
+            if (frame.message_id() == ERROR) {
+                IO::read<uint16_t>(frame.payload());
+                auto error = IO::read_string_from_stream<uint64_t>(frame.payload());
+
+                std::lock_guard<std::mutex> guard(mutex);
+                errors[frame.channel()].push_back(std::move(error));
+                return;
+            }
+
+            listener->message(serialization->read(
+                    frame.payload(),
+                    []() { throw std::runtime_error("Unexpected close in frame."); },
+                    [](auto) { throw std::runtime_error("Unexpected error in frame."); }
+            ));
+        }
+        catch (const std::exception &e) {
+            drop(frame.channel(), listener, e.what());
+        }
+    }
+
+    // Fails a single channel; anything the peer sends on it later is ignored.
+    void MultiplexedPeer::drop(ChannelID channel, const std::shared_ptr<Listener> &listener, const std::string &reason) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            listeners.erase(channel);
+            errors.erase(channel);
+        }
+        listener->failed(reason);
+    }
+
+    void MultiplexedPeer::fail(const std::string &reason) {
+        std::map<ChannelID, std::shared_ptr<Listener>> failed;
+        {
+            std::lock_guard<std::mutex> guard(write_mutex);
+            broken = true;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            std::swap(failed, listeners);
+            errors.clear();
+        }
+        for (auto &pair : failed) pair.second->failed(reason);
+    }
+
+    /**
+     * The fallback for peers that do not support multiplexing: every job gets a connection of its own, configured on
+     * its own, with a thread reading its output.
+     */
+    class PerJobPeer : public PeerConnection {
+    public:
+        PerJobPeer(
+                Address address,
+                std::shared_ptr<Serialization> serialization,
+                std::shared_ptr<Configuration> configuration
+        ) : address(std::move(address)),
+            serialization(std::move(serialization)),
+            configuration(std::move(configuration)) {}
+
+        ~PerJobPeer() override;
+
+        ChannelID open(std::shared_ptr<Listener> listener) override;
+        void send(ChannelID channel, Message message) override;
+        void close(ChannelID channel) override;
+
+    private:
+        std::shared_ptr<ExternalChannel> find(ChannelID channel);
+        void read(ChannelID channel, std::shared_ptr<ExternalChannel> external, std::shared_ptr<Listener> listener);
+
+        const Address address;
+        const std::shared_ptr<Serialization> serialization;
+        const std::shared_ptr<Configuration> configuration;
+
+        std::mutex mutex;
+        ChannelID next_channel = 1;
+        std::map<ChannelID, std::shared_ptr<ExternalChannel>> channels;
+        std::list<std::thread> readers;
+    };
+
+    PerJobPeer::~PerJobPeer() {
+        // Every reader ends with its connection; the peer closes those once the job is done.
+        for (auto &reader : readers) reader.join();
+    }
+
+    ChannelID PerJobPeer::open(std::shared_ptr<Listener> listener) {
+        auto stream = connect(address, configuration);
+        stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+        auto external = std::make_shared<ExternalChannel>(std::move(stream), serialization, configuration);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto channel = next_channel++;
+        channels[channel] = external;
+        readers.emplace_back([this, channel, external, listener]() { read(channel, external, listener); });
+        return channel;
+    }
+
+    std::shared_ptr<ExternalChannel> PerJobPeer::find(ChannelID channel) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = channels.find(channel);
+        if (it == channels.end()) throw std::runtime_error("Connection to peer closed.");
+        return it->second;
+    }
+
+    void PerJobPeer::send(ChannelID channel, Message message) {
+        find(channel)->push_message(std::move(message));
+    }
+
+    void PerJobPeer::close(ChannelID channel) {
+        find(channel)->close();
+    }
+
+    void PerJobPeer::read(
+            ChannelID channel,
+            std::shared_ptr<ExternalChannel> external,
+            std::shared_ptr<Listener> listener
+    ) {
+        auto forget = [&]() {
+            std::lock_guard<std::mutex> guard(mutex);
+            channels.erase(channel);
+        };
+
+        try {
+            while (true) listener->message(external->pop());
+        }
+        catch (const ChannelClosed &) {
+            forget();
+            listener->closed({});
+        }
+        catch (const RemoteError &e) {
+            forget();
+            listener->closed(e.errors());
+        }
+        catch (const std::exception &e) {
+            forget();
+            listener->failed(e.what());
+        }
+    }
+
+    // Asks the peer, before configuring it, whether it takes multiplexed connections. Peers that predate them do not
+    // know the query; they report an error and close the connection.
+    bool supports_multiplexing(std::iostream &stream) {
+        IO::write(stream, QUERY);
+        IO::write(stream, uint64_t(0)); // Reserved.
+        IO::write(stream, uint64_t(0)); // Correlation id.
+        IO::write_string_to_stream<uint64_t>(stream, std::string(multiplex_query));
+        stream.flush();
+
+        if (IO::read<uint16_t>(stream) != RESPONSE) return false;
+        IO::read<uint64_t>(stream);
+        return IO::read_string_from_stream<uint64_t>(stream) == "1";
+    }
+
+    std::unique_ptr<PeerConnection> connect_peer(
+            const Address &address,
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
     ) {
-        GINFO_STREAM("Connecting to peer: " << peer);
-        external = std::make_shared<ExternalChannel>(
-                connect(peer, configuration),
-                std::move(serialization),
-                std::move(configuration)
+        auto stream = connect(address, configuration);
+        stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+
+        if (supports_multiplexing(*stream)) {
+            return std::make_unique<MultiplexedPeer>(
+                    address, std::move(stream), std::move(serialization), std::move(configuration));
+        }
+
+        GWARN_STREAM("Peer " << address << " does not support multiplexed connections; each job gets its own.");
+        return std::make_unique<PerJobPeer>(address, std::move(serialization), std::move(configuration));
+    }
+
+    /**
+     * The connections of a single Distributed node; each peer is connected once, when it is first given a job.
+     */
+    class PeerConnections {
+    public:
+        PeerConnections(
+                std::shared_ptr<Peers> peers,
+                std::shared_ptr<Serialization> serialization,
+                std::shared_ptr<Configuration> configuration
+        ) : peers(std::move(peers)),
+            serialization(std::move(serialization)),
+            configuration(std::move(configuration)) {}
+
+        ~PeerConnections();
+
+        PeerConnection &get(size_t peer);
+
+    private:
+        const std::shared_ptr<Peers> peers;
+        const std::shared_ptr<Serialization> serialization;
+        const std::shared_ptr<Configuration> configuration;
+
+        std::mutex mutex;
+        std::map<size_t, std::unique_ptr<PeerConnection>> connections;
+        bool closing = false;
+    };
+
+    PeerConnections::~PeerConnections() {
+        // Jobs still running when the connections close fail over; they must not find a new one.
+        std::map<size_t, std::unique_ptr<PeerConnection>> closed;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            closing = true;
+            std::swap(closed, connections);
+        }
+    }
+
+    PeerConnection &PeerConnections::get(size_t peer) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (closing) throw std::runtime_error("Distributed processing is shutting down.");
+
+        auto &connection = connections[peer];
+        if (!connection) {
+            GINFO_STREAM("Connecting to peer: " << peers->address(peer));
+            connection = connect_peer(peers->address(peer), serialization, configuration);
+        }
+        return *connection;
+    }
+
+    /**
+     * A single distributed job, running on one peer at a time.
+     *
+     * Jobs are created unplaced, and their input is kept until the scheduler finds them a peer. If retries are
+     * allowed, every message sent is kept until the job is done, so that the job can be replayed on another peer if
+     * its current peer fails. The replacement peer reproduces the output already passed on, which is skipped.
+     *
+     * Input is sent on the thread pushing it; output arrives on the reader thread of the peer connection. Placing
+     * and moving the job happens on the scheduler thread.
+     */
+    class Job : public std::enable_shared_from_this<Job> {
+    public:
+        Job(
+                std::shared_ptr<Peers> peers,
+                PeerConnections &connections,
+                Scheduler &scheduler,
+                OutputChannel output,
+                ErrorHandler error_handler,
+                size_t retries,
+                std::function<void()> on_finished
         );
+
+        /// Hands the job to the scheduler, to be placed on a peer once one is free.
+        void start();
+        void push(Message message);
+        void close();
+
+    private:
+        struct Connection {
+            size_t peer;
+            PeerConnection *remote;
+            ChannelID channel;
+            size_t generation;
+        };
+
+        // Passes on what happens to the channel of a single connection; the generation tells stale ones apart.
+        class Binding : public PeerConnection::Listener {
+        public:
+            Binding(std::shared_ptr<Job> job, size_t generation) : job(std::move(job)), generation(generation) {}
+
+            void message(Message message) override { job->received(generation, std::move(message)); }
+            void closed(std::list<std::string> errors) override { job->closed(generation, std::move(errors)); }
+            void failed(const std::string &reason) override { job->failed(generation, reason); }
+
+        private:
+            const std::shared_ptr<Job> job;
+            const size_t generation;
+        };
+
+        Connection current();
+        Connection open(size_t peer, size_t generation);
+
+        void schedule_move(size_t from_generation);
+        void move(size_t from_generation);
+        void replay(const Connection &connection);
+
+        void received(size_t generation, Message message);
+        void closed(size_t generation, std::list<std::string> errors);
+        void failed(size_t generation, const std::string &reason);
+
+        void finish();
+
+        const std::shared_ptr<Peers> peers;
+        PeerConnections &connections;
+        Scheduler &scheduler;
+        const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        OutputChannel output;
+        ErrorHandler error_handler;
+        const std::function<void()> on_finished;
+
+        // Held while sending to the peer, so replayed messages stay in order with new ones. The output never takes
+        // it; a peer blocked on writing its output must never keep us from reading it. Jobs are only ever moved on
+        // the scheduler thread, and never wait for a peer holding it.
+        std::mutex send_mutex;
+        std::vector<Message> sent;
+        bool input_closed = false;
+        size_t retries_left;
+
+        std::mutex mutex;
+        Connection connection{0, nullptr, 0, 0}; // Generation 0 is the job before it is placed.
+        size_t emitted = 0, to_skip = 0;
+        bool exhausted = false, finished = false, output_failed = false;
+    };
+
+    Job::Job(
+            std::shared_ptr<Peers> peers,
+            PeerConnections &connections,
+            Scheduler &scheduler,
+            OutputChannel output,
+            ErrorHandler error_handler,
+            size_t retries,
+            std::function<void()> on_finished
+    ) : peers(std::move(peers)),
+        connections(connections),
+        scheduler(scheduler),
+        output(std::move(output)),
+        error_handler(std::move(error_handler)),
+        on_finished(std::move(on_finished)),
+        retries_left(retries) {}
+
+    void Job::start() {
+        schedule_move(0);
+    }
+
+    // Moving a job may wait for a free peer, and replays its input; neither may hold up the reader thread of a peer
+    // connection, which delivers the output, and frees the peers, of every other job there.
+    void Job::schedule_move(size_t from_generation) {
+        scheduler.post([job = shared_from_this(), from_generation]() {
+            job->error_handler.handle([&]() { job->move(from_generation); });
+
+            bool failed;
+            {
+                std::lock_guard<std::mutex> guard(job->mutex);
+                failed = job->exhausted;
+            }
+            if (failed) job->finish();
+        });
+    }
+
+    // Runs on the scheduler, which alone changes the connection. No lock is held waiting for a peer; input pushed in
+    // the meantime is logged, or sent to the failed peer - failing, and scheduling a move that will then be stale.
+    void Job::move(size_t from_generation) {
+        Connection previous;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (exhausted) throw std::runtime_error("Distributed job failed on multiple peers; aborting.");
+            if (finished || connection.generation != from_generation) return;
+            previous = connection;
+        }
+
+        // Placing a new job costs no retries; moving it off a failed peer does. The channel on the failed peer is
+        // closed already; either by the peer, or with the connection.
+        const bool moving = previous.remote != nullptr;
+        optional<size_t> failed_peer = moving ? optional<size_t>(previous.peer) : none;
+        auto generation = from_generation;
+
+        while (true) {
+            size_t peer;
+            try {
+                if (failed_peer) {
+                    GWARN_STREAM("Peer " << peers->address(*failed_peer) << " failed processing job. The job will be moved.");
+                    peers->fail(*failed_peer);
+                }
+                if (moving) {
+                    std::lock_guard<std::mutex> send_guard(send_mutex);
+                    std::lock_guard<std::mutex> guard(mutex);
+                    if (!retries_left) throw std::runtime_error("Distributed job failed on multiple peers; aborting.");
+                    retries_left--;
+                }
+
+                peer = peers->acquire();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(mutex);
+                exhausted = true;
+                throw;
+            }
+
+            Connection replacement;
+            try {
+                replacement = open(peer, ++generation);
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Failed to connect to peer " << peers->address(peer) << " [" << e.what() << "]");
+                failed_peer = peer;
+                continue;
+            }
+
+            // The new connection is current before replaying, so none of the output it produces is missed.
+            std::lock_guard<std::mutex> send_guard(send_mutex);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                connection = replacement;
+                to_skip = emitted;
+            }
+
+            try {
+                replay(replacement);
+                return;
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Failed to replay job on peer " << peers->address(peer) << " [" << e.what() << "]");
+                failed_peer = peer;
+            }
+        }
+    }
+
+    // Sends the logged input to a new connection; called with the send mutex held. With no retries left, the log is
+    // not needed again.
+    void Job::replay(const Connection &connection) {
+        for (auto &message : sent) {
+            connection.remote->send(connection.channel, retries_left ? message.clone() : std::move(message));
+        }
+        if (!retries_left) std::vector<Message>().swap(sent);
+        if (input_closed) connection.remote->close(connection.channel);
+    }
+
+    Job::Connection Job::open(size_t peer, size_t generation) {
+        auto &remote = connections.get(peer);
+        auto channel = remote.open(std::make_shared<Binding>(shared_from_this(), generation));
+        return Connection{peer, &remote, channel, generation};
+    }
+
+    Job::Connection Job::current() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return connection;
+    }
+
+    void Job::push(Message message) {
+        std::lock_guard<std::mutex> send_guard(send_mutex);
+        auto connection = current();
+        if (!connection.remote) {
+            sent.push_back(std::move(message));
+            return;
+        }
+
+        if (retries_left) sent.push_back(message.clone());
+        try {
+            connection.remote->send(connection.channel, std::move(message));
+        }
+        catch (const std::exception &) {
+            // The message is in the log, if there are retries left; the replacement peer gets it with the rest.
+            schedule_move(connection.generation);
+        }
+    }
+
+    void Job::close() {
+        std::lock_guard<std::mutex> send_guard(send_mutex);
+        if (input_closed) return;
+        input_closed = true;
+        auto connection = current();
+        if (!connection.remote) return;
+        try {
+            connection.remote->close(connection.channel);
+        }
+        catch (const std::exception &) {
+            schedule_move(connection.generation);
+        }
+    }
+
+    void Job::received(size_t generation, Message message) {
+        size_t index;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            // Output from a peer we have since given up on is reproduced by its replacement.
+            if (connection.generation != generation || output_failed) return;
+            if (to_skip) { to_skip--; return; }
+            index = emitted++;
+        }
+
+        // Runs on the reader thread of the peer connection. The output failing is no fault of the peer; it is
+        // reported once, and the rest of the output is dropped as the job runs to its end.
+        try {
+            output.push_message(std::move(message));
+        }
+        catch (...) {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                output_failed = true;
+            }
+            error_handler.handle([error = std::current_exception()]() { std::rethrow_exception(error); });
+            return;
+        }
+        GDEBUG_FIELDS("Pushed message to distributed output", "peer", peers->address(current().peer), "index", index);
     }
 
-    void ChannelWrapper::process_input(GenericInputChannel input) {
-        auto closer = make_closer(external);
-        for (auto message : input) {
-            external->push_message(std::move(message));
+    void Job::closed(size_t generation, std::list<std::string> errors) {
+        // A peer reporting errors on a clean close has done its part; the errors are the job's, not the peer's, and
+        // go to the error handler. Only a peer closing early without them has failed. Taking the send mutex waits
+        // out any replay in progress.
+        bool done;
+        Connection connection;
+        {
+            std::lock_guard<std::mutex> send_guard(send_mutex);
+            connection = current();
+            done = connection.generation == generation && (input_closed || !errors.empty());
+        }
+        if (!done) {
+            schedule_move(generation);
+            return;
+        }
+
+        for (auto &error : errors) {
+            error_handler.handle([&]() { throw std::runtime_error(error); });
         }
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time);
+        peers->release(connection.peer, duration);
+        finish();
+    }
+
+    void Job::failed(size_t generation, const std::string &reason) {
+        GWARN_STREAM("Lost connection to peer [" << reason << "]");
+        schedule_move(generation);
     }
 
-    void ChannelWrapper::process_output(OutputChannel output) {
-        while(true) {
-            output.push_message(external->pop());
-            GDEBUG_STREAM("Pushed message to distributed output.");
+    void Job::finish() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (finished) return;
+            finished = true;
+        }
+        {
+            // The job is kept until every job is done; its log is not.
+            std::lock_guard<std::mutex> send_guard(send_mutex);
+            std::vector<Message>().swap(sent);
         }
+        on_finished();
     }
 
+    // The input end of a job; pushing to it sends to the current peer.
+    class JobInput : public Channel {
+    public:
+        explicit JobInput(std::weak_ptr<Job> job) : job(std::move(job)) {}
+
+    protected:
+        Message pop() override { throw ChannelClosed(); }
+        optional<Message> try_pop() override { throw ChannelClosed(); }
+
+        void push_message(Message message) override {
+            if (auto job = this->job.lock()) job->push(std::move(message));
+        }
+
+        void close() override {
+            if (auto job = this->job.lock()) job->close();
+        }
+
+    private:
+        const std::weak_ptr<Job> job;
+    };
+
     class ChannelCreatorImpl : public ChannelCreator {
     public:
         OutputChannel create() override;
@@ -67,67 +905,89 @@ namespace {
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration,
                 OutputChannel output_channel,
-                ErrorHandler& error_handler
+                ErrorHandler& error_handler,
+                size_t max_jobs_per_peer,
+                size_t retries
         );
+        ~ChannelCreatorImpl();
 
     private:
-        Address next_peer();
-
         OutputChannel output;
 
-        std::shared_ptr<Serialization> serialization;
-        std::shared_ptr<Configuration> configuration;
-
-        std::list<Address> peers;
-        std::list<std::thread> threads;
+        std::shared_ptr<Peers> peers;
+        Scheduler scheduler;
+        std::unique_ptr<PeerConnections> connections;
+        const size_t retries;
 
         ErrorHandler error_handler;
+
+        struct Entry {
+            std::shared_ptr<Job> job;
+            GenericInputChannel input; // Unused, but closes the job when dropped; it is kept until the job is done.
+        };
+
+        std::mutex mutex;
+        std::condition_variable job_finished;
+        std::list<Entry> jobs;
+        size_t finished = 0;
     };
 
     ChannelCreatorImpl::ChannelCreatorImpl(
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration,
             OutputChannel output_channel,
-            ErrorHandler &error_handler
-    ) : serialization(std::move(serialization)),
-        configuration(std::move(configuration)),
-        output(std::move(output_channel)),
-        error_handler(error_handler, "Distributed") {
+            ErrorHandler &error_handler,
+            size_t max_jobs_per_peer,
+            size_t retries
+    ) : output(std::move(output_channel)),
+        peers(std::make_shared<Peers>(discover_peers(), max_jobs_per_peer)),
+        connections(std::make_unique<PeerConnections>(peers, std::move(serialization), std::move(configuration))),
+        retries(retries),
+        error_handler(error_handler, "Distributed") {}
 
-        auto ps = discover_peers();
-        std::copy(ps.begin(), ps.end(), std::back_inserter(peers));
+    ChannelCreatorImpl::~ChannelCreatorImpl() {
+        // Unless joined, jobs may still be waiting for a peer; they will not get one.
+        peers->shutdown();
+        scheduler.stop();
     }
 
     OutputChannel ChannelCreatorImpl::create() {
 
-        auto pair = Core::make_channel<MessageChannel>();
-
-        auto channel = std::make_shared<ChannelWrapper>(
-                next_peer(),
-                serialization,
-                configuration
+        auto job = std::make_shared<Job>(
+                peers,
+                *connections,
+                scheduler,
+                Core::split(output),
+                error_handler,
+                retries,
+                [this]() {
+                    {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        finished++;
+                    }
+                    job_finished.notify_all();
+                }
         );
 
-        threads.push_back(error_handler.run(
-                [=](auto in) { channel->process_input(std::move(in)); },
-                std::move(pair.input)
-        ));
-        threads.push_back(error_handler.run(
-                [=](auto out) { channel->process_output(std::move(out)); },
-                Core::split(output)
-        ));
+        auto pair = Core::make_channel<JobInput>(job);
+        job->start();
 
+        std::lock_guard<std::mutex> guard(mutex);
+        jobs.push_back(Entry{job, std::move(pair.input)});
         return std::move(pair.output);
     }
 
     void ChannelCreatorImpl::join() {
-        for (auto &thread : threads) thread.join();
-    }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_finished.wait(lock, [this]() { return finished == jobs.size(); });
+        }
 
-    Address ChannelCreatorImpl::next_peer() {
-        auto peer = peers.front(); peers.pop_front();
-        peers.push_back(peer);
-        return peer;
+        // Jobs refer to the peer connections; those are closed last, waiting for their readers. Anything scheduled
+        // for the jobs by then is stale.
+        scheduler.stop();
+        jobs.clear();
+        connections.reset();
     }
 }
 
@@ -154,7 +1014,9 @@ namespace Gadgetron::Server::Connection::Stream {
             serialization,
             configuration,
             Core::split(output),
-            error_handler
+            error_handler,
+            max_jobs_per_peer,
+            retries
         };
 
         distributor->process(std::move(input), channel_creator, std::move(output));
@@ -173,7 +1035,9 @@ namespace Gadgetron::Server::Connection::Stream {
                 context,
                 config
         )),
-        distributor(load_distributor(loader, context, config.distributor)) {}
+        distributor(load_distributor(loader, context, config.distributor)),
+        max_jobs_per_peer(config.max_jobs_per_peer),
+        retries(config.retries) {}
 
     const std::string& Distributed::name() {
         static const std::string n = "Distributed";
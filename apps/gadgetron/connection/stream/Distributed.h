@@ -37,6 +37,9 @@ namespace Gadgetron::Server::Connection::Stream {
 
         const std::shared_ptr<Serialization> serialization;
         const std::shared_ptr<Configuration> configuration;
+
+        const size_t max_jobs_per_peer;
+        const size_t retries;
     };
 }
 
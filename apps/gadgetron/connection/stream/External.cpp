@@ -2,6 +2,7 @@
 
 #include "connection/Config.h"
 #include "connection/SocketStreamBuf.h"
+#include "connection/SharedMemoryStream.h"
 #include "connection/stream/common/Closer.h"
 #include "connection/stream/common/ExternalChannel.h"
 
@@ -20,11 +21,24 @@ using tcp = boost::asio::ip::tcp;
 
 namespace {
 
-    const std::map<std::string, std::function<boost::process::child(const Config::Execute &, unsigned short, const Context &)>> modules{
+    const std::map<std::string, std::function<boost::process::child(const Config::Execute &, unsigned short, const std::string &, const Context &)>> modules{
             {"python", start_python_module},
             {"matlab", start_matlab_module}
     };
 
+    // Modules we launch run on this host, and may take bulk data through shared memory instead of the socket. Only
+    // modules configured for it get a segment; others would leave it unused, taking up /dev/shm for nothing.
+    std::shared_ptr<Gadgetron::Connection::SharedMemorySegment> create_shared_memory(const Config::Execute &execute) {
+        if (!execute.shared_memory) return nullptr;
+        try {
+            return Gadgetron::Connection::SharedMemorySegment::create();
+        }
+        catch (const std::exception &e) {
+            GWARN_STREAM("Could not create shared memory for external module; using the socket only: " << e.what());
+            return nullptr;
+        }
+    }
+
     void process_input(GenericInputChannel input, std::shared_ptr<ExternalChannel> external) {
         auto closer = make_closer(external);
         for (auto message : input) {
@@ -68,7 +82,10 @@ namespace Gadgetron::Server::Connection::Stream {
 
         GINFO_STREAM("Waiting for external module '" << execute.name << "' on port: " << port);
 
-        auto child = std::make_shared<boost::process::child>(modules.at(execute.type)(execute, port, context));
+        auto shared_memory = create_shared_memory(execute);
+        auto child = std::make_shared<boost::process::child>(
+                modules.at(execute.type)(execute, port, shared_memory ? shared_memory->name() : "", context)
+        );
 
         monitors.child = std::async(
                 std::launch::async,
@@ -85,14 +102,17 @@ namespace Gadgetron::Server::Connection::Stream {
 
         GINFO_STREAM("Connected to external module '" << execute.name << "' on port: " << port);
 
+        // Every write goes straight to the socket; with shared memory, most of them are small descriptors.
+        socket->set_option(tcp::no_delay(true));
+
         auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
-        auto external_channel = std::make_shared<ExternalChannel>(
-                std::move(stream),
+        if (!shared_memory) return std::make_shared<ExternalChannel>(std::move(stream), serialization, configuration);
+
+        return std::make_shared<ExternalChannel>(
+                std::make_unique<Gadgetron::Connection::SharedMemoryStream>(std::move(stream), shared_memory),
                 serialization,
                 configuration
         );
-
-        return external_channel;
     }
 
     std::shared_ptr<ExternalChannel> External::open_external_channel(
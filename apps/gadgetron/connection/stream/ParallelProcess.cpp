@@ -1,60 +1,243 @@
 #include "ParallelProcess.h"
 
 #include "ThreadPool.h"
+#include "MPMCRingBuffer.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 
 using namespace Gadgetron::Core;
 
 namespace Gadgetron::Server::Connection::Stream {
 
-    void ParallelProcess::process_input(GenericInputChannel input, Queue &queue) {
+    /**
+     * Counts messages from the moment they are submitted until they have been passed on, and holds the input
+     * back while max_in_flight messages are underway. Closing the window releases the input, should the output fail.
+     *
+     * Tasks are counted apart from messages, from submission until they have run; they use the stream and the window,
+     * so a call waits for its tasks before returning, even if its output failed.
+     */
+    class ParallelProcess::InFlightWindow {
+    public:
+        explicit InFlightWindow(size_t limit) : limit{ limit } {}
+
+        void acquire() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this]() { return closed || !limit || in_flight < limit; });
+            if (closed) throw ChannelClosed();
+            in_flight++;
+        }
+
+        void release() {
+            { std::lock_guard<std::mutex> guard(m); in_flight--; }
+            cv.notify_all();
+        }
 
-        ThreadPool pool(workers ? workers : std::thread::hardware_concurrency());
+        void drain() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this]() { return closed || in_flight == 0; });
+        }
 
-        for (auto message : input) {
-            queue.push(
-                pool.async(
-                        [&](auto message) { return pureStream.process_function(std::move(message)); },
-                        std::move(message)
-                )
-            );
+        void close() {
+            { std::lock_guard<std::mutex> guard(m); closed = true; }
+            cv.notify_all();
+        }
+
+        void task_submitted() {
+            std::lock_guard<std::mutex> guard(m);
+            tasks++;
+        }
+
+        // Notifies with the lock held; the window may be gone the moment a waiting call sees the last task finish.
+        void task_finished() {
+            std::lock_guard<std::mutex> guard(m);
+            tasks--;
+            cv.notify_all();
+        }
+
+        void wait_for_tasks() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [this]() { return tasks == 0; });
         }
 
-        pool.join(); queue.close();
+        class Task {
+        public:
+            explicit Task(InFlightWindow &window) : window{ window } {}
+            ~Task() { window.task_finished(); }
+        private:
+            InFlightWindow &window;
+        };
+
+    private:
+        const size_t limit;
+        size_t in_flight = 0;
+        size_t tasks = 0;
+        bool closed = false;
+        std::mutex m;
+        std::condition_variable cv;
+    };
+
+    namespace {
+        struct Completed {
+            optional<Message> message;
+            std::exception_ptr error;
+        };
     }
 
-    void ParallelProcess::process_output(OutputChannel output, Queue &queue) {
-        while(true) output.push_message(queue.pop().get());
+    template<class SUBMIT>
+    void ParallelProcess::process_input(GenericInputChannel input, InFlightWindow &window, SUBMIT submit) {
+
+        auto submit_all = [&](ThreadPool &pool) {
+            for (auto message : input) {
+                window.acquire();
+                window.task_submitted();
+                try {
+                    submit(pool, std::move(message));
+                } catch (...) {
+                    window.task_finished();
+                    throw;
+                }
+            }
+        };
+
+        // A shared pool serves every connection, rather than adding a set of threads per connection.
+        if (shared_pool) {
+            submit_all(ThreadPool::shared());
+            return;
+        }
+
+        ThreadPool pool(workers);
+        submit_all(pool);
+        pool.join();
     }
 
-    void ParallelProcess::process(GenericInputChannel input,
+    template<class QUEUE>
+    void ParallelProcess::process_output(OutputChannel output, QUEUE &queue, InFlightWindow &window) {
+        try {
+            while (true) {
+                output.push_message(queue.pop().get());
+                window.release();
+            }
+        } catch (...) {
+            window.close(); queue.close();
+            throw;
+        }
+    }
+
+    template<class QUEUE>
+    void ParallelProcess::process_ordered(GenericInputChannel input,
+            OutputChannel output,
+            ErrorHandler& error_handler,
+            QUEUE &queue
+    ) {
+        InFlightWindow window(max_in_flight);
+
+        auto input_thread = error_handler.run(
+                [&](auto input) {
+                    this->process_input(std::move(input), window, [&](ThreadPool &pool, Message message) {
+                        queue.push(pool.async(
+                                [this, &window](auto message) {
+                                    InFlightWindow::Task task(window);
+                                    return pureStream.process_function(std::move(message));
+                                },
+                                std::move(message)
+                        ));
+                    });
+                    queue.close();
+                },
+                std::move(input)
+        );
+
+        auto output_thread = error_handler.run(
+                [&](auto output) { this->process_output(std::move(output), queue, window); },
+                std::move(output)
+        );
+
+        input_thread.join(); output_thread.join();
+        window.wait_for_tasks();
+    }
+
+    void ParallelProcess::process_unordered(GenericInputChannel input,
             OutputChannel output,
             ErrorHandler& error_handler
     ) {
-        Queue queue;
+        InFlightWindow window(max_in_flight);
+
+        // Tasks may still push their results after the output has failed, so they share ownership of the channel.
+        auto completed = std::make_shared<MPMCChannel<Completed>>();
 
         auto input_thread = error_handler.run(
-                [&](auto input) { this->process_input(std::move(input), queue); },
+                [&](auto input) {
+                    this->process_input(std::move(input), window, [&](ThreadPool &pool, Message message) {
+                        pool.async([this, &window, completed](auto message) {
+                            InFlightWindow::Task task(window);
+                            try {
+                                completed->push(Completed{ pureStream.process_function(std::move(message)), nullptr });
+                            } catch (...) {
+                                completed->push(Completed{ none, std::current_exception() });
+                            }
+                        }, std::move(message));
+                    });
+                    window.drain();
+                    completed->close();
+                },
                 std::move(input)
         );
 
         auto output_thread = error_handler.run(
-                [&](auto output) { this->process_output(std::move(output), queue); },
+                [&](auto output) {
+                    try {
+                        while (true) {
+                            auto result = completed->pop();
+                            if (result.error) std::rethrow_exception(result.error);
+                            output.push_message(std::move(*result.message));
+                            window.release();
+                        }
+                    } catch (...) {
+                        window.close(); completed->close();
+                        throw;
+                    }
+                },
                 std::move(output)
         );
 
         input_thread.join(); output_thread.join();
+        window.wait_for_tasks();
+    }
+
+    void ParallelProcess::process(GenericInputChannel input,
+            OutputChannel output,
+            ErrorHandler& error_handler
+    ) {
+        if (!ordered) {
+            process_unordered(std::move(input), std::move(output), error_handler);
+        } else if (queue.capacity) {
+            MPMCRingBuffer<ThreadPool::Future<Message>> bounded_queue(
+                    queue.capacity,
+                    queue.spin ? WaitPolicy::Spin : WaitPolicy::Block
+            );
+            process_ordered(std::move(input), std::move(output), error_handler, bounded_queue);
+        } else {
+            MPMCChannel<ThreadPool::Future<Message>> unbounded_queue;
+            process_ordered(std::move(input), std::move(output), error_handler, unbounded_queue);
+        }
     }
 
     ParallelProcess::ParallelProcess(
             const Config::ParallelProcess& conf,
-            const Context& context,
+            const StreamContext& context,
             Loader& loader
-    ) : pureStream{ conf.stream, context, loader }, workers{ conf.workers } {}
+    ) : workers{ conf.workers },
+        pureStream{ conf.stream, context, loader },
+        queue{ conf.queue },
+        // On the shared pool, the thread budget of the connection bounds how many of its messages are underway.
+        max_in_flight{ conf.max_in_flight || !(conf.shared_pool || !conf.workers) ? conf.max_in_flight : context.budget.threads },
+        ordered{ conf.ordered },
+        shared_pool{ conf.shared_pool || !conf.workers } {}
 
     const std::string& ParallelProcess::name() {
         const static std::string n = "ParallelProcess";
         return n;
     }
 }
-
-
@@ -2,23 +2,32 @@
 
 #include "PureStream.h"
 #include "connection/stream/Processable.h"
-#include <future>
+#include "ThreadPool.h"
 
 namespace Gadgetron::Server::Connection::Stream {
     class ParallelProcess : public Processable {
 
     public:
-        ParallelProcess(const Config::ParallelProcess& conf, const Core::Context& context, Loader& loader);
+        ParallelProcess(const Config::ParallelProcess& conf, const Core::StreamContext& context, Loader& loader);
         void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler) override;
         const std::string& name() override;
     private:
+        class InFlightWindow;
 
-        using Queue = Core::MPMCChannel<std::future<Core::Message>>;
+        template<class QUEUE>
+        void process_ordered(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler, QUEUE &queue);
+        void process_unordered(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler);
 
-        void process_input(Core::GenericInputChannel input, Queue &queue);
-        void process_output(Core::OutputChannel output, Queue &queue);
+        template<class SUBMIT>
+        void process_input(Core::GenericInputChannel input, InFlightWindow &window, SUBMIT submit);
+        template<class QUEUE>
+        void process_output(Core::OutputChannel output, QUEUE &queue, InFlightWindow &window);
 
         const size_t workers;
         const PureStream pureStream;
+        const Config::Queue queue;
+        const size_t max_in_flight;
+        const bool ordered;
+        const bool shared_pool;
     };
 }
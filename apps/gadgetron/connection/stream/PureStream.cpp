@@ -34,17 +34,10 @@ Gadgetron::Server::Connection::Stream::PureStream::PureStream(
     const Gadgetron::Server::Connection::Config::PureStream& conf,
     const Gadgetron::Core::Context& context,
     Loader& loader
-) : pure_gadgets{ load_pure_gadgets(conf.gadgets, context, loader) } {}
+) : pure_gadgets{ load_pure_gadgets(conf.gadgets, context, loader), conf.fused } {}
 
 Gadgetron::Core::Message Gadgetron::Server::Connection::Stream::PureStream::process_function(
     Gadgetron::Core::Message message
 ) const {
-    return std::accumulate(
-            pure_gadgets.begin(),
-            pure_gadgets.end(),
-            std::move(message),
-            [](auto& message, auto& gadget) {
-                return gadget->process_function(std::move(message));
-            }
-    );
+    return pure_gadgets.process_function(std::move(message));
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "Message.h"
 #include "PureGadget.h"
+#include "PureChain.h"
 #include "connection/Loader.h"
 #include "connection/Config.h"
 
@@ -11,6 +12,6 @@ namespace Gadgetron::Server::Connection::Stream {
         Core::Message process_function(Core::Message) const;
 
     private:
-        const std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets;
+        const Core::PureChain pure_gadgets;
     };
 }
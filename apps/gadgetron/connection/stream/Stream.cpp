@@ -83,7 +83,12 @@ namespace {
 
 namespace Gadgetron::Server::Connection::Stream {
 
-    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key) {
+    Core::ChannelPair make_queue_channel(const Config::Queue &queue) {
+        if (!queue.capacity) return make_channel<MessageChannel>();
+        return make_channel<BoundedMessageChannel>(queue.capacity, queue.spin ? WaitPolicy::Spin : WaitPolicy::Block);
+    }
+
+    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key), queue(config.queue) {
         for (auto &node_config : config.nodes) {
             nodes.emplace_back(
                     Core::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
@@ -102,7 +107,7 @@ namespace Gadgetron::Server::Connection::Stream {
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = make_queue_channel(queue);
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
@@ -32,6 +32,13 @@ namespace Gadgetron::Server::Connection::Stream {
 
     private:
         std::vector<std::shared_ptr<Processable>> nodes;
+        const Config::Queue queue;
     };
+
+    /**
+     * Creates a channel as configured; a plain MessageChannel when no capacity is set, a BoundedMessageChannel
+     * otherwise.
+     */
+    Core::ChannelPair make_queue_channel(const Config::Queue &queue);
 }
 
@@ -33,6 +33,12 @@ namespace Gadgetron::Server::Connection::Stream {
         send_header(stream, context.header);
     }
 
+    void Configuration::send_multiplexed(std::iostream &stream) const {
+        send_config(stream, config);
+        IO::write(stream, MULTIPLEX);
+        send_header(stream, context.header);
+    }
+
     Configuration::Configuration(
             Core::StreamContext context,
             Config config
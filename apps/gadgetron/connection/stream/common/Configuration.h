@@ -12,6 +12,8 @@ namespace Gadgetron::Server::Connection::Stream {
         const Core::StreamContext context;
 
         void send(std::iostream &stream) const;
+        /// Configures a multiplexed connection; see Multiplexing.h.
+        void send_multiplexed(std::iostream &stream) const;
 
         Configuration(Core::StreamContext context, Config config);
         Configuration(Core::StreamContext context, Config::External config);
@@ -12,6 +12,7 @@ namespace Gadgetron::Server::Connection::Stream {
     class RemoteError : public std::runtime_error {
     public:
         explicit RemoteError(std::list<std::string> messages);
+        const std::list<std::string> &errors() const { return messages; }
     private:
         const std::list<std::string> messages;
     };
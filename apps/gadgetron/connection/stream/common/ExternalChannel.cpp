@@ -5,6 +5,10 @@
 #include "Configuration.h"
 #include "External.h"
 
+#include "io/primitives.h"
+#include "MessageID.h"
+#include "log.h"
+
 using namespace Gadgetron::Core;
 
 namespace Gadgetron::Server::Connection::Stream {
@@ -53,7 +57,8 @@ namespace Gadgetron::Server::Connection::Stream {
                     [&](auto message) {
                         channel->outbound->close();
                         channel->remote_errors.push_back(message);
-                    }
+                    },
+                    [&](auto &stream) { channel->accept_shared_memory(stream); }
             );
         }
 
@@ -87,6 +92,37 @@ namespace Gadgetron::Server::Connection::Stream {
         configuration->send(*this->stream);
     }
 
+    ExternalChannel::ExternalChannel(
+            std::unique_ptr<Gadgetron::Connection::SharedMemoryStream> stream,
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration
+    ) : ExternalChannel(
+            std::unique_ptr<std::iostream>(std::move(stream)),
+            std::move(serialization),
+            std::move(configuration)
+    ) {
+        shared_memory = static_cast<Gadgetron::Connection::SharedMemoryStream *>(this->stream.get());
+    }
+
+    void ExternalChannel::accept_shared_memory(std::iostream &stream) {
+        auto name = IO::read_string_from_stream<uint32_t>(stream);
+        if (!shared_memory || name != shared_memory->segment()->name())
+            throw std::runtime_error("External peer accepted an unknown shared memory segment: " + name);
+
+        // Everything the peer sends after accepting is framed. Our answer tells the peer the same of our output.
+        shared_memory->frame_input();
+        shared_memory->segment()->remove();
+
+        std::lock_guard<std::mutex> guard{mutex};
+        if (!dynamic_cast<Outbound::Open *>(outbound.get())) return;
+
+        IO::write(*this->stream, SHARED_MEMORY);
+        IO::write_string_to_stream<uint32_t>(*this->stream, name);
+        shared_memory->frame_output();
+
+        GDEBUG_STREAM("External peer uses shared memory segment: " << name);
+    }
+
     Core::Message ExternalChannel::pop() {
         return inbound->pop();
     }
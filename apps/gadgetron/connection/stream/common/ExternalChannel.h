@@ -4,6 +4,7 @@
 #include <list>
 
 #include "connection/Config.h"
+#include "connection/SharedMemoryStream.h"
 
 #include "Context.h"
 #include "Channel.h"
@@ -28,6 +29,13 @@ namespace Gadgetron::Server::Connection::Stream {
                 std::shared_ptr<Configuration> configuration
         );
 
+        /// Offers the shared memory of the stream to the peer; a peer accepting the offer says so in its first message.
+        ExternalChannel(
+                std::unique_ptr<Gadgetron::Connection::SharedMemoryStream> stream,
+                std::shared_ptr<Serialization> serialization,
+                std::shared_ptr<Configuration> configuration
+        );
+
         Core::Message pop();
         void push_message(Core::Message message);
         void close();
@@ -36,6 +44,9 @@ namespace Gadgetron::Server::Connection::Stream {
         std::unique_ptr<std::iostream> stream;
         std::list<std::string> remote_errors;
 
+        Gadgetron::Connection::SharedMemoryStream *shared_memory = nullptr;
+        void accept_shared_memory(std::iostream &stream);
+
         std::shared_ptr<Serialization> serialization;
 
         class Outbound {
@@ -32,7 +32,8 @@ namespace Gadgetron::Server::Connection::Stream {
     Core::Message Serialization::read(
             std::iostream &stream,
             std::function<void()> on_close,
-            std::function<void(std::string message)> on_error
+            std::function<void(std::string message)> on_error,
+            std::function<void(std::iostream &)> on_shared_memory
     ) const {
 
         auto id = IO::read<uint16_t>(stream);
@@ -48,7 +49,11 @@ namespace Gadgetron::Server::Connection::Stream {
                 {TEXT,      illegal_message},
                 {QUERY,     illegal_message},
                 {RESPONSE,  illegal_message},
-                {ERROR,     [&](auto &stream) { on_error(IO::read_string_from_stream<uint64_t>(stream)); }}
+                {ERROR,     [&](auto &stream) { on_error(IO::read_string_from_stream<uint64_t>(stream)); }},
+                {SHARED_MEMORY, [&](auto &stream) {
+                    if (!on_shared_memory) illegal_message(stream);
+                    on_shared_memory(stream);
+                }}
         };
 
         for (; handlers.count(id); id = IO::read<uint16_t>(stream)) handlers.at(id)(stream);
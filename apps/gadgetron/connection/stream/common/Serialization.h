@@ -20,7 +20,8 @@ namespace Gadgetron::Server::Connection::Stream {
         Core::Message read(
                 std::iostream &stream,
                 std::function<void()> on_close,
-                std::function<void(std::string message)> on_error
+                std::function<void(std::string message)> on_error,
+                std::function<void(std::iostream &)> on_shared_memory = nullptr
         ) const;
     private:
         const Readers readers;
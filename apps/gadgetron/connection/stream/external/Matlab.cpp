@@ -9,13 +9,17 @@
 
 namespace Gadgetron::Server::Connection::Stream {
 
-    boost::process::child start_matlab_module(const Config::Execute &execute, unsigned short port, const Gadgetron::Core::Context &context) {
+    boost::process::child start_matlab_module(const Config::Execute &execute, unsigned short port, const std::string &shared_memory, const Gadgetron::Core::Context &context) {
+
+        boost::process::environment environment = boost::this_process::environment();
+        environment["GADGETRON_EXTERNAL_PORT"] = std::to_string(port);
+        environment["GADGETRON_EXTERNAL_MODULE"] = execute.name;
+        if (!shared_memory.empty()) environment["GADGETRON_SHARED_MEMORY"] = shared_memory;
 
         boost::process::child module(
                 boost::process::search_path("matlab"),
                 boost::process::args={"-batch", "gadgetron.external.main"},
-                boost::process::env["GADGETRON_EXTERNAL_PORT"] = std::to_string(port),
-                boost::process::env["GADGETRON_EXTERNAL_MODULE"] = execute.name
+                environment
         );
 
         GINFO_STREAM("Started external MATLAB module (pid: " << module.id() << ").");
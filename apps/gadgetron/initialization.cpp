@@ -1,6 +1,12 @@
-
 #include "initialization.h"
 
+#include <boost/filesystem.hpp>
+
+#include "log.h"
+#include "hoNDFFT.h"
+#include "BufferPool.h"
+#include "hoMemoryPool.h"
+
 #ifdef FORCE_LIMIT_OPENBLAS_NUM_THREADS
 #include <cblas.h>
 #endif
@@ -19,4 +25,49 @@ namespace Gadgetron::Server {
 #endif
 
     }
+
+    namespace {
+        FFTPlanningRigor parse_planning_rigor(const std::string &rigor) {
+            if (rigor == "estimate") return FFTPlanningRigor::Estimate;
+            if (rigor == "measure") return FFTPlanningRigor::Measure;
+            if (rigor == "patient") return FFTPlanningRigor::Patient;
+            throw std::runtime_error("Unknown FFT planning rigor: " + rigor);
+        }
+
+        // FFTW keeps separate wisdom for single and double precision.
+        template<class T>
+        void configure_fft(FFTPlanningRigor rigor, const boost::program_options::variables_map &args,
+                           const std::string &wisdom_file) {
+            auto fft = hoNDFFT<T>::instance();
+            fft->set_planning_rigor(rigor);
+
+            if (!args.count("fft_wisdom")) return;
+
+            auto wisdom = args["fft_wisdom"].as<boost::filesystem::path>() / wisdom_file;
+            if (boost::filesystem::exists(wisdom)) {
+                GINFO_STREAM("Importing FFTW wisdom from " << wisdom);
+                if (!fft->import_wisdom(wisdom.string())) {
+                    GWARN_STREAM("Failed to import FFTW wisdom from " << wisdom);
+                }
+            }
+
+            // The server is stopped rather than shut down, so wisdom is saved as plans are measured.
+            fft->set_wisdom_file(wisdom.string());
+        }
+    }
+
+    void configure_fft_planning(const boost::program_options::variables_map &args) {
+        auto rigor = parse_planning_rigor(args["fft_planning"].as<std::string>());
+
+        configure_fft<float>(rigor, args, "fftwf.wisdom");
+        configure_fft<double>(rigor, args, "fftw.wisdom");
+    }
+
+    void configure_buffer_pool(const boost::program_options::variables_map &args) {
+        Core::BufferPool::instance().set_max_cached_bytes(args["buffer_pool_size"].as<size_t>() << 20);
+
+        if (auto array_pool_size = args["array_pool_size"].as<size_t>()) {
+            hoMemoryPool::instance().enable(array_pool_size << 20);
+        }
+    }
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <boost/program_options/variables_map.hpp>
+
 namespace Gadgetron::Server {
     void configure_blas_libraries();
-}
\ No newline at end of file
+    void configure_fft_planning(const boost::program_options::variables_map &args);
+    void configure_buffer_pool(const boost::program_options::variables_map &args);
+}
@@ -12,6 +12,8 @@
 #include "gadgetron_config.h"
 
 #include "Server.h"
+#include "BufferPool.h"
+#include "connection/SocketStreamBuf.h"
 
 using namespace boost::filesystem;
 using namespace boost::program_options;
@@ -31,7 +33,42 @@ int main(int argc, char *argv[]) {
              "Set the Gadgetron home directory.")
             ("port,p",
              value<unsigned short>()->default_value(9002),
-             "Listen for incoming connections on this port.");
+             "Listen for incoming connections on this port.")
+            ("fft_planning",
+             value<std::string>()->default_value("estimate"),
+             "FFTW planning rigor; one of 'estimate', 'measure' or 'patient'.")
+            ("fft_wisdom",
+             value<path>(),
+             "Directory holding FFTW wisdom (fftwf.wisdom, fftw.wisdom); imported at startup, and saved as plans are measured.")
+            ("socket_buffer_size",
+             value<size_t>()->default_value(Gadgetron::Connection::default_socket_buffer_size),
+             "Size in bytes of the buffer used for incoming and outgoing connection data.")
+            ("coalesce_writes",
+             value<bool>()->default_value(true),
+             "Gather results sent to clients into large, vectored writes, rather than writing each piece separately.")
+            ("buffer_pool_size",
+             value<size_t>()->default_value(Gadgetron::Core::BufferPool::default_max_cached_bytes >> 20),
+             "Maximum memory in MiB kept in reserve for incoming acquisition data.")
+            ("array_pool_size",
+             value<size_t>()->default_value(0),
+             "Maximum memory in MiB kept cached for reuse by arrays; 0 leaves array memory to the system allocator.")
+            ("max_reconstructions",
+             value<size_t>()->default_value(0),
+             "Maximum number of connections reconstructing at the same time; others wait. 0 for no limit.")
+            ("max_waiting",
+             value<size_t>()->default_value(0),
+             "Maximum number of connections waiting to start; further connections are turned away. 0 for no limit.")
+            ("scanner_hosts",
+             value<std::vector<std::string>>()->multitoken(),
+             "Addresses of scanners; their connections start ahead of waiting offline connections.")
+            ("connection_threads",
+             value<size_t>()->default_value(0),
+             "Messages each connection may have underway in parallel processes on the shared pool. "
+             "0 shares the cores among max_reconstructions connections, or sets no limit without one.")
+            ("connection_memory",
+             value<size_t>()->default_value(0),
+             "Memory in MiB each connection may use; enforced on forked connection processes only. "
+             "0 shares the system memory among max_reconstructions connections, or sets no limit without one.");
 
     variables_map args;
     store(parse_command_line(argc, argv, desc), args);
@@ -52,6 +89,8 @@ int main(int argc, char *argv[]) {
 
     try {
         configure_blas_libraries();
+        configure_fft_planning(args);
+        configure_buffer_pool(args);
 
         // Ensure working directory exists.
         create_directories(args["dir"].as<path>());
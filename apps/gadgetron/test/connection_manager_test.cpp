@@ -0,0 +1,97 @@
+#include "../ConnectionManager.h"
+#include <gtest/gtest.h>
+#include <map>
+
+using namespace Gadgetron::Server;
+
+namespace {
+    using Priority = ConnectionManager::Priority;
+
+    // Records the order in which connections start, and keeps their completion for the test to call.
+    struct Recorder {
+        std::vector<int> started;
+        std::map<int, ConnectionManager::Done> done;
+
+        ConnectionManager::Start connection(int id) {
+            return [this, id](ConnectionManager::Done finished) {
+                started.push_back(id);
+                done[id] = std::move(finished);
+            };
+        }
+    };
+
+    ConnectionManager::Settings settings(size_t max_running, size_t max_waiting) {
+        ConnectionManager::Settings settings;
+        settings.max_running = max_running;
+        settings.max_waiting = max_waiting;
+        settings.scanners.push_back(boost::asio::ip::make_address("10.0.0.1"));
+        return settings;
+    }
+}
+
+TEST(ConnectionManager, unlimited) {
+    ConnectionManager manager(settings(0, 0));
+    Recorder recorder;
+
+    for (int i = 0; i < 10; i++) EXPECT_TRUE(manager.submit(Priority::offline, recorder.connection(i)));
+    EXPECT_EQ(recorder.started.size(), 10u);
+}
+
+TEST(ConnectionManager, scanner_connections_first) {
+    ConnectionManager manager(settings(2, 0));
+    Recorder recorder;
+
+    manager.submit(Priority::offline, recorder.connection(0));
+    manager.submit(Priority::offline, recorder.connection(1));
+    manager.submit(Priority::offline, recorder.connection(2));
+    manager.submit(Priority::offline, recorder.connection(3));
+    manager.submit(Priority::scanner, recorder.connection(4));
+    manager.submit(Priority::scanner, recorder.connection(5));
+
+    ASSERT_EQ(recorder.started, (std::vector<int>{ 0, 1 }));
+    auto statistics = ConnectionManager::statistics();
+    EXPECT_EQ(statistics.running, 2u);
+    EXPECT_EQ(statistics.waiting_scanner, 2u);
+    EXPECT_EQ(statistics.waiting_offline, 2u);
+
+    recorder.done[1]();
+    recorder.done[0]();
+    ASSERT_EQ(recorder.started, (std::vector<int>{ 0, 1, 4, 5 }));
+
+    recorder.done[4]();
+    recorder.done[5]();
+    recorder.done[2]();
+    ASSERT_EQ(recorder.started, (std::vector<int>{ 0, 1, 4, 5, 2, 3 }));
+
+    recorder.done[3]();
+    statistics = ConnectionManager::statistics();
+    EXPECT_EQ(statistics.running, 0u);
+    EXPECT_EQ(statistics.waiting_scanner + statistics.waiting_offline, 0u);
+}
+
+TEST(ConnectionManager, rejects_when_queue_full) {
+    ConnectionManager manager(settings(1, 2));
+    Recorder recorder;
+
+    auto rejected = ConnectionManager::statistics().rejected;
+
+    EXPECT_TRUE(manager.submit(Priority::offline, recorder.connection(0)));
+    EXPECT_TRUE(manager.submit(Priority::offline, recorder.connection(1)));
+    EXPECT_TRUE(manager.submit(Priority::scanner, recorder.connection(2)));
+    EXPECT_FALSE(manager.submit(Priority::scanner, recorder.connection(3)));
+
+    EXPECT_EQ(ConnectionManager::statistics().rejected, rejected + 1);
+
+    recorder.done[0]();
+    recorder.done[2]();
+    recorder.done[1]();
+    EXPECT_EQ(recorder.started, (std::vector<int>{ 0, 2, 1 }));
+}
+
+TEST(ConnectionManager, priority_by_address) {
+    ConnectionManager manager(settings(1, 0));
+
+    EXPECT_EQ(manager.priority(boost::asio::ip::make_address("10.0.0.1")), Priority::scanner);
+    EXPECT_EQ(manager.priority(boost::asio::ip::make_address("::ffff:10.0.0.1")), Priority::scanner);
+    EXPECT_EQ(manager.priority(boost::asio::ip::make_address("10.0.0.2")), Priority::offline);
+}
@@ -0,0 +1,76 @@
+#include "../connection/Multiplexing.h"
+#include "io/primitives.h"
+#include "MessageID.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Multiplexing;
+
+TEST(Multiplexing, frame_round_trip) {
+    std::stringstream stream;
+
+    for (ChannelID channel : { 1u, 7u, 1u }) {
+        Frame frame(channel);
+        IO::write(frame.payload(), uint16_t(1008));
+        IO::write(frame.payload(), std::vector<float>(channel * 100, float(channel)));
+        frame.write(stream);
+    }
+
+    Frame closing(7);
+    IO::write(closing.payload(), CLOSE);
+    closing.write(stream);
+
+    for (ChannelID channel : { 1u, 7u, 1u }) {
+        ASSERT_EQ(IO::read<uint16_t>(stream), FRAME);
+        Frame frame(stream);
+        EXPECT_EQ(frame.channel(), channel);
+        EXPECT_EQ(frame.message_id(), 1008);
+        EXPECT_EQ(IO::read<uint16_t>(frame.payload()), 1008);
+
+        auto data = IO::read<std::vector<float>>(frame.payload());
+        EXPECT_EQ(data, std::vector<float>(channel * 100, float(channel)));
+    }
+
+    ASSERT_EQ(IO::read<uint16_t>(stream), FRAME);
+    Frame frame(stream);
+    EXPECT_EQ(frame.channel(), 7u);
+    EXPECT_EQ(frame.message_id(), CLOSE);
+    EXPECT_EQ(stream.peek(), std::char_traits<char>::eof());
+}
+
+TEST(Multiplexing, reading_past_frame_throws) {
+    std::stringstream stream;
+
+    Frame frame(3);
+    IO::write(frame.payload(), CLOSE);
+    frame.write(stream);
+
+    IO::read<uint16_t>(stream);
+    Frame read(stream);
+    IO::read<uint16_t>(read.payload());
+    EXPECT_ANY_THROW(IO::read<uint64_t>(read.payload()));
+}
+
+TEST(Multiplexing, frame_too_long_throws) {
+    std::stringstream stream;
+    IO::write(stream, uint32_t(5));
+    IO::write(stream, Frame::max_length + 1);
+
+    EXPECT_THROW(Frame frame(stream), std::runtime_error);
+}
+
+TEST(Multiplexing, frame_cut_short_throws) {
+    std::stringstream stream;
+
+    Frame frame(5);
+    IO::write(frame.payload(), uint16_t(1008));
+    IO::write(frame.payload(), std::vector<float>(1000, 1.0f));
+    frame.write(stream);
+
+    auto bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+
+    IO::read<uint16_t>(truncated);
+    EXPECT_THROW(Frame read(truncated), std::runtime_error);
+}
@@ -0,0 +1,141 @@
+#include "../connection/SharedMemoryStream.h"
+#include "../connection/SocketStreamBuf.h"
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace ba = boost::asio;
+using tcp    = boost::asio::ip::tcp;
+using namespace Gadgetron;
+using namespace Gadgetron::Connection;
+
+namespace {
+    std::vector<char> random_bytes(size_t size) {
+        std::vector<char> data(size);
+        std::mt19937_64 engine(size);
+        std::uniform_int_distribution<int> distribution(-128, 127);
+        for (auto& d : data) d = char(distribution(engine));
+        return data;
+    }
+}
+
+class SharedMemoryTest : public ::testing::Test {
+public:
+    void connect(size_t capacity) {
+        auto endpoint = tcp::endpoint(tcp::v6(), 0);
+        tcp::acceptor acceptor(ios, endpoint);
+
+        auto port    = acceptor.local_endpoint().port();
+        auto socketF = std::async([&]() {
+            auto socket = std::make_unique<tcp::socket>(ios);
+            acceptor.accept(*socket);
+            return socket;
+        });
+
+        auto segment = SharedMemorySegment::create(capacity);
+        peer = std::make_unique<SharedMemoryStream>(
+            remote_stream("localhost", std::to_string(port)), SharedMemorySegment::open(segment->name()));
+        creator = std::make_unique<SharedMemoryStream>(stream_from_socket(socketF.get()), segment);
+    }
+
+    // Writes the data in pieces of the given lengths, and reads them back on the other end.
+    void round_trip(std::iostream& from, std::iostream& to, const std::vector<size_t>& lengths) {
+        size_t total = 0;
+        for (auto length : lengths) total += length;
+        auto data = random_bytes(total);
+
+        auto thread = std::thread([&]() {
+            size_t position = 0;
+            for (auto length : lengths) {
+                from.write(data.data() + position, length);
+                position += length;
+            }
+        });
+
+        auto data2 = std::vector<char>(total);
+        size_t position = 0;
+        for (auto length : lengths) {
+            to.read(data2.data() + position, length);
+            position += length;
+        }
+        thread.join();
+
+        ASSERT_TRUE(to.good());
+        ASSERT_EQ(data, data2);
+    }
+
+    ba::io_service ios{};
+    std::unique_ptr<SharedMemoryStream> creator, peer;
+};
+
+TEST_F(SharedMemoryTest, pass_through) {
+    connect(SharedMemorySegment::default_capacity);
+    round_trip(*creator, *peer, { 2, 100, 1 << 20, 7 });
+    round_trip(*peer, *creator, { 2, 100, 1 << 20, 7 });
+}
+
+TEST_F(SharedMemoryTest, framed) {
+    connect(SharedMemorySegment::default_capacity);
+
+    // Plain bytes may precede the switch, as the handshake does.
+    round_trip(*creator, *peer, { 16 });
+    creator->frame_output();
+    peer->frame_input();
+    peer->frame_output();
+    creator->frame_input();
+
+    const std::vector<size_t> lengths{ 2, 100, 1 << 20, 7, 1 << 16, 3, 5 << 20, 1 << 12, 1, 512 << 10 };
+    round_trip(*creator, *peer, lengths);
+    round_trip(*peer, *creator, lengths);
+}
+
+TEST_F(SharedMemoryTest, ring_full) {
+    // Arrays larger than the ring, and a reader that falls behind, fall back to inline frames.
+    connect(4 << 20);
+    creator->frame_output();
+    peer->frame_input();
+
+    round_trip(*creator, *peer, { 13 << 20, 1 << 20, 1 << 20, 1 << 20, 1 << 20, 1 << 20, 1 << 20, 9 });
+}
+
+TEST_F(SharedMemoryTest, character_reads) {
+    connect(SharedMemorySegment::default_capacity);
+    creator->frame_output();
+    peer->frame_input();
+
+    auto data = random_bytes(1 << 17);
+    creator->write(data.data(), data.size());
+    creator->put('x');
+
+    for (auto d : data) ASSERT_EQ(char(peer->get()), d);
+    ASSERT_EQ(peer->get(), 'x');
+}
+
+TEST(SharedMemorySegment, name_removed_with_creator) {
+    std::string name;
+    {
+        auto segment = SharedMemorySegment::create(4 << 20);
+        name = segment->name();
+        ASSERT_EQ(SharedMemorySegment::open(name)->capacity(), 4u << 20);
+    }
+    ASSERT_ANY_THROW(SharedMemorySegment::open(name));
+}
+
+TEST_F(SharedMemoryTest, rejects_frame_outside_ring) {
+    connect(4 << 20);
+    peer->frame_input();
+    peer->exceptions(std::iostream::badbit);
+
+    // A descriptor near the end of the ring, with a length that wraps offset + length around to a small number.
+    uint64_t position = (4 << 20) - 8;
+    uint64_t length   = ~uint64_t(0) - 4;
+    char descriptor[1 + 2 * sizeof(uint64_t)] = { 1 };
+    std::memcpy(descriptor + 1, &length, sizeof(length));
+    std::memcpy(descriptor + 1 + sizeof(length), &position, sizeof(position));
+    creator->write(descriptor, sizeof(descriptor));
+    creator->flush();
+
+    char c;
+    EXPECT_THROW(peer->read(&c, 1), std::exception);
+}
@@ -102,3 +102,58 @@ TEST_F(SocketTest, nulltest) {
     thread.join();
 }
 
+
+TEST_F(SocketTest, mixed_read_test) {
+    auto data = std::vector<char>(1u << 22);
+    std::mt19937_64 engine;
+    std::uniform_int_distribution<int> distribution(-128, 127);
+    for (auto& d : data) d = char(distribution(engine));
+
+    auto thread = std::thread([&]() { ba::write(*server_socket, ba::buffer(data.data(), data.size())); });
+
+    // Alternate small, buffered reads with reads large enough to bypass the buffer.
+    auto data2 = std::vector<char>(data.size());
+    size_t position = 0;
+    for (size_t length : { 7, 100, 1 << 20, 3, 1 << 19, 1 << 10 }) {
+        socketstream->read(data2.data() + position, length);
+        position += length;
+    }
+    socketstream->read(data2.data() + position, data2.size() - position);
+
+    ASSERT_EQ(data, data2);
+    thread.join();
+}
+
+
+TEST_F(SocketTest, coalesced_write_test) {
+    auto port    = acceptor->local_endpoint().port();
+    auto socketF = std::async([&]() {
+        tcp::socket socket{ ios };
+        acceptor->accept(socket);
+        return socket;
+    });
+    auto stream = Connection::remote_stream("localhost", std::to_string(port), 1u << 12, true);
+    auto socket = socketF.get();
+
+    auto data = std::vector<char>(1u << 20);
+    std::mt19937_64 engine;
+    std::uniform_int_distribution<int> distribution(-128, 127);
+    for (auto& d : data) d = char(distribution(engine));
+
+    // Small writes stay in the buffer, larger ones leave together with whatever is pending.
+    auto thread = std::thread([&]() {
+        size_t position = 0;
+        for (size_t length : { 5, 200, 3000, 1 << 16, 17, 1 << 12, 1 << 18 }) {
+            stream->write(data.data() + position, length);
+            position += length;
+        }
+        stream->write(data.data() + position, data.size() - position);
+        stream->flush();
+    });
+
+    auto data2 = std::vector<char>(data.size());
+    ba::read(socket, ba::buffer(data2.data(), data2.size()));
+
+    ASSERT_EQ(data, data2);
+    thread.join();
+}
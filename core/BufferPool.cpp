@@ -0,0 +1,38 @@
+#include "BufferPool.h"
+
+#include <new>
+
+namespace Gadgetron::Core {
+
+    BufferPool::BufferPool(size_t max_cached_bytes) : cache{ max_cached_bytes } {}
+
+    void* BufferPool::allocate(size_t bytes) {
+        auto size = hoBlockCache::size_class(bytes);
+
+        auto block = cache.take(size);
+        if (!block) block = hoBlockCache::allocate(size);
+
+        new (block) Header{ this, size };
+        return hoBlockCache::data_from_block(block);
+    }
+
+    void BufferPool::release(void* data) {
+        auto block  = hoBlockCache::block_from_data(data);
+        auto header = static_cast<Header*>(block);
+        header->pool->cache.give(block, header->size);
+    }
+
+    void BufferPool::set_max_cached_bytes(size_t bytes) {
+        cache.set_max_cached_bytes(bytes);
+    }
+
+    size_t BufferPool::cached_bytes() const {
+        return cache.cached_bytes();
+    }
+
+    BufferPool& BufferPool::instance() {
+        // Deliberately leaked; arrays may well be released during static destruction.
+        static auto pool = new BufferPool();
+        return *pool;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "hoBlockCache.h"
+#include "hoNDArray.h"
+
+#include <type_traits>
+#include <vector>
+
+namespace Gadgetron::Core {
+
+    /**
+     * Recycles the 64 byte aligned buffers behind incoming data arrays.
+     *
+     * Readers receive arrays of the same few shapes over and over. Arrays made by the pool own their buffer and
+     * give it back to the pool when they are destroyed - wherever the message has ended up by then - so the next
+     * message of the same size is received into memory that is already mapped.
+     *
+     * A pool must outlive the arrays made from it; the shared instance() is never destroyed.
+     */
+    class BufferPool {
+    public:
+        static constexpr size_t alignment = hoBlockCache::alignment;
+        static constexpr size_t default_max_cached_bytes = size_t(256) << 20;
+
+        explicit BufferPool(size_t max_cached_bytes = default_max_cached_bytes);
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        template <class T> hoNDArray<T> make_array(const std::vector<size_t>& dimensions);
+
+        void* allocate(size_t bytes);
+        static void release(void* data);
+
+        void set_max_cached_bytes(size_t bytes);
+        size_t cached_bytes() const;
+
+        static BufferPool& instance();
+
+    private:
+        struct Header {
+            BufferPool* pool;
+            size_t size;
+        };
+        static_assert(sizeof(Header) <= alignment, "Buffer header must fit in the alignment padding");
+
+        hoBlockCache cache;
+    };
+
+    /** Implementation **/
+
+    template <class T> hoNDArray<T> BufferPool::make_array(const std::vector<size_t>& dimensions) {
+        static_assert(std::is_trivially_destructible<T>::value, "Pooled arrays hold uninitialized memory");
+
+        size_t elements = 1;
+        for (auto d : dimensions) elements *= d;
+        if (elements == 0) return hoNDArray<T>(dimensions);
+
+        return hoNDArray<T>(dimensions, static_cast<T*>(allocate(elements * sizeof(T))), &BufferPool::release);
+    }
+}
@@ -6,6 +6,7 @@
 #include <mutex>
 
 #include "MPMCChannel.h"
+#include "MPMCRingBuffer.h"
 #include "Message.h"
 #include "Types.h"
 
@@ -122,6 +123,26 @@ namespace Gadgetron { namespace Core {
         MPMCChannel<Message> channel;
     };
 
+    /**
+     * A MessageChannel holding at most a fixed number of messages. Pushing to a full channel waits until a message
+     * is popped, so a slow consumer throttles its producer instead of letting the channel grow without bounds.
+     */
+    class BoundedMessageChannel : public Channel {
+    public:
+        explicit BoundedMessageChannel(size_t capacity, WaitPolicy policy = WaitPolicy::Block);
+
+    protected:
+        Message pop() override;
+
+        optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        MPMCRingBuffer<Message> channel;
+    };
+
     /***
      * Creates a ChannelPair
      * @tparam ChannelType Type of Channel, typically MessageChannel
@@ -26,8 +26,16 @@ namespace Gadgetron::Core {
 
     struct StreamContext : Context {
         using Args = boost::program_options::variables_map;
-        StreamContext(ISMRMRD::IsmrmrdHeader header, const Paths paths, const Args args) : Context{std::move(header),paths},args{args} {}
+
+        // Resources a connection is meant to stay within; zero means no limit.
+        struct Budget {
+            size_t threads;
+            size_t memory; // Bytes.
+        };
+
+        StreamContext(ISMRMRD::IsmrmrdHeader header, const Paths paths, const Args args, Budget budget = Budget{}) : Context{std::move(header),paths},args{args},budget{budget} {}
         Args   args;
+        Budget budget;
     };
 
 
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "MPMCChannel.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Gadgetron::Core {
+
+    enum class WaitPolicy {
+        Block, /// Spin briefly, then sleep until woken. Cheap on cores, slightly higher latency.
+        Spin   /// Never sleep; yield the core between attempts. Lowest latency, burns a core per waiting thread.
+    };
+
+    /**
+     * Bounded multi-producer multi-consumer queue with the same interface and close semantics as MPMCChannel.
+     *
+     * Elements live in a fixed ring of slots, each with a sequence number marking whether it is ready to be written
+     * or read (Vyukov's bounded queue), so neither push nor pop allocates or takes a lock while the ring is neither
+     * full nor empty. When the ring is full, push waits for space - which is the backpressure that keeps a fast
+     * producer from running away from a slow consumer.
+     */
+    template <class T> class MPMCRingBuffer {
+    public:
+        explicit MPMCRingBuffer(size_t capacity, WaitPolicy policy = WaitPolicy::Block);
+        ~MPMCRingBuffer();
+
+        MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+        MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+        void push(T);
+
+        template <class... ARGS> void emplace(ARGS&&... args);
+
+        T pop();
+        optional<T> try_pop();
+
+        void close();
+
+        size_t capacity() const;
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        template <class... ARGS> bool try_emplace(ARGS&&... args);
+        optional<T> try_take();
+
+        bool readable() const;
+        bool writable() const;
+        bool empty() const;
+
+        template <class F> void wait(std::condition_variable& cv, std::atomic<size_t>& waiters, F ready);
+        void notify(std::condition_variable& cv, std::atomic<size_t>& waiters);
+
+        static size_t round_to_power_of_two(size_t capacity);
+
+        static constexpr size_t spin_limit = 64;
+
+        const size_t mask;
+        const WaitPolicy policy;
+        std::unique_ptr<Slot[]> slots;
+
+        alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+        alignas(64) std::atomic<size_t> dequeue_position{ 0 };
+
+        std::atomic<bool> is_closed{ false };
+        std::atomic<size_t> waiting_consumers{ 0 };
+        std::atomic<size_t> waiting_producers{ 0 };
+        std::mutex m;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+    };
+
+    /** Implementation **/
+
+    template <class T> size_t MPMCRingBuffer<T>::round_to_power_of_two(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+    template <class T>
+    MPMCRingBuffer<T>::MPMCRingBuffer(size_t capacity, WaitPolicy policy)
+        : mask{ round_to_power_of_two(capacity) - 1 }, policy{ policy }, slots{ new Slot[mask + 1] } {
+        for (size_t i = 0; i <= mask; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <class T> MPMCRingBuffer<T>::~MPMCRingBuffer() {
+        while (try_take()) {}
+    }
+
+    template <class T> size_t MPMCRingBuffer<T>::capacity() const {
+        return mask + 1;
+    }
+
+    template <class T> template <class... ARGS> bool MPMCRingBuffer<T>::try_emplace(ARGS&&... args) {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot          = &slots[position & mask];
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff     = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&slot->storage) T(std::forward<ARGS>(args)...);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T> optional<T> MPMCRingBuffer<T>::try_take() {
+        size_t position = dequeue_position.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot          = &slots[position & mask];
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            auto diff     = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (diff == 0) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return none;
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        auto element = reinterpret_cast<T*>(&slot->storage);
+        optional<T> result{ std::move(*element) };
+        element->~T();
+        slot->sequence.store(position + mask + 1, std::memory_order_release);
+        return result;
+    }
+
+    template <class T> bool MPMCRingBuffer<T>::readable() const {
+        auto position = dequeue_position.load(std::memory_order_relaxed);
+        return slots[position & mask].sequence.load(std::memory_order_acquire) == position + 1;
+    }
+
+    // Unlike !readable(), this also counts elements a producer has claimed a slot for, but not yet published.
+    template <class T> bool MPMCRingBuffer<T>::empty() const {
+        return enqueue_position.load(std::memory_order_acquire) == dequeue_position.load(std::memory_order_acquire);
+    }
+
+    template <class T> bool MPMCRingBuffer<T>::writable() const {
+        auto position = enqueue_position.load(std::memory_order_relaxed);
+        return slots[position & mask].sequence.load(std::memory_order_acquire) == position;
+    }
+
+    template <class T>
+    template <class F>
+    void MPMCRingBuffer<T>::wait(std::condition_variable& cv, std::atomic<size_t>& waiters, F ready) {
+        for (size_t spin = 0; spin < spin_limit || policy == WaitPolicy::Spin; spin++) {
+            if (ready())
+                return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(m);
+        waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv.wait(lock, ready);
+        waiters.fetch_sub(1);
+    }
+
+    template <class T> void MPMCRingBuffer<T>::notify(std::condition_variable& cv, std::atomic<size_t>& waiters) {
+        // Pairs with the fence in wait(); either the waiter sees our update, or we see the waiter.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        { std::lock_guard<std::mutex> guard(m); }
+        cv.notify_all();
+    }
+
+    template <class T> template <class... ARGS> void MPMCRingBuffer<T>::emplace(ARGS&&... args) {
+        while (true) {
+            if (is_closed.load(std::memory_order_acquire))
+                throw ChannelClosed();
+            if (try_emplace(std::forward<ARGS>(args)...))
+                break;
+            wait(not_full, waiting_producers, [this]() { return this->writable() || this->is_closed.load(); });
+        }
+        notify(not_empty, waiting_consumers);
+    }
+
+    template <class T> void MPMCRingBuffer<T>::push(T message) {
+        emplace(std::move(message));
+    }
+
+    template <class T> T MPMCRingBuffer<T>::pop() {
+        while (true) {
+            if (auto message = try_take()) {
+                notify(not_full, waiting_producers);
+                return std::move(*message);
+            }
+            if (is_closed.load(std::memory_order_acquire) && empty())
+                throw ChannelClosed();
+            wait(not_empty, waiting_consumers, [this]() { return this->readable() || this->is_closed.load(); });
+        }
+    }
+
+    template <class T> optional<T> MPMCRingBuffer<T>::try_pop() {
+        auto message = try_take();
+        if (message)
+            notify(not_full, waiting_producers);
+        return message;
+    }
+
+    template <class T> void MPMCRingBuffer<T>::close() {
+        is_closed.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> guard(m);
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+}
@@ -0,0 +1,47 @@
+#include "PureChain.h"
+
+namespace Gadgetron::Core {
+
+    namespace {
+        bool fusable(const GenericPureGadget& first, const GenericPureGadget& second) {
+            return first.output_type() != typeid(void) && first.output_type() == second.input_type();
+        }
+
+        std::vector<size_t> find_run_lengths(const std::vector<std::unique_ptr<GenericPureGadget>>& gadgets, bool fused) {
+            std::vector<size_t> run_lengths(gadgets.size(), 1);
+            if (!fused) return run_lengths;
+
+            for (size_t i = gadgets.size(); i-- > 1;) {
+                if (fusable(*gadgets[i - 1], *gadgets[i])) run_lengths[i - 1] = run_lengths[i] + 1;
+            }
+            return run_lengths;
+        }
+    }
+
+    PureChain::PureChain(std::vector<std::unique_ptr<GenericPureGadget>> gadgets, bool fused)
+        : gadgets{ std::move(gadgets) }, run_lengths{ find_run_lengths(this->gadgets, fused) } {}
+
+    Message PureChain::process_function(Message message) const {
+        size_t i = 0;
+        while (i < gadgets.size()) {
+            auto length = run_lengths[i];
+
+            // Once the first gadget of a run accepts the message, every later gadget of the run accepts its input.
+            if (length > 1 && gadgets[i]->accepts(message)) {
+                auto payload = gadgets[i]->unpack_input(std::move(message));
+                for (size_t n = i; n < i + length; n++) gadgets[n]->process_payload(payload);
+                message = gadgets[i + length - 1]->pack_output(std::move(payload));
+                i += length;
+                continue;
+            }
+
+            message = gadgets[i]->process_function(std::move(message));
+            i++;
+        }
+        return message;
+    }
+
+    size_t PureChain::size() const {
+        return gadgets.size();
+    }
+}
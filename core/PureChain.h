@@ -0,0 +1,32 @@
+#pragma once
+
+#include "PureGadget.h"
+
+#include <memory>
+#include <vector>
+
+namespace Gadgetron::Core {
+
+    /**
+     * Runs a message through a sequence of pure gadgets.
+     *
+     * Folding a message through each gadget's process_function unpacks it and builds a new Message at every stage.
+     * When fused, runs of gadgets whose input type is the output type of the gadget before them are found once, up
+     * front. A message entering such a run is unpacked once, passed by move from stage to stage, and packed into a
+     * Message only when it leaves the run.
+     */
+    class PureChain {
+    public:
+        explicit PureChain(std::vector<std::unique_ptr<GenericPureGadget>> gadgets, bool fused = true);
+
+        Message process_function(Message message) const;
+
+        size_t size() const;
+
+    private:
+        const std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+
+        // Number of gadgets, starting at each index, that can be run without repacking the message.
+        const std::vector<size_t> run_lengths;
+    };
+}
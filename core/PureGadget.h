@@ -1,7 +1,26 @@
 #pragma once
 #include "Node.h"
 
+#include <memory>
+#include <stdexcept>
+#include <typeindex>
+
 namespace Gadgetron::Core {
+
+    /**
+     * Type erased value passed between fused stages of a pure chain, in place of a Message.
+     */
+    class PurePayload {
+    public:
+        virtual ~PurePayload() = default;
+    };
+
+    template <class T> class TypedPurePayload : public PurePayload {
+    public:
+        explicit TypedPurePayload(T value) : value(std::move(value)) {}
+        T value;
+    };
+
 class GenericPureGadget : public GenericChannelGadget {
 public:
     using GenericChannelGadget::GenericChannelGadget;
@@ -16,6 +35,19 @@ public:
          * @return The processed Message
          */
         virtual Message process_function(Message) const = 0;
+
+        /***
+         * Typed access used to fuse consecutive gadgets, so that the output of one is passed directly to the next
+         * without being packed into a Message in between. Gadgets without a fixed input and output type (the
+         * default) are never fused.
+         */
+        virtual std::type_index input_type() const { return typeid(void); }
+        virtual std::type_index output_type() const { return typeid(void); }
+
+        virtual bool accepts(const Message&) const { return false; }
+        virtual std::unique_ptr<PurePayload> unpack_input(Message) const { throw std::logic_error("Gadget cannot be fused"); }
+        virtual void process_payload(std::unique_ptr<PurePayload>&) const { throw std::logic_error("Gadget cannot be fused"); }
+        virtual Message pack_output(std::unique_ptr<PurePayload>) const { throw std::logic_error("Gadget cannot be fused"); }
     };
 
 template <class RETURN, class INPUT>
@@ -33,5 +65,26 @@ public:
      */
     virtual RETURN process_function(INPUT args) const = 0;
 
+    std::type_index input_type() const override { return typeid(INPUT); }
+    std::type_index output_type() const override { return typeid(RETURN); }
+
+    bool accepts(const Message& message) const override { return convertible_to<INPUT>(message); }
+
+    std::unique_ptr<PurePayload> unpack_input(Message message) const override {
+        return std::make_unique<TypedPurePayload<INPUT>>(force_unpack<INPUT>(std::move(message)));
+    }
+
+    void process_payload(std::unique_ptr<PurePayload>& payload) const override {
+        auto& input = static_cast<TypedPurePayload<INPUT>&>(*payload);
+        if constexpr (std::is_same<INPUT, RETURN>::value) {
+            input.value = process_function(std::move(input.value));
+        } else {
+            payload = std::make_unique<TypedPurePayload<RETURN>>(process_function(std::move(input.value)));
+        }
+    }
+
+    Message pack_output(std::unique_ptr<PurePayload> payload) const override {
+        return Message(std::move(static_cast<TypedPurePayload<RETURN>&>(*payload).value));
+    }
 };
 }
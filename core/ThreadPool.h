@@ -5,101 +5,425 @@
 #pragma once
 #include "MPMCChannel.h"
 #include <boost/hana.hpp>
-#include <future>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Gadgetron::Core {
 
-
+    /**
+     * Work-stealing thread pool.
+     *
+     * Each worker owns a deque of tasks. Tasks submitted from a worker (i.e. forked from another task) go to the back
+     * of that worker's deque and are run LIFO, while idle workers steal from the front of other deques. Tasks submitted
+     * from outside the pool go through a shared injection queue, which can be bounded to throttle the submitter.
+     *
+     * Waiting on a Future from inside the pool runs other pending tasks while waiting, so tasks can fork subtasks and
+     * wait for them without deadlocking - even on a pool with a single worker.
+     */
     class ThreadPool {
     private:
-        class Work {
+        /**
+         * Type erased, move-only callable. Callables small enough are stored inline, which makes forking small tasks
+         * free of heap allocations.
+         */
+        class Task {
         public:
-            virtual void execute() = 0;
-            virtual ~Work()        = default;
+            Task() = default;
+
+            template <class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+            explicit Task(F&& f) {
+                using Fn = std::decay_t<F>;
+                if constexpr (fits_inline<Fn>()) {
+                    new (&storage) Fn(std::forward<F>(f));
+                    vtable = &inline_vtable<Fn>;
+                } else {
+                    *reinterpret_cast<Fn**>(&storage) = new Fn(std::forward<F>(f));
+                    vtable = &heap_vtable<Fn>;
+                }
+            }
+
+            Task(Task&& other) noexcept : vtable{ other.vtable } {
+                if (vtable) vtable->move(&other.storage, &storage);
+                other.vtable = nullptr;
+            }
+
+            Task& operator=(Task&& other) noexcept {
+                if (this == &other) return *this;
+                reset();
+                vtable = other.vtable;
+                if (vtable) vtable->move(&other.storage, &storage);
+                other.vtable = nullptr;
+                return *this;
+            }
+
+            ~Task() { reset(); }
+
+            void operator()() { vtable->invoke(&storage); }
+
+            explicit operator bool() const { return vtable != nullptr; }
+
+        private:
+            static constexpr size_t inline_size = 64;
+
+            struct VTable {
+                void (*invoke)(void*);
+                void (*move)(void* from, void* to);
+                void (*destroy)(void*);
+            };
+
+            template <class Fn> static constexpr bool fits_inline() {
+                return sizeof(Fn) <= inline_size && alignof(Fn) <= alignof(std::max_align_t)
+                       && std::is_nothrow_move_constructible<Fn>::value;
+            }
+
+            template <class Fn>
+            static constexpr VTable inline_vtable = {
+                [](void* f) { (*static_cast<Fn*>(f))(); },
+                [](void* from, void* to) {
+                    new (to) Fn(std::move(*static_cast<Fn*>(from)));
+                    static_cast<Fn*>(from)->~Fn();
+                },
+                [](void* f) { static_cast<Fn*>(f)->~Fn(); }
+            };
+
+            template <class Fn>
+            static constexpr VTable heap_vtable = {
+                [](void* f) { (**static_cast<Fn**>(f))(); },
+                [](void* from, void* to) { *static_cast<Fn**>(to) = *static_cast<Fn**>(from); },
+                [](void* f) { delete *static_cast<Fn**>(f); }
+            };
+
+            void reset() {
+                if (vtable) vtable->destroy(&storage);
+                vtable = nullptr;
+            }
+
+            std::aligned_storage_t<inline_size, alignof(std::max_align_t)> storage;
+            const VTable* vtable = nullptr;
         };
 
-        template <class F, class... ARGS> class Storage{
+        /**
+         * Counts down to zero, at which point waiting threads are released.
+         */
+        class Latch {
         public:
-            explicit Storage(F&& f, ARGS&&... args)
-                : f{ std::forward<F>(f) }, args{ std::forward<ARGS>(args)... } {}
-        protected:
-            F f;
-            boost::hana::tuple<std::decay_t<ARGS>...> args;
-        public:
-            using R = decltype(boost::hana::unpack(std::move(args),f));
-        protected:
-            std::promise<R> promise;
+            explicit Latch(size_t count) : count{ count } {}
 
+            // Counts down and notifies under the mutex, which wait() takes before returning. A latch may be destroyed
+            // as soon as a wait returns; the last count_down must be done with it by then.
+            void count_down() {
+                std::lock_guard<std::mutex> guard(m);
+                if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) cv.notify_all();
+            }
 
-        public:
-            std::future<R> get_future() {
-                return promise.get_future();
+            bool ready() const { return count.load(std::memory_order_acquire) == 0; }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this]() { return this->ready(); });
+            }
+
+            void set_exception(std::exception_ptr e) {
+                std::lock_guard<std::mutex> guard(m);
+                if (!exception) exception = std::move(e);
             }
+
+            void rethrow() {
+                if (exception) std::rethrow_exception(exception);
+            }
+
+        private:
+            std::atomic<size_t> count;
+            std::exception_ptr exception;
+            std::mutex m;
+            std::condition_variable cv;
         };
-        template<class F, bool IS_VOID, class... ARGS> class ConcreteWorkImpl{};
 
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,false,ARGS...> : public Work, public Storage<F,ARGS...> {
+        struct Unit {};
+
+        template <class R> struct State : Latch {
+            State() : Latch(1) {}
+            optional<std::conditional_t<std::is_void<R>::value, Unit, R>> value;
+        };
+
+        struct Worker {
+            std::mutex m;
+            std::deque<Task> tasks;
+        };
+
+        struct WorkerContext {
+            const ThreadPool* pool;
+            size_t index;
+        };
+
+        inline static thread_local WorkerContext current_worker; // Zero initialized; no pool.
+
+    public:
+        /**
+         * Result of a task submitted through async. Unlike std::future, calling get() from a task running on the
+         * same pool helps execute pending work instead of blocking the worker.
+         */
+        template <class R> class Future {
         public:
-            using Storage<F,ARGS...>::Storage;
+            Future() = default;
 
-            void execute() override {
-                try {
-                    auto val = boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value(std::move(val));
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
+            R get() {
+                wait();
+                state->rethrow();
+                if constexpr (!std::is_void<R>::value) {
+                    return std::move(*state->value);
                 }
             }
-        };
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,true,ARGS...> : public Work, public Storage<F,ARGS...> {
-        public:
-            using Storage<F,ARGS...>::Storage;
 
-            void execute() override {
-                try {
-                    boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value();
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
+            void wait() {
+                // The pool may already be joined and gone when we are not running on one of its workers,
+                // so only touch it when we are.
+                if (current_worker.pool == pool) {
+                    pool->help_until(*state);
+                } else {
+                    state->wait();
                 }
             }
-        };
 
-    template<class F, class... ARGS> class ConcreteWork : public ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...> {
-        public:
-            using ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...>::ConcreteWorkImpl;
+            bool ready() const {
+                return state->ready();
+            }
+
+            bool valid() const {
+                return bool(state);
+            }
+
+        private:
+            friend ThreadPool;
+            Future(std::shared_ptr<State<R>> state, ThreadPool* pool) : state{ std::move(state) }, pool{ pool } {}
+
+            std::shared_ptr<State<R>> state;
+            ThreadPool* pool = nullptr;
         };
 
-    public:
-        explicit ThreadPool(unsigned int workers) {
+        /**
+         * @param workers Number of worker threads
+         * @param queue_capacity Maximum number of tasks waiting in the injection queue before async blocks the
+         * submitting thread. Zero means unbounded. Tasks forked from inside the pool are never blocked.
+         */
+        explicit ThreadPool(unsigned int workers, size_t queue_capacity = 0) : capacity{ queue_capacity } {
+            workers = std::max(workers, 1u);
             for (auto i = 0u; i < workers; i++) {
-                threads.emplace_back([this]() {
-                    try {
-                        while (true)
-                            this->work_queue.pop()->execute();
-                    } catch (const ChannelClosed&) {
-                    }
-                });
+                worker_queues.emplace_back(std::make_unique<Worker>());
             }
+            for (auto i = 0u; i < workers; i++) {
+                threads.emplace_back([this, i]() { this->run_worker(i); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            join();
+        }
+
+        /**
+         * Process wide pool with one worker per hardware thread, for callers that should share cores rather than
+         * each spinning up their own threads.
+         */
+        static ThreadPool& shared() {
+            static ThreadPool pool(std::thread::hardware_concurrency());
+            return pool;
         }
 
         template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
-            auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
-            auto future_result = work->get_future();
-            work_queue.push(std::move(work));
-            return std::move(future_result);
+            using R = decltype(boost::hana::unpack(std::declval<boost::hana::tuple<std::decay_t<ARGS>...>>(), f));
+
+            auto state = std::make_shared<State<R>>();
+            schedule(Task([state, f = std::forward<F>(f),
+                              arguments = boost::hana::tuple<std::decay_t<ARGS>...>{ std::forward<ARGS>(args)... }]() mutable {
+                try {
+                    if constexpr (std::is_void<R>::value) {
+                        boost::hana::unpack(std::move(arguments), f);
+                        state->value.emplace();
+                    } else {
+                        state->value.emplace(boost::hana::unpack(std::move(arguments), f));
+                    }
+                } catch (...) {
+                    state->set_exception(std::current_exception());
+                }
+                state->count_down();
+            }));
+
+            return Future<R>(std::move(state), this);
+        }
+
+        /**
+         * Calls f(i) for every i in [begin, end), split in chunks across the pool. Blocks until all calls are done,
+         * and rethrows the first exception thrown, if any. Safe to call from tasks running on the pool.
+         */
+        template <class F> void parallel_for(size_t begin, size_t end, F&& f) {
+            if (end <= begin) return;
+
+            size_t total  = end - begin;
+            size_t chunks = std::min(total, threads.size() * 4);
+            size_t chunk_size = (total + chunks - 1) / chunks;
+            chunks = (total + chunk_size - 1) / chunk_size;
+
+            Latch latch(chunks);
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                size_t chunk_begin = begin + chunk * chunk_size;
+                size_t chunk_end   = std::min(end, chunk_begin + chunk_size);
+                schedule(Task([&latch, &f, chunk_begin, chunk_end]() {
+                    try {
+                        for (size_t i = chunk_begin; i < chunk_end; i++) f(i);
+                    } catch (...) {
+                        latch.set_exception(std::current_exception());
+                    }
+                    latch.count_down();
+                }));
+            }
+
+            if (on_worker()) {
+                help_until(latch);
+            } else {
+                latch.wait();
+            }
+            latch.rethrow();
         }
 
-        void join(){
-            work_queue.close();
-            for (auto& thread : threads){
+        /**
+         * Stops accepting work from outside the pool, finishes all pending tasks and joins the workers.
+         */
+        void join() {
+            {
+                std::lock_guard<std::mutex> guard(m);
+                if (closed) return;
+                closed = true;
+            }
+            work_available.notify_all();
+            space_available.notify_all();
+            for (auto& thread : threads) {
                 thread.join();
             }
         }
 
+        size_t size() const {
+            return threads.size();
+        }
+
     private:
-        MPMCChannel<std::unique_ptr<Work>> work_queue;
+        bool on_worker() const {
+            return current_worker.pool == this;
+        }
+
+        void schedule(Task task) {
+            if (on_worker()) {
+                auto& worker = *worker_queues[current_worker.index];
+                std::lock_guard<std::mutex> guard(worker.m);
+                worker.tasks.push_back(std::move(task));
+                pending.fetch_add(1);
+            } else {
+                std::unique_lock<std::mutex> lock(m);
+                if (capacity) {
+                    space_available.wait(lock, [this]() { return injection.size() < capacity || closed; });
+                }
+                if (closed) throw ChannelClosed();
+                injection.push_back(std::move(task));
+                pending.fetch_add(1);
+            }
+            notify_worker();
+        }
+
+        void notify_worker() {
+            // Pairs with the fence in run_worker; either the sleeper sees the new task, or we see the sleeper.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed) == 0) return;
+            { std::lock_guard<std::mutex> guard(m); }
+            work_available.notify_one();
+        }
+
+        Task take_task(size_t index) {
+            {
+                auto& own = *worker_queues[index];
+                std::lock_guard<std::mutex> guard(own.m);
+                if (!own.tasks.empty()) {
+                    auto task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    pending.fetch_sub(1);
+                    return task;
+                }
+            }
+
+            if (auto task = take_injected()) return task;
+
+            for (size_t offset = 1; offset < worker_queues.size(); offset++) {
+                auto& victim = *worker_queues[(index + offset) % worker_queues.size()];
+                std::unique_lock<std::mutex> lock(victim.m, std::try_to_lock);
+                if (!lock.owns_lock() || victim.tasks.empty()) continue;
+                auto task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pending.fetch_sub(1);
+                return task;
+            }
+
+            return Task{};
+        }
+
+        Task take_injected() {
+            Task task;
+            {
+                std::lock_guard<std::mutex> guard(m);
+                if (injection.empty()) return task;
+                task = std::move(injection.front());
+                injection.pop_front();
+                pending.fetch_sub(1);
+            }
+            if (capacity) space_available.notify_one();
+            return task;
+        }
+
+        void run_worker(size_t index) {
+            current_worker = WorkerContext{ this, index };
+            while (true) {
+                if (auto task = take_task(index)) {
+                    task();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m);
+                sleeping.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                work_available.wait(lock, [this]() { return pending.load() > 0 || closed; });
+                sleeping.fetch_sub(1);
+                if (closed && pending.load() == 0) return;
+            }
+        }
+
+        void help_until(Latch& latch) {
+            // With nothing left to take, whatever the latch waits for is running on other workers. Tasks they fork go
+            // to their own queues, which they drain before waiting themselves, so blocking here cannot starve them.
+            while (!latch.ready()) {
+                auto task = take_task(current_worker.index);
+                if (!task) break;
+                task();
+            }
+            latch.wait();
+        }
+
+        const size_t capacity;
+        std::vector<std::unique_ptr<Worker>> worker_queues;
         std::vector<std::thread> threads;
+
+        std::deque<Task> injection;
+        bool closed = false;
+        std::atomic<size_t> pending{ 0 };
+        std::atomic<size_t> sleeping{ 0 };
+        std::mutex m;
+        std::condition_variable work_available;
+        std::condition_variable space_available;
     };
 
 }
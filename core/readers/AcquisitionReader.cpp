@@ -2,6 +2,8 @@
 #include "io/primitives.h"
 #include "mri_core_data.h"
 
+#include "BufferPool.h"
+
 #include "MessageID.h"
 #include "AcquisitionReader.h"
 
@@ -15,14 +17,15 @@ namespace Gadgetron::Core::Readers {
 
         auto header = IO::read<ISMRMRD::AcquisitionHeader>(stream);
 
+        // Data is read straight from the stream into pooled buffers, which return to the pool with the message.
+        auto &pool = BufferPool::instance();
+
         optional<hoNDArray<float>> trajectory = Core::none;
         if (header.trajectory_dimensions) {
-            trajectory = hoNDArray<float>(header.trajectory_dimensions,
-                                          header.number_of_samples);
+            trajectory = pool.make_array<float>({header.trajectory_dimensions, header.number_of_samples});
             IO::read(stream, trajectory->data(), trajectory->get_number_of_elements());
         }
-        auto data = hoNDArray<std::complex<float>>(header.number_of_samples,
-                                                   header.active_channels);
+        auto data = pool.make_array<std::complex<float>>({header.number_of_samples, header.active_channels});
         IO::read(stream, data.data(), data.get_number_of_elements());
         return Core::Message(header, data, trajectory);
     }
@@ -19,6 +19,7 @@ GADGETRON_ADAPT_STRUCT(Gadgetron::IsmrmrdReconData,GADGETRON_ACCESS_ELEMENT(rbit
 void
 Gadgetron::Core::Writers::BufferWriter::serialize(std::ostream &stream, const Gadgetron::IsmrmrdReconData &reconData) {
     static_assert(!Gadgetron::Core::is_trivially_copyable_v<IsmrmrdReconData>);
+    for (auto& bit : reconData.rbit_) require_kspace(bit.data_, "BufferWriter");
     GDEBUG("Sending out reconData\n");
     IO::write(stream,MessageID::GADGET_MESSAGE_RECONDATA);
     IO::write(stream, reconData);
@@ -286,6 +286,8 @@ namespace Gadgetron {
 	  
 	  GINFO_STREAM("Process start");
 
+	  for (const auto& recon_bit : m1->getObjectPtr()->rbit_)
+	       require_kspace(recon_bit.data_, "BartGadget");
   
 	  auto generated_files_folder(internal::generate_unique_folder(BartWorkingDirectory_path.value()));
 
@@ -144,6 +144,8 @@ namespace Gadgetron {
             GDEBUG_CONDITION_STREAM(verbose.value(), "Calling " << process_called_times_ << " , encoding space : " << e);
             GDEBUG_CONDITION_STREAM(verbose.value(), "======================================================================");
 
+            require_kspace(recon_bit_->rbit_[e].data_, "CmrCartesianKSpaceBinningCineGadget");
+
             // ---------------------------------------------------------------
             // export incoming data
 
@@ -34,6 +34,7 @@ Gadgetron::IsmrmrdImageArray Gadgetron::PureCmrCartesianKSpaceBinningCineGadget:
     if (args.rbit_.size() > 1)
         throw std::runtime_error("Only single encoding space supported");
     size_t encoding = 0;
+    require_kspace(args.rbit_[encoding].data_, "PureCmrCartesianKSpaceBinningCineGadget");
     auto result     = perform_binning(args.rbit_[encoding], encoding);
     set_image_header(args.rbit_[encoding], result.image, encoding);
     set_time_stamps(result.image, result.acquisition_time, result.capture_time, time_tick);
@@ -6,6 +6,7 @@
 #include "hoNDArray.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
+#include "hoNDArray_kernels.h"
 
 
 namespace {
@@ -85,24 +86,33 @@ namespace Gadgetron::Grappa {
             const Weights &weights
     ) {
         hoNDArray<std::complex<float>> unmixed_image(create_unmixed_image_dimensions(weights));
-        clear(unmixed_image);
 
         auto sets = weights.data.get_number_of_elements() / image.data.get_number_of_elements();
         auto image_elements = unmixed_image.get_number_of_elements() / sets;
         auto coils = weights.data.get_number_of_elements() / (sets * image_elements);
 
-        for (unsigned int s = 0; s < sets; s++) {
-            for (unsigned int p = 0; p < image_elements; p++) {
-                for (unsigned int c = 0; c < coils; c++) {
-                    unmixed_image[s * image_elements + p] +=
-                            weights.data[s * image_elements * coils + c * image_elements + p] *
-                            image.data[c * image_elements + p] *
-                            unmixing_scale;
-                }
-            }
+        // Each set is split into blocks of pixels, so that even a single set keeps every core busy.
+        const size_t block = 4096;
+        const long long blocks = (image_elements + block - 1) / block;
+        const long long tasks = sets * blocks;
+
+#pragma omp parallel for schedule(static) if (tasks > 1 && coils * image_elements * sets >= Kernels::parallel_threshold)
+        for (long long task = 0; task < tasks; task++) {
+            size_t s = task / blocks;
+            size_t start = (task % blocks) * block;
+            size_t pixels = std::min(block, image_elements - start);
+
+            Kernels::unmix(
+                    weights.data.begin() + s * image_elements * coils + start,
+                    image.data.begin() + start,
+                    unmixed_image.begin() + s * image_elements + start,
+                    coils, pixels, image_elements
+            );
         }
 
-        return std::move(unmixed_image);
+        if (unmixing_scale != 1.0f) unmixed_image *= unmixing_scale;
+
+        return unmixed_image;
     }
 
     ISMRMRD::ImageHeader Unmixing::create_image_header(const Image &image, const Weights &weights) {
@@ -48,6 +48,7 @@ int gpuCSICoilEstimationGadget::process_config(ACE_Message_Block* mb) {
 int gpuCSICoilEstimationGadget::process(
 		GadgetContainerMessage<IsmrmrdReconData>* m1) {
 	IsmrmrdReconData* bucket = m1->getObjectPtr();
+	require_kspace(bucket->rbit_.front().data_, "gpuCSICoilEstimationGadget");
 
 	auto cm1 = new GadgetContainerMessage<cuSenseData>();
 	auto senseData = cm1->getObjectPtr();
@@ -1,4 +1,5 @@
 #include "AcquisitionAccumulateTriggerGadget.h"
+#include "hoNDFFT.h"
 #include "log.h"
 #include "mri_core_data.h"
 #include <boost/algorithm/string.hpp>
@@ -197,6 +198,287 @@ namespace Gadgetron {
     }
     GADGETRON_GADGET_EXPORT(AcquisitionAccumulateTriggerGadget);
 
+    namespace {
+        using BufferKey = BucketToBufferGadget::BufferKey;
+
+        struct BufferKeyLess {
+            bool operator()(const BufferKey& a, const BufferKey& b) const {
+                return std::tie(a.average, a.slice, a.contrast, a.phase, a.repetition, a.set, a.segment)
+                       < std::tie(b.average, b.slice, b.contrast, b.phase, b.repetition, b.set, b.segment);
+            }
+        };
+
+        bool is_reference(const ISMRMRD::AcquisitionHeader& head) {
+            return head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)
+                   || head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION_AND_IMAGING);
+        }
+
+        bool is_data(const ISMRMRD::AcquisitionHeader& head) {
+            return !(head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PARALLEL_CALIBRATION)
+                     || head.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_PHASECORR_DATA));
+        }
+
+        bool has_separate_reference(const ISMRMRD::Encoding& encoding) {
+            if (!encoding.parallelImaging || !encoding.parallelImaging->calibrationMode) return false;
+            auto& mode = encoding.parallelImaging->calibrationMode.get();
+            return mode == "separate" || mode == "external";
+        }
+
+        std::set<uint16_t>* stats_of(AcquisitionBucketStats& stats, TriggerDimension dimension) {
+            switch (dimension) {
+            case TriggerDimension::kspace_encode_step_1: return &stats.kspace_encode_step_1;
+            case TriggerDimension::kspace_encode_step_2: return &stats.kspace_encode_step_2;
+            case TriggerDimension::average: return &stats.average;
+            case TriggerDimension::slice: return &stats.slice;
+            case TriggerDimension::contrast: return &stats.contrast;
+            case TriggerDimension::phase: return &stats.phase;
+            case TriggerDimension::repetition: return &stats.repetition;
+            case TriggerDimension::set: return &stats.set;
+            case TriggerDimension::segment: return &stats.segment;
+            default: return nullptr;
+            }
+        }
+
+        // The statistics BucketToBufferGadget would see for a complete bucket; dimensions split up by triggering or
+        // sorting hold a single value per bucket.
+        AcquisitionBucketStats stats_from_encoding(
+            const ISMRMRD::Encoding& encoding, TriggerDimension trigger, TriggerDimension sorting) {
+
+            auto range = [](const auto& limit) {
+                return limit ? std::set<uint16_t>{ limit->minimum, limit->maximum } : std::set<uint16_t>{ 0 };
+            };
+
+            auto& limits = encoding.encodingLimits;
+            AcquisitionBucketStats stats;
+            stats.kspace_encode_step_1 = range(limits.kspace_encoding_step_1);
+            stats.kspace_encode_step_2 = range(limits.kspace_encoding_step_2);
+            stats.average              = range(limits.average);
+            stats.slice                = range(limits.slice);
+            stats.contrast             = range(limits.contrast);
+            stats.phase                = range(limits.phase);
+            stats.repetition           = range(limits.repetition);
+            stats.set                  = range(limits.set);
+            stats.segment              = range(limits.segment);
+
+            for (auto dimension : { trigger, sorting }) {
+                if (auto dimension_stats = stats_of(stats, dimension)) *dimension_stats = { 0 };
+            }
+            return stats;
+        }
+
+        // The dimension of the buffers N or S is laid out along, as a trigger dimension. Slices are laid out along
+        // LOC, not N or S.
+        TriggerDimension trigger_dimension_of(BucketToBufferGadget::Dimension dimension) {
+            switch (dimension) {
+            case BucketToBufferGadget::Dimension::average: return TriggerDimension::average;
+            case BucketToBufferGadget::Dimension::contrast: return TriggerDimension::contrast;
+            case BucketToBufferGadget::Dimension::phase: return TriggerDimension::phase;
+            case BucketToBufferGadget::Dimension::repetition: return TriggerDimension::repetition;
+            case BucketToBufferGadget::Dimension::set: return TriggerDimension::set;
+            case BucketToBufferGadget::Dimension::segment: return TriggerDimension::segment;
+            default: return TriggerDimension::none;
+            }
+        }
+
+        // The name of the encoding limit the buffers are sized by along a dimension, if the header lacks it. As in
+        // BucketToBufferGadget, segment is sized by the average limit.
+        const char* missing_limit(const ISMRMRD::EncodingLimits& limits, TriggerDimension dimension) {
+            switch (dimension) {
+            case TriggerDimension::average:
+            case TriggerDimension::segment: return limits.average ? nullptr : "average";
+            case TriggerDimension::slice: return limits.slice ? nullptr : "slice";
+            case TriggerDimension::contrast: return limits.contrast ? nullptr : "contrast";
+            case TriggerDimension::phase: return limits.phase ? nullptr : "phase";
+            case TriggerDimension::repetition: return limits.repetition ? nullptr : "repetition";
+            case TriggerDimension::set: return limits.set ? nullptr : "set";
+            default: return nullptr;
+            }
+        }
+
+        // A dimension of the buffers that is sized by a missing encoding limit. Only index 0 is allocated along it,
+        // so an acquisition at any other index cannot be placed.
+        struct UnlimitedDimension {
+            TriggerDimension dimension;
+            const char* limit;
+        };
+
+        // The buffers of one encoding space, filled in place.
+        struct Assembly {
+            Core::optional<IsmrmrdDataBuffered> data;
+            Core::optional<IsmrmrdDataBuffered> ref;
+        };
+
+        // Everything received since the last trigger, by sorting index.
+        struct Window {
+            std::map<unsigned short, std::map<BufferKey, std::vector<Assembly>, BufferKeyLess>> buffers;
+            std::map<unsigned short, AcquisitionBucket> separate_references;
+            std::vector<Core::Waveform> waveforms;
+
+            bool empty() const { return buffers.empty() && separate_references.empty(); }
+        };
+
+        // Transforms one line of the buffer along E0; its channels are gathered so they are transformed together.
+        void transform_readout(
+            hoNDArray<std::complex<float>>& data, std::complex<float>* line, hoNDArray<std::complex<float>>& channels) {
+
+            auto E0     = data.get_size(0);
+            auto CHA    = data.get_size(3);
+            auto stride = E0 * data.get_size(1) * data.get_size(2);
+
+            channels.create(E0, CHA);
+            for (size_t cha = 0; cha < CHA; cha++)
+                std::copy_n(line + cha * stride, E0, &channels(0, cha));
+
+            hoNDFFT<float>::instance()->ifft1c(channels);
+
+            for (size_t cha = 0; cha < CHA; cha++)
+                std::copy_n(&channels(0, cha), E0, line + cha * stride);
+        }
+
+        Assembly& assembly_of(Window& window, unsigned short sorting_index, const BufferKey& key, uint16_t espace) {
+            auto& assemblies = window.buffers[sorting_index][key];
+            if (assemblies.size() < size_t(espace + 1)) assemblies.resize(espace + 1);
+            return assemblies[espace];
+        }
+    }
+
+    AcquisitionAccumulateToBufferGadget::AcquisitionAccumulateToBufferGadget(
+        const Core::Context& context, const Core::GadgetProperties& props)
+        : AcquisitionAccumulateTriggerGadget(context, props), header{ context.header }, layout(context, props) {}
+
+    void AcquisitionAccumulateToBufferGadget::process(
+        Core::InputChannel<Core::variant<Core::Acquisition, Core::Waveform>>& in, Core::OutputChannel& out) {
+
+        std::vector<AcquisitionBucketStats> encoding_stats;
+        for (auto& encoding : header.encoding)
+            encoding_stats.push_back(stats_from_encoding(encoding, trigger_dimension, sorting_dimension));
+
+        std::vector<std::vector<UnlimitedDimension>> unlimited_dimensions;
+        for (auto& encoding : header.encoding) {
+            std::vector<UnlimitedDimension> unlimited;
+            for (auto dimension : { trigger_dimension_of(layout.N_dimension), trigger_dimension_of(layout.S_dimension),
+                     layout.split_slices ? TriggerDimension::none : TriggerDimension::slice }) {
+                if (dimension == trigger_dimension || dimension == sorting_dimension) continue;
+                if (auto limit = missing_limit(encoding.encodingLimits, dimension))
+                    unlimited.push_back({ dimension, limit });
+            }
+            unlimited_dimensions.push_back(std::move(unlimited));
+        }
+
+        hoNDArray<std::complex<float>> channels;
+
+        auto place = [&](IsmrmrdDataBuffered& buffer, const Core::Acquisition& acq, uint16_t espace, bool forref) {
+            const auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+            for (auto& unlimited : unlimited_dimensions[espace]) {
+                if (get_index(head, unlimited.dimension) != 0)
+                    throw std::runtime_error("AcquisitionAccumulateToBufferGadget: the header has no encoding limit for "
+                                             + std::string(unlimited.limit) + " to size the buffers by");
+            }
+
+            auto line = layout.add_acquisition(buffer, acq, header.encoding[espace], encoding_stats[espace], forref);
+            if (line && buffer.hybrid_space_) transform_readout(buffer.data_, line, channels);
+        };
+
+        auto allocate = [&](const ISMRMRD::AcquisitionHeader& head, const ISMRMRD::Encoding& encoding,
+                            const AcquisitionBucketStats& stats, bool forref) {
+            auto buffer          = layout.makeDataBuffer(head, encoding, stats, forref);
+            buffer.sampling_     = layout.createSamplingDescription(encoding, stats, head, forref);
+            buffer.hybrid_space_ = transform_readouts && !forref;
+            return buffer;
+        };
+
+        auto send = [&](Window& window) {
+            if (window.empty()) return;
+            trigger_events++;
+
+            // Reference lines of separate calibration are sized by what was received, as in BucketToBufferGadget.
+            for (auto& pair : window.separate_references) {
+                auto& bucket = pair.second;
+                for (auto& acq : bucket.ref_) {
+                    const auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+                    auto espace      = head.encoding_space_ref;
+                    auto& assembly   = assembly_of(window, pair.first, layout.getKey(head.idx), espace);
+
+                    if (!assembly.ref)
+                        assembly.ref = allocate(head, header.encoding[espace], bucket.refstats_[espace], true);
+                    layout.add_acquisition(*assembly.ref, acq, header.encoding[espace], bucket.refstats_[espace], true);
+                }
+            }
+
+            GDEBUG("Trigger (%d) occurred, sending out %d buffered buckets\n", trigger_events, window.buffers.size());
+
+            bool first = true;
+            for (auto& bucket : window.buffers) {
+                for (auto& buffer : bucket.second) {
+                    IsmrmrdReconData recon_data;
+                    recon_data.rbit_.resize(buffer.second.size());
+
+                    for (size_t espace = 0; espace < buffer.second.size(); espace++) {
+                        auto& assembly = buffer.second[espace];
+                        if (assembly.data) recon_data.rbit_[espace].data_ = std::move(*assembly.data);
+                        if (assembly.ref) recon_data.rbit_[espace].ref_ = std::move(assembly.ref);
+                    }
+
+                    // The waveforms go with the first bucket, as the pair of gadgets would send them.
+                    if (first && !window.waveforms.empty())
+                        out.push(std::move(recon_data), window.waveforms);
+                    else
+                        out.push(std::move(recon_data));
+                }
+                first = false;
+            }
+
+            window = Window{};
+        };
+
+        Window window;
+        auto trigger = get_trigger(*this);
+
+        for (auto message : in) {
+            if (Core::holds_alternative<Core::Waveform>(message)) {
+                window.waveforms.emplace_back(std::move(Core::get<Core::Waveform>(message)));
+                continue;
+            }
+
+            auto& acq = Core::get<Core::Acquisition>(message);
+            if (is_noise(acq))
+                continue;
+            const auto head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+
+            if (trigger_before(trigger, head))
+                send(window);
+
+            auto sorting_index = get_index(head, sorting_dimension);
+            auto espace        = head.encoding_space_ref;
+            auto& encoding     = header.encoding.at(espace);
+            auto key           = layout.getKey(head.idx);
+
+            if (is_reference(head)) {
+                if (has_separate_reference(encoding)) {
+                    auto& bucket = window.separate_references[sorting_index];
+                    if (bucket.refstats_.size() < size_t(espace + 1)) bucket.refstats_.resize(espace + 1);
+                    add_stats(bucket.refstats_[espace], head);
+                    bucket.ref_.push_back(acq);
+                } else {
+                    auto& assembly = assembly_of(window, sorting_index, key, espace);
+                    if (!assembly.ref) assembly.ref = allocate(head, encoding, encoding_stats[espace], true);
+                    place(*assembly.ref, acq, espace, true);
+                }
+            }
+
+            if (is_data(head)) {
+                auto& assembly = assembly_of(window, sorting_index, key, espace);
+                if (!assembly.data) assembly.data = allocate(head, encoding, encoding_stats[espace], false);
+                place(*assembly.data, acq, espace, false);
+            }
+
+            if (trigger_after(trigger, head))
+                send(window);
+        }
+        send(window);
+    }
+    GADGETRON_GADGET_EXPORT(AcquisitionAccumulateToBufferGadget);
+
     namespace {
         const std::map<std::string, TriggerDimension> triggerdimension_from_name = {
 
@@ -3,6 +3,7 @@
 #include "Node.h"
 #include "hoNDArray.h"
 
+#include "BucketToBufferGadget.h"
 #include "mri_core_acquisition_bucket.h"
 #include <complex>
 #include <ismrmrd/ismrmrd.h>
@@ -52,6 +53,35 @@ namespace Gadgetron {
                        std::vector<Core::Waveform>& waveforms);
     };
 
+    /**
+     * Accumulates acquisitions straight into the buffers BucketToBufferGadget would assemble from the buckets, and sends
+     * them on trigger; it replaces the pair. Buffers are sized from the encoding in the header once their first
+     * readout arrives, and every readout is copied into place on arrival, so a trigger only hands the buffers on.
+     *
+     * Properties are those of both gadgets. Unlike BucketToBufferGadget, the N, S and slice dimensions span their
+     * encoding limits rather than the range received before the trigger; a readout at a nonzero index along one
+     * whose limit is missing from the header is an error. Reference data from separate or external calibration is
+     * sized by the lines actually received; it is assembled on trigger.
+     *
+     * With transform_readouts, each imaging readout is also inverse Fourier transformed along E0 once it is in place,
+     * overlapping that transform with the acquisition. The buffers are then sent in hybrid space, flagged as such;
+     * GenericReconCartesianFFTGadget and the GRAPPA gadgets finish the transform along E1 and E2 only; other
+     * consumers of the buffers reject them. Reference data stays in k-space.
+     */
+    class AcquisitionAccumulateToBufferGadget : public AcquisitionAccumulateTriggerGadget {
+    public:
+        AcquisitionAccumulateToBufferGadget(const Core::Context& context, const Core::GadgetProperties& props);
+
+        void process(Core::InputChannel<Core::variant<Core::Acquisition, Core::Waveform>>& in,
+            Core::OutputChannel& out) override;
+
+        NODE_PROPERTY(transform_readouts, bool, "Transform imaging readouts along E0 as they arrive", false);
+
+    private:
+        const ISMRMRD::IsmrmrdHeader header;
+        BucketToBufferGadget layout;
+    };
+
     void from_string(const std::string& str, AcquisitionAccumulateTriggerGadget::TriggerDimension& val);
 
 }
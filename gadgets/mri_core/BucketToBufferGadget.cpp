@@ -404,8 +404,8 @@ namespace Gadgetron {
         return sampling;
     }
 
-    void BucketToBufferGadget::add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq,
-        ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref) {
+    std::complex<float>* BucketToBufferGadget::add_acquisition(IsmrmrdDataBuffered& dataBuffer,
+        const Core::Acquisition& acq, ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref) {
 
         // The acquisition header and data
         const auto& acqhdr  = std::get<ISMRMRD::AcquisitionHeader>(acq);
@@ -509,7 +509,7 @@ namespace Gadgetron {
                     << acqhdr.scan_counter
                     << " is inside the encoding limits, but outside the encoded matrix for kspace_encode_step_1 : "
                     << e1 << " out of " << NE1);
-                return;
+                return nullptr;
             }
 
             if (e2 < 0 || e2 >= (int16_t)NE2) {
@@ -522,7 +522,7 @@ namespace Gadgetron {
                     << acqhdr.scan_counter
                     << " is inside the encoding limits, but outside the encoded matrix for kspace_encode_step_2 : "
                     << e2 << " out of " << NE2);
-                return;
+                return nullptr;
             }
         }
 
@@ -544,6 +544,8 @@ namespace Gadgetron {
             auto* fromptr  = &acqtraj(0, acqhdr.discard_pre);
             std::copy(fromptr, fromptr + npts_to_copy * acqhdr.trajectory_dimensions, trajptr);
         }
+
+        return &dataBuffer.data_(0, e1, e2, 0, NUsed, SUsed, slice_loc);
     }
     BucketToBufferGadget::BucketToBufferGadget(const Core::Context& context, const Core::GadgetProperties& props)
         : ChannelGadget(context, props), header{ context.header } {}
@@ -35,6 +35,8 @@ namespace Gadgetron {
         }
     };
     protected:
+        friend class AcquisitionAccumulateToBufferGadget;
+
         NODE_PROPERTY(N_dimension, Dimension, "N-Dimensions", Dimension::none);
         NODE_PROPERTY(S_dimension, Dimension, "S-Dimensions", Dimension::none);
 
@@ -52,8 +54,9 @@ namespace Gadgetron {
             const AcquisitionBucketStats& stats, bool forref) const;
         SamplingDescription createSamplingDescription(const ISMRMRD::Encoding& encoding,
             const AcquisitionBucketStats& stats, const ISMRMRD::AcquisitionHeader& acqhdr, bool forref) const ;
-        void add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq, ISMRMRD::Encoding encoding,
-            const AcquisitionBucketStats& stats, bool forref);
+        // Returns the start of the line the readout was copied to, for the first channel, or nullptr if it was dropped.
+        std::complex<float>* add_acquisition(IsmrmrdDataBuffered& dataBuffer, const Core::Acquisition& acq,
+            ISMRMRD::Encoding encoding, const AcquisitionBucketStats& stats, bool forref);
         uint16_t getNE0(const ISMRMRD::AcquisitionHeader& acqhdr, const ISMRMRD::Encoding& encoding) const;
         uint16_t getNE1(const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, bool forref) const;
         uint16_t getNE2(const ISMRMRD::Encoding& encoding, const AcquisitionBucketStats& stats, bool forref) const;
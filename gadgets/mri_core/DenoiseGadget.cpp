@@ -1,17 +1,25 @@
 
 #include "DenoiseGadget.h"
 #include "GadgetronTimer.h"
+#include "hoNDArray_utils.h"
 #include "non_local_bayes.h"
 #include "non_local_means.h"
 
 namespace Gadgetron {
     template <class T>
-    Gadgetron::hoNDArray<T> Gadgetron::DenoiseGadget::denoise_function(const Gadgetron::hoNDArray<T>& input) const {
+    Gadgetron::hoNDArray<T> Gadgetron::DenoiseGadget::denoise_function(const Gadgetron::hoNDArray<T>& input, unsigned int temporal_radius) const {
 
         if (denoiser == "non_local_bayes") {
-            return Denoise::non_local_bayes(input, image_std, search_radius);
+            Denoise::NonLocalBayesSettings settings;
+            settings.search_window  = search_radius;
+            settings.max_patches    = max_patches;
+            settings.reference_step = reference_step;
+            return Denoise::non_local_bayes(input, image_std, settings);
         } else if (denoiser == "non_local_means") {
-            return Denoise::non_local_means(input, image_std, search_radius);
+            Denoise::NonLocalMeansSettings settings;
+            settings.search_radius   = search_radius;
+            settings.temporal_radius = temporal_radius;
+            return Denoise::non_local_means(input, image_std, settings);
         } else {
             throw std::invalid_argument(std::string("DenoiseGadget: Unknown denoiser type: ") + std::string(denoiser));
         }
@@ -29,7 +37,13 @@ namespace Gadgetron {
 
     IsmrmrdImageArray DenoiseGadget::denoise(IsmrmrdImageArray image_array) const {
         auto& input = image_array.data_;
-        input       = denoise_function(input);
+        if (denoiser == "non_local_means" && temporal_radius > 0) {
+            // The denoiser takes the frames along dimension 2, where image arrays hold E2 rather than N.
+            auto frames = permute(input, std::vector<size_t>{ 0, 1, 4, 2, 3, 5, 6 });
+            input       = permute(denoise_function(frames, temporal_radius), std::vector<size_t>{ 0, 1, 3, 4, 2, 5, 6 });
+        } else {
+            input = denoise_function(input);
+        }
         return std::move(image_array);
     }
 
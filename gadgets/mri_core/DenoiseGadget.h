@@ -28,13 +28,16 @@ namespace Gadgetron {
         NODE_PROPERTY(image_std, float, "Standard deviation of the noise in the produced image", 1);
         NODE_PROPERTY(search_radius, int, "Standard deviation of the noise in the produced image", 25);
         NODE_PROPERTY(denoiser, std::string, "Type of denoiser - non_local_means or non_local_bayes", "non_local_bayes");
+        NODE_PROPERTY(max_patches, int, "Number of similar patches non_local_bayes denoises together", 50);
+        NODE_PROPERTY(reference_step, int, "Distance between the reference patches of non_local_bayes; higher is faster", 1);
+        NODE_PROPERTY(temporal_radius, int, "Frames (N) on either side that non_local_means searches for similar patches in image arrays", 0);
 
     protected:
         template <class T>
         DenoiseImage<T> denoise(DenoiseImage<T> image) const;
         IsmrmrdImageArray denoise(IsmrmrdImageArray image_array) const;
 
-        template <class T> hoNDArray<T> denoise_function(const hoNDArray<T>&) const;
+        template <class T> hoNDArray<T> denoise_function(const hoNDArray<T>&, unsigned int temporal_radius = 0) const;
     };
 
 }
@@ -232,14 +232,7 @@ namespace Gadgetron {
             data_recon_buf_.create(RO, E1, E2, dstCHA, N, S, SLC);
 	    
 
-            if (E2>1)
-            {
-                Gadgetron::hoNDFFT<float>::instance()->ifft3c(recon_bit.data_.data_, complex_im_recon_buf_, data_recon_buf_);
-            }
-            else
-            {
-                Gadgetron::hoNDFFT<float>::instance()->ifft2c(recon_bit.data_.data_, complex_im_recon_buf_, data_recon_buf_);
-            }
+            this->compute_aliased_images(recon_bit.data_, complex_im_recon_buf_, data_recon_buf_);
 
           
 
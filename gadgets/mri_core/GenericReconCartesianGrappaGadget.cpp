@@ -433,8 +433,10 @@ namespace Gadgetron {
 
             long long ii;
 
+            bool use_calibration_cache = CalibrationCache::instance().enabled();
+
             // only allow this for loop openmp if num>1 and 2D recon
-#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kNE1, kNE2, fitItself) if(num>1)
+#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kNE1, kNE2, fitItself, use_calibration_cache) if(num>1)
             for (ii = 0; ii < num; ii++) {
                 size_t slc = ii / (ref_N * ref_S);
                 size_t s = (ii - slc * ref_N * ref_S) / (ref_N);
@@ -450,6 +452,38 @@ namespace Gadgetron {
                 std::complex<float> *pDst = &(dst(0, 0, 0, 0, n, s, slc));
                 hoNDArray<std::complex<float> > ref_dst(ref_RO, ref_E1, ref_E2, dstCHA, pDst);
 
+                // -----------------------------------
+                // reuse the calibration, if the same reference data was calibrated before with the same parameters
+
+                hoNDArray<std::complex<float> > kernelSlice(convKRO, convKE1, convKE2, srcCHA, dstCHA,
+                                                            &(recon_obj.kernel_(0, 0, 0, 0, 0, n, s, slc)));
+                hoNDArray<std::complex<float> > unmixSlice(RO, E1, E2, srcCHA,
+                                                           &(recon_obj.unmixing_coeff_(0, 0, 0, 0, n, s, slc)));
+                hoNDArray<float> gFactorSlice(RO, E1, E2, 1, &(recon_obj.gfactor_(0, 0, 0, 0, n, s, slc)));
+                hoNDArray<std::complex<float> > kImSlice;
+                std::vector<hoNDArray<std::complex<float> > *> calibOutputs{&kernelSlice, &unmixSlice};
+                if (E2 == 1) {
+                    kImSlice.create(RO, E1, srcCHA, dstCHA, &(recon_obj.kernelIm_(0, 0, 0, 0, 0, n, s, slc)));
+                    calibOutputs.push_back(&kImSlice);
+                }
+
+                uint64_t calibKey = 0;
+                if (use_calibration_cache) {
+                    CalibrationFingerprint fingerprint;
+                    fingerprint.add(ref_src)
+                        .add(hoNDArray<std::complex<float> >(RO, E1, E2, dstCHA,
+                                                              &(recon_obj.coil_map_(0, 0, 0, 0, n, s, slc))))
+                        .add(RO).add(E1).add(E2)
+                        .add(acceFactorE1_[e]).add(acceFactorE2_[e])
+                        .add(kRO).add(kNE1).add(kNE2)
+                        .add(grappa_reg_lamda.value()).add(grappa_calib_over_determine_ratio.value())
+                        .add(fitItself);
+                    if (fitItself) fingerprint.add(ref_dst);
+                    calibKey = fingerprint.value();
+
+                    if (restore_calibration(calibKey, calibOutputs, {&gFactorSlice})) continue;
+                }
+
                 // -----------------------------------
 
                 if (E2 > 1) {
@@ -548,9 +582,17 @@ namespace Gadgetron {
                 }
 
                 // -----------------------------------
+
+                if (use_calibration_cache) cache_calibration(calibKey, calibOutputs, {&gFactorSlice});
             }
         }
 
+        if (CalibrationCache::instance().enabled()) {
+            auto stats = CalibrationCache::instance().statistics();
+            GDEBUG_CONDITION_STREAM(verbose.value(), "Calibration cache : " << stats.hits << " hits, " << stats.disk_hits
+                                                     << " disk hits, " << stats.misses << " misses, " << stats.entries
+                                                     << " entries");
+        }
     }
 
     void GenericReconCartesianGrappaGadget::perform_unwrapping(IsmrmrdReconBit &recon_bit, ReconObjType &recon_obj,
@@ -596,13 +638,7 @@ namespace Gadgetron {
         // compute aliased images
         data_recon_buf_.create(RO, E1, E2, dstCHA, N, S, SLC);
 
-        if (E2 > 1) {
-            Gadgetron::hoNDFFT<float>::instance()->ifft3c(recon_bit.data_.data_, complex_im_recon_buf_,
-                                                          data_recon_buf_);
-        } else {
-            Gadgetron::hoNDFFT<float>::instance()->ifft2c(recon_bit.data_.data_, complex_im_recon_buf_,
-                                                          data_recon_buf_);
-        }
+        this->compute_aliased_images(recon_bit.data_, complex_im_recon_buf_, data_recon_buf_);
 
         // SNR unit scaling
         float effective_acce_factor(1), snr_scaling_ratio(1);
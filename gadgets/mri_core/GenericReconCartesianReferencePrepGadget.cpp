@@ -181,6 +181,7 @@ namespace Gadgetron {
             // if embedded mode, fill back ref if required
             if((calib_mode_[e] == ISMRMRD_embedded) && ref_fill_into_data_embedded.value())
             {
+                require_kspace(rbit.data_, "GenericReconCartesianReferencePrepGadget with ref_fill_into_data_embedded");
                 hoNDArray< std::complex<float> >& data = rbit.data_.data_;
 
                 GADGET_CHECK_THROW(data.get_size(0) == RO);
@@ -160,6 +160,8 @@ namespace Gadgetron {
             {
                 // if (!debug_folder_full_path_.empty()) { gt_exporter_.export_array_complex(recon_bit_->rbit_[e].data_.data_, debug_folder_full_path_ + "data_before_unwrapping" + os.str()); }
 
+                require_kspace(recon_bit_->rbit_[e].data_, "GenericReconCartesianSpiritGadget");
+
                 if (perform_timing.value()) { gt_timer_.start("GenericReconCartesianSpiritGadget::perform_unwrapping"); }
                 this->perform_unwrapping(recon_bit_->rbit_[e], recon_obj_[e], e);
                 if (perform_timing.value()) { gt_timer_.stop(); }
@@ -259,7 +261,9 @@ namespace Gadgetron {
 
                 long long ii;
 
-#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kE1, kE2, reg_lamda, over_determine_ratio) if(num>1)
+                bool use_calibration_cache = CalibrationCache::instance().enabled();
+
+#pragma omp parallel for default(none) private(ii) shared(src, dst, recon_obj, e, num, ref_N, ref_S, ref_RO, ref_E1, ref_E2, RO, E1, E2, dstCHA, srcCHA, convKRO, convKE1, convKE2, kRO, kE1, kE2, reg_lamda, over_determine_ratio, use_calibration_cache) if(num>1)
                 for (ii = 0; ii < num; ii++)
                 {
                     size_t slc = ii / (ref_N*ref_S);
@@ -276,6 +280,38 @@ namespace Gadgetron {
                     std::complex<float>* pDst = &(dst(0, 0, 0, 0, n, s, slc));
                     hoNDArray< std::complex<float> > ref_dst(ref_RO, ref_E1, ref_E2, dstCHA, pDst);
 
+                    // -----------------------------------
+                    // reuse the calibration, if the same reference data was calibrated before with the same parameters
+
+                    hoNDArray< std::complex<float> > kernelSlice, kImSlice;
+                    hoNDArray<float> gFactorSlice;
+                    std::vector< hoNDArray< std::complex<float> >* > calibOutputs{ &kernelSlice, &kImSlice };
+                    std::vector< hoNDArray<float>* > calibRealOutputs;
+                    if (E2 > 1)
+                    {
+                        kernelSlice.create(convKRO, convKE1, convKE2, srcCHA, dstCHA, &(recon_obj.kernel_(0, 0, 0, 0, 0, n, s, slc)));
+                        kImSlice.create(convKE1, convKE2, srcCHA, dstCHA, RO, &(recon_obj.kernelIm3D_(0, 0, 0, 0, 0, n, s, slc)));
+                    }
+                    else
+                    {
+                        kernelSlice.create(convKRO, convKE1, srcCHA, dstCHA, &(recon_obj.kernel_(0, 0, 0, 0, 0, n, s, slc)));
+                        kImSlice.create(RO, E1, srcCHA, dstCHA, &(recon_obj.kernelIm2D_(0, 0, 0, 0, n, s, slc)));
+                        gFactorSlice.create(RO, E1, &(recon_obj.gfactor_(0, 0, 0, 0, n, s, slc)));
+                        calibRealOutputs.push_back(&gFactorSlice);
+                    }
+
+                    uint64_t calibKey = 0;
+                    if (use_calibration_cache)
+                    {
+                        CalibrationFingerprint fingerprint;
+                        fingerprint.add(ref_src).add(RO).add(E1).add(E2).add(acceFactorE1_[e]).add(acceFactorE2_[e])
+                            .add(kRO).add(kE1).add(kE2).add(reg_lamda).add(over_determine_ratio);
+                        if (E2 == 1) fingerprint.add(hoNDArray< std::complex<float> >(RO, E1, dstCHA, &(recon_obj.coil_map_(0, 0, 0, 0, n, s, slc))));
+                        calibKey = fingerprint.value();
+
+                        if (restore_calibration(calibKey, calibOutputs, calibRealOutputs)) continue;
+                    }
+
                     // -----------------------------------
 
                     if (E2 > 1)
@@ -309,6 +345,14 @@ namespace Gadgetron {
                         Gadgetron::grappa2d_unmixing_coeff(kImTmp, coilMap, (size_t)acceFactorE1_[e], unmixC, gFactor);
                         memcpy(&(recon_obj.gfactor_(0, 0, 0, 0, n, s, slc)), gFactor.begin(), gFactor.get_number_of_bytes());
                     }
+
+                    if (use_calibration_cache) cache_calibration(calibKey, calibOutputs, calibRealOutputs);
+                }
+
+                if (CalibrationCache::instance().enabled())
+                {
+                    auto stats = CalibrationCache::instance().statistics();
+                    GDEBUG_CONDITION_STREAM(this->verbose.value(), "Calibration cache : " << stats.hits << " hits, " << stats.disk_hits << " disk hits, " << stats.misses << " misses, " << stats.entries << " entries");
                 }
             }
         }
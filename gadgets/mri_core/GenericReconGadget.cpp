@@ -95,6 +95,13 @@ namespace Gadgetron {
             }
         }
 
+        if (calibration_cache_size.value() > 0) {
+            auto& cache = CalibrationCache::instance();
+            cache.set_capacity(calibration_cache_size.value());
+            cache.set_folder(calibration_cache_folder.value());
+            GDEBUG_CONDITION_STREAM(verbose.value(), "Calibration cache size : " << calibration_cache_size.value());
+        }
+
         return GADGET_OK;
     }
 
@@ -619,11 +626,72 @@ namespace Gadgetron {
             GWARN_STREAM("Cannot find any sampled lines ... ");
         }
     }
+
+    void GenericReconGadget::compute_aliased_images(const IsmrmrdDataBuffered& data,
+        hoNDArray<std::complex<float>>& complex_im, hoNDArray<std::complex<float>>& buf) {
+
+        size_t E2 = data.data_.get_size(2);
+
+        if (!data.hybrid_space_) {
+            if (E2 > 1)
+                Gadgetron::hoNDFFT<float>::instance()->ifft3c(data.data_, complex_im, buf);
+            else
+                Gadgetron::hoNDFFT<float>::instance()->ifft2c(data.data_, complex_im, buf);
+            return;
+        }
+
+        // the shifts along E0 undo each other, leaving the centered transform along E1 and E2; the scaling of the
+        // transforms along each dimension multiplies up to that of ifft2c and ifft3c
+        complex_im = data.data_;
+        if (E2 > 1) {
+            Gadgetron::hoNDFFT<float>::instance()->ifftshift3D(complex_im);
+            Gadgetron::FFT::ifft(complex_im, std::vector<size_t>{ 1, 2 });
+            Gadgetron::hoNDFFT<float>::instance()->fftshift3D(complex_im);
+        } else {
+            Gadgetron::hoNDFFT<float>::instance()->ifftshift2D(complex_im);
+            Gadgetron::FFT::ifft(complex_im, size_t(1));
+            Gadgetron::hoNDFFT<float>::instance()->fftshift2D(complex_im);
+        }
+    }
     void GenericReconGadget::send_out_image_array(
         IsmrmrdImageArray& res, size_t encoding, int series_num, const std::string& data_role) {
         this->prepare_image_array(res, encoding, series_num, data_role);
         this->next()->putq(new GadgetContainerMessage<IsmrmrdImageArray>(res));
     }
 
+    bool GenericReconGadget::restore_calibration(uint64_t key,
+        const std::vector<hoNDArray<std::complex<float>>*>& outputs, const std::vector<hoNDArray<float>*>& real_outputs) {
+        CalibrationResult cached;
+        if (!CalibrationCache::instance().lookup(key, cached))
+            return false;
+
+        if (cached.complex_arrays.size() != outputs.size() || cached.real_arrays.size() != real_outputs.size())
+            return false;
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if (!outputs[i]->dimensions_equal(cached.complex_arrays[i].dimensions()))
+                return false;
+        }
+        for (size_t i = 0; i < real_outputs.size(); i++) {
+            if (!real_outputs[i]->dimensions_equal(cached.real_arrays[i].dimensions()))
+                return false;
+        }
+
+        for (size_t i = 0; i < outputs.size(); i++)
+            memcpy(outputs[i]->begin(), cached.complex_arrays[i].begin(), outputs[i]->get_number_of_bytes());
+        for (size_t i = 0; i < real_outputs.size(); i++)
+            memcpy(real_outputs[i]->begin(), cached.real_arrays[i].begin(), real_outputs[i]->get_number_of_bytes());
+        return true;
+    }
+
+    void GenericReconGadget::cache_calibration(uint64_t key,
+        const std::vector<hoNDArray<std::complex<float>>*>& outputs, const std::vector<hoNDArray<float>*>& real_outputs) {
+        CalibrationResult result;
+        for (auto output : outputs)
+            result.complex_arrays.push_back(*output);
+        for (auto output : real_outputs)
+            result.real_arrays.push_back(*output);
+        CalibrationCache::instance().insert(key, result);
+    }
+
     GADGET_FACTORY_DECLARE(GenericReconGadget)
 }
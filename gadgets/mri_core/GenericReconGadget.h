@@ -13,6 +13,7 @@
 #include "hoNDFFT.h"
 
 #include "mri_core_coil_map_estimation.h"
+#include "mri_core_calibration_cache.h"
 #include "ImageArraySendMixin.h"
 
 namespace Gadgetron {
@@ -42,6 +43,11 @@ namespace Gadgetron {
         GADGET_PROPERTY(coil_map_num_iter, size_t, "Coil map estimation, number of iterations", 10);
         GADGET_PROPERTY(coil_map_thres_iter, double, "Coil map estimation, threshold to stop iteration", 1e-4);
 
+        /// calibration cache, shared by all recon gadgets in the process
+        /// if calibration_cache_size > 0, calibrations are reused when the same reference data, geometry and kernel parameters come back
+        GADGET_PROPERTY(calibration_cache_size, size_t, "Number of calibrations kept in memory for reuse, 0 to disable", 0);
+        GADGET_PROPERTY(calibration_cache_folder, std::string, "If set, cached calibrations are also stored in this folder", "");
+
     protected:
 
         void send_out_image_array(IsmrmrdImageArray& res, size_t encoding, int series_num, const std::string& data_role);
@@ -98,5 +104,14 @@ namespace Gadgetron {
         // compute snr scaling factor from effective acceleration rate and sampling region
         void compute_snr_scaling_factor(IsmrmrdReconBit& recon_bit, float& effective_acce_factor, float& snr_scaling_ratio);
 
+        // compute the aliased channel images; data sent in hybrid space is only transformed along E1 and E2
+        void compute_aliased_images(const IsmrmrdDataBuffered& data, hoNDArray< std::complex<float> >& complex_im, hoNDArray< std::complex<float> >& buf);
+
+        // copy the cached calibration of one [N S SLC] slice into the output arrays; false if it is not cached
+        static bool restore_calibration(uint64_t key, const std::vector< hoNDArray< std::complex<float> >* >& outputs, const std::vector< hoNDArray<float>* >& real_outputs);
+
+        // keep a copy of the calibration of one [N S SLC] slice for later
+        static void cache_calibration(uint64_t key, const std::vector< hoNDArray< std::complex<float> >* >& outputs, const std::vector< hoNDArray<float>* >& real_outputs);
+
     };
 }
@@ -2,9 +2,7 @@
 #include "hoNDFFT.h"
 #include "ismrmrd/xml.h"
 
-#ifdef USE_OMP
-    #include "omp.h"
-#endif // USE_OMP
+#include <cmath>
 
 namespace Gadgetron{
 
@@ -37,12 +35,6 @@ namespace Gadgetron{
         reconNx_   = r_space.matrixSize.x;
         reconFOV_  = r_space.fieldOfView_mm.x;
 
-        // limit the number of threads used to be 1
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-        GDEBUG_STREAM("RemoveROOversamplingGadget:omp_set_num_threads(1) ... ");
-#endif // USE_OMP
-
     // If the encoding and recon matrix size and FOV are the same
     // then the data is not oversampled and we can safely pass
     // the data onto the next gadget
@@ -54,6 +46,22 @@ namespace Gadgetron{
       dowork_ = true;
     }
 
+        decimator_.reset();
+        if ( dowork_ && decimation.value() == "FIR" )
+        {
+            // the filter decimates by a whole number; anything else is left to the FFTs
+            float ratioFOV = encodeFOV_/reconFOV_;
+            size_t factor = (size_t)std::round(ratioFOV);
+            if ( factor > 1 && std::abs(ratioFOV - factor) < 1e-3 )
+            {
+                decimator_ = std::make_unique<ReadoutDecimator>(factor, fir_length.value());
+            }
+            else
+            {
+                GWARN_STREAM("RemoveROOversamplingGadget: FIR decimation needs a whole oversampling ratio, not " << ratioFOV << "; using FFT");
+            }
+        }
+
         return GADGET_OK;
     }
 
@@ -73,58 +81,72 @@ namespace Gadgetron{
             return GADGET_FAIL;
         }
 
-        std::vector<size_t> data_out_dims = *m2->getObjectPtr()->get_dimensions();
-        if ( !ifft_buf_.dimensions_equal(&data_out_dims) )
-        {
-            ifft_buf_.create(data_out_dims);
-            ifft_res_.create(data_out_dims);
-        }
-
         float ratioFOV = encodeFOV_/reconFOV_;
 
-        data_out_dims[0] = (size_t)(data_out_dims[0]/ratioFOV);
-        if ( !fft_buf_.dimensions_equal(&data_out_dims) )
+        if ( decimator_ && m2->getObjectPtr()->get_size(0) % decimator_->factor() == 0 )
         {
-            fft_buf_.create(data_out_dims);
-            fft_res_.create(data_out_dims);
+            ratioFOV = (float)decimator_->factor();
+
+            try { (*decimator_)(*m2->getObjectPtr(), *m3->getObjectPtr()); }
+            catch (std::runtime_error &err)
+            {
+                GEXCEPTION(err,"Unable to decimate the readout\n");
+                return GADGET_FAIL;
+            }
         }
-
-        try{ m3->getObjectPtr()->create(data_out_dims);}
-        catch (std::runtime_error &err)
+        else
         {
-            GEXCEPTION(err,"Unable to create new data array for downsampled data\n");
-            return GADGET_FAIL;
-        }
+            std::vector<size_t> data_out_dims = *m2->getObjectPtr()->get_dimensions();
+            if ( !ifft_buf_.dimensions_equal(&data_out_dims) )
+            {
+                ifft_buf_.create(data_out_dims);
+                ifft_res_.create(data_out_dims);
+            }
 
-        size_t sRO = m2->getObjectPtr()->get_size(0);
-        size_t start = (size_t)( (m2->getObjectPtr()->get_size(0)-data_out_dims[0])/ratioFOV );
+            data_out_dims[0] = (size_t)(data_out_dims[0]/ratioFOV);
+            if ( !fft_buf_.dimensions_equal(&data_out_dims) )
+            {
+                fft_buf_.create(data_out_dims);
+                fft_res_.create(data_out_dims);
+            }
 
-        size_t dRO = m3->getObjectPtr()->get_size(0);
-        size_t numOfBytes = data_out_dims[0]*sizeof(std::complex<float>);
+            try{ m3->getObjectPtr()->create(data_out_dims);}
+            catch (std::runtime_error &err)
+            {
+                GEXCEPTION(err,"Unable to create new data array for downsampled data\n");
+                return GADGET_FAIL;
+            }
 
-        int c;
+            size_t sRO = m2->getObjectPtr()->get_size(0);
+            size_t start = (size_t)( (m2->getObjectPtr()->get_size(0)-data_out_dims[0])/ratioFOV );
 
-        int CHA = (int)(data_out_dims[1]);
+            size_t dRO = m3->getObjectPtr()->get_size(0);
+            size_t numOfBytes = data_out_dims[0]*sizeof(std::complex<float>);
 
-        std::complex<float>* data_in, *data_out;
+            int c;
 
-        hoNDFFT<float>::instance()->ifft1c(*m2->getObjectPtr(), ifft_res_, ifft_buf_);
-        data_in  = ifft_res_.get_data_ptr();
-        data_out = m3->getObjectPtr()->get_data_ptr();
+            int CHA = (int)(data_out_dims[1]);
 
-        for ( c=0; c<CHA; c++)
-        {
-            memcpy( data_out+c*dRO, data_in+c*sRO+start, numOfBytes );
-        }
+            std::complex<float>* data_in, *data_out;
 
-        hoNDFFT<float>::instance()->fft1c(*m3->getObjectPtr(), fft_res_, fft_buf_);
+            hoNDFFT<float>::instance()->ifft1c(*m2->getObjectPtr(), ifft_res_, ifft_buf_);
+            data_in  = ifft_res_.get_data_ptr();
+            data_out = m3->getObjectPtr()->get_data_ptr();
 
-        memcpy(m3->getObjectPtr()->begin(), fft_res_.begin(), fft_res_.get_number_of_bytes());
+            for ( c=0; c<CHA; c++)
+            {
+                memcpy( data_out+c*dRO, data_in+c*sRO+start, numOfBytes );
+            }
+
+            hoNDFFT<float>::instance()->fft1c(*m3->getObjectPtr(), fft_res_, fft_buf_);
+
+            memcpy(m3->getObjectPtr()->begin(), fft_res_.begin(), fft_res_.get_number_of_bytes());
+        }
 
         m2->release(); //We are done with this data
 
         m1->cont(m3);
-        m1->getObjectPtr()->number_of_samples = data_out_dims[0];
+        m1->getObjectPtr()->number_of_samples = (uint16_t)m3->getObjectPtr()->get_size(0);
         m1->getObjectPtr()->center_sample = (uint16_t)(m1->getObjectPtr()->center_sample/ratioFOV);
         m1->getObjectPtr()->discard_pre = (uint16_t)(m1->getObjectPtr()->discard_pre / ratioFOV);
         m1->getObjectPtr()->discard_post = (uint16_t)(m1->getObjectPtr()->discard_post / ratioFOV);
@@ -3,9 +3,11 @@
 #include "Gadget.h"
 #include "hoNDArray.h"
 #include "gadgetron_mricore_export.h"
+#include "mri_core_readout_decimation.h"
 
 #include <ismrmrd/ismrmrd.h>
 #include <complex>
+#include <memory>
 
 namespace Gadgetron{
 
@@ -20,6 +22,11 @@ namespace Gadgetron{
 
     protected:
 
+        GADGET_PROPERTY_LIMITS(decimation, std::string, "Method to remove the oversampling: crop in image domain with FFTs, or filter the k-space samples with a FIR lowpass", "FFT",
+            GadgetPropertyLimitsEnumeration, "FFT", "FIR");
+        GADGET_PROPERTY_LIMITS(fir_length, int, "Length of the FIR filter in samples; longer filters are more accurate near the edge of the field of view", 64,
+            GadgetPropertyLimitsRange, 8, 512);
+
         virtual int process_config(ACE_Message_Block* mb);
 
         virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
@@ -39,5 +46,8 @@ namespace Gadgetron{
 	// if true the gadget performs the operation
 	// otherwise, it just passes the data on
 	bool dowork_;
+
+        // set when decimating with the FIR filter
+        std::unique_ptr<ReadoutDecimator> decimator_;
     };
 }
@@ -19,6 +19,7 @@ int SimpleReconGadget::process( GadgetContainerMessage<IsmrmrdReconData>* m1)
         //Grab a reference to the buffer containing the imaging data
         //We are ignoring the reference data
         IsmrmrdDataBuffered & dbuff = it->data_;
+        require_kspace(dbuff, "SimpleReconGadget");
 
         //Data 7D, fixed order [E0, E1, E2, CHA, N, S, LOC]
         uint16_t E0 = dbuff.data_.get_size(0);
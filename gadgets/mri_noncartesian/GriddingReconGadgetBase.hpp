@@ -64,6 +64,7 @@ template<template<class> class ARRAY> 	int GriddingReconGadgetBase<ARRAY>::proce
 		{
 
 			IsmrmrdDataBuffered* buffer = &(recon_bit_->rbit_[e].data_);
+			require_kspace(*buffer, "GriddingReconGadget");
 
 			size_t RO = buffer->data_.get_size(0);
 			size_t E1 = buffer->data_.get_size(1);
@@ -71,6 +71,7 @@ int gpuBufferSensePrepGadget::process(
 	}
 
 	IsmrmrdReconBit& reconbit = recondata->rbit_[0];
+	require_kspace(reconbit.data_, "gpuBufferSensePrepGadget");
 
 	GenericReconJob job;
 
@@ -194,6 +194,7 @@ typedef cuNFFT_impl<_real,2> plan_type;
 			//Map data in rbit_[0].ref_->data_ (N dimension should be "set", 0th N-dim is TE0, 1st N-dim is TE1)
 
 		IsmrmrdReconData* recon_bit_ = m1->getObjectPtr();
+		require_kspace(recon_bit_->rbit_[0].data_, "gpuSpiralDeblurGadget");
 
 		// Allocate various counters if they are NULL
 		if( !image_counter_.get() ){
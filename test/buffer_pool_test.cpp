@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "BufferPool.h"
+
+#include <complex>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+TEST(BufferPoolTest, aligned) {
+    BufferPool pool;
+    auto array = pool.make_array<std::complex<float>>({ 123, 7 });
+
+    EXPECT_EQ(array.get_number_of_elements(), 123 * 7);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data()) % BufferPool::alignment, 0);
+}
+
+TEST(BufferPoolTest, recycled) {
+    BufferPool pool;
+
+    std::complex<float>* data;
+    {
+        auto array = pool.make_array<std::complex<float>>({ 256, 32 });
+        data       = array.data();
+    }
+    EXPECT_GE(pool.cached_bytes(), 256 * 32 * sizeof(std::complex<float>));
+
+    auto array = pool.make_array<std::complex<float>>({ 256, 32 });
+    EXPECT_EQ(array.data(), data);
+    EXPECT_EQ(pool.cached_bytes(), 0);
+}
+
+TEST(BufferPoolTest, ownership_follows_move) {
+    BufferPool pool;
+
+    hoNDArray<float> moved;
+    {
+        auto array = pool.make_array<float>({ 1024 });
+        std::fill(array.begin(), array.end(), 1.0f);
+        moved = std::move(array);
+    }
+    EXPECT_EQ(pool.cached_bytes(), 0);
+    EXPECT_EQ(moved[1023], 1.0f);
+
+    moved = hoNDArray<float>(16);
+    EXPECT_EQ(pool.cached_bytes(), 1024 * sizeof(float));
+}
+
+TEST(BufferPoolTest, trimmed) {
+    BufferPool pool(8192);
+    {
+        auto a = pool.make_array<float>({ 2048 });
+        auto b = pool.make_array<float>({ 2048 });
+        auto c = pool.make_array<float>({ 2048 });
+    }
+    EXPECT_LE(pool.cached_bytes(), 8192);
+
+    pool.set_max_cached_bytes(0);
+    EXPECT_EQ(pool.cached_bytes(), 0);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "mri_core_calibration_cache.h"
+
+#include <boost/filesystem.hpp>
+
+using namespace Gadgetron;
+
+namespace {
+    CalibrationResult make_result(float value) {
+        CalibrationResult result;
+        result.complex_arrays.emplace_back(7, 5, 3);
+        result.complex_arrays.back().fill(std::complex<float>(value, -value));
+        result.real_arrays.emplace_back(7, 5);
+        result.real_arrays.back().fill(value);
+        return result;
+    }
+}
+
+TEST(CalibrationFingerprint, sensitive) {
+    hoNDArray<std::complex<float>> ref(32, 24, 4);
+    ref.fill(std::complex<float>(1, 2));
+
+    auto key = CalibrationFingerprint().add(ref).add(size_t(5)).add(0.0005).value();
+    EXPECT_EQ(key, CalibrationFingerprint().add(ref).add(size_t(5)).add(0.0005).value());
+
+    EXPECT_NE(key, CalibrationFingerprint().add(ref).add(size_t(4)).add(0.0005).value());
+    EXPECT_NE(key, CalibrationFingerprint().add(ref).add(size_t(5)).add(0.001).value());
+
+    hoNDArray<std::complex<float>> reshaped(24, 32, 4);
+    reshaped.fill(std::complex<float>(1, 2));
+    EXPECT_NE(key, CalibrationFingerprint().add(reshaped).add(size_t(5)).add(0.0005).value());
+
+    ref(31, 23, 3) = std::complex<float>(1, 2.0001f);
+    EXPECT_NE(key, CalibrationFingerprint().add(ref).add(size_t(5)).add(0.0005).value());
+}
+
+TEST(CalibrationCache, disabled) {
+    CalibrationCache cache;
+    cache.insert(1, make_result(1));
+
+    CalibrationResult result;
+    EXPECT_FALSE(cache.lookup(1, result));
+    EXPECT_EQ(cache.statistics().entries, 0);
+}
+
+TEST(CalibrationCache, least_recently_used) {
+    CalibrationCache cache(2);
+    cache.insert(1, make_result(1));
+    cache.insert(2, make_result(2));
+
+    CalibrationResult result;
+    ASSERT_TRUE(cache.lookup(1, result));
+    EXPECT_EQ(result.real_arrays[0](3, 3), 1);
+    EXPECT_EQ(result.complex_arrays[0].dimensions(), make_result(1).complex_arrays[0].dimensions());
+
+    // 2 is now the least recently used, and makes way for 3.
+    cache.insert(3, make_result(3));
+    EXPECT_FALSE(cache.lookup(2, result));
+    EXPECT_TRUE(cache.lookup(1, result));
+    EXPECT_TRUE(cache.lookup(3, result));
+
+    auto stats = cache.statistics();
+    EXPECT_EQ(stats.hits, 3);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.entries, 2);
+
+    cache.set_capacity(1);
+    EXPECT_EQ(cache.statistics().entries, 1);
+    EXPECT_TRUE(cache.lookup(3, result));
+}
+
+TEST(CalibrationCache, folder) {
+    auto folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("calibration_cache_%%%%-%%%%");
+
+    {
+        CalibrationCache cache(4, folder.string());
+        cache.insert(42, make_result(4.5f));
+    }
+
+    // A new cache, as after a restart, finds the result on disk.
+    CalibrationCache cache(4, folder.string());
+    CalibrationResult result;
+    ASSERT_TRUE(cache.lookup(42, result));
+    EXPECT_EQ(result.complex_arrays[0](6, 4, 2), std::complex<float>(4.5f, -4.5f));
+    EXPECT_EQ(result.real_arrays[0](6, 4), 4.5f);
+    EXPECT_EQ(cache.statistics().disk_hits, 1);
+
+    // ... and keeps it in memory from then on.
+    ASSERT_TRUE(cache.lookup(42, result));
+    EXPECT_EQ(cache.statistics().hits, 1);
+
+    EXPECT_FALSE(cache.lookup(43, result));
+
+    boost::filesystem::remove_all(folder);
+}
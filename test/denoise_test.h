@@ -0,0 +1,31 @@
+//
+// Fixture of the denoising tests: a noisy series of block images, for real and complex data.
+//
+#pragma once
+
+#include "denoise_test_helpers.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+namespace Gadgetron { namespace Test {
+
+    template <typename T> class DenoiseTest : public ::testing::Test {
+    protected:
+        void make_series(size_t X, size_t Y, size_t frames) {
+            std::mt19937 engine(7);
+            clean = blocks<T>(X, Y, frames);
+            noisy = clean;
+            for (auto& value : noisy) value += noise<T>(engine, 1.0f);
+        }
+
+        hoNDArray<T> clean, noisy;
+    };
+
+    typedef ::testing::Types<float, std::complex<float>> DenoiseImplementations;
+
+    // Settings that are refused before any work is done.
+    template <class F> void expect_invalid_settings(F denoise) {
+        EXPECT_THROW(denoise(hoNDArray<float>(16, 16)), std::invalid_argument);
+    }
+}}
@@ -0,0 +1,110 @@
+//
+// Test images, error measures and the original patch-by-patch non-local means, shared by the denoising tests and
+// benchmarks.
+//
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace Gadgetron { namespace Test {
+
+    template <class T> T noise(std::mt19937& engine, float std) {
+        return T(std::normal_distribution<float>(0, std)(engine));
+    }
+
+    template <> inline std::complex<float> noise<std::complex<float>>(std::mt19937& engine, float std) {
+        std::normal_distribution<float> distribution(0, std / std::sqrt(2.0f));
+        return { distribution(engine), distribution(engine) };
+    }
+
+    // Blocks of two levels, moving along a series of frames.
+    template <class T> hoNDArray<T> blocks(size_t X, size_t Y, size_t frames) {
+        hoNDArray<T> image(X, Y, frames);
+        for (size_t f = 0; f < frames; f++)
+            for (size_t y = 0; y < Y; y++)
+                for (size_t x = 0; x < X; x++)
+                    image(x, y, f) = T(((x + f) / 12 + y / 12) % 2 ? 8.0f : 0.0f);
+        return image;
+    }
+
+    // A disc on a gradient, moving along the frames, with complex Gaussian noise.
+    inline void cine(size_t size, size_t frames, float noise_std, hoNDArray<std::complex<float>>& clean,
+        hoNDArray<std::complex<float>>& noisy) {
+        std::mt19937 engine(size + frames);
+
+        clean.create(size, size, frames);
+        noisy.create(size, size, frames);
+        for (size_t f = 0; f < frames; f++) {
+            float cx = size * (0.4f + 0.2f * f / frames), cy = size * 0.5f, radius = size * 0.2f;
+            for (size_t y = 0; y < size; y++) {
+                for (size_t x = 0; x < size; x++) {
+                    float value    = 4.0f * x / size + (std::hypot(x - cx, y - cy) < radius ? 8.0f : 0.0f);
+                    clean(x, y, f) = std::polar(value, 0.3f);
+                    noisy(x, y, f) = clean(x, y, f) + noise<std::complex<float>>(engine, noise_std);
+                }
+            }
+        }
+    }
+
+    template <class T> double rms_error(const hoNDArray<T>& a, const hoNDArray<T>& b) {
+        double sum = 0;
+        for (size_t i = 0; i < a.get_number_of_elements(); i++) sum += std::norm(a[i] - b[i]);
+        return std::sqrt(sum / a.get_number_of_elements());
+    }
+
+    template <class F> double time_ms(F f, int repetitions) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; i++) f();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+    }
+
+    namespace original {
+
+        // Non-local means before integral images, reduced to a single image: every pair of patches is compared on
+        // its own, with wrapped indices.
+        template <class T> hoNDArray<T> non_local_means(const hoNDArray<T>& image, float noise_std, int search_radius) {
+            constexpr int D = 5;
+            const int X = image.get_size(0), Y = image.get_size(1);
+            const float noise_std2 = noise_std * noise_std;
+
+            auto get_patch = [&](int x, int y) {
+                T window[D * D];
+                for (int ky = 0; ky < D; ky++)
+                    for (int kx = 0; kx < D; kx++)
+                        window[kx + ky * D] = image(((kx - D / 2) + x + X) % X, ((ky - D / 2) + y + Y) % Y);
+                return std::vector<T>(window, window + D * D);
+            };
+
+            hoNDArray<T> result(image.dimensions());
+#pragma omp parallel for
+            for (int ky = 0; ky < Y; ky++) {
+                for (int kx = 0; kx < X; kx++) {
+                    float sum_weight = 0;
+                    T sum_value      = 0;
+                    auto window      = get_patch(kx, ky);
+
+                    for (int dy = -search_radius; dy < search_radius; dy++) {
+                        for (int dx = -search_radius; dx < search_radius; dx++) {
+                            auto window2   = get_patch(kx + dx, ky + dy);
+                            float distance = 0;
+                            for (int i = 0; i < D * D; i++) distance += std::norm(window[i] - window2[i]);
+                            auto weight = std::exp(-distance / (noise_std2 * D * D));
+
+                            sum_weight += weight;
+                            sum_value += weight * window2[D / 2 + D * (D / 2)];
+                        }
+                    }
+                    result(kx, ky) = sum_value / sum_weight;
+                }
+            }
+            return result;
+        }
+    }
+}}
@@ -2,6 +2,8 @@
 // Created by dchansen on 9/20/19.
 //
 #include "../../gadgets/mri_core/AcquisitionAccumulateTriggerGadget.h"
+#include "../../gadgets/mri_core/GenericReconGadget.h"
+#include "hoNDFFT.h"
 #include "setup_gadget.h"
 #include <future>
 #include <gtest/gtest.h>
@@ -44,4 +46,199 @@ TEST(AcquisitionAccumulateTriggerTest, slice_trigger) {
         ASSERT_EQ(bucket.data_.size(), 11);
     } catch (const Core::ChannelClosed&){}
 
-}
\ No newline at end of file
+}
+namespace {
+    std::vector<Core::Acquisition> slice_acquisitions() {
+        std::vector<Core::Acquisition> acquisitions;
+        for (size_t i = 0; i < 11; i++) {
+            auto acq                      = generate_acquisition(192, 16);
+            auto& head                    = std::get<ISMRMRD::AcquisitionHeader>(acq);
+            head.idx.kspace_encode_step_1 = i;
+            auto& data                    = std::get<hoNDArray<std::complex<float>>>(acq);
+            std::fill(data.begin(), data.end(), std::complex<float>(float(i + 1), -float(i)));
+            acquisitions.push_back(std::move(acq));
+        }
+
+        auto acq   = generate_acquisition(192, 16);
+        auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+        head.idx.slice++;
+        acquisitions.push_back(std::move(acq));
+        return acquisitions;
+    }
+
+    Core::Message pop(Core::GenericInputChannel& channel) {
+        auto message_future = std::async([&]() { return channel.pop(); });
+        if (message_future.wait_for(1000ms) != std::future_status::ready)
+            throw std::runtime_error("Timed out waiting for gadget output");
+        return message_future.get();
+    }
+}
+
+TEST(AcquisitionAccumulateTriggerTest, buffers_match_bucket_to_buffer) {
+
+    try {
+        auto fused = setup_gadget<AcquisitionAccumulateToBufferGadget>({ { "trigger_dimension"s, "slice"s } });
+        auto accumulate = setup_gadget<AcquisitionAccumulateTriggerGadget>({ { "trigger_dimension"s, "slice"s } });
+        auto bucket_to_buffer = setup_gadget<BucketToBufferGadget>({});
+
+        for (auto& acq : slice_acquisitions()) {
+            fused.input.push(acq);
+            accumulate.input.push(acq);
+        }
+
+        auto message = pop(fused.output);
+        ASSERT_TRUE(Core::convertible_to<IsmrmrdReconData>(message));
+        auto assembled = Core::force_unpack<IsmrmrdReconData>(std::move(message));
+
+        bucket_to_buffer.input.push_message(pop(accumulate.output));
+        message = pop(bucket_to_buffer.output);
+        ASSERT_TRUE(Core::convertible_to<IsmrmrdReconData>(message));
+        auto expected = Core::force_unpack<IsmrmrdReconData>(std::move(message));
+
+        ASSERT_EQ(assembled.rbit_.size(), 1);
+        auto& data = assembled.rbit_[0].data_.data_;
+        auto& expected_data = expected.rbit_[0].data_.data_;
+
+        ASSERT_EQ(data.dimensions(), expected_data.dimensions());
+        EXPECT_TRUE(std::equal(data.begin(), data.end(), expected_data.begin()));
+        EXPECT_FALSE(assembled.rbit_[0].ref_);
+    } catch (const Core::ChannelClosed&){}
+}
+
+TEST(AcquisitionAccumulateTriggerTest, transformed_readouts_are_in_hybrid_space) {
+
+    try {
+        auto fused = setup_gadget<AcquisitionAccumulateToBufferGadget>({ { "trigger_dimension"s, "slice"s } });
+        auto transformed = setup_gadget<AcquisitionAccumulateToBufferGadget>(
+            { { "trigger_dimension"s, "slice"s }, { "transform_readouts"s, "true"s } });
+
+        for (auto& acq : slice_acquisitions()) {
+            fused.input.push(acq);
+            transformed.input.push(acq);
+        }
+
+        auto expected = Core::force_unpack<IsmrmrdReconData>(pop(fused.output));
+        auto assembled = Core::force_unpack<IsmrmrdReconData>(pop(transformed.output));
+
+        EXPECT_FALSE(expected.rbit_[0].data_.hybrid_space_);
+        ASSERT_TRUE(assembled.rbit_[0].data_.hybrid_space_);
+
+        auto& data = assembled.rbit_[0].data_.data_;
+        auto expected_data = FFT::ifft1c(expected.rbit_[0].data_.data_);
+
+        ASSERT_EQ(data.dimensions(), expected_data.dimensions());
+        for (size_t i = 0; i < data.get_number_of_elements(); i++)
+            EXPECT_NEAR(std::abs(data[i] - expected_data[i]), 0.0f, 1e-4f);
+    } catch (const Core::ChannelClosed&){}
+}
+
+namespace {
+    // Two contrasts of 11 lines each, then a readout of the next slice.
+    std::vector<Core::Acquisition> contrast_acquisitions() {
+        std::vector<Core::Acquisition> acquisitions;
+        for (uint16_t contrast = 0; contrast < 2; contrast++) {
+            for (size_t i = 0; i < 11; i++) {
+                auto acq                      = generate_acquisition(192, 4);
+                auto& head                    = std::get<ISMRMRD::AcquisitionHeader>(acq);
+                head.idx.kspace_encode_step_1 = i;
+                head.idx.contrast             = contrast;
+                auto& data                    = std::get<hoNDArray<std::complex<float>>>(acq);
+                std::fill(data.begin(), data.end(), std::complex<float>(float(i), float(contrast)));
+                acquisitions.push_back(std::move(acq));
+            }
+        }
+
+        auto acq   = generate_acquisition(192, 4);
+        auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+        head.idx.slice++;
+        acquisitions.push_back(std::move(acq));
+        return acquisitions;
+    }
+
+    Core::Context contrast_context() {
+        auto context = generate_context();
+        auto& limits = context.header.encoding[0].encodingLimits;
+        limits.contrast          = ISMRMRD::Limit();
+        limits.contrast->minimum = 0;
+        limits.contrast->center  = 0;
+        limits.contrast->maximum = 1;
+        return context;
+    }
+}
+
+TEST(AcquisitionAccumulateTriggerTest, n_dimension_spans_encoding_limit) {
+
+    try {
+        auto fused = setup_gadget<AcquisitionAccumulateToBufferGadget>(
+            { { "trigger_dimension"s, "slice"s }, { "N_dimension"s, "contrast"s } }, contrast_context());
+
+        for (auto& acq : contrast_acquisitions())
+            fused.input.push(acq);
+
+        auto assembled = Core::force_unpack<IsmrmrdReconData>(pop(fused.output));
+        auto& data     = assembled.rbit_[0].data_.data_;
+
+        ASSERT_EQ(data.get_size(4), 2);
+        for (size_t contrast = 0; contrast < 2; contrast++) {
+            for (size_t i = 0; i < 11; i++)
+                EXPECT_EQ(data(0, i, 0, 3, contrast, 0, 0), std::complex<float>(float(i), float(contrast)));
+        }
+    } catch (const Core::ChannelClosed&){}
+}
+
+TEST(AcquisitionAccumulateTriggerTest, n_dimension_requires_encoding_limit) {
+
+    auto input  = Core::make_channel();
+    auto output = Core::make_channel();
+
+    for (auto& acq : contrast_acquisitions())
+        input.output.push(acq);
+    { auto closed = std::move(input.output); }
+
+    AcquisitionAccumulateToBufferGadget gadget(
+        generate_context(), { { "trigger_dimension"s, "slice"s }, { "N_dimension"s, "contrast"s } });
+    Core::Node& node = gadget;
+    EXPECT_THROW(node.process(input.input, output.output), std::runtime_error);
+}
+
+namespace {
+    struct AliasedImages : public GenericReconGadget {
+        using GenericReconGadget::compute_aliased_images;
+    };
+}
+
+class AliasedImagesTest : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(AliasedImagesTest, hybrid_space_matches_kspace) {
+
+    const size_t E2 = GetParam();
+    hoNDArray<std::complex<float>> kspace(32, 24, E2, 4, 2, 1, 1);
+    for (size_t i = 0; i < kspace.get_number_of_elements(); i++)
+        kspace[i] = std::complex<float>(std::sin(0.37f * i), std::cos(0.11f * i * i));
+
+    hoNDArray<std::complex<float>> expected;
+    if (E2 > 1)
+        hoNDFFT<float>::instance()->ifft3c(kspace, expected);
+    else
+        hoNDFFT<float>::instance()->ifft2c(kspace, expected);
+
+    IsmrmrdDataBuffered buffer;
+    buffer.data_ = FFT::ifft1c(kspace);
+    buffer.hybrid_space_ = true;
+
+    hoNDArray<std::complex<float>> images, buf(kspace.dimensions());
+    AliasedImages().compute_aliased_images(buffer, images, buf);
+
+    ASSERT_EQ(images.dimensions(), expected.dimensions());
+    for (size_t i = 0; i < images.get_number_of_elements(); i++)
+        EXPECT_NEAR(std::abs(images[i] - expected[i]), 0.0f, 1e-4f);
+}
+
+INSTANTIATE_TEST_CASE_P(Encodings, AliasedImagesTest, ::testing::Values(size_t(1), size_t(6)));
+
+TEST(AliasedImagesTest, kspace_consumers_reject_hybrid_space) {
+    IsmrmrdDataBuffered buffer;
+    EXPECT_NO_THROW(require_kspace(buffer, "test"));
+    buffer.hybrid_space_ = true;
+    EXPECT_THROW(require_kspace(buffer, "test"), std::runtime_error);
+}
@@ -0,0 +1,132 @@
+#include "hoBatchCgSolver.h"
+#include "hoIdentityOperator.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    template <class T> T conjugate(T x) { return x; }
+    template <class T> std::complex<T> conjugate(std::complex<T> x) { return std::conj(x); }
+
+    // Multiplication with a fixed array, element by element.
+    template <class T> class DiagonalOperator : public linearOperator<hoNDArray<T>> {
+    public:
+        explicit DiagonalOperator(boost::shared_ptr<hoNDArray<T>> diagonal) : diagonal(diagonal) {}
+
+        void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            apply(in, out, accumulate, [](T d) { return d; });
+        }
+
+        void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            apply(in, out, accumulate, [](T d) { return conjugate(d); });
+        }
+
+        void mult_MH_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false) override {
+            apply(in, out, accumulate, [](T d) { return T(std::norm(d)); });
+        }
+
+    private:
+        template <class F> void apply(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate, F f) {
+            for (size_t i = 0; i < in->get_number_of_elements(); i++) {
+                T value = f((*diagonal)[i]) * (*in)[i];
+                (*out)[i] = accumulate ? (*out)[i] + value : value;
+            }
+        }
+
+        boost::shared_ptr<hoNDArray<T>> diagonal;
+    };
+}
+
+template <typename T> class hoBatchCgSolver_Test : public ::testing::Test {
+protected:
+    using REAL = realType_t<T>;
+
+    // Four systems of 300x200 unknowns, enough for the solver to split them across threads.
+    std::vector<size_t> dims{ 300, 200, 4 };
+    REAL lambda = REAL(0.1);
+
+    boost::shared_ptr<hoNDArray<T>> diagonal = boost::make_shared<hoNDArray<T>>(dims);
+    hoNDArray<T> data = hoNDArray<T>(dims);
+
+    void SetUp() override {
+        std::mt19937 engine(7);
+        std::uniform_real_distribution<double> distribution(0.5, 2.0);
+        for (auto& value : *diagonal) value = T(distribution(engine));
+        for (auto& value : data) value = T(distribution(engine) - 1.25);
+
+        // System 1 is trivial, and should converge in a single iteration; system 2 has nothing to solve.
+        size_t system = diagonal->get_size(0) * diagonal->get_size(1);
+        std::fill(diagonal->begin() + system, diagonal->begin() + 2 * system, T(1));
+        std::fill(data.begin() + 2 * system, data.begin() + 3 * system, T(0));
+    }
+
+    hoBatchCgSolver<T> make_solver() {
+        auto E = boost::make_shared<DiagonalOperator<T>>(diagonal);
+        E->set_domain_dimensions(&dims);
+        E->set_codomain_dimensions(&dims);
+
+        auto R = boost::make_shared<hoIdentityOperator<T>>();
+        R->set_domain_dimensions(&dims);
+        R->set_codomain_dimensions(&dims);
+        R->set_weight(lambda);
+
+        hoBatchCgSolver<T> solver;
+        solver.set_encoding_operator(E);
+        solver.add_regularization_operator(R);
+        solver.set_max_iterations(100);
+        solver.set_tc_tolerance(REAL(1e-10));
+        return solver;
+    }
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> Implementations;
+
+TYPED_TEST_CASE(hoBatchCgSolver_Test, Implementations);
+
+TYPED_TEST(hoBatchCgSolver_Test, solves_every_system) {
+    using T = TypeParam;
+    auto solver = this->make_solver();
+    auto x = solver.solve(&this->data);
+
+    ASSERT_TRUE(x->dimensions_equal(&this->data));
+    for (size_t i = 0; i < x->get_number_of_elements(); i++) {
+        T d = (*this->diagonal)[i];
+        T expected = conjugate(d) * this->data[i] / (std::norm(d) + this->lambda);
+        EXPECT_NEAR(0, std::abs((*x)[i] - expected), 1e-3) << "element " << i;
+    }
+}
+
+TYPED_TEST(hoBatchCgSolver_Test, systems_converge_independently) {
+    auto solver = this->make_solver();
+    solver.solve(&this->data);
+
+    auto& iterations = solver.get_iterations_used();
+    ASSERT_EQ(iterations.size(), 4);
+    EXPECT_EQ(iterations[1], 1);
+    EXPECT_EQ(iterations[2], 0);
+    EXPECT_GT(iterations[0], 1);
+    EXPECT_GT(iterations[3], 1);
+}
+
+TYPED_TEST(hoBatchCgSolver_Test, system_dimensions) {
+    using T = TypeParam;
+    auto solver = this->make_solver();
+    solver.set_system_dimensions(1);
+    auto x = solver.solve(&this->data);
+
+    // 800 systems of one column each; the trivial columns converge at once, the rest need more iterations.
+    auto& iterations = solver.get_iterations_used();
+    ASSERT_EQ(iterations.size(), 800);
+    EXPECT_EQ(iterations[200], 1);
+    EXPECT_EQ(iterations[400], 0);
+
+    for (size_t i = 0; i < x->get_number_of_elements(); i++) {
+        T d = (*this->diagonal)[i];
+        T expected = conjugate(d) * this->data[i] / (std::norm(d) + this->lambda);
+        EXPECT_NEAR(0, std::abs((*x)[i] - expected), 1e-3) << "element " << i;
+    }
+}
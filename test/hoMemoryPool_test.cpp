@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "hoNDArray.h"
+#include "hoMemoryPool.h"
+
+#include <complex>
+#include <thread>
+
+using namespace Gadgetron;
+
+class hoMemoryPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hoMemoryPool::instance().enable();
+    }
+
+    void TearDown() override {
+        hoMemoryPool::instance().disable();
+    }
+};
+
+TEST_F(hoMemoryPoolTest, aligned) {
+    hoNDArray<std::complex<float>> array(123, 7);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(array.data()) % hoMemoryPool::alignment, 0);
+
+    hoNDArray<char> odd(3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(odd.data()) % hoMemoryPool::alignment, 0);
+}
+
+TEST_F(hoMemoryPoolTest, default_constructed) {
+    // Plain new[] value-initializes complex numbers; pooled arrays must do the same.
+    {
+        hoNDArray<std::complex<float>> array(64, 64);
+        std::fill(array.begin(), array.end(), std::complex<float>(1, 2));
+    }
+    hoNDArray<std::complex<float>> array(64, 64);
+    for (auto& value : array) EXPECT_EQ(value, std::complex<float>(0));
+}
+
+TEST_F(hoMemoryPoolTest, reused) {
+    auto& pool  = hoMemoryPool::instance();
+    auto before = pool.statistics();
+
+    float* data;
+    {
+        hoNDArray<float> array(257, 33);
+        data = array.data();
+    }
+    hoNDArray<float> array(256, 33);
+
+    auto after = pool.statistics();
+    EXPECT_EQ(array.data(), data);
+    EXPECT_EQ(after.allocations - before.allocations, 2);
+    EXPECT_GE(after.thread_cache_hits - before.thread_cache_hits, 1);
+}
+
+TEST_F(hoMemoryPoolTest, released_on_other_thread) {
+    auto& pool = hoMemoryPool::instance();
+    pool.set_thread_cache_bytes(0);
+
+    auto array = std::make_unique<hoNDArray<double>>(1024, 16);
+    auto data  = array->data();
+    std::thread([&]() { array.reset(); }).join();
+
+    auto before = pool.statistics();
+    hoNDArray<double> reused(1024, 16);
+    auto after = pool.statistics();
+
+    EXPECT_EQ(reused.data(), data);
+    EXPECT_EQ(after.pool_hits - before.pool_hits, 1);
+
+    pool.set_thread_cache_bytes(hoMemoryPool::default_thread_cache_bytes);
+}
+
+TEST_F(hoMemoryPoolTest, trimmed) {
+    auto& pool = hoMemoryPool::instance();
+    pool.set_thread_cache_bytes(0);
+    pool.set_max_cached_bytes(size_t(1) << 20);
+
+    auto before = pool.statistics();
+    {
+        hoNDArray<float> small(1024);
+        hoNDArray<float> large(1 << 20);
+    }
+    auto after = pool.statistics();
+
+    // The largest block goes first.
+    EXPECT_EQ(after.system_releases - before.system_releases, 1);
+
+    pool.trim();
+    EXPECT_EQ(pool.statistics().system_releases - after.system_releases, 1);
+
+    pool.set_thread_cache_bytes(hoMemoryPool::default_thread_cache_bytes);
+}
+
+TEST_F(hoMemoryPoolTest, outlives_disable) {
+    hoNDArray<float> array(4096);
+    hoMemoryPool::instance().disable();
+
+    hoNDArray<float> moved(std::move(array));
+    std::fill(moved.begin(), moved.end(), 1.0f);
+    moved.clear();
+
+    auto before = hoMemoryPool::instance().statistics();
+    hoNDArray<float> unpooled(4096);
+    EXPECT_EQ(hoMemoryPool::instance().statistics().allocations, before.allocations);
+}
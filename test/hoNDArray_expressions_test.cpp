@@ -0,0 +1,140 @@
+#include "hoNDArray_elemwise.h"
+#include "complext.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    template <class T> T random_value(std::mt19937& engine) {
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        return T(distribution(engine));
+    }
+
+    template <> std::complex<float> random_value(std::mt19937& engine) {
+        return { random_value<float>(engine), random_value<float>(engine) };
+    }
+
+    template <> std::complex<double> random_value(std::mt19937& engine) {
+        return { random_value<double>(engine), random_value<double>(engine) };
+    }
+
+    template <> float_complext random_value(std::mt19937& engine) {
+        return { random_value<float>(engine), random_value<float>(engine) };
+    }
+
+    template <class T> hoNDArray<T> random_array(std::vector<size_t> dimensions, unsigned int seed) {
+        std::mt19937 engine(seed);
+        hoNDArray<T> array(dimensions);
+        for (auto& value : array) value = random_value<T>(engine);
+        return array;
+    }
+
+    template <class T> void expect_near(const hoNDArray<T>& expected, const hoNDArray<T>& actual) {
+        using std::abs;
+        ASSERT_EQ(expected.dimensions(), actual.dimensions());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_NEAR(abs(expected[i]), abs(actual[i]), 1e-5) << "at element " << i;
+            ASSERT_NEAR(0, abs(expected[i] - actual[i]), 1e-5) << "at element " << i;
+        }
+    }
+}
+
+template <typename T> class hoNDArray_expressions_Test : public ::testing::Test {
+protected:
+    // Prime sizes, because they are messy; the 4D arrays are large enough to be evaluated in parallel.
+    std::vector<size_t> dims{ 37, 49, 23, 19 };
+    std::vector<size_t> dims2{ 37, 49 };
+
+    hoNDArray<T> a = random_array<T>(dims, 1);
+    hoNDArray<T> b = random_array<T>(dims, 2);
+    hoNDArray<T> c = random_array<T>(dims, 3);
+    hoNDArray<T> d = random_array<T>(dims, 4);
+    hoNDArray<T> small = random_array<T>(dims2, 5);
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>, float_complext> Implementations;
+
+TYPED_TEST_CASE(hoNDArray_expressions_Test, Implementations);
+
+TYPED_TEST(hoNDArray_expressions_Test, fused) {
+    hoNDArray<TypeParam> ab, cd, expected;
+    multiply(this->a, this->b, ab);
+    multiplyConj(this->c, this->d, cd);
+    add(ab, cd, expected);
+
+    hoNDArray<TypeParam> result = this->a * this->b + this->c * conj(this->d);
+    expect_near(expected, result);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, broadcast) {
+    hoNDArray<TypeParam> expected;
+    multiply(this->a, this->small, expected);
+
+    hoNDArray<TypeParam> result = this->a * this->small;
+    expect_near(expected, result);
+
+    hoNDArray<TypeParam> swapped = this->small * this->a;
+    expect_near(expected, swapped);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, scalars) {
+    auto expected = this->a;
+    expected *= TypeParam(2);
+    expected -= this->b;
+    expected -= TypeParam(1);
+
+    hoNDArray<TypeParam> result = 2.0 * this->a - this->b - 1;
+    expect_near(expected, result);
+
+    using value_type = typename decltype(2.0 * this->a)::value_type;
+    static_assert(std::is_same<value_type, TypeParam>::value, "Real scalars must not change the array type");
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, negate) {
+    hoNDArray<TypeParam> expected;
+    subtract(this->b, this->a, expected);
+
+    hoNDArray<TypeParam> result = -this->a + this->b;
+    expect_near(expected, result);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, aliased) {
+    hoNDArray<TypeParam> expected;
+    multiply(this->a, this->b, expected);
+    expected += this->a;
+
+    this->a = this->a * this->b + this->a;
+    expect_near(expected, this->a);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, compound) {
+    hoNDArray<TypeParam> expected;
+    multiply(this->b, this->small, expected);
+    expected += this->a;
+
+    this->a += this->b * this->small;
+    expect_near(expected, this->a);
+
+    EXPECT_THROW(this->small += this->a * this->b, std::runtime_error);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, reuses_output) {
+    hoNDArray<TypeParam> result(this->dims);
+    auto data = result.data();
+
+    evaluate(this->a + this->b, result);
+    EXPECT_EQ(data, result.data());
+
+    hoNDArray<TypeParam> expected;
+    add(this->a, this->b, expected);
+    expect_near(expected, result);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, incompatible) {
+    hoNDArray<TypeParam> odd(5, 7);
+    EXPECT_THROW(evaluate(this->a + odd), std::runtime_error);
+}
@@ -0,0 +1,159 @@
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoNDArray_kernels.h"
+#include "complext.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    template <class T> struct Random {
+        static T value(std::mt19937& engine) { return T(std::uniform_real_distribution<double>(-1, 1)(engine)); }
+    };
+
+    template <class T> struct Random<std::complex<T>> {
+        static std::complex<T> value(std::mt19937& engine) {
+            return { Random<T>::value(engine), Random<T>::value(engine) };
+        }
+    };
+
+    template <class T> hoNDArray<T> random_array(std::vector<size_t> dimensions, unsigned int seed) {
+        std::mt19937 engine(seed);
+        hoNDArray<T> array(dimensions);
+        for (auto& value : array) value = Random<T>::value(engine);
+        return array;
+    }
+}
+
+template <typename T> class hoNDArray_kernels_Test : public ::testing::Test {
+protected:
+    using REAL = realType_t<T>;
+
+    // Large enough to be split across threads, and not a multiple of the chunk size.
+    std::vector<size_t> dims{ 263, 257, 3 };
+    std::vector<size_t> dims2{ 263, 257 };
+
+    hoNDArray<T> a     = random_array<T>(dims, 1);
+    hoNDArray<T> b     = random_array<T>(dims, 2);
+    hoNDArray<T> small = random_array<T>(dims2, 3);
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> Implementations;
+
+TYPED_TEST_CASE(hoNDArray_kernels_Test, Implementations);
+
+TYPED_TEST(hoNDArray_kernels_Test, multiply) {
+    hoNDArray<TypeParam> result;
+    multiply(this->a, this->b, result);
+    for (size_t i = 0; i < result.size(); i++)
+        ASSERT_NEAR(0, std::abs(result[i] - this->a[i] * this->b[i]), 1e-6) << "at element " << i;
+}
+
+TYPED_TEST(hoNDArray_kernels_Test, multiply_conj_broadcast) {
+    hoNDArray<TypeParam> result;
+    multiplyConj(this->a, this->small, result);
+    for (size_t i = 0; i < result.size(); i++) {
+        auto expected = this->a[i] * std::conj(this->small[i % this->small.size()]);
+        ASSERT_NEAR(0, std::abs(result[i] - expected), 1e-6) << "at element " << i;
+    }
+}
+
+TYPED_TEST(hoNDArray_kernels_Test, conjugate_and_abs) {
+    auto magnitudes = abs(this->a);
+    for (size_t i = 0; i < this->a.size(); i++)
+        ASSERT_NEAR(std::abs(this->a[i]), magnitudes[i], 1e-6) << "at element " << i;
+
+    if constexpr (!std::is_arithmetic<TypeParam>::value) {
+        hoNDArray<TypeParam> conjugated;
+        conjugate(this->a, conjugated);
+        for (size_t i = 0; i < this->a.size(); i++)
+            ASSERT_EQ(std::conj(this->a[i]), conjugated[i]) << "at element " << i;
+    }
+}
+
+TYPED_TEST(hoNDArray_kernels_Test, max_and_min_absolute) {
+    // Plant the extremes in different chunks, twice each; the first occurrence must be reported.
+    this->a[70000] = this->a[150000] = TypeParam(5);
+    this->a[90000] = this->a[170000] = TypeParam(0);
+
+    TypeParam value;
+    size_t index;
+    maxAbsolute(this->a, value, index);
+    EXPECT_EQ(70000, index);
+    EXPECT_EQ(TypeParam(5), value);
+
+    minAbsolute(this->a, value, index);
+    EXPECT_EQ(90000, index);
+    EXPECT_EQ(TypeParam(0), value);
+}
+
+TYPED_TEST(hoNDArray_kernels_Test, blas_reductions) {
+    using REAL = typename TestFixture::REAL;
+    double abs_sum = 0, squares = 0;
+    std::complex<double> inner = 0;
+    for (size_t i = 0; i < this->a.size(); i++) {
+        abs_sum += std::abs(std::real(this->a[i])) + std::abs(std::imag(this->a[i]));
+        squares += std::norm(this->a[i]);
+        inner += std::complex<double>(std::conj(this->a[i])) * std::complex<double>(this->b[i]);
+    }
+
+    REAL tolerance = std::is_same<REAL, float>::value ? 1e-4 : 1e-10;
+    EXPECT_NEAR(1, asum(this->a) / abs_sum, tolerance);
+    EXPECT_NEAR(1, nrm2(this->a) / std::sqrt(squares), tolerance);
+    EXPECT_NEAR(0, std::abs(std::complex<double>(dot(this->a, this->b, true)) - inner) / std::abs(inner), tolerance);
+}
+
+template <class T> class hoNDArray_kernels_unmix_Test : public ::testing::Test {};
+
+typedef Types<std::complex<float>, std::complex<double>> ComplexImplementations;
+
+TYPED_TEST_CASE(hoNDArray_kernels_unmix_Test, ComplexImplementations);
+
+TYPED_TEST(hoNDArray_kernels_unmix_Test, matches_scalar_loop) {
+    using T = TypeParam;
+    // A pixel count that is not a multiple of the block size, and a stride larger than the pixel count.
+    const size_t coils = 13, pixels = 700, stride = 731;
+
+    auto weights = random_array<T>({ stride, coils }, 4);
+    auto data    = random_array<T>({ stride, coils }, 5);
+    hoNDArray<T> result(pixels);
+
+    Kernels::unmix(weights.data(), data.data(), result.data(), coils, pixels, stride);
+
+    for (size_t p = 0; p < pixels; p++) {
+        std::complex<double> expected = 0;
+        for (size_t c = 0; c < coils; c++)
+            expected += std::complex<double>(weights[c * stride + p]) * std::complex<double>(data[c * stride + p]);
+        EXPECT_NEAR(0, std::abs(std::complex<double>(result[p]) - expected), 1e-4) << "pixel " << p;
+    }
+}
+
+template <class T> class hoNDArray_kernels_squared_difference_Test : public ::testing::Test {};
+
+typedef Types<float, std::complex<float>> SinglePrecisionImplementations;
+
+TYPED_TEST_CASE(hoNDArray_kernels_squared_difference_Test, SinglePrecisionImplementations);
+
+TYPED_TEST(hoNDArray_kernels_squared_difference_Test, accumulates) {
+    using T = TypeParam;
+    const size_t n = 263;
+
+    auto x = random_array<T>({ n }, 6);
+    auto y = random_array<T>({ n }, 7);
+    auto r = random_array<float>({ n }, 8);
+    auto expected = r;
+
+    Kernels::add_squared_difference(x.data(), y.data(), r.data(), n);
+
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(expected[i] + std::norm(x[i] - y[i]), r[i], 1e-5) << "element " << i;
+}
+
+TEST(hoNDArray_kernels, instruction_set) {
+    auto set = Kernels::instruction_set();
+    EXPECT_TRUE(set == "avx512f" || set == "avx2" || set == "default");
+}
@@ -2,6 +2,7 @@
 #include "hoNDArray_math.h"
 #include "complext.h"
 #include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
 #include <boost/random.hpp>
 #include <random>
 
@@ -168,3 +169,81 @@ TEST(FFTshiftTest, shift3d_random){
 }
 
 
+
+TEST(FFTPlanCacheTest, reuse){
+    auto fft = hoNDFFT<float>::instance();
+    fft->clear_plan_cache();
+    EXPECT_EQ(fft->plan_cache_size(),0);
+
+    auto array = make_random_array(32,16,4);
+    fft->fft2(array);
+    EXPECT_EQ(fft->plan_cache_size(),1);
+
+    auto array2 = make_random_array(32,16,4);
+    fft->fft2(array2);
+    EXPECT_EQ(fft->plan_cache_size(),1);
+
+    fft->ifft2(array2);
+    EXPECT_EQ(fft->plan_cache_size(),2);
+}
+
+TEST(FFTPlanCacheTest, drops_least_recently_used){
+    auto fft = hoNDFFT<float>::instance();
+    auto max_plans = fft->max_cached_plans();
+    fft->clear_plan_cache();
+    fft->set_max_cached_plans(2);
+
+    auto small = make_random_array(16,8,2);
+    auto medium = make_random_array(32,8,2);
+    auto large = make_random_array(64,8,2);
+    fft->fft2(small);
+    fft->fft2(medium);
+    fft->fft2(small);
+    fft->fft2(large);
+    EXPECT_EQ(fft->plan_cache_size(),2);
+
+    fft->fft2(small);
+    EXPECT_EQ(fft->plan_cache_size(),2);
+    fft->fft2(medium);
+    EXPECT_EQ(fft->plan_cache_size(),2);
+
+    fft->set_max_cached_plans(max_plans);
+    fft->clear_plan_cache();
+}
+
+TEST(FFTPlanCacheTest, saves_wisdom_when_measuring){
+    auto fft = hoNDFFT<float>::instance();
+    auto wisdom = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("fftwf_%%%%-%%%%.wisdom");
+    fft->set_wisdom_file(wisdom.string());
+
+    auto array = make_random_array(40,12,2);
+    fft->set_planning_rigor(FFTPlanningRigor::Estimate);
+    fft->fft2(array);
+    EXPECT_FALSE(boost::filesystem::exists(wisdom));
+
+    fft->set_planning_rigor(FFTPlanningRigor::Measure);
+    fft->fft2(array);
+    EXPECT_TRUE(boost::filesystem::exists(wisdom));
+    EXPECT_TRUE(fft->import_wisdom(wisdom.string()));
+
+    fft->set_wisdom_file("");
+    fft->set_planning_rigor(FFTPlanningRigor::Estimate);
+    boost::filesystem::remove(wisdom);
+}
+
+TEST(FFTPlanCacheTest, measure_matches_estimate){
+    auto fft = hoNDFFT<float>::instance();
+    const auto array = make_random_array(48,20,3);
+
+    fft->set_planning_rigor(FFTPlanningRigor::Estimate);
+    hoNDArray<std::complex<float>> estimated;
+    fft->fft2c(array,estimated);
+
+    fft->set_planning_rigor(FFTPlanningRigor::Measure);
+    hoNDArray<std::complex<float>> measured;
+    fft->fft2c(array,measured);
+    fft->set_planning_rigor(FFTPlanningRigor::Estimate);
+
+    for (size_t i = 0; i < array.size(); i++)
+        EXPECT_NEAR(std::abs(estimated[i]-measured[i]),0.0f,1e-4f);
+}
@@ -0,0 +1,88 @@
+#include "hoNDImage.h"
+#include "hoNDInterpolator.h"
+#include "hoNDBoundaryHandler.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename ImageType> class hoNDInterpolator_Test : public ::testing::Test {
+protected:
+    using T = typename ImageType::value_type;
+    using coord_type = typename ImageType::coord_type;
+    static constexpr unsigned int D = ImageType::NDIM;
+
+    void SetUp() override {
+        std::vector<size_t> dims(D, 17);
+        dims[0] = 19;
+        image.create(dims);
+
+        std::mt19937 engine(11);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        for (size_t i = 0; i < image.get_number_of_elements(); i++) image(i) = T(distribution(engine));
+
+        // Points inside the image, on its edges and well outside of it.
+        points.resize(1000 * D);
+        std::uniform_real_distribution<double> position(-3.0, 21.0);
+        for (auto& x : points) x = coord_type(position(engine));
+        for (unsigned int d = 0; d < D; d++) {
+            points[d] = 0;
+            points[D + d] = coord_type(image.get_size(d) - 1);
+        }
+
+        handlers.emplace_back(new hoNDBoundaryHandlerFixedValue<ImageType>(image, T(2.5)));
+        handlers.emplace_back(new hoNDBoundaryHandlerBorderValue<ImageType>(image));
+        handlers.emplace_back(new hoNDBoundaryHandlerPeriodic<ImageType>(image));
+        handlers.emplace_back(new hoNDBoundaryHandlerMirror<ImageType>(image));
+    }
+
+    // The batch interface must give what the interpolator gives point by point.
+    void compare(hoNDInterpolator<ImageType>& interp) {
+        size_t n = points.size() / D;
+        std::vector<T> values(n);
+        interp.interpolate(points.data(), n, values.data());
+
+        for (size_t i = 0; i < n; i++) {
+            const coord_type* x = &points[i * D];
+            T expected = (D == 2) ? interp(x[0], x[1]) : interp(x[0], x[1], x[2]);
+            EXPECT_NEAR(expected, values[i], 1e-4) << "point " << i;
+        }
+    }
+
+    ImageType image;
+    std::vector<coord_type> points;
+    std::vector<std::unique_ptr<hoNDBoundaryHandler<ImageType>>> handlers;
+};
+
+typedef Types<hoNDImage<float, 2>, hoNDImage<float, 3>, hoNDImage<double, 2>, hoNDImage<double, 3>> Implementations;
+
+TYPED_TEST_CASE(hoNDInterpolator_Test, Implementations);
+
+TYPED_TEST(hoNDInterpolator_Test, linear_batch) {
+    for (auto& handler : this->handlers) {
+        hoNDInterpolatorLinear<TypeParam> interp(this->image, *handler);
+        this->compare(interp);
+    }
+}
+
+TYPED_TEST(hoNDInterpolator_Test, bspline_batch) {
+    for (auto& handler : this->handlers) {
+        hoNDInterpolatorBSpline<TypeParam, TypeParam::NDIM> interp(this->image, *handler, 3);
+        this->compare(interp);
+    }
+}
+
+// The array may be given new storage after the interpolator was set up; the batch interface must read the new data.
+TYPED_TEST(hoNDInterpolator_Test, linear_batch_after_reallocation) {
+    using T = typename TypeParam::value_type;
+    hoNDInterpolatorLinear<TypeParam> interp(this->image, *this->handlers[1]);
+
+    hoNDArray<T> replacement(this->image.dimensions());
+    for (size_t i = 0; i < replacement.get_number_of_elements(); i++) replacement(i) = T(i % 7);
+    static_cast<hoNDArray<T>&>(this->image) = std::move(replacement);
+
+    this->compare(interp);
+}
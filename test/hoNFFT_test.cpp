@@ -3,6 +3,7 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNFFT.h"
+#include "hoNFFT_sparseMatrix.h"
 #include "vector_td_utilities.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
@@ -136,3 +137,38 @@ TYPED_TEST(hoNFFT_2D_NC2C_BACKWARDS, randomTestOne)
 
     EXPECT_LE(v/norm_ref, 0.00001);
 }
+
+TEST(hoNFFT_sparseMatrix, transposeIsExact)
+{
+    hoNDArray<vector_td<float, 2>> traj(1000);
+    for (size_t i = 0; i < traj.get_number_of_elements(); i++)
+    {
+        traj[i][0] = float((i * 7919) % 640) / 10;
+        traj[i][1] = float((i * 104729) % 640) / 10;
+    }
+
+    vector_td<size_t, 2> dims(64, 64);
+    auto matrix = NFFT_internal::make_NFFT_matrix(traj, dims, 5.5f, vector_td<float, 2>(10.0f, 10.0f));
+    auto transposed = NFFT_internal::transpose(matrix);
+
+    ASSERT_EQ(matrix.n_cols, transposed.n_rows);
+    ASSERT_EQ(matrix.n_rows, transposed.n_cols);
+    ASSERT_EQ(matrix.non_zeros(), transposed.non_zeros());
+
+    // Every entry of the transpose must appear in the original matrix, and each column must be sorted.
+    for (size_t row = 0; row < transposed.n_cols; row++)
+    {
+        for (size_t n = transposed.offsets[row]; n < transposed.offsets[row + 1]; n++)
+        {
+            if (n > transposed.offsets[row]) EXPECT_LT(transposed.indices[n - 1], transposed.indices[n]);
+
+            size_t col = transposed.indices[n];
+            bool found = false;
+            for (size_t m = matrix.offsets[col]; m < matrix.offsets[col + 1]; m++)
+            {
+                if (matrix.indices[m] == row && matrix.weights[m] == transposed.weights[n]) found = true;
+            }
+            EXPECT_TRUE(found);
+        }
+    }
+}
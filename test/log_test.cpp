@@ -0,0 +1,68 @@
+#include "log.h"
+
+#include <gtest/gtest.h>
+#include <functional>
+
+using namespace Gadgetron;
+
+namespace {
+    std::string capture(std::function<void()> f) {
+        auto logger = GadgetronLogger::instance();
+        logger->flush();
+
+        testing::internal::CaptureStdout();
+        f();
+        logger->flush();
+        return testing::internal::GetCapturedStdout();
+    }
+
+    int counted(int& count) { return ++count; }
+}
+
+class GadgetronLogger_Test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto logger = GadgetronLogger::instance();
+        logger->enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+        logger->disableAllOutputOptions();
+    }
+
+    void TearDown() override {
+        auto logger = GadgetronLogger::instance();
+        logger->enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+        logger->enableOutputOption(GADGETRON_LOG_PRINT_FILELOC);
+        logger->enableOutputOption(GADGETRON_LOG_PRINT_LEVEL);
+        logger->enableOutputOption(GADGETRON_LOG_PRINT_DATETIME);
+    }
+};
+
+TEST_F(GadgetronLogger_Test, messages_in_order) {
+    auto output = capture([]() {
+        for (int i = 0; i < 3; i++) GDEBUG("message %d\n", i);
+        GDEBUG_STREAM("stream " << 3);
+    });
+
+    EXPECT_EQ(output, "message 0\nmessage 1\nmessage 2\nstream 3\n");
+}
+
+TEST_F(GadgetronLogger_Test, fields) {
+    auto output = capture([]() {
+        GINFO_FIELDS("Pushed message", "peer", "host:9002", "index", 12, "note", "two words", "quoted", "a\"b");
+    });
+
+    EXPECT_EQ(output, "Pushed message peer=host:9002 index=12 note=\"two words\" quoted=\"a\\\"b\"\n");
+}
+
+TEST_F(GadgetronLogger_Test, disabled_level_not_formatted) {
+    GadgetronLogger::instance()->disableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+
+    int count = 0;
+    auto output = capture([&]() {
+        GDEBUG("%d\n", counted(count));
+        GDEBUG_STREAM(counted(count));
+        GDEBUG_FIELDS("count", "value", counted(count));
+    });
+
+    EXPECT_EQ(count, 0);
+    EXPECT_EQ(output, "");
+}
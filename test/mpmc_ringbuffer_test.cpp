@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "MPMCRingBuffer.h"
+#include "Channel.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace Gadgetron::Core;
+
+TEST(MPMCRingBufferTest, fifo) {
+    MPMCRingBuffer<int> buffer(8);
+    for (int i = 0; i < 8; i++) buffer.push(i);
+    for (int i = 0; i < 8; i++) EXPECT_EQ(buffer.pop(), i);
+    EXPECT_FALSE(buffer.try_pop());
+}
+
+TEST(MPMCRingBufferTest, capacity_is_power_of_two) {
+    MPMCRingBuffer<int> buffer(5);
+    EXPECT_EQ(buffer.capacity(), 8);
+}
+
+TEST(MPMCRingBufferTest, push_blocks_when_full) {
+    MPMCRingBuffer<std::unique_ptr<int>> buffer(2);
+    buffer.push(std::make_unique<int>(1));
+    buffer.push(std::make_unique<int>(2));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]() {
+        buffer.push(std::make_unique<int>(3));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    EXPECT_EQ(*buffer.pop(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed);
+
+    EXPECT_EQ(*buffer.pop(), 2);
+    EXPECT_EQ(*buffer.pop(), 3);
+}
+
+TEST(MPMCRingBufferTest, close_drains_then_throws) {
+    MPMCRingBuffer<int> buffer(4);
+    buffer.push(42);
+    buffer.close();
+
+    EXPECT_THROW(buffer.push(1), ChannelClosed);
+    EXPECT_EQ(buffer.pop(), 42);
+    EXPECT_THROW(buffer.pop(), ChannelClosed);
+}
+
+TEST(MPMCRingBufferTest, multiple_producers_and_consumers) {
+    for (auto policy : {WaitPolicy::Block, WaitPolicy::Spin}) {
+        MPMCRingBuffer<long> buffer(16, policy);
+        std::atomic<long> sum{0};
+
+        std::vector<std::thread> producers, consumers;
+        for (int i = 0; i < 4; i++) {
+            producers.emplace_back([&]() { for (long n = 1; n <= 10000; n++) buffer.push(n); });
+            consumers.emplace_back([&]() {
+                try { while (true) sum += buffer.pop(); } catch (const ChannelClosed &) {}
+            });
+        }
+
+        for (auto &thread : producers) thread.join();
+        buffer.close();
+        for (auto &thread : consumers) thread.join();
+
+        EXPECT_EQ(sum, 4 * (10000L * 10001L) / 2);
+    }
+}
+
+TEST(MPMCRingBufferTest, bounded_message_channel) {
+    auto channel = make_channel<BoundedMessageChannel>(4);
+
+    channel.output.push(std::string("test"), int(4));
+    auto message = channel.input.pop();
+
+    bool convertible = convertible_to<std::string, int>(message);
+    EXPECT_TRUE(convertible);
+}
@@ -0,0 +1,51 @@
+#include "non_local_bayes.h"
+#include "denoise_test.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+
+// The image size is not a multiple of the tile size.
+template <typename T> class non_local_bayes_test : public DenoiseTest<T> {
+protected:
+    void SetUp() override { this->make_series(70, 45, 3); }
+};
+
+TYPED_TEST_CASE(non_local_bayes_test, DenoiseImplementations);
+
+TYPED_TEST(non_local_bayes_test, reduces_noise) {
+    auto denoised = Denoise::non_local_bayes(this->noisy, 1.0f, 25u);
+
+    ASSERT_EQ(denoised.dimensions(), this->noisy.dimensions());
+    EXPECT_LT(rms_error(denoised, this->clean), 0.7 * rms_error(this->noisy, this->clean));
+}
+
+TYPED_TEST(non_local_bayes_test, real_time_settings_cover_every_pixel) {
+    Denoise::NonLocalBayesSettings settings;
+    settings.search_window  = 15;
+    settings.max_patches    = 30;
+    settings.reference_step = 5;
+    settings.tile_size      = 8;
+
+    auto denoised = Denoise::non_local_bayes(this->noisy, 1.0f, settings);
+
+    for (auto value : denoised) ASSERT_TRUE(std::isfinite(std::abs(value)));
+    EXPECT_LT(rms_error(denoised, this->clean), 0.8 * rms_error(this->noisy, this->clean));
+}
+
+TYPED_TEST(non_local_bayes_test, tiling_does_not_change_the_quality) {
+    Denoise::NonLocalBayesSettings settings;
+    settings.tile_size = 1000;
+    auto whole = Denoise::non_local_bayes(this->noisy, 1.0f, settings);
+
+    // Reference patches skipped after being denoised with another one depend on the tiles; the quality should not.
+    settings.tile_size = 16;
+    auto tiled = Denoise::non_local_bayes(this->noisy, 1.0f, settings);
+
+    EXPECT_NEAR(rms_error(whole, this->clean), rms_error(tiled, this->clean), 0.05);
+}
+
+TEST(non_local_bayes, rejects_reference_step_beyond_patch_size) {
+    Denoise::NonLocalBayesSettings settings;
+    settings.reference_step = settings.patch_size + 1;
+    expect_invalid_settings([&](const auto& image) { return Denoise::non_local_bayes(image, 1.0f, settings); });
+}
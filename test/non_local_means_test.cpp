@@ -0,0 +1,49 @@
+#include "non_local_means.h"
+#include "denoise_test.h"
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+
+template <typename T> class non_local_means_test : public DenoiseTest<T> {
+protected:
+    void SetUp() override { this->make_series(50, 37, 5); }
+};
+
+TYPED_TEST_CASE(non_local_means_test, DenoiseImplementations);
+
+TYPED_TEST(non_local_means_test, matches_direct_patch_comparison) {
+    hoNDArray<TypeParam> frame(50, 37);
+    std::copy(this->noisy.begin(), this->noisy.begin() + frame.get_number_of_elements(), frame.begin());
+
+    auto denoised = Denoise::non_local_means(frame, 1.0f, 6u);
+    auto expected = original::non_local_means(frame, 1.0f, 6);
+
+    ASSERT_EQ(denoised.dimensions(), frame.dimensions());
+    for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+        ASSERT_NEAR(std::abs(denoised[i] - expected[i]), 0.0, 1e-3) << "at pixel " << i;
+}
+
+TYPED_TEST(non_local_means_test, reduces_noise) {
+    auto denoised = Denoise::non_local_means(this->noisy, 1.0f, 10u);
+
+    ASSERT_EQ(denoised.dimensions(), this->noisy.dimensions());
+    EXPECT_LT(rms_error(denoised, this->clean), 0.7 * rms_error(this->noisy, this->clean));
+}
+
+TYPED_TEST(non_local_means_test, neighbouring_frames_reduce_noise_further) {
+    Denoise::NonLocalMeansSettings settings;
+    settings.search_radius = 5;
+    auto spatial = Denoise::non_local_means(this->noisy, 1.0f, settings);
+
+    settings.temporal_radius = 2;
+    auto temporal = Denoise::non_local_means(this->noisy, 1.0f, settings);
+
+    ASSERT_EQ(temporal.dimensions(), this->noisy.dimensions());
+    EXPECT_LT(rms_error(temporal, this->clean), rms_error(spatial, this->clean));
+}
+
+TEST(non_local_means, rejects_even_patch_size) {
+    Denoise::NonLocalMeansSettings settings;
+    settings.patch_size = 4;
+    expect_invalid_settings([&](const auto& image) { return Denoise::non_local_means(image, 1.0f, settings); });
+}
@@ -0,0 +1,101 @@
+//
+// Times the vectorized, threaded element-wise functions and reductions on hoNDArrays against plain scalar loops,
+// for a range of array sizes around the threading threshold.
+//
+
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_reductions.h"
+#include "hoNDArray_kernels.h"
+
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace Gadgetron;
+
+template<class F>
+static double time_ms(F f, int repetitions) {
+    f();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; i++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static hoNDArray<std::complex<float>> random_array(size_t elements, unsigned int seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    hoNDArray<std::complex<float>> array(elements);
+    for (auto& value : array) value = { distribution(engine), distribution(engine) };
+    return array;
+}
+
+static void report(const std::string& name, size_t elements, double scalar_ms, double kernel_ms) {
+    std::cout << std::setw(16) << name << std::setw(12) << elements << std::setw(14) << scalar_ms
+              << std::setw(14) << kernel_ms << std::setw(10) << scalar_ms / kernel_ms << "x" << std::endl;
+}
+
+static void run(size_t elements) {
+    using T = std::complex<float>;
+    auto x = random_array(elements, 1);
+    auto y = random_array(elements, 2);
+    hoNDArray<T> r(elements);
+    hoNDArray<float> m(elements);
+    int repetitions = std::max<int>(5, int((size_t(1) << 26) / elements));
+
+    volatile float sink = 0;
+
+    report("multiply", elements,
+        time_ms([&]() { for (size_t i = 0; i < elements; i++) r[i] = x[i] * y[i]; }, repetitions),
+        time_ms([&]() { multiply(x, y, r); }, repetitions));
+
+    report("multiplyConj", elements,
+        time_ms([&]() { for (size_t i = 0; i < elements; i++) r[i] = x[i] * std::conj(y[i]); }, repetitions),
+        time_ms([&]() { multiplyConj(x, y, r); }, repetitions));
+
+    report("abs", elements,
+        time_ms([&]() { for (size_t i = 0; i < elements; i++) m[i] = std::abs(x[i]); }, repetitions),
+        time_ms([&]() { Gadgetron::abs(x, m); }, repetitions));
+
+    report("maxAbsolute", elements,
+        time_ms([&]() {
+            size_t ind = 0;
+            float v    = std::abs(x[0]);
+            for (size_t i = 1; i < elements; i++) {
+                float v2 = std::abs(x[i]);
+                if (v2 > v) { v = v2; ind = i; }
+            }
+            sink = sink + ind;
+        }, repetitions),
+        time_ms([&]() {
+            T value;
+            size_t ind;
+            maxAbsolute(x, value, ind);
+            sink = sink + ind;
+        }, repetitions));
+
+    report("asum", elements,
+        time_ms([&]() { sink = sink + BLAS::asum(elements, x.data(), 1); }, repetitions),
+        time_ms([&]() { sink = sink + asum(x); }, repetitions));
+
+    report("nrm2", elements,
+        time_ms([&]() { sink = sink + BLAS::nrm2(elements, x.data(), 1); }, repetitions),
+        time_ms([&]() { sink = sink + nrm2(x); }, repetitions));
+
+    report("dot", elements,
+        time_ms([&]() { sink = sink + std::abs(BLAS::dotc(elements, x.data(), 1, y.data(), 1)); }, repetitions),
+        time_ms([&]() { sink = sink + std::abs(dot(x, y, true)); }, repetitions));
+}
+
+int main() {
+    std::cout << "Kernels running with: " << Kernels::instruction_set() << std::endl;
+    std::cout << std::setw(16) << "operation" << std::setw(12) << "elements" << std::setw(14) << "scalar [ms]"
+              << std::setw(14) << "kernel [ms]" << std::setw(11) << "speedup" << std::endl;
+
+    for (size_t elements : { size_t(1) << 12, size_t(1) << 16, size_t(1) << 20, size_t(1) << 24 }) {
+        run(elements);
+    }
+    return 0;
+}
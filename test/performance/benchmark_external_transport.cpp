@@ -0,0 +1,109 @@
+//
+// Round trip latency and throughput of the transports to external modules: the plain socket, and the socket
+// carrying descriptors of data in shared memory. A peer thread echoes every message back, as a module would
+// send back an image of the same size.
+//
+
+#include "../../apps/gadgetron/connection/SharedMemoryStream.h"
+#include "../../apps/gadgetron/connection/SocketStreamBuf.h"
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron::Connection;
+using tcp = boost::asio::ip::tcp;
+
+template<class F>
+static double time_ms(F f, int repetitions) {
+    f();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; i++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static void echo(std::iostream& stream) {
+    std::vector<char> data;
+    uint64_t size;
+    while (stream.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+        if (size == 0) return;
+        data.resize(size);
+        stream.read(data.data(), size);
+        stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        stream.write(data.data(), size);
+    }
+}
+
+static void run(bool shared_memory, const std::vector<size_t>& sizes) {
+    boost::asio::io_service ios;
+    tcp::acceptor acceptor(ios, tcp::endpoint(tcp::v6(), 0));
+    auto port = acceptor.local_endpoint().port();
+
+    auto accepted = std::async(std::launch::async, [&]() {
+        auto socket = std::make_unique<tcp::socket>(ios);
+        acceptor.accept(*socket);
+        return socket;
+    });
+
+    auto client_socket = std::make_unique<tcp::socket>(ios);
+    client_socket->connect(tcp::endpoint(boost::asio::ip::address_v6::loopback(), port));
+    auto server_socket = accepted.get();
+
+    // As External does; descriptors are small writes, which Nagle's algorithm would hold back.
+    client_socket->set_option(tcp::no_delay(true));
+    server_socket->set_option(tcp::no_delay(true));
+
+    std::unique_ptr<std::iostream> client = stream_from_socket(std::move(client_socket));
+    std::unique_ptr<std::iostream> server = stream_from_socket(std::move(server_socket));
+
+    if (shared_memory) {
+        auto segment = SharedMemorySegment::create();
+        auto client_stream = std::make_unique<SharedMemoryStream>(std::move(client), SharedMemorySegment::open(segment->name()));
+        auto server_stream = std::make_unique<SharedMemoryStream>(std::move(server), segment);
+        for (auto stream : { client_stream.get(), server_stream.get() }) {
+            stream->frame_input();
+            stream->frame_output();
+        }
+        client = std::move(client_stream);
+        server = std::move(server_stream);
+    }
+
+    auto peer = std::thread([&]() { echo(*client); });
+
+    for (auto size : sizes) {
+        std::vector<char> data(size, 1), result(size);
+        auto round_trip = [&]() {
+            uint64_t length = size;
+            server->write(reinterpret_cast<const char*>(&length), sizeof(length));
+            server->write(data.data(), size);
+            server->read(reinterpret_cast<char*>(&length), sizeof(length));
+            server->read(result.data(), size);
+        };
+
+        int repetitions = int(std::min<size_t>(200, std::max<size_t>(10, (size_t(1) << 30) / size / 4)));
+        double ms = time_ms(round_trip, repetitions);
+        std::cout << std::setw(8) << (shared_memory ? "shm" : "tcp") << std::setw(12) << size / 1024
+                  << std::setw(14) << std::setprecision(4) << 1000 * ms
+                  << std::setw(14) << std::setprecision(4) << 2 * size / ms / 1e6 << std::endl;
+    }
+
+    uint64_t end = 0;
+    server->write(reinterpret_cast<const char*>(&end), sizeof(end));
+    peer.join();
+}
+
+int main() {
+    const std::vector<size_t> sizes{ 1 << 10, 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20, 64 << 20 };
+
+    std::cout << std::setw(8) << "mode" << std::setw(12) << "size [KiB]" << std::setw(14) << "round trip [us]"
+              << std::setw(14) << "GB/s" << std::endl;
+    run(false, sizes);
+    run(true, sizes);
+    return 0;
+}
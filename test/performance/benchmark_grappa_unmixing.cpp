@@ -0,0 +1,82 @@
+//
+// Latency of GRAPPA image domain unmixing, comparing the original scalar loop with the blocked kernel
+// that Grappa::Unmixing and grappa2d_image_domain_unwrapping_aliased_image share.
+//
+
+#include "hoNDArray.h"
+#include "hoNDArray_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace Gadgetron;
+
+template<class F>
+static double time_ms(F f, int repetitions) {
+    f();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; i++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static hoNDArray<std::complex<float>> random_array(std::vector<size_t> dimensions, unsigned int seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    hoNDArray<std::complex<float>> array(dimensions);
+    for (auto& value : array) value = { distribution(engine), distribution(engine) };
+    return array;
+}
+
+static void run(size_t coils, size_t sets) {
+    const size_t RO = 192, E1 = 192, pixels = RO * E1;
+
+    auto weights = random_array({ RO, E1, coils, sets }, 1);
+    auto image   = random_array({ RO, E1, coils }, 2);
+    hoNDArray<std::complex<float>> unmixed(RO, E1, sets);
+
+    auto scalar = [&]() {
+        std::fill(unmixed.begin(), unmixed.end(), std::complex<float>(0));
+        for (size_t s = 0; s < sets; s++)
+            for (size_t p = 0; p < pixels; p++)
+                for (size_t c = 0; c < coils; c++)
+                    unmixed[s * pixels + p] += weights[s * pixels * coils + c * pixels + p] * image[c * pixels + p];
+    };
+
+    // Same task split as Grappa::Unmixing.
+    auto kernel = [&]() {
+        const size_t block = 4096;
+        const long long blocks = (pixels + block - 1) / block;
+        const long long tasks = sets * blocks;
+
+#pragma omp parallel for schedule(static)
+        for (long long task = 0; task < tasks; task++) {
+            size_t s = task / blocks;
+            size_t start = (task % blocks) * block;
+            Kernels::unmix(weights.begin() + s * pixels * coils + start, image.begin() + start,
+                unmixed.begin() + s * pixels + start, coils, std::min(block, pixels - start), pixels);
+        }
+    };
+
+    double scalar_ms = time_ms(scalar, 5);
+    double kernel_ms = time_ms(kernel, 20);
+    std::cout << std::setw(8) << coils << std::setw(8) << sets << std::setw(14) << scalar_ms << std::setw(14)
+              << kernel_ms << std::setw(10) << scalar_ms / kernel_ms << "x" << std::endl;
+}
+
+int main() {
+    std::cout << "Kernels running with: " << Kernels::instruction_set() << std::endl;
+    std::cout << std::setw(8) << "coils" << std::setw(8) << "sets" << std::setw(14) << "scalar [ms]" << std::setw(14)
+              << "kernel [ms]" << std::setw(11) << "speedup" << std::endl;
+
+    for (size_t coils : { 32, 64, 128 }) {
+        for (size_t sets : { 1, 2 }) {
+            run(coils, sets);
+        }
+    }
+    return 0;
+}
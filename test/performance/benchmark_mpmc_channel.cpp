@@ -0,0 +1,70 @@
+//
+// Compares the list based MPMCChannel against the bounded MPMCRingBuffer.
+//
+
+#include "MPMCChannel.h"
+#include "MPMCRingBuffer.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron::Core;
+
+static constexpr size_t MESSAGES_PER_PRODUCER = 1000000;
+
+template<class QUEUE>
+void time_queue(const std::string &name, QUEUE &queue, size_t producers, size_t consumers) {
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> producer_threads;
+    for (size_t i = 0; i < producers; i++) {
+        producer_threads.emplace_back([&]() {
+            for (size_t n = 0; n < MESSAGES_PER_PRODUCER; n++) queue.push(std::make_unique<size_t>(n));
+        });
+    }
+
+    std::vector<std::thread> consumer_threads;
+    std::vector<size_t> received(consumers, 0);
+    for (size_t i = 0; i < consumers; i++) {
+        consumer_threads.emplace_back([&, i]() {
+            try {
+                while (true) {
+                    queue.pop();
+                    received[i]++;
+                }
+            } catch (const ChannelClosed &) {}
+        });
+    }
+
+    for (auto &thread : producer_threads) thread.join();
+    queue.close();
+    for (auto &thread : consumer_threads) thread.join();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << name << " " << producers << "P/" << consumers << "C took " << ms << " ms ("
+              << (producers * MESSAGES_PER_PRODUCER) / std::max<decltype(ms)>(ms, 1) << " messages/ms)" << std::endl;
+}
+
+int main() {
+
+    for (auto threads : {std::make_pair(1, 1), std::make_pair(4, 1), std::make_pair(1, 4), std::make_pair(4, 4)}) {
+        {
+            MPMCChannel<std::unique_ptr<size_t>> channel;
+            time_queue("MPMCChannel", channel, threads.first, threads.second);
+        }
+        for (auto capacity : {16, 256, 4096}) {
+            MPMCRingBuffer<std::unique_ptr<size_t>> ring(capacity);
+            time_queue("MPMCRingBuffer(" + std::to_string(capacity) + ", block)", ring, threads.first, threads.second);
+        }
+        {
+            MPMCRingBuffer<std::unique_ptr<size_t>> ring(256, WaitPolicy::Spin);
+            time_queue("MPMCRingBuffer(256, spin)", ring, threads.first, threads.second);
+        }
+    }
+}
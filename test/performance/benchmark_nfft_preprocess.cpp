@@ -0,0 +1,89 @@
+//
+// Times hoNFFT preprocessing and convolution on a 2D spiral and a 3D radial trajectory, and reports the memory
+// taken by the convolution matrices.
+//
+
+#include "hoNFFT.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNFFT_sparseMatrix.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace Gadgetron;
+
+template<class F>
+static double time_ms(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static hoNDArray<vector_td<float, 2>> spiral_trajectory(size_t samples, size_t interleaves) {
+    hoNDArray<vector_td<float, 2>> traj(samples, interleaves);
+    for (size_t i = 0; i < interleaves; i++) {
+        for (size_t n = 0; n < samples; n++) {
+            float r = 0.5f * float(n) / samples;
+            float theta = 32 * M_PI * float(n) / samples + 2 * M_PI * i / interleaves;
+            traj(n, i) = vector_td<float, 2>(r * std::cos(theta), r * std::sin(theta));
+        }
+    }
+    return traj;
+}
+
+static hoNDArray<vector_td<float, 3>> radial_trajectory(size_t samples, size_t spokes) {
+    hoNDArray<vector_td<float, 3>> traj(samples, spokes);
+    const float golden = M_PI * (3 - std::sqrt(5.0f));
+    for (size_t s = 0; s < spokes; s++) {
+        float z = 1 - 2 * (s + 0.5f) / spokes;
+        float radius = std::sqrt(1 - z * z);
+        vector_td<float, 3> direction(radius * std::cos(golden * s), radius * std::sin(golden * s), z);
+        for (size_t n = 0; n < samples; n++) {
+            float r = float(n) / samples - 0.5f;
+            traj(n, s) = direction * r;
+        }
+    }
+    return traj;
+}
+
+template<unsigned int D>
+static void run(const std::string &name, const hoNDArray<vector_td<float, D>> &traj, size_t matrix_size) {
+
+    vector_td<size_t, D> dims(matrix_size);
+    hoNFFT_plan<float, D> plan(dims, 1.5f, 5.5f);
+
+    auto preprocess_ms = time_ms([&]() { plan.preprocess(traj); });
+
+    hoNDArray<float_complext> image(to_std_vector(dims));
+    fill(&image, float_complext(1.0f));
+    hoNDArray<float_complext> data(traj.get_dimensions());
+
+    auto forward_ms = time_ms([&]() { plan.compute(image, data, nullptr, NFFT_comp_mode::FORWARDS_C2NC); });
+    auto backward_ms = time_ms([&]() { plan.compute(data, image, nullptr, NFFT_comp_mode::BACKWARDS_NC2C); });
+
+    // Same scaling as hoNFFT_plan::preprocess applies; the weights do not matter for the memory footprint.
+    vector_td<size_t, D> dims_os(size_t(matrix_size * 1.5f));
+    auto scaled = traj;
+    for (auto &point : scaled) point = (point + 0.5f) * vector_td<float, D>(dims_os);
+    auto matrix = NFFT_internal::make_NFFT_matrix(scaled, dims_os, 5.5f, vector_td<float, D>(1.0f));
+    auto transposed = NFFT_internal::transpose(matrix);
+
+    // The previous layout held a pair of std::vectors per column, with 64 bit indices.
+    auto nested_usage = [](const NFFT_internal::NFFT_Matrix<float> &m) {
+        return m.n_cols * 2 * sizeof(std::vector<float>) + m.non_zeros() * (sizeof(size_t) + sizeof(float));
+    };
+
+    std::cout << name << ": " << traj.get_number_of_elements() << " samples, preprocess " << preprocess_ms
+              << " ms, forward " << forward_ms << " ms, backward " << backward_ms << " ms" << std::endl;
+    std::cout << "    matrices use " << (matrix.memory_usage() + transposed.memory_usage()) / (1024 * 1024)
+              << " MiB, nested vectors would use " << (nested_usage(matrix) + nested_usage(transposed)) / (1024 * 1024)
+              << " MiB" << std::endl;
+}
+
+int main() {
+    run("2D spiral", spiral_trajectory(4096, 48), 256);
+    run("3D radial", radial_trajectory(256, 8192), 128);
+    return 0;
+}
@@ -0,0 +1,175 @@
+//
+// Time to denoise a cine series with non-local Bayes, comparing the original patch-by-patch implementation with the
+// tiled one, at default settings and at settings meant for real-time use. The error against the noise free series
+// shows what the faster settings cost in quality.
+//
+
+#include "hoNDArray.h"
+#include "hoArmadillo.h"
+#include "non_local_bayes.h"
+#include "../denoise_test_helpers.h"
+
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+using namespace Gadgetron;
+using Test::cine;
+using Test::rms_error;
+using Test::time_ms;
+
+namespace original {
+
+    // The implementation before tiling, reduced to a single image.
+    template<class T>
+    struct ImagePatch {
+        arma::Col<T> patch;
+        int center_x, center_y;
+    };
+
+    template<class T>
+    arma::Col<T> get_patch(const hoNDArray<T> &image, int x, int y, int patch_size) {
+        const int X = image.get_size(0), Y = image.get_size(1);
+        arma::Col<T> window(patch_size * patch_size);
+        for (int ky = 0; ky < patch_size; ky++)
+            for (int kx = 0; kx < patch_size; kx++)
+                window[kx + ky * patch_size] = image(((kx - patch_size / 2) + x + X) % X, ((ky - patch_size / 2) + y + Y) % Y);
+        return window;
+    }
+
+    template<class T>
+    void denoise_patches(std::vector<ImagePatch<T>> &patches, float noise_std) {
+        auto mean_patch = arma::Col<T>(patches.front().patch.size(), arma::fill::zeros);
+        for (auto &patch : patches) mean_patch += patch.patch;
+        mean_patch /= patches.size();
+
+        float std2 = 0;
+        for (auto &patch : patches) {
+            float std = arma::stddev(patch.patch);
+            std2 += std * std;
+        }
+        std2 *= patches.size() / float(patches.size() - 1);
+        if (std2 < noise_std * noise_std * 1.1) {
+            T mean_value = arma::mean(mean_patch);
+            for (auto &patch : patches) patch.patch.fill(mean_value);
+            return;
+        }
+
+        auto covariance_matrix = arma::Mat<T>(mean_patch.size(), mean_patch.size(), arma::fill::zeros);
+        for (auto &patch : patches) covariance_matrix += (patch.patch - mean_patch) * (patch.patch - mean_patch).t();
+        covariance_matrix /= patches.size() - 1;
+
+        arma::Mat<T> noise_covariance = covariance_matrix + noise_std * noise_std * arma::eye<arma::Mat<T>>(
+                arma::size(covariance_matrix));
+        auto inv_cov = arma::Mat<T>(arma::size(covariance_matrix));
+        if (inv(inv_cov, noise_covariance)) {
+            for (auto &patch : patches) patch.patch = mean_patch + inv_cov * covariance_matrix * (patch.patch - mean_patch);
+        }
+    }
+
+    template<class T>
+    hoNDArray<T> non_local_bayes(const hoNDArray<T> &image, float noise_std, int search_window) {
+        constexpr int patch_size = 5;
+        constexpr int n_patches = 50;
+        const int X = image.get_size(0), Y = image.get_size(1);
+
+        hoNDArray<T> result(image.dimensions());
+        result.fill(0);
+        hoNDArray<bool> mask(image.dimensions());
+        mask.fill(true);
+        hoNDArray<int> count(image.dimensions());
+        count.fill(0);
+
+        for (int ky = 0; ky < Y; ky++) {
+            for (int kx = 0; kx < X; kx++) {
+                if (!mask(kx, ky)) continue;
+
+                auto reference_patch = get_patch(image, kx, ky, patch_size);
+                std::vector<ImagePatch<T>> patches;
+                for (int dy = std::max(ky - search_window / 2, 0); dy < std::min(search_window / 2 + ky, Y); dy++)
+                    for (int dx = std::max(kx - search_window / 2, 0); dx < std::min(search_window / 2 + kx, X); dx++)
+                        patches.push_back(ImagePatch<T>{ get_patch(image, dx, dy, patch_size), dx, dy });
+
+                std::vector<float> distances(patches.size());
+                for (size_t i = 0; i < patches.size(); i++) {
+                    arma::Col<T> diff = patches[i].patch - reference_patch;
+                    float d = 0;
+                    for (auto v : diff) d += std::norm(v);
+                    distances[i] = d;
+                }
+                std::vector<size_t> indices(patches.size());
+                std::iota(indices.begin(), indices.end(), 0);
+                std::sort(indices.begin(), indices.end(), [&](auto a, auto b) { return distances[a] < distances[b]; });
+
+                std::vector<ImagePatch<T>> best(std::min<size_t>(patches.size(), n_patches));
+                for (size_t i = 0; i < best.size(); i++) best[i] = std::move(patches[indices[i]]);
+
+                denoise_patches(best, noise_std);
+
+                for (auto &patch : best) {
+                    for (int y = 0; y < patch_size; y++) {
+                        auto oy = (patch.center_y + y - patch_size / 2 + Y) % Y;
+                        for (int x = 0; x < patch_size; x++) {
+                            auto ox = (patch.center_x + x - patch_size / 2 + X) % X;
+                            result(ox, oy) += patch.patch[x + y * patch_size];
+                            count(ox, oy)++;
+                        }
+                    }
+                    mask(patch.center_x, patch.center_y) = false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < result.get_number_of_elements(); i++) result[i] /= count[i];
+        return result;
+    }
+
+    // Images in parallel, as the original did.
+    template<class T>
+    hoNDArray<T> non_local_bayes_series(const hoNDArray<T> &images, float noise_std, int search_window) {
+        std::vector<size_t> image_dims = { images.get_size(0), images.get_size(1) };
+        size_t image_elements = image_dims[0] * image_dims[1];
+        size_t n_images = images.get_number_of_elements() / image_elements;
+
+        hoNDArray<T> result(images.dimensions());
+#pragma omp parallel for
+        for (long long i = 0; i < (long long)n_images; i++) {
+            hoNDArray<T> view(image_dims, const_cast<T *>(images.get_data_ptr() + i * image_elements));
+            auto denoised = non_local_bayes(view, noise_std, search_window);
+            std::copy(denoised.begin(), denoised.end(), result.begin() + i * image_elements);
+        }
+        return result;
+    }
+}
+
+int main() {
+    const float noise_std = 1.0f;
+
+    Denoise::NonLocalBayesSettings real_time;
+    real_time.search_window = 15;
+    real_time.max_patches = 30;
+    real_time.reference_step = 3;
+
+    std::cout << std::setw(6) << "size" << std::setw(8) << "frames" << std::setw(15) << "original [ms]"
+              << std::setw(14) << "tiled [ms]" << std::setw(17) << "real-time [ms]" << std::setw(10) << "speedup"
+              << std::setw(30) << "rms error: noisy/orig/tiled/rt" << std::endl;
+
+    for (size_t size : { 128, 192 }) {
+        for (size_t frames : { 1, 10 }) {
+            hoNDArray<std::complex<float>> clean, noisy;
+            cine(size, frames, noise_std, clean, noisy);
+
+            hoNDArray<std::complex<float>> original_result, tiled_result, real_time_result;
+            double original_ms = time_ms([&]() { original_result = original::non_local_bayes_series(noisy, noise_std, 25); }, 1);
+            double tiled_ms = time_ms([&]() { tiled_result = Denoise::non_local_bayes(noisy, noise_std, 25u); }, 3);
+            double real_time_ms = time_ms([&]() { real_time_result = Denoise::non_local_bayes(noisy, noise_std, real_time); }, 3);
+
+            std::cout << std::setw(6) << size << std::setw(8) << frames << std::setw(15) << original_ms
+                      << std::setw(14) << tiled_ms << std::setw(17) << real_time_ms << std::setw(9)
+                      << std::setprecision(3) << original_ms / tiled_ms << "x" << std::setw(10)
+                      << rms_error(noisy, clean) << std::setw(7) << rms_error(original_result, clean)
+                      << std::setw(7) << rms_error(tiled_result, clean) << std::setw(7)
+                      << rms_error(real_time_result, clean) << std::endl;
+        }
+    }
+}
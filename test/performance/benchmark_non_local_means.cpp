@@ -0,0 +1,59 @@
+//
+// Time to denoise an image with non-local means at typical search radii, comparing the original implementation, which
+// compares every pair of patches on its own, with the integral image one. The last column times the temporal variant,
+// searching two frames on either side of every frame of a cine series.
+//
+
+#include "hoNDArray.h"
+#include "non_local_means.h"
+#include "../denoise_test_helpers.h"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+
+int main() {
+    const float noise_std = 1.0f;
+    const size_t frames = 10;
+
+    std::cout << std::setw(6) << "size" << std::setw(8) << "radius" << std::setw(15) << "original [ms]"
+              << std::setw(17) << "integral [ms]" << std::setw(10) << "speedup" << std::setw(12) << "max diff"
+              << std::setw(23) << "temporal [ms/frame]" << std::endl;
+
+    for (size_t size : { 128, 256 }) {
+        hoNDArray<std::complex<float>> clean, noisy;
+        cine(size, frames, noise_std, clean, noisy);
+        hoNDArray<std::complex<float>> frame(size, size);
+        std::copy(noisy.begin(), noisy.begin() + frame.get_number_of_elements(), frame.begin());
+
+        for (unsigned int radius : { 5, 10, 15 }) {
+            hoNDArray<std::complex<float>> original_result, integral_result, temporal_result;
+            double original_ms = time_ms([&]() { original_result = original::non_local_means(frame, noise_std, radius); }, 1);
+            double integral_ms = time_ms([&]() { integral_result = Denoise::non_local_means(frame, noise_std, radius); }, 3);
+
+            float max_difference = 0;
+            for (size_t i = 0; i < frame.get_number_of_elements(); i++)
+                max_difference = std::max(max_difference, std::abs(original_result[i] - integral_result[i]));
+
+            Denoise::NonLocalMeansSettings settings;
+            settings.search_radius = radius;
+            settings.temporal_radius = 2;
+            double temporal_ms = time_ms([&]() { temporal_result = Denoise::non_local_means(noisy, noise_std, settings); }, 1) / frames;
+
+            std::cout << std::setw(6) << size << std::setw(8) << radius << std::setw(15) << original_ms
+                      << std::setw(17) << integral_ms << std::setw(9) << std::setprecision(3)
+                      << original_ms / integral_ms << "x" << std::setw(12) << max_difference << std::setw(23)
+                      << temporal_ms << std::endl;
+        }
+
+        auto spatial = Denoise::non_local_means(noisy, noise_std, 5u);
+        Denoise::NonLocalMeansSettings settings;
+        settings.search_radius = 5;
+        settings.temporal_radius = 2;
+        auto temporal = Denoise::non_local_means(noisy, noise_std, settings);
+        std::cout << "rms error at radius 5, noisy/spatial/temporal: " << rms_error(noisy, clean) << " "
+                  << rms_error(spatial, clean) << " " << rms_error(temporal, clean) << std::endl;
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Measures the per-message overhead of a chain of cheap pure gadgets, with and without fusing.
+//
+
+#include "PureChain.h"
+#include "Types.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+namespace {
+    class ScaleImage : public PureGadget<Image<float>, Image<float>> {
+    public:
+        using PureGadget::PureGadget;
+        Image<float> process_function(Image<float> image) const override {
+            auto &data = std::get<hoNDArray<float>>(image);
+            data[0] *= 1.0001f;
+            return image;
+        }
+    };
+
+    static constexpr size_t MESSAGES = 200000;
+
+    double time_chain(size_t stages, bool fused) {
+        Context context;
+        GadgetProperties properties;
+
+        std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+        for (size_t i = 0; i < stages; i++) gadgets.push_back(std::make_unique<ScaleImage>(context, properties));
+        PureChain chain(std::move(gadgets), fused);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < MESSAGES; i++) {
+            auto message = Message(ISMRMRD::ImageHeader{}, hoNDArray<float>(8, 8));
+            chain.process_function(std::move(message));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / MESSAGES;
+    }
+}
+
+int main() {
+    for (auto stages : { 1, 4, 8, 16 }) {
+        auto unfused = time_chain(stages, false);
+        auto fused   = time_chain(stages, true);
+        std::cout << stages << " stages: " << unfused << " ns/message unfused, " << fused << " ns/message fused ("
+                  << unfused / fused << "x)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+// Throughput of readout oversampling removal, comparing the image domain crop with FFTs that
+// RemoveROOversamplingGadget does by default with its FIR decimation mode.
+//
+
+#include "hoNDArray.h"
+#include "hoNDFFT.h"
+#include "mri_core_readout_decimation.h"
+
+#include <chrono>
+#include <complex>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace Gadgetron;
+
+template<class F>
+static double time_ms(F f, int repetitions) {
+    f();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repetitions; i++) f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static void run(size_t RO, size_t coils) {
+    std::mt19937 engine(RO + coils);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    hoNDArray<std::complex<float>> readout(RO, coils);
+    for (auto& value : readout) value = { distribution(engine), distribution(engine) };
+
+    const size_t dRO = RO / 2;
+    const int repetitions = 2000;
+
+    // Same steps as the gadget.
+    hoNDArray<std::complex<float>> ifft_res(RO, coils), ifft_buf(RO, coils), fft_res(dRO, coils), fft_buf(dRO, coils);
+    hoNDArray<std::complex<float>> cropped(dRO, coils);
+    auto fft = [&]() {
+        hoNDFFT<float>::instance()->ifft1c(readout, ifft_res, ifft_buf);
+        for (size_t c = 0; c < coils; c++)
+            memcpy(cropped.begin() + c * dRO, ifft_res.begin() + c * RO + dRO / 2, dRO * sizeof(std::complex<float>));
+        hoNDFFT<float>::instance()->fft1c(cropped, fft_res, fft_buf);
+    };
+
+    double fft_us = 1000 * time_ms(fft, repetitions);
+    std::cout << std::setw(6) << RO << std::setw(7) << coils << std::setw(12) << fft_us;
+
+    for (size_t length : { 32, 64, 128 }) {
+        ReadoutDecimator decimator(2, length);
+        hoNDArray<std::complex<float>> decimated;
+        double fir_us = 1000 * time_ms([&]() { decimator(readout, decimated); }, repetitions);
+        std::cout << std::setw(10) << fir_us << std::setw(7) << std::setprecision(3) << fft_us / fir_us << "x";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "Time per readout [us], and speedup of the FIR filter over the FFT crop" << std::endl;
+    std::cout << std::setw(6) << "RO" << std::setw(7) << "coils" << std::setw(12) << "FFT";
+    for (size_t length : { 32, 64, 128 }) std::cout << std::setw(10) << ("FIR " + std::to_string(length)) << std::setw(8) << " ";
+    std::cout << std::endl;
+
+    for (size_t RO : { 256, 512 }) {
+        for (size_t coils : { 16, 32, 64 }) {
+            run(RO, coils);
+        }
+    }
+    return 0;
+}
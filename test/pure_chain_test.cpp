@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "PureChain.h"
+#include "hoNDArray.h"
+
+#include <numeric>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+namespace {
+    class AddOne : public PureGadget<hoNDArray<float>, hoNDArray<float>> {
+    public:
+        using PureGadget::PureGadget;
+        hoNDArray<float> process_function(hoNDArray<float> array) const override {
+            for (auto& value : array) value += 1;
+            return array;
+        }
+    };
+
+    class Sum : public PureGadget<float, hoNDArray<float>> {
+    public:
+        using PureGadget::PureGadget;
+        float process_function(hoNDArray<float> array) const override {
+            return std::accumulate(array.begin(), array.end(), 0.0f);
+        }
+    };
+
+    class Double : public PureGadget<float, float> {
+    public:
+        using PureGadget::PureGadget;
+        float process_function(float value) const override { return 2 * value; }
+    };
+
+    class Negate : public PureGadget<int, int> {
+    public:
+        using PureGadget::PureGadget;
+        int process_function(int value) const override { return -value; }
+    };
+
+    PureChain make_chain(bool fused) {
+        Context context;
+        GadgetProperties properties;
+
+        std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+        gadgets.push_back(std::make_unique<AddOne>(context, properties));
+        gadgets.push_back(std::make_unique<AddOne>(context, properties));
+        gadgets.push_back(std::make_unique<Sum>(context, properties));
+        gadgets.push_back(std::make_unique<Negate>(context, properties));
+        gadgets.push_back(std::make_unique<Double>(context, properties));
+        gadgets.push_back(std::make_unique<Double>(context, properties));
+        return PureChain(std::move(gadgets), fused);
+    }
+
+    hoNDArray<float> make_array() {
+        hoNDArray<float> array(16);
+        std::fill(array.begin(), array.end(), 1.0f);
+        return array;
+    }
+}
+
+TEST(PureChainTest, fused_matches_unfused) {
+    auto fused   = make_chain(true);
+    auto unfused = make_chain(false);
+
+    auto expected = force_unpack<float>(unfused.process_function(Message(make_array())));
+    auto result   = force_unpack<float>(fused.process_function(Message(make_array())));
+
+    EXPECT_FLOAT_EQ(expected, 4 * 16 * 3.0f);
+    EXPECT_FLOAT_EQ(result, expected);
+}
+
+TEST(PureChainTest, run_entered_midway) {
+    auto fused = make_chain(true);
+
+    // Skips the array gadgets, but is picked up by the trailing run of float gadgets.
+    auto result = force_unpack<float>(fused.process_function(Message(1.5f)));
+    EXPECT_FLOAT_EQ(result, 6.0f);
+
+    auto negated = force_unpack<int>(fused.process_function(Message(3)));
+    EXPECT_EQ(negated, -3);
+}
+
+TEST(PureChainTest, unmatched_passes_through) {
+    auto fused = make_chain(true);
+
+    auto result = force_unpack<std::string>(fused.process_function(Message(std::string("unchanged"))));
+    EXPECT_EQ(result, "unchanged");
+}
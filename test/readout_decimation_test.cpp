@@ -0,0 +1,91 @@
+#include "mri_core_readout_decimation.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    typedef std::complex<double> C;
+
+    // Centered, unitary DFT; sign -1 for the forward transform.
+    std::vector<C> centered_dft(const std::vector<C>& x, int sign) {
+        const size_t N = x.size();
+        std::vector<C> y(N);
+        for (size_t p = 0; p < N; p++) {
+            C sum = 0;
+            for (size_t n = 0; n < N; n++) {
+                sum += x[n] * std::polar(1.0, sign * 2 * M_PI * (double(n) - N / 2) * (double(p) - N / 2) / N);
+            }
+            y[p] = sum / std::sqrt(double(N));
+        }
+        return y;
+    }
+
+    // Object in the central 80% of the reduced field of view, and weaker signal in the oversampled part.
+    std::vector<C> phantom(size_t N, size_t factor, std::mt19937& engine) {
+        std::normal_distribution<double> noise(0, 0.02);
+        std::vector<C> image(N);
+        for (size_t p = 0; p < N; p++) {
+            double x = (double(p) - N / 2) / (N / 2.0) * factor;
+            double value = std::abs(x) < 0.8 ? 1 + 0.3 * std::cos(5 * x) : (std::abs(x) < factor * 0.9 ? 0.2 : 0);
+            image[p] = C(value + noise(engine), noise(engine));
+        }
+        return image;
+    }
+}
+
+// Readout length and decimation factor.
+class ReadoutDecimator_Test : public ::testing::TestWithParam<std::tuple<size_t, size_t>> {};
+
+// Compared with cropping the central part of the field of view in image domain.
+TEST_P(ReadoutDecimator_Test, matches_image_domain_crop) {
+    const size_t N = std::get<0>(GetParam()), factor = std::get<1>(GetParam()), dN = N / factor, CHA = 3;
+
+    std::mt19937 engine(5);
+    hoNDArray<std::complex<float>> data(N, CHA);
+    std::vector<std::vector<C>> expected(CHA);
+    for (size_t c = 0; c < CHA; c++) {
+        auto kspace = centered_dft(phantom(N, factor, engine), -1);
+        for (size_t n = 0; n < N; n++) data(n, c) = std::complex<float>(kspace[n]);
+
+        auto image = centered_dft(kspace, +1);
+        std::vector<C> cropped(image.begin() + N / 2 - dN / 2, image.begin() + N / 2 - dN / 2 + dN);
+        expected[c] = cropped;
+    }
+
+    ReadoutDecimator decimator(factor, 64);
+    hoNDArray<std::complex<float>> decimated;
+    decimator(data, decimated);
+
+    ASSERT_EQ(decimated.get_size(0), dN);
+    ASSERT_EQ(decimated.get_size(1), CHA);
+
+    // Away from the edges of the field of view, where the filter rolls off.
+    for (size_t c = 0; c < CHA; c++) {
+        std::vector<C> line(dN);
+        for (size_t m = 0; m < dN; m++) line[m] = C(decimated(m, c));
+        auto image = centered_dft(line, +1);
+
+        double error = 0, norm = 0;
+        for (size_t p = dN / 10; p < dN - dN / 10; p++) {
+            error += std::norm(image[p] - expected[c][p]);
+            norm += std::norm(expected[c][p]);
+        }
+        EXPECT_LT(std::sqrt(error / norm), 1e-3) << "channel " << c;
+    }
+}
+
+// The last two decimate to an odd length.
+INSTANTIATE_TEST_CASE_P(Factors, ReadoutDecimator_Test,
+    ::testing::Values(std::make_tuple(192, 2), std::make_tuple(192, 3), std::make_tuple(198, 2), std::make_tuple(195, 3)));
+
+TEST(ReadoutDecimator, half_band) {
+    // Every other tap of the half-band filter is zero, and left out.
+    ReadoutDecimator decimator(2, 64);
+    for (size_t j = 1; j < decimator.offsets().size(); j++) {
+        EXPECT_EQ(decimator.offsets()[j] % 2, 1);
+    }
+}
@@ -24,3 +24,42 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+static long fibonacci(ThreadPool& pool, int n){
+    if (n < 2) return n;
+    auto first = pool.async([&pool,n](){return fibonacci(pool,n-1);});
+    auto second = fibonacci(pool,n-2);
+    return first.get() + second;
+}
+
+TEST(ThreadPoolTest,nestedTest){
+    ThreadPool pool{1};
+    auto result = pool.async([&pool](){ return fibonacci(pool,15); });
+    EXPECT_EQ(result.get(),610);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,exceptionTest){
+    ThreadPool pool{2};
+    auto result = pool.async([](){ throw std::runtime_error("Task failed"); });
+    EXPECT_THROW(result.get(),std::runtime_error);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,parallelForTest){
+    ThreadPool pool{4};
+    std::vector<size_t> values(1000,0);
+    pool.parallel_for(0,values.size(),[&](size_t i){ values[i] = i; });
+    for (size_t i = 0; i < values.size(); i++) EXPECT_EQ(values[i],i);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,boundedQueueTest){
+    ThreadPool pool{2,4};
+    std::vector<ThreadPool::Future<int>> results;
+    for (int i = 0; i < 100; i++) results.push_back(pool.async([i](){ return i; }));
+    int sum = 0;
+    for (auto& result : results) sum += result.get();
+    EXPECT_EQ(sum,4950);
+    pool.join();
+}
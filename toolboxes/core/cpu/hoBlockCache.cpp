@@ -0,0 +1,86 @@
+#include "hoBlockCache.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Gadgetron {
+
+    namespace {
+        constexpr size_t small_granularity = hoBlockCache::alignment;
+        constexpr size_t page_granularity  = 4096;
+    }
+
+    hoBlockCache::hoBlockCache(size_t max_cached_bytes) : max_cached{ max_cached_bytes } {}
+
+    hoBlockCache::~hoBlockCache() {
+        for (auto& entry : free_blocks)
+            for (auto block : entry.second) std::free(block);
+    }
+
+    // Rounding up lets arrays of nearly the same size share blocks; above a page, we waste at most one page.
+    size_t hoBlockCache::size_class(size_t bytes) {
+        auto granularity = bytes < page_granularity ? small_granularity : page_granularity;
+        return ((bytes + granularity - 1) / granularity) * granularity;
+    }
+
+    void* hoBlockCache::allocate(size_t size) {
+        auto block = std::aligned_alloc(alignment, alignment + size);
+        if (!block) throw std::bad_alloc();
+        return block;
+    }
+
+    void* hoBlockCache::take(size_t size) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = free_blocks.find(size);
+        if (it == free_blocks.end() || it->second.empty()) return nullptr;
+
+        auto block = it->second.back();
+        it->second.pop_back();
+        cached -= size;
+        return block;
+    }
+
+    size_t hoBlockCache::give(void* block, size_t size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        free_blocks[size].push_back(block);
+        cached += size;
+        return trim(lock, max_cached);
+    }
+
+    size_t hoBlockCache::set_max_cached_bytes(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        max_cached = bytes;
+        return trim(lock, max_cached);
+    }
+
+    size_t hoBlockCache::trim() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return trim(lock, 0);
+    }
+
+    // Drops the largest cached blocks until we are back under the limit; those are the most expensive to keep.
+    size_t hoBlockCache::trim(std::unique_lock<std::mutex>& lock, size_t limit) {
+        std::vector<void*> excess;
+        while (cached > limit) {
+            auto largest = free_blocks.end();
+            for (auto it = free_blocks.begin(); it != free_blocks.end(); ++it) {
+                if (!it->second.empty() && (largest == free_blocks.end() || it->first > largest->first))
+                    largest = it;
+            }
+            if (largest == free_blocks.end()) break;
+
+            excess.push_back(largest->second.back());
+            largest->second.pop_back();
+            cached -= largest->first;
+        }
+        lock.unlock();
+
+        for (auto block : excess) std::free(block);
+        return excess.size();
+    }
+
+    size_t hoBlockCache::cached_bytes() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return cached;
+    }
+}
@@ -0,0 +1,63 @@
+/** \file hoBlockCache.h
+    \brief Size-class cache of aligned memory blocks, shared by the array memory pools.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Keeps freed memory blocks by size class, for the next allocation of the same class.
+     *
+     * A block is alignment bytes of header space followed by the data, so the data is 64 byte aligned and its owner
+     * can find its way back from the data to the block. What the header holds is up to the owner.
+     *
+     * Once more than the maximum is cached, the largest blocks are given back to the system. Cached blocks are freed
+     * when the cache is destroyed.
+     */
+    class EXPORTCPUCORE hoBlockCache {
+    public:
+        static constexpr size_t alignment = 64;
+
+        explicit hoBlockCache(size_t max_cached_bytes);
+        ~hoBlockCache();
+
+        hoBlockCache(const hoBlockCache&) = delete;
+        hoBlockCache& operator=(const hoBlockCache&) = delete;
+
+        /// The size of the blocks an allocation of the given number of bytes is served from.
+        static size_t size_class(size_t bytes);
+
+        /// A new block from the system, for size bytes of data.
+        static void* allocate(size_t size);
+        static void* data_from_block(void* block) { return static_cast<char*>(block) + alignment; }
+        static void* block_from_data(void* data) { return static_cast<char*>(data) - alignment; }
+
+        /// A cached block of the size class, or nullptr.
+        void* take(size_t size);
+        /// Caches a block of the size class. Returns the number of blocks given back to the system to make room.
+        size_t give(void* block, size_t size);
+
+        /// Returns the number of blocks given back to the system to get under the new maximum.
+        size_t set_max_cached_bytes(size_t bytes);
+        /// Gives every cached block back to the system, and returns how many there were.
+        size_t trim();
+
+        size_t cached_bytes() const;
+
+    private:
+        size_t trim(std::unique_lock<std::mutex>& lock, size_t limit);
+
+        mutable std::mutex mutex;
+        std::unordered_map<size_t, std::vector<void*>> free_blocks;
+        size_t cached = 0;
+        size_t max_cached;
+    };
+}
@@ -0,0 +1,134 @@
+#include "hoMemoryPool.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Gadgetron {
+
+    namespace {
+        // Other thread locals may release arrays after the thread's cache is gone; those go to the shared pool.
+        thread_local bool thread_cache_destroyed = false;
+    }
+
+    // Blocks released by a thread are kept close at hand for the next allocation on that same thread, which is how
+    // loops over temporaries behave. What doesn't fit - or is left when the thread exits - goes to the shared pool.
+    class hoMemoryPool::ThreadCache {
+    public:
+        explicit ThreadCache(hoMemoryPool& pool) : pool(pool) {}
+
+        ~ThreadCache() {
+            thread_cache_destroyed = true;
+            for (auto& entry : blocks)
+                for (auto block : entry.second) pool.give(block, entry.first);
+            pool.thread_cached -= bytes;
+        }
+
+        void* take(size_t size) {
+            auto it = blocks.find(size);
+            if (it == blocks.end() || it->second.empty()) return nullptr;
+
+            auto block = it->second.back();
+            it->second.pop_back();
+            bytes -= size;
+            pool.thread_cached -= size;
+            return block;
+        }
+
+        bool give(void* block, size_t size) {
+            if (bytes + size > pool.thread_cache_bytes.load(std::memory_order_relaxed)) return false;
+
+            blocks[size].push_back(block);
+            bytes += size;
+            pool.thread_cached += size;
+            return true;
+        }
+
+    private:
+        hoMemoryPool& pool;
+        FreeLists blocks;
+        size_t bytes = 0;
+    };
+
+    hoMemoryPool::hoMemoryPool() {
+        if (auto limit = std::getenv("GADGETRON_ARRAY_POOL")) {
+            auto mebibytes = std::strtoull(limit, nullptr, 10);
+            if (mebibytes > 0) enable(size_t(mebibytes) << 20);
+        }
+    }
+
+    hoMemoryPool& hoMemoryPool::instance() {
+        // Never destroyed, as the thread caches and arrays with static storage give blocks back to it at exit.
+        static auto pool = new hoMemoryPool();
+        return *pool;
+    }
+
+    hoMemoryPool::ThreadCache* hoMemoryPool::thread_cache() {
+        if (thread_cache_destroyed) return nullptr;
+        thread_local ThreadCache cache{ instance() };
+        return &cache;
+    }
+
+    void hoMemoryPool::enable(size_t max_cached_bytes) {
+        set_max_cached_bytes(max_cached_bytes);
+        is_enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void hoMemoryPool::disable() {
+        is_enabled.store(false, std::memory_order_relaxed);
+        trim();
+    }
+
+    void* hoMemoryPool::allocate(size_t bytes) {
+        auto size = hoBlockCache::size_class(bytes);
+        allocations++;
+
+        auto cache  = thread_cache();
+        void* block = cache ? cache->take(size) : nullptr;
+        if (block) {
+            thread_cache_hits++;
+        } else if ((block = shared.take(size))) {
+            pool_hits++;
+        } else {
+            block = hoBlockCache::allocate(size);
+            system_allocations++;
+        }
+
+        new (block) Header{ size };
+        return hoBlockCache::data_from_block(block);
+    }
+
+    void hoMemoryPool::release(void* data) {
+        auto block = hoBlockCache::block_from_data(data);
+        auto size  = static_cast<Header*>(block)->size;
+
+        auto cache = thread_cache();
+        if (!cache || !cache->give(block, size)) instance().give(block, size);
+    }
+
+    void hoMemoryPool::give(void* block, size_t size) {
+        system_releases += shared.give(block, size);
+    }
+
+    void hoMemoryPool::set_max_cached_bytes(size_t bytes) {
+        system_releases += shared.set_max_cached_bytes(bytes);
+    }
+
+    void hoMemoryPool::set_thread_cache_bytes(size_t bytes) {
+        thread_cache_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    void hoMemoryPool::trim() {
+        system_releases += shared.trim();
+    }
+
+    hoMemoryPool::Statistics hoMemoryPool::statistics() const {
+        return Statistics{
+            allocations.load(),
+            thread_cache_hits.load(),
+            pool_hits.load(),
+            system_allocations.load(),
+            system_releases.load(),
+            shared.cached_bytes() + thread_cached.load()
+        };
+    }
+}
@@ -0,0 +1,91 @@
+/** \file hoMemoryPool.h
+    \brief Size-class caching allocator backing hoNDArray memory, when enabled.
+*/
+
+#pragma once
+
+#include "cpucore_export.h"
+#include "hoBlockCache.h"
+
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Recycles the memory of hoNDArrays, rather than handing every block back to the system allocator.
+     *
+     * Reconstructions create the same few temporaries over and over; with the pool enabled, freed blocks are kept in
+     * a small per-thread cache, backed by a shared pool, and handed to the next array of the same size class. All
+     * blocks are 64 byte aligned, which suits both SIMD loads and FFTW.
+     *
+     * The pool is off by default. It is switched on by enable(), or by setting GADGETRON_ARRAY_POOL to the maximum
+     * number of MiB to keep cached. Arrays allocated while enabled return their memory to the pool, even if the pool
+     * is disabled later on; memory is never handed to anything but the pool that made it.
+     */
+    class EXPORTCPUCORE hoMemoryPool {
+    public:
+        static constexpr size_t alignment = hoBlockCache::alignment;
+        static constexpr size_t default_max_cached_bytes = size_t(512) << 20;
+        static constexpr size_t default_thread_cache_bytes = size_t(32) << 20;
+
+        struct Statistics {
+            size_t allocations;        /// Blocks handed out.
+            size_t thread_cache_hits;  /// ... of which were found in the calling thread's cache.
+            size_t pool_hits;          /// ... of which were found in the shared pool.
+            size_t system_allocations; /// ... of which had to come from the system allocator.
+            size_t system_releases;    /// Blocks given back to the system allocator when trimming.
+            size_t cached_bytes;       /// Bytes currently cached, across the shared pool and all thread caches.
+        };
+
+        static hoMemoryPool& instance();
+
+        void enable(size_t max_cached_bytes = default_max_cached_bytes);
+        void disable();
+        bool enabled() const { return is_enabled.load(std::memory_order_relaxed); }
+
+        void* allocate(size_t bytes);
+        static void release(void* data);
+
+        /// Bytes kept by the shared pool before the largest blocks are freed. Trims immediately if needed.
+        void set_max_cached_bytes(size_t bytes);
+        /// Bytes each thread may keep for itself, before released blocks go to the shared pool.
+        void set_thread_cache_bytes(size_t bytes);
+
+        /// Gives all memory cached in the shared pool back to the system.
+        void trim();
+
+        Statistics statistics() const;
+
+    private:
+        hoMemoryPool();
+
+        struct Header {
+            size_t size;
+        };
+        static_assert(sizeof(Header) <= alignment, "Block header must fit in the alignment padding");
+
+        using FreeLists = std::unordered_map<size_t, std::vector<void*>>;
+
+        class ThreadCache;
+        friend ThreadCache;
+
+        static ThreadCache* thread_cache();
+
+        void give(void* block, size_t size);
+
+        std::atomic<bool> is_enabled{ false };
+        std::atomic<size_t> thread_cache_bytes{ default_thread_cache_bytes };
+
+        hoBlockCache shared{ default_max_cached_bytes };
+
+        std::atomic<size_t> allocations{ 0 };
+        std::atomic<size_t> thread_cache_hits{ 0 };
+        std::atomic<size_t> pool_hits{ 0 };
+        std::atomic<size_t> system_allocations{ 0 };
+        std::atomic<size_t> system_releases{ 0 };
+        std::atomic<size_t> thread_cached{ 0 };
+    };
+}
@@ -6,8 +6,10 @@
 
 #include "NDArray.h"
 #include "complext.h"
+#include "hoMemoryPool.h"
 #include "vector_td.h"
 #include <type_traits>
+#include <memory>
 #include <boost/shared_ptr.hpp>
 #include <stdexcept>
 #include "TypeTraits.h"
@@ -149,6 +151,17 @@ namespace Gadgetron{
     hoNDArray(size_t sx, size_t sy, size_t sz, size_t st, size_t sp, size_t sq, size_t sr, T* data, bool delete_data_on_destruct = false);
     hoNDArray(size_t sx, size_t sy, size_t sz, size_t st, size_t sp, size_t sq, size_t sr, size_t ss, T* data, bool delete_data_on_destruct = false);
 
+    /**
+     * Function used to hand back memory that was not allocated by the array itself, such as a pooled buffer.
+     */
+    typedef void (*release_function)(void*);
+
+    /**
+     * Takes ownership of data allocated elsewhere. Instead of deleting the data, the array calls release(data) when
+     * it is destroyed or reallocated. Moving the array moves this responsibility along with the data.
+     */
+    hoNDArray(const std::vector<size_t> &dimensions, T* data, release_function release);
+
     virtual ~hoNDArray();
 
     // Copy constructors
@@ -312,6 +325,8 @@ namespace Gadgetron{
     virtual void allocate_memory();
     virtual void deallocate_memory();
 
+    release_function release_ = nullptr;
+
     // Generic allocator / deallocator
     //
 
@@ -325,6 +340,16 @@ namespace Gadgetron{
       delete [] data;
     }
 
+    // Pooled memory is released without running destructors, so only trivially destructible types qualify.
+    static constexpr bool pooled_allocation = std::is_trivially_destructible<T>::value;
+
+    template<class X> void _allocate_pooled_memory( size_t size, X** data )
+    {
+      *data = static_cast<X*>(hoMemoryPool::instance().allocate(size * sizeof(X)));
+      std::uninitialized_default_construct_n(*data, size);
+      this->release_ = &hoMemoryPool::release;
+    }
+
 
   };
 
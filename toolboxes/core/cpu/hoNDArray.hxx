@@ -202,6 +202,13 @@ namespace Gadgetron {
         this->create(&dim, data, delete_data_on_destruct);
     }
 
+    template<typename T>
+    hoNDArray<T>::hoNDArray(const std::vector<size_t> &dimensions, T *data, release_function release)
+            : NDArray<T>::NDArray() {
+        this->create(dimensions, data, true);
+        this->release_ = release;
+    }
+
     template<typename T>
     hoNDArray<T>::~hoNDArray() {
         if (this->delete_data_on_destruct_) {
@@ -257,6 +264,8 @@ namespace Gadgetron {
         a.data_ = nullptr;
         this->offsetFactors_ = a.offsetFactors_;
         this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
+        this->release_ = a.release_;
+        a.release_ = nullptr;
     }
 
 
@@ -301,6 +310,8 @@ namespace Gadgetron {
         data_ = rhs.data_;
         rhs.data_ = nullptr;
         this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
+        this->release_ = rhs.release_;
+        rhs.release_ = nullptr;
         return *this;
     }
 
@@ -780,7 +791,11 @@ namespace Gadgetron {
             }
 
             if (this->elements_ > 0) {
-                this->_allocate_memory(this->elements_, &this->data_);
+                if (pooled_allocation && hoMemoryPool::instance().enabled()) {
+                    this->_allocate_pooled_memory(this->elements_, &this->data_);
+                } else {
+                    this->_allocate_memory(this->elements_, &this->data_);
+                }
 
                 if (this->data_ == 0x0) {
                     BOOST_THROW_EXCEPTION(bad_alloc("hoNDArray<>::allocate memory failed"));
@@ -802,9 +817,14 @@ namespace Gadgetron {
         }
 
         if (this->data_) {
-            this->_deallocate_memory(this->data_);
+            if (this->release_) {
+                this->release_(this->data_);
+            } else {
+                this->_deallocate_memory(this->data_);
+            }
             this->data_ = 0x0;
         }
+        this->release_ = nullptr;
     }
 
 
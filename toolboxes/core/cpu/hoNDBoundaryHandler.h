@@ -106,6 +106,7 @@ namespace Gadgetron
         virtual T operator()( long long x, long long y, long long z, long long s, long long p, long long r, long long a, long long q, long long u ) = 0;
 
         void setArray(const ArrayType& a) { array_ = &a; };
+        const ArrayType* getArray() const { return array_; }
 
         /// return a%b
         inline long long mod(long long a, long long b)
@@ -138,6 +139,8 @@ namespace Gadgetron
         hoNDBoundaryHandlerFixedValue(const ArrayType& a, T v=T(0)) : BaseClass(a), value_(v) {}
         virtual ~hoNDBoundaryHandlerFixedValue() {}
 
+        T getValue() const { return value_; }
+
         /// access the pixel value
         virtual T operator()( const std::vector<long long>& ind );
         virtual T operator()( long long x );
@@ -242,6 +245,114 @@ namespace Gadgetron
         using BaseClass::array_;
     };
 
+    /// Non-virtual versions of the boundary handlers for 2D and 3D arrays, used by the batched interpolation.
+    /// Each gives the value at an integer position, which may be outside the array of the handler.
+    namespace BoundaryPolicy
+    {
+        struct BorderIndex
+        {
+            static long long index(long long i, long long n) { return (i<0) ? 0 : ( (i>=n) ? n-1 : i ); }
+        };
+
+        struct PeriodicIndex
+        {
+            static long long index(long long i, long long n) { if ( i<0 || i>=n ) { i %= n; if ( i<0 ) i += n; } return i; }
+        };
+
+        struct MirrorIndex
+        {
+            static long long index(long long i, long long n) { return (i<0) ? -i : ( (i>=n) ? (2*n-i-2) : i ); }
+        };
+
+        /// maps every index back into the array, as the border value, periodic and mirror handlers do
+        template <typename ArrayType, typename Index>
+        struct Remap
+        {
+            typedef typename ArrayType::value_type T;
+
+            explicit Remap(const hoNDBoundaryHandler<ArrayType>& bh)
+                : data(bh.getArray()->begin()), sx(bh.getArray()->get_size(0)), sy(bh.getArray()->get_size(1)), sz(bh.getArray()->get_size(2)) {}
+
+            T operator()(long long x, long long y) const
+            {
+                return data[Index::index(x, sx) + Index::index(y, sy)*sx];
+            }
+
+            T operator()(long long x, long long y, long long z) const
+            {
+                return data[Index::index(x, sx) + Index::index(y, sy)*sx + Index::index(z, sz)*sx*sy];
+            }
+
+            const T* data;
+            long long sx, sy, sz;
+        };
+
+        template <typename ArrayType>
+        struct FixedValue
+        {
+            typedef typename ArrayType::value_type T;
+
+            explicit FixedValue(const hoNDBoundaryHandlerFixedValue<ArrayType>& bh)
+                : data(bh.getArray()->begin()), sx(bh.getArray()->get_size(0)), sy(bh.getArray()->get_size(1)), sz(bh.getArray()->get_size(2)), value(bh.getValue()) {}
+
+            T operator()(long long x, long long y) const
+            {
+                return (x>=0 && x<sx && y>=0 && y<sy) ? data[x + y*sx] : value;
+            }
+
+            T operator()(long long x, long long y, long long z) const
+            {
+                return (x>=0 && x<sx && y>=0 && y<sy && z>=0 && z<sz) ? data[x + y*sx + z*sx*sy] : value;
+            }
+
+            const T* data;
+            long long sx, sy, sz;
+            T value;
+        };
+
+        /// any other handler, through its virtual operator()
+        template <typename ArrayType>
+        struct Virtual
+        {
+            typedef typename ArrayType::value_type T;
+
+            explicit Virtual(hoNDBoundaryHandler<ArrayType>& bh) : bh(bh) {}
+
+            T operator()(long long x, long long y) const { return bh(x, y); }
+            T operator()(long long x, long long y, long long z) const { return bh(x, y, z); }
+
+            hoNDBoundaryHandler<ArrayType>& bh;
+        };
+    }
+
+    /// calls f with the boundary policy matching the type of bh, so the boundary handling is resolved once per batch
+    template <typename ArrayType, typename F>
+    void dispatchBoundaryPolicy(hoNDBoundaryHandler<ArrayType>& bh, F&& f)
+    {
+        using namespace BoundaryPolicy;
+
+        if ( auto fixed = dynamic_cast<hoNDBoundaryHandlerFixedValue<ArrayType>*>(&bh) )
+        {
+            f(FixedValue<ArrayType>(*fixed));
+        }
+        else if ( dynamic_cast<hoNDBoundaryHandlerBorderValue<ArrayType>*>(&bh) )
+        {
+            f(Remap<ArrayType, BorderIndex>(bh));
+        }
+        else if ( dynamic_cast<hoNDBoundaryHandlerPeriodic<ArrayType>*>(&bh) )
+        {
+            f(Remap<ArrayType, PeriodicIndex>(bh));
+        }
+        else if ( dynamic_cast<hoNDBoundaryHandlerMirror<ArrayType>*>(&bh) )
+        {
+            f(Remap<ArrayType, MirrorIndex>(bh));
+        }
+        else
+        {
+            f(Virtual<ArrayType>(bh));
+        }
+    }
+
     template <typename ArrayType> 
     hoNDBoundaryHandler<ArrayType>* createBoundaryHandler(GT_BOUNDARY_CONDITION bh)
     {
@@ -12,6 +12,7 @@
 #include "hoNDImage.h"
 #include "hoNDBoundaryHandler.h"
 #include "hoNDBSpline.h"
+#include <algorithm>
 
 namespace Gadgetron
 {
@@ -125,6 +126,32 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q ) = 0;
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u ) = 0;
 
+        /// interpolate at n points, with the coordinates of every point stored one after the other in xs
+        /// one virtual call per batch; derived interpolators override this with kernels for 2D and 3D arrays
+        virtual void interpolate( const coord_type* xs, size_t n, T* out )
+        {
+            size_t D = array_->get_number_of_dimensions();
+
+            size_t ii;
+            switch ( D )
+            {
+                case 1:
+                    for ( ii=0; ii<n; ii++ ) out[ii] = this->operator()(xs[ii]);
+                    break;
+
+                case 2:
+                    for ( ii=0; ii<n; ii++ ) out[ii] = this->operator()(xs[2*ii], xs[2*ii+1]);
+                    break;
+
+                case 3:
+                    for ( ii=0; ii<n; ii++ ) out[ii] = this->operator()(xs[3*ii], xs[3*ii+1], xs[3*ii+2]);
+                    break;
+
+                default:
+                    for ( ii=0; ii<n; ii++ ) out[ii] = this->operator()(xs + ii*D);
+            }
+        }
+
     protected:
 
         const ArrayType* array_;
@@ -210,6 +237,8 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q );
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u );
 
+        virtual void interpolate( const coord_type* xs, size_t n, T* out );
+
     protected:
 
         using BaseClass::array_;
@@ -221,6 +250,9 @@ namespace Gadgetron
         using BaseClass::sz_;
         using BaseClass::st_;
 
+        template <typename Boundary> void interpolate2D( const coord_type* xs, size_t n, T* out, const Boundary& boundary );
+        template <typename Boundary> void interpolate3D( const coord_type* xs, size_t n, T* out, const Boundary& boundary );
+
         // number of points involved in interpolation
         unsigned int number_of_points_;
     };
@@ -257,6 +289,8 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q );
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u );
 
+        virtual void interpolate( const coord_type* xs, size_t n, T* out );
+
      protected:
 
         using BaseClass::array_;
@@ -336,4 +336,28 @@ namespace Gadgetron
             return (*bh_)(anchor[0], anchor[1], anchor[2], anchor[3], anchor[4], anchor[5], anchor[6], anchor[7], anchor[8]);
         }
     }
+
+    template <typename ArrayType, unsigned int D> 
+    void hoNDInterpolatorBSpline<ArrayType, D>::interpolate( const coord_type* xs, size_t n, T* out )
+    {
+        // qualified calls are bound at compile time, so the per point operators inline into these loops
+        size_t ii;
+        switch ( D )
+        {
+            case 1:
+                for ( ii=0; ii<n; ii++ ) out[ii] = Self::operator()(xs[ii]);
+                break;
+
+            case 2:
+                for ( ii=0; ii<n; ii++ ) out[ii] = Self::operator()(xs[2*ii], xs[2*ii+1]);
+                break;
+
+            case 3:
+                for ( ii=0; ii<n; ii++ ) out[ii] = Self::operator()(xs[3*ii], xs[3*ii+1], xs[3*ii+2]);
+                break;
+
+            default:
+                for ( ii=0; ii<n; ii++ ) out[ii] = Self::operator()(xs + ii*D);
+        }
+    }
 }
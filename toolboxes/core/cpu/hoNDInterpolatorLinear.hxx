@@ -202,15 +202,16 @@ namespace Gadgetron
                     +   (*array_)(size_t(ix)+1, size_t(iy)+1,   size_t(iz)+1  )   *   dx           *dy         *dz) );*/
 
             size_t offset = ix + iy*sx_ + iz*sx_*sy_;
+            const T* data = array_->begin();
 
-            return (    (data_[offset]              *   dx_prime     *dy_prime   *dz_prime 
-                    +   data_[offset+1]             *   dx           *dy_prime   *dz_prime) 
-                    +   (data_[offset+sx_]          *   dx_prime     *dy         *dz_prime 
-                    +   data_[offset+sx_+1]         *   dx           *dy         *dz_prime) 
-                    +   (data_[offset+sx_*sy_]      *   dx_prime     *dy_prime   *dz 
-                    +   data_[offset+sx_*sy_+1]     *   dx           *dy_prime   *dz) 
-                    +   (data_[offset+sx_*sy_+sx_]  *   dx_prime     *dy         *dz 
-                    +   data_[offset+sx_*sy_+sx_+1] *   dx           *dy         *dz) );
+            return (    (data[offset]              *   dx_prime     *dy_prime   *dz_prime 
+                    +   data[offset+1]             *   dx           *dy_prime   *dz_prime) 
+                    +   (data[offset+sx_]          *   dx_prime     *dy         *dz_prime 
+                    +   data[offset+sx_+1]         *   dx           *dy         *dz_prime) 
+                    +   (data[offset+sx_*sy_]      *   dx_prime     *dy_prime   *dz 
+                    +   data[offset+sx_*sy_+1]     *   dx           *dy_prime   *dz) 
+                    +   (data[offset+sx_*sy_+sx_]  *   dx_prime     *dy         *dz 
+                    +   data[offset+sx_*sy_+sx_+1] *   dx           *dy         *dz) );
         }
         else
         {
@@ -871,4 +872,172 @@ namespace Gadgetron
 
         return res;
     }
+
+    template <typename ArrayType> 
+    void hoNDInterpolatorLinear<ArrayType>::interpolate( const coord_type* xs, size_t n, T* out )
+    {
+        size_t D = array_->get_number_of_dimensions();
+
+        // the kernels read a 2x2 (2x2x2) neighbourhood for every point, which needs two pixels along every dimension
+        if ( D==2 && sx_>1 && sy_>1 )
+        {
+            dispatchBoundaryPolicy(*bh_, [&](const auto& boundary) { this->interpolate2D(xs, n, out, boundary); });
+        }
+        else if ( D==3 && sx_>1 && sy_>1 && sz_>1 )
+        {
+            dispatchBoundaryPolicy(*bh_, [&](const auto& boundary) { this->interpolate3D(xs, n, out, boundary); });
+        }
+        else
+        {
+            BaseClass::interpolate(xs, n, out);
+        }
+    }
+
+    // Points are processed in blocks. Every point is first interpolated with its neighbourhood clamped to the array,
+    // a loop without branches that vectorizes; points whose neighbourhood was clamped are then recomputed with the
+    // boundary handler, exactly as operator() does. Like operator(), they read the data through the array rather than
+    // the pointer cached when it was set; the array may have been reallocated since.
+
+    template <typename ArrayType> 
+    template <typename Boundary>
+    void hoNDInterpolatorLinear<ArrayType>::interpolate2D( const coord_type* xs, size_t n, T* out, const Boundary& boundary )
+    {
+        const long long sx = (long long)sx_;
+        const long long sy = (long long)sy_;
+        const T* data = array_->begin();
+
+        const size_t block = 256;
+        unsigned char outside[block];
+
+        for ( size_t start=0; start<n; start+=block )
+        {
+            const size_t num = std::min(block, n-start);
+            const coord_type* pos = xs + 2*start;
+            T* res = out + start;
+
+            long long ii;
+
+            #pragma omp simd
+            for ( ii=0; ii<(long long)num; ii++ )
+            {
+                long long ix = static_cast<long long>(std::floor(pos[2*ii]));
+                coord_type dx = pos[2*ii] - ix;
+                coord_type dx_prime = coord_type(1.0)-dx;
+
+                long long iy = static_cast<long long>(std::floor(pos[2*ii+1]));
+                coord_type dy = pos[2*ii+1] - iy;
+                coord_type dy_prime = coord_type(1.0)-dy;
+
+                long long cx = std::min(std::max(ix, 0LL), sx-2);
+                long long cy = std::min(std::max(iy, 0LL), sy-2);
+                outside[ii] = (cx!=ix) || (cy!=iy);
+
+                size_t offset = cx + cy*sx;
+
+                res[ii] = (    (data[offset]       *   dx_prime     *dy_prime
+                            +   data[offset+1]      *   dx           *dy_prime)
+                            +   (data[offset+sx]    *   dx_prime     *dy
+                            +   data[offset+sx+1]   *   dx           *dy) );
+            }
+
+            for ( ii=0; ii<(long long)num; ii++ )
+            {
+                if ( !outside[ii] ) continue;
+
+                long long ix = static_cast<long long>(std::floor(pos[2*ii]));
+                coord_type dx = pos[2*ii] - ix;
+                coord_type dx_prime = coord_type(1.0)-dx;
+
+                long long iy = static_cast<long long>(std::floor(pos[2*ii+1]));
+                coord_type dy = pos[2*ii+1] - iy;
+                coord_type dy_prime = coord_type(1.0)-dy;
+
+                res[ii] = (    (boundary(ix, iy       )   *   dx_prime    *dy_prime 
+                            +   boundary(ix+1, iy      )   *   dx          *dy_prime)
+                            +   (boundary(ix, iy+1     )   *   dx_prime    *dy
+                            +   boundary(ix+1, iy+1    )   *   dx          *dy) );
+            }
+        }
+    }
+
+    template <typename ArrayType> 
+    template <typename Boundary>
+    void hoNDInterpolatorLinear<ArrayType>::interpolate3D( const coord_type* xs, size_t n, T* out, const Boundary& boundary )
+    {
+        const long long sx = (long long)sx_;
+        const long long sy = (long long)sy_;
+        const long long sz = (long long)sz_;
+        const long long sxy = sx*sy;
+        const T* data = array_->begin();
+
+        const size_t block = 256;
+        unsigned char outside[block];
+
+        for ( size_t start=0; start<n; start+=block )
+        {
+            const size_t num = std::min(block, n-start);
+            const coord_type* pos = xs + 3*start;
+            T* res = out + start;
+
+            long long ii;
+
+            #pragma omp simd
+            for ( ii=0; ii<(long long)num; ii++ )
+            {
+                long long ix = static_cast<long long>(std::floor(pos[3*ii]));
+                coord_type dx = pos[3*ii] - ix;
+                coord_type dx_prime = coord_type(1.0)-dx;
+
+                long long iy = static_cast<long long>(std::floor(pos[3*ii+1]));
+                coord_type dy = pos[3*ii+1] - iy;
+                coord_type dy_prime = coord_type(1.0)-dy;
+
+                long long iz = static_cast<long long>(std::floor(pos[3*ii+2]));
+                coord_type dz = pos[3*ii+2] - iz;
+                coord_type dz_prime = coord_type(1.0)-dz;
+
+                long long cx = std::min(std::max(ix, 0LL), sx-2);
+                long long cy = std::min(std::max(iy, 0LL), sy-2);
+                long long cz = std::min(std::max(iz, 0LL), sz-2);
+                outside[ii] = (cx!=ix) || (cy!=iy) || (cz!=iz);
+
+                size_t offset = cx + cy*sx + cz*sxy;
+
+                res[ii] = (    (data[offset]              *   dx_prime     *dy_prime   *dz_prime 
+                            +   data[offset+1]             *   dx           *dy_prime   *dz_prime) 
+                            +   (data[offset+sx]           *   dx_prime     *dy         *dz_prime 
+                            +   data[offset+sx+1]          *   dx           *dy         *dz_prime) 
+                            +   (data[offset+sxy]          *   dx_prime     *dy_prime   *dz 
+                            +   data[offset+sxy+1]         *   dx           *dy_prime   *dz) 
+                            +   (data[offset+sxy+sx]       *   dx_prime     *dy         *dz 
+                            +   data[offset+sxy+sx+1]      *   dx           *dy         *dz) );
+            }
+
+            for ( ii=0; ii<(long long)num; ii++ )
+            {
+                if ( !outside[ii] ) continue;
+
+                long long ix = static_cast<long long>(std::floor(pos[3*ii]));
+                coord_type dx = pos[3*ii] - ix;
+                coord_type dx_prime = coord_type(1.0)-dx;
+
+                long long iy = static_cast<long long>(std::floor(pos[3*ii+1]));
+                coord_type dy = pos[3*ii+1] - iy;
+                coord_type dy_prime = coord_type(1.0)-dy;
+
+                long long iz = static_cast<long long>(std::floor(pos[3*ii+2]));
+                coord_type dz = pos[3*ii+2] - iz;
+                coord_type dz_prime = coord_type(1.0)-dz;
+
+                res[ii] = (    (boundary(ix,   iy,     iz   )   *   dx_prime     *dy_prime   *dz_prime 
+                            +   boundary(ix+1, iy,     iz    )   *   dx           *dy_prime   *dz_prime) 
+                            +   (boundary(ix,   iy+1,   iz   )   *   dx_prime     *dy         *dz_prime 
+                            +   boundary(ix+1, iy+1,   iz    )   *   dx           *dy         *dz_prime) 
+                            +   (boundary(ix,   iy,     iz+1 )   *   dx_prime     *dy_prime   *dz 
+                            +   boundary(ix+1, iy,     iz+1  )   *   dx           *dy_prime   *dz) 
+                            +   (boundary(ix,   iy+1,   iz+1 )   *   dx_prime     *dy         *dz 
+                            +   boundary(ix+1, iy+1,   iz+1  )   *   dx           *dy         *dz) );
+            }
+        }
+    }
 }
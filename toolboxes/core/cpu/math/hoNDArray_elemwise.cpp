@@ -23,7 +23,16 @@
 #define NumElementsUseThreading 64 * 1024
 
 namespace {
+    using namespace Gadgetron;
 
+    template <class T> struct is_vectorized_complex : std::false_type {};
+    template <class T> struct is_vectorized_complex<std::complex<T>> : std::true_type {};
+    template <class T> struct is_vectorized_complex<complext<T>> : std::true_type {};
+
+    template <class T> auto as_std_complex(const T* x) {
+        return reinterpret_cast<const std::complex<realType_t<T>>*>(x);
+    }
+    template <class T> auto as_std_complex(T* x) { return reinterpret_cast<std::complex<realType_t<T>>*>(x); }
 }
 
 namespace Gadgetron {
@@ -32,7 +41,15 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        Gadgetron::transform(x,r,[](auto val){return conj(val);});
+        if constexpr (is_vectorized_complex<T>::value) {
+            auto input  = as_std_complex(x.data());
+            auto output = as_std_complex(r.data());
+            Kernels::parallel_chunks(x.size(), [&](size_t begin, size_t end) {
+                Kernels::conjugate(input + begin, output + begin, end - begin);
+            });
+        } else {
+            Gadgetron::transform(x, r, [](auto val) { return conj(val); });
+        }
     }
 
     template  void conjugate(
@@ -102,7 +119,15 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
-        transform(x,r,[](auto val){return abs(val);});
+        if constexpr (is_vectorized_complex<T>::value && std::is_same<R, realType_t<T>>::value) {
+            auto input = as_std_complex(x.data());
+            auto output = r.data();
+            Kernels::parallel_chunks(x.size(), [&](size_t begin, size_t end) {
+                Kernels::abs(input + begin, output + begin, end - begin);
+            });
+        } else {
+            transform(x,r,[](auto val){return abs(val);});
+        }
     }
 
     template  void abs(const hoNDArray<float>& x, hoNDArray<float>& r);
@@ -117,8 +142,9 @@ namespace Gadgetron {
     template  void abs(const hoNDArray<complext<double>>& x, hoNDArray<complext<double>>& r);
 
     template <class T> hoNDArray<realType_t<T>> abs(const hoNDArray<T>& x) {
-        using std::abs;
-        return transform(x,[](auto val){return abs(val);}) ;
+        hoNDArray<realType_t<T>> result(x.dimensions());
+        abs(x, result);
+        return result;
     }
 
     template  hoNDArray<float> abs(const hoNDArray<float>& x);
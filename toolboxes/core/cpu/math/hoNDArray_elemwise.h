@@ -27,6 +27,7 @@
 
 #include "hoNDArray.h"
 #include "cpp_blas.h"
+#include "hoNDArray_kernels.h"
 
 #include <complex>
 
@@ -655,3 +656,4 @@ void sum_over_dimension(const hoNDArray<T>& x, hoNDArray<T>& y, size_t dim);
 
 
 #include "hoNDArray_elemwise.hpp"
+#include "hoNDArray_expressions.h"
@@ -15,7 +15,34 @@ namespace {
 
         // --------------------------------------------------------------------------------
 
-        // internal low level function for element-wise addition of two arrays
+        // x * conj(y); named, so that complex arrays can be dispatched to the vectorized kernel.
+        struct MultiplyConj {
+            template <class T, class S> auto operator()(const T& a, const S& b) const { return a * conj(b); }
+        };
+
+        // Applies op to n consecutive elements.
+        template <class T, class S, class R, class BinaryOperator>
+        inline void transform_span(const T* a, const S* b, R* c, size_t n, const BinaryOperator& op) {
+            for (long long i = 0; i < (long long)n; i++) {
+                c[i] = op(a[i], b[i]);
+            }
+        }
+
+        template <class T>
+        inline void transform_span(const complext<T>* a, const complext<T>* b, complext<T>* c, size_t n,
+                                   const std::multiplies<>&) {
+            Kernels::multiply(reinterpret_cast<const std::complex<T>*>(a), reinterpret_cast<const std::complex<T>*>(b),
+                              reinterpret_cast<std::complex<T>*>(c), n);
+        }
+
+        template <class T>
+        inline void transform_span(const complext<T>* a, const complext<T>* b, complext<T>* c, size_t n,
+                                   const MultiplyConj&) {
+            Kernels::multiply_conj(reinterpret_cast<const std::complex<T>*>(a),
+                                   reinterpret_cast<const std::complex<T>*>(b), reinterpret_cast<std::complex<T>*>(c), n);
+        }
+
+        // internal low level function for element-wise operations on two arrays, where y is repeated along x
         template<class T, class S, class BinaryOperator>
         inline void transform_impl(size_t sizeX, size_t sizeY, const T *x, const S *y,
                                    typename mathReturnType<T, S>::type *r, BinaryOperator op) {
@@ -28,29 +55,15 @@ namespace {
             typename mathInternalType<typename mathReturnType<T, S>::type>::type *c
                     = reinterpret_cast<typename mathInternalType<typename mathReturnType<T, S>::type>::type *>(r);
 
-            if (sizeX == sizeY) {
-                // No Broadcasting
-                long long loopsize = sizeX;
-                long long n;
-
-                for ( long long n = 0; n < loopsize; n++) {
-                    c[n] = op(a[n], b[n]);
-                }
-            } else {
-                // Broadcasting
-                long long outerloopsize = sizeX / sizeY;
-                long long innerloopsize = sizeX / outerloopsize;
-                // No OMP at All
-                for (long long outer = 0; outer < outerloopsize; outer++) {
-                    size_t offset = outer * innerloopsize;
-                    const typename mathInternalType<T>::type *ai = &a[offset];
-                    typename mathInternalType<typename mathReturnType<T, S>::type>::type *ci = &c[offset];
-                    for (long long n = 0; n < innerloopsize; n++) {
-                        ci[n] = op(ai[n], b[n]);
-                    }
+            // Large arrays are split across threads; each chunk is cut where y starts over, if broadcasting.
+            Kernels::parallel_chunks(sizeX, [&](size_t begin, size_t end) {
+                while (begin < end) {
+                    size_t offset = begin % sizeY;
+                    size_t length = std::min(end - begin, sizeY - offset);
+                    transform_span(a + begin, b + offset, c + begin, length, op);
+                    begin += length;
                 }
-
-            }
+            });
         }
 
         template <class T, class S, class BinaryFunction>
@@ -117,7 +130,7 @@ void Gadgetron::divide(
 template <class T, class S>
 void Gadgetron::multiplyConj(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); });
+    ::gadgetron_detail::transform_arrays(x, y, r, ::gadgetron_detail::MultiplyConj());
 }
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDArray<T>& x, const hoNDArray<S>& y) {
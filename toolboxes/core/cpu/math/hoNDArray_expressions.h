@@ -0,0 +1,366 @@
+/** \file   hoNDArray_expressions.h
+    \brief  Lazily evaluated element-wise arithmetic on hoNDArrays.
+
+    Arithmetic operators on hoNDArrays (+, -, *, / and unary -, along with conj) do not compute anything; they build
+    an expression, which is evaluated in a single pass when it is assigned to an array:
+
+        hoNDArray<std::complex<float>> r = a * b + c * conj(d);
+
+    No intermediate arrays are allocated, and each input is read once. Evaluation is split across threads with
+    OpenMP for large arrays, and the inner loops are written to be vectorized.
+
+    Broadcasting follows the rules of add, multiply, etc.: an operand with fewer elements than the result is repeated
+    along the trailing dimensions, so its number of elements must divide the size of the result.
+
+    Expressions refer to their operands; they must be evaluated before the operands go out of scope. Do not store
+    them in auto variables - assign them to an hoNDArray, or call evaluate().
+ */
+
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Gadgetron {
+
+    template <class NODE> class hoNDArrayExpression;
+
+    namespace Expressions {
+
+        // Computation happens on complext, for the same reasons as in the rest of the element-wise functions.
+        template <class T> struct internal_type { using type = T; };
+        template <class T> struct internal_type<std::complex<T>> { using type = complext<T>; };
+        template <class T> using internal_type_t = typename internal_type<T>::type;
+
+        // Real scalars take on the precision of the array they are combined with; 2.0 * float_array stays float.
+        template <class T> struct scalar_precision { using type = T; };
+        template <class T> struct scalar_precision<std::complex<T>> { using type = T; };
+        template <class T> struct scalar_precision<complext<T>> { using type = T; };
+
+        template <class T> struct is_scalar : std::is_arithmetic<T> {};
+        template <class T> struct is_scalar<std::complex<T>> : std::true_type {};
+        template <class T> struct is_scalar<complext<T>> : std::true_type {};
+
+        template <class T, class OTHER>
+        using scalar_operand_t = std::conditional_t<std::is_arithmetic<T>::value,
+            typename scalar_precision<OTHER>::type, T>;
+
+        constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+
+        /**
+         * Every node offers:
+         *  size()              - number of elements produced; the largest operand.
+         *  dimensions()        - dimensions of the largest operand, or nullptr for scalars.
+         *  validate(n)         - throws if an operand cannot be broadcast to n elements.
+         *  contiguous(start)   - how many elements, from start, can be read without an operand wrapping around.
+         *  cursor(start)       - a light-weight view, where cursor[j] is element start + j.
+         */
+        template <class T> class Leaf {
+        public:
+            using value_type = T;
+
+            explicit Leaf(const hoNDArray<T>& array) : array(array) {}
+
+            size_t size() const { return array.get_number_of_elements(); }
+            const std::vector<size_t>* dimensions() const { return &array.dimensions(); }
+
+            void validate(size_t elements) const {
+                if (size() == 0 || elements % size() != 0)
+                    throw std::runtime_error("hoNDArray expression: operands have incompatible dimensions.");
+            }
+
+            size_t contiguous(size_t start) const { return size() - start % size(); }
+
+            struct Cursor {
+                const internal_type_t<T>* data;
+                const internal_type_t<T>& operator[](size_t j) const { return data[j]; }
+            };
+
+            Cursor cursor(size_t start) const {
+                return Cursor{ reinterpret_cast<const internal_type_t<T>*>(array.data()) + start % size() };
+            }
+
+        private:
+            const hoNDArray<T>& array;
+        };
+
+        template <class T> class Scalar {
+        public:
+            using value_type = T;
+
+            explicit Scalar(const T& value) : value(value) {}
+
+            size_t size() const { return 0; }
+            const std::vector<size_t>* dimensions() const { return nullptr; }
+            void validate(size_t) const {}
+            size_t contiguous(size_t) const { return unbounded; }
+
+            struct Cursor {
+                internal_type_t<T> value;
+                const internal_type_t<T>& operator[](size_t) const { return value; }
+            };
+
+            Cursor cursor(size_t) const { return Cursor{ *reinterpret_cast<const internal_type_t<T>*>(&value) }; }
+
+        private:
+            T value;
+        };
+
+        template <class OP, class LEFT, class RIGHT> class Binary {
+        public:
+            using value_type = typename mathReturnType<typename LEFT::value_type, typename RIGHT::value_type>::type;
+
+            Binary(LEFT left, RIGHT right) : left(std::move(left)), right(std::move(right)) {}
+
+            size_t size() const { return std::max(left.size(), right.size()); }
+
+            const std::vector<size_t>* dimensions() const {
+                return left.size() >= right.size() ? left.dimensions() : right.dimensions();
+            }
+
+            void validate(size_t elements) const {
+                left.validate(elements);
+                right.validate(elements);
+            }
+
+            size_t contiguous(size_t start) const { return std::min(left.contiguous(start), right.contiguous(start)); }
+
+            struct Cursor {
+                typename LEFT::Cursor left;
+                typename RIGHT::Cursor right;
+                auto operator[](size_t j) const { return OP{}(left[j], right[j]); }
+            };
+
+            Cursor cursor(size_t start) const { return Cursor{ left.cursor(start), right.cursor(start) }; }
+
+        private:
+            LEFT left;
+            RIGHT right;
+        };
+
+        template <class OP, class OPERAND> class Unary {
+        public:
+            using value_type = typename OPERAND::value_type;
+
+            explicit Unary(OPERAND operand) : operand(std::move(operand)) {}
+
+            size_t size() const { return operand.size(); }
+            const std::vector<size_t>* dimensions() const { return operand.dimensions(); }
+            void validate(size_t elements) const { operand.validate(elements); }
+            size_t contiguous(size_t start) const { return operand.contiguous(start); }
+
+            struct Cursor {
+                typename OPERAND::Cursor operand;
+                auto operator[](size_t j) const { return OP{}(operand[j]); }
+            };
+
+            Cursor cursor(size_t start) const { return Cursor{ operand.cursor(start) }; }
+
+        private:
+            OPERAND operand;
+        };
+
+        // complext only offers a non-const unary minus.
+        struct Negate {
+            template <class T> auto operator()(const T& value) const { return T(0) - value; }
+        };
+
+        struct Conjugate {
+            template <class T> auto operator()(const T& value) const { return conj(value); }
+        };
+
+        template <class T> Leaf<T> node(const hoNDArray<T>& array) { return Leaf<T>(array); }
+        template <class NODE> const NODE& node(const hoNDArrayExpression<NODE>& expression) { return expression.node; }
+
+        template <class T> struct is_operand : std::false_type {};
+        template <class T> struct is_operand<hoNDArray<T>> : std::true_type {};
+        template <class NODE> struct is_operand<hoNDArrayExpression<NODE>> : std::true_type {};
+
+        // hoNDArray subclasses, such as hoNDImage, are operands as well.
+        template <class T, class = void> struct array_operand : std::false_type {};
+        template <class T>
+        struct array_operand<T, std::void_t<typename T::element_type>>
+            : std::is_base_of<hoNDArray<typename T::element_type>, T> {};
+
+        template <class T>
+        constexpr bool is_operand_v = is_operand<std::decay_t<T>>::value || array_operand<std::decay_t<T>>::value;
+
+        template <class T> auto node_of(const T& operand) {
+            if constexpr (array_operand<T>::value) {
+                return node(static_cast<const hoNDArray<typename T::element_type>&>(operand));
+            } else {
+                return node(operand);
+            }
+        }
+
+        template <class NODE> auto wrap(NODE node) { return hoNDArrayExpression<NODE>(std::move(node)); }
+
+        template <class OP, class L, class R> auto binary(const L& left, const R& right) {
+            auto l = node_of(left);
+            auto r = node_of(right);
+            return wrap(Binary<OP, decltype(l), decltype(r)>(std::move(l), std::move(r)));
+        }
+
+        template <class OP, class L, class S> auto binary_scalar(const L& left, const S& right) {
+            auto l = node_of(left);
+            using scalar = Scalar<scalar_operand_t<S, typename decltype(l)::value_type>>;
+            return wrap(Binary<OP, decltype(l), scalar>(std::move(l), scalar(right)));
+        }
+
+        template <class OP, class S, class R> auto scalar_binary(const S& left, const R& right) {
+            auto r = node_of(right);
+            using scalar = Scalar<scalar_operand_t<S, typename decltype(r)::value_type>>;
+            return wrap(Binary<OP, scalar, decltype(r)>(scalar(left), std::move(r)));
+        }
+
+        template <class T, class NODE> void evaluate_compound(hoNDArray<T>& x, const NODE& y) {
+            if (y.size() > x.get_number_of_elements())
+                throw std::runtime_error("hoNDArray expression: result does not fit in the assigned array.");
+            evaluate(wrap(y), x);
+        }
+
+        constexpr size_t chunk_size         = size_t(1) << 14;
+        constexpr size_t parallel_threshold = size_t(1) << 16;
+
+        template <class T, class NODE> void evaluate_into(const NODE& node, T* output, size_t elements) {
+            auto out = reinterpret_cast<internal_type_t<T>*>(output);
+
+            long long chunks = (elements + chunk_size - 1) / chunk_size;
+#pragma omp parallel for schedule(static) if (elements >= parallel_threshold)
+            for (long long chunk = 0; chunk < chunks; chunk++) {
+                size_t end = std::min(elements, size_t(chunk + 1) * chunk_size);
+
+                for (size_t start = size_t(chunk) * chunk_size; start < end;) {
+                    size_t length = std::min(end - start, node.contiguous(start));
+                    auto cursor   = node.cursor(start);
+                    auto o        = out + start;
+#pragma omp simd
+                    for (long long j = 0; j < (long long)length; j++) {
+                        o[j] = internal_type_t<T>(cursor[j]);
+                    }
+                    start += length;
+                }
+            }
+        }
+    }
+
+    /**
+     * An unevaluated element-wise expression; converts to an hoNDArray of any type the result can be stored in.
+     */
+    template <class NODE> class hoNDArrayExpression {
+    public:
+        using value_type = typename NODE::value_type;
+
+        explicit hoNDArrayExpression(NODE node) : node(std::move(node)) {}
+
+        template <class T> operator hoNDArray<T>() const {
+            hoNDArray<T> result;
+            evaluate(*this, result);
+            return result;
+        }
+
+        const NODE node;
+    };
+
+    /**
+     * Evaluates an expression into output. Output is reused if it has the right number of elements, and
+     * (re)created with the dimensions of the largest operand otherwise. Output may be one of the operands.
+     */
+    template <class NODE, class T> void evaluate(const hoNDArrayExpression<NODE>& expression, hoNDArray<T>& output) {
+        auto& node    = expression.node;
+        auto elements = node.size();
+        node.validate(elements);
+
+        if (output.get_number_of_elements() != elements) {
+            // Output may be an operand; it can't be released until the expression has been evaluated.
+            hoNDArray<T> result(*node.dimensions());
+            Expressions::evaluate_into(node, result.data(), elements);
+            output = std::move(result);
+            return;
+        }
+        Expressions::evaluate_into(node, output.data(), elements);
+    }
+
+    template <class NODE> hoNDArray<typename NODE::value_type> evaluate(const hoNDArrayExpression<NODE>& expression) {
+        return expression;
+    }
+
+    template <class L, class R, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_operand_v<R>, int> = 0>
+    auto operator+(const L& left, const R& right) { return Expressions::binary<std::plus<>>(left, right); }
+
+    template <class L, class R, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_operand_v<R>, int> = 0>
+    auto operator-(const L& left, const R& right) { return Expressions::binary<std::minus<>>(left, right); }
+
+    template <class L, class R, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_operand_v<R>, int> = 0>
+    auto operator*(const L& left, const R& right) { return Expressions::binary<std::multiplies<>>(left, right); }
+
+    template <class L, class R, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_operand_v<R>, int> = 0>
+    auto operator/(const L& left, const R& right) { return Expressions::binary<std::divides<>>(left, right); }
+
+    template <class L, class S, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_scalar<S>::value, int> = 0>
+    auto operator+(const L& left, const S& right) { return Expressions::binary_scalar<std::plus<>>(left, right); }
+
+    template <class L, class S, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_scalar<S>::value, int> = 0>
+    auto operator-(const L& left, const S& right) { return Expressions::binary_scalar<std::minus<>>(left, right); }
+
+    template <class L, class S, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_scalar<S>::value, int> = 0>
+    auto operator*(const L& left, const S& right) { return Expressions::binary_scalar<std::multiplies<>>(left, right); }
+
+    template <class L, class S, std::enable_if_t<Expressions::is_operand_v<L> && Expressions::is_scalar<S>::value, int> = 0>
+    auto operator/(const L& left, const S& right) { return Expressions::binary_scalar<std::divides<>>(left, right); }
+
+    template <class S, class R, std::enable_if_t<Expressions::is_scalar<S>::value && Expressions::is_operand_v<R>, int> = 0>
+    auto operator+(const S& left, const R& right) { return Expressions::scalar_binary<std::plus<>>(left, right); }
+
+    template <class S, class R, std::enable_if_t<Expressions::is_scalar<S>::value && Expressions::is_operand_v<R>, int> = 0>
+    auto operator-(const S& left, const R& right) { return Expressions::scalar_binary<std::minus<>>(left, right); }
+
+    template <class S, class R, std::enable_if_t<Expressions::is_scalar<S>::value && Expressions::is_operand_v<R>, int> = 0>
+    auto operator*(const S& left, const R& right) { return Expressions::scalar_binary<std::multiplies<>>(left, right); }
+
+    template <class S, class R, std::enable_if_t<Expressions::is_scalar<S>::value && Expressions::is_operand_v<R>, int> = 0>
+    auto operator/(const S& left, const R& right) { return Expressions::scalar_binary<std::divides<>>(left, right); }
+
+    template <class E, std::enable_if_t<Expressions::is_operand_v<E>, int> = 0> auto operator-(const E& operand) {
+        auto n = Expressions::node_of(operand);
+        return Expressions::wrap(Expressions::Unary<Expressions::Negate, decltype(n)>(std::move(n)));
+    }
+
+    template <class NODE> auto conj(const hoNDArrayExpression<NODE>& operand) {
+        return Expressions::wrap(Expressions::Unary<Expressions::Conjugate, NODE>(operand.node));
+    }
+
+    template <class T> auto conj(const hoNDArray<T>& operand) {
+        return Expressions::wrap(Expressions::Unary<Expressions::Conjugate, Expressions::Leaf<T>>(Expressions::node(operand)));
+    }
+
+    /**
+     * Compound assignment evaluates the expression straight into the array. The expression may broadcast, but
+     * must not have more elements than the array.
+     */
+    template <class T, class NODE> hoNDArray<T>& operator+=(hoNDArray<T>& x, const hoNDArrayExpression<NODE>& y) {
+        Expressions::evaluate_compound(x, (x + y).node);
+        return x;
+    }
+
+    template <class T, class NODE> hoNDArray<T>& operator-=(hoNDArray<T>& x, const hoNDArrayExpression<NODE>& y) {
+        Expressions::evaluate_compound(x, (x - y).node);
+        return x;
+    }
+
+    template <class T, class NODE> hoNDArray<T>& operator*=(hoNDArray<T>& x, const hoNDArrayExpression<NODE>& y) {
+        Expressions::evaluate_compound(x, (x * y).node);
+        return x;
+    }
+
+    template <class T, class NODE> hoNDArray<T>& operator/=(hoNDArray<T>& x, const hoNDArrayExpression<NODE>& y) {
+        Expressions::evaluate_compound(x, (x / y).node);
+        return x;
+    }
+}
@@ -0,0 +1,228 @@
+#include "hoNDArray_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifndef __has_attribute
+#define __has_attribute(x) 0
+#endif
+
+// Builds each kernel for several instruction sets, and lets the loader pick the best one for the CPU at hand.
+#if defined(__x86_64__) && defined(__linux__) && __has_attribute(target_clones)
+#define GADGETRON_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define GADGETRON_SIMD_CLONES
+#endif
+
+namespace {
+
+    // Complex numbers are handled as interleaved real and imaginary parts, which the compiler vectorizes far
+    // more readily than std::complex arithmetic with its checks for infinities.
+    template <class T> const T* interleaved(const std::complex<T>* x) { return reinterpret_cast<const T*>(x); }
+    template <class T> T* interleaved(std::complex<T>* x) { return reinterpret_cast<T*>(x); }
+
+    template <class T>
+    inline void multiply_impl(const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r, size_t n) {
+        auto a = interleaved(x);
+        auto b = interleaved(y);
+        auto c = interleaved(r);
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            T re = a[2 * i] * b[2 * i] - a[2 * i + 1] * b[2 * i + 1];
+            T im = a[2 * i] * b[2 * i + 1] + a[2 * i + 1] * b[2 * i];
+            c[2 * i]     = re;
+            c[2 * i + 1] = im;
+        }
+    }
+
+    template <class T>
+    inline void multiply_conj_impl(const std::complex<T>* x, const std::complex<T>* y, std::complex<T>* r, size_t n) {
+        auto a = interleaved(x);
+        auto b = interleaved(y);
+        auto c = interleaved(r);
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            T re = a[2 * i] * b[2 * i] + a[2 * i + 1] * b[2 * i + 1];
+            T im = a[2 * i + 1] * b[2 * i] - a[2 * i] * b[2 * i + 1];
+            c[2 * i]     = re;
+            c[2 * i + 1] = im;
+        }
+    }
+
+    template <class T> inline void conjugate_impl(const std::complex<T>* x, std::complex<T>* r, size_t n) {
+        auto a = interleaved(x);
+        auto c = interleaved(r);
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            c[2 * i]     = a[2 * i];
+            c[2 * i + 1] = -a[2 * i + 1];
+        }
+    }
+
+    // Single precision magnitudes are computed in double precision, so that they neither overflow nor lose
+    // accuracy, just like std::abs. In double precision, only values beyond 1e154 would overflow.
+    template <class T> struct Accumulator { using type = T; };
+    template <> struct Accumulator<float> { using type = double; };
+
+    template <class T> inline void abs_impl(const std::complex<T>* x, T* r, size_t n) {
+        using A = typename Accumulator<T>::type;
+        auto a  = interleaved(x);
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            A re = a[2 * i];
+            A im = a[2 * i + 1];
+            r[i] = T(std::sqrt(re * re + im * im));
+        }
+    }
+
+    template <class T>
+    inline void unmix_impl(const std::complex<T>* weights, const std::complex<T>* data, std::complex<T>* result,
+                           size_t coils, size_t pixels, size_t stride) {
+        // 256 complex accumulators take 4 KiB in double precision, leaving most of L1 for the streamed inputs.
+        constexpr size_t block = 256;
+        alignas(64) T accumulator[2 * block];
+
+        for (size_t start = 0; start < pixels; start += block) {
+            size_t n = std::min(block, pixels - start);
+            std::fill(accumulator, accumulator + 2 * n, T(0));
+
+            for (size_t c = 0; c < coils; c++) {
+                auto w = interleaved(weights + c * stride + start);
+                auto x = interleaved(data + c * stride + start);
+#pragma omp simd aligned(accumulator : 64)
+                for (long long i = 0; i < (long long)n; i++) {
+                    accumulator[2 * i]     += w[2 * i] * x[2 * i] - w[2 * i + 1] * x[2 * i + 1];
+                    accumulator[2 * i + 1] += w[2 * i] * x[2 * i + 1] + w[2 * i + 1] * x[2 * i];
+                }
+            }
+
+            std::copy(accumulator, accumulator + 2 * n, interleaved(result + start));
+        }
+    }
+
+    template <class T> inline T magnitude(T x) { return std::abs(x); }
+    template <class T> inline T magnitude(std::complex<T> x) { return x.real() * x.real() + x.imag() * x.imag(); }
+
+    // Two passes; the first finds the extreme value with a vectorized reduction, the second finds where it is.
+    template <class T> inline size_t max_abs_index_impl(const T* x, size_t n) {
+        using R = decltype(magnitude(x[0]));
+        R best  = R(0);
+#pragma omp simd reduction(max : best)
+        for (long long i = 0; i < (long long)n; i++) {
+            best = std::max(best, magnitude(x[i]));
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (magnitude(x[i]) == best) return i;
+        }
+        return 0; // Only reached if the span contains NaNs.
+    }
+
+    template <class T> inline size_t min_abs_index_impl(const T* x, size_t n) {
+        using R = decltype(magnitude(x[0]));
+        R best  = std::numeric_limits<R>::infinity();
+#pragma omp simd reduction(min : best)
+        for (long long i = 0; i < (long long)n; i++) {
+            best = std::min(best, magnitude(x[i]));
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (magnitude(x[i]) == best) return i;
+        }
+        return 0;
+    }
+}
+
+namespace Gadgetron::Kernels {
+
+    GADGETRON_SIMD_CLONES void multiply(
+        const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r, size_t n) {
+        multiply_impl(x, y, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void multiply(
+        const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r, size_t n) {
+        multiply_impl(x, y, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void multiply_conj(
+        const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r, size_t n) {
+        multiply_conj_impl(x, y, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void multiply_conj(
+        const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r, size_t n) {
+        multiply_conj_impl(x, y, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void conjugate(const std::complex<float>* x, std::complex<float>* r, size_t n) {
+        conjugate_impl(x, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void conjugate(const std::complex<double>* x, std::complex<double>* r, size_t n) {
+        conjugate_impl(x, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void abs(const std::complex<float>* x, float* r, size_t n) {
+        abs_impl(x, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES void abs(const std::complex<double>* x, double* r, size_t n) {
+        abs_impl(x, r, n);
+    }
+
+    GADGETRON_SIMD_CLONES size_t max_abs_index(const float* x, size_t n) { return max_abs_index_impl(x, n); }
+    GADGETRON_SIMD_CLONES size_t max_abs_index(const double* x, size_t n) { return max_abs_index_impl(x, n); }
+    GADGETRON_SIMD_CLONES size_t max_abs_index(const std::complex<float>* x, size_t n) {
+        return max_abs_index_impl(x, n);
+    }
+    GADGETRON_SIMD_CLONES size_t max_abs_index(const std::complex<double>* x, size_t n) {
+        return max_abs_index_impl(x, n);
+    }
+
+    GADGETRON_SIMD_CLONES size_t min_abs_index(const float* x, size_t n) { return min_abs_index_impl(x, n); }
+    GADGETRON_SIMD_CLONES size_t min_abs_index(const double* x, size_t n) { return min_abs_index_impl(x, n); }
+    GADGETRON_SIMD_CLONES size_t min_abs_index(const std::complex<float>* x, size_t n) {
+        return min_abs_index_impl(x, n);
+    }
+    GADGETRON_SIMD_CLONES size_t min_abs_index(const std::complex<double>* x, size_t n) {
+        return min_abs_index_impl(x, n);
+    }
+
+    GADGETRON_SIMD_CLONES void unmix(const std::complex<float>* weights, const std::complex<float>* data,
+                                     std::complex<float>* result, size_t coils, size_t pixels, size_t stride) {
+        unmix_impl(weights, data, result, coils, pixels, stride);
+    }
+
+    GADGETRON_SIMD_CLONES void unmix(const std::complex<double>* weights, const std::complex<double>* data,
+                                     std::complex<double>* result, size_t coils, size_t pixels, size_t stride) {
+        unmix_impl(weights, data, result, coils, pixels, stride);
+    }
+
+    GADGETRON_SIMD_CLONES void add_squared_difference(const float* x, const float* y, float* r, size_t n) {
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            float d = x[i] - y[i];
+            r[i] += d * d;
+        }
+    }
+
+    GADGETRON_SIMD_CLONES void add_squared_difference(
+        const std::complex<float>* x, const std::complex<float>* y, float* r, size_t n) {
+        auto a = interleaved(x);
+        auto b = interleaved(y);
+#pragma omp simd
+        for (long long i = 0; i < (long long)n; i++) {
+            float re = a[2 * i] - b[2 * i];
+            float im = a[2 * i + 1] - b[2 * i + 1];
+            r[i] += re * re + im * im;
+        }
+    }
+
+    std::string instruction_set() {
+#if defined(__x86_64__) && defined(__linux__) && __has_attribute(target_clones)
+        if (__builtin_cpu_supports("avx512f")) return "avx512f";
+        if (__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+        return "default";
+    }
+}
@@ -0,0 +1,95 @@
+/** \file   hoNDArray_kernels.h
+    \brief  Vectorized inner loops behind the element-wise functions and reductions on hoNDArrays.
+
+    Each kernel works on a single contiguous span, on the calling thread. Where the compiler supports it, the kernels
+    are built for AVX-512, AVX2 and baseline x86-64, and the best version for the running CPU is picked on first use.
+    Threading is up to the caller; parallel_chunks splits large arrays into spans across OpenMP threads.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace Gadgetron::Kernels {
+
+    /// Spans are at least this long when split across threads.
+    constexpr size_t chunk_size = size_t(1) << 14;
+    /// Arrays smaller than this are processed on the calling thread; starting threads would cost more than it saves.
+    constexpr size_t parallel_threshold = size_t(1) << 16;
+
+    /**
+     * Calls f(begin, end) for consecutive spans covering [0, elements), in parallel if there are enough elements.
+     */
+    template <class F> void parallel_chunks(size_t elements, F&& f) {
+        long long chunks = (elements + chunk_size - 1) / chunk_size;
+#pragma omp parallel for schedule(static) if (elements >= parallel_threshold)
+        for (long long chunk = 0; chunk < chunks; chunk++) {
+            f(size_t(chunk) * chunk_size, std::min(elements, size_t(chunk + 1) * chunk_size));
+        }
+    }
+
+    /**
+     * Sums partial(begin, end) over the same spans as parallel_chunks; arrays below the threshold are one span.
+     * Used to thread BLAS reductions, as the BLAS library itself may well be limited to a single thread.
+     */
+    template <class R, class F> R sum_chunks(size_t elements, F&& partial) {
+        if (elements < parallel_threshold)
+            return partial(0, elements);
+
+        std::vector<R> parts((elements + chunk_size - 1) / chunk_size);
+        parallel_chunks(elements, [&](size_t begin, size_t end) { parts[begin / chunk_size] = partial(begin, end); });
+        return std::accumulate(parts.begin(), parts.end(), R(0));
+    }
+
+    /// r = x * y
+    void multiply(const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r, size_t n);
+    void multiply(const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r, size_t n);
+
+    /// r = x * conj(y)
+    void multiply_conj(const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r, size_t n);
+    void multiply_conj(const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r, size_t n);
+
+    /// r = conj(x)
+    void conjugate(const std::complex<float>* x, std::complex<float>* r, size_t n);
+    void conjugate(const std::complex<double>* x, std::complex<double>* r, size_t n);
+
+    /// r = abs(x)
+    void abs(const std::complex<float>* x, float* r, size_t n);
+    void abs(const std::complex<double>* x, double* r, size_t n);
+
+    /**
+     * Index of the first element with the largest (or smallest) absolute value in a span of n > 0 elements.
+     * Complex values are compared by their squared magnitude, which orders them the same way without any sqrt.
+     */
+    size_t max_abs_index(const float* x, size_t n);
+    size_t max_abs_index(const double* x, size_t n);
+    size_t max_abs_index(const std::complex<float>* x, size_t n);
+    size_t max_abs_index(const std::complex<double>* x, size_t n);
+
+    size_t min_abs_index(const float* x, size_t n);
+    size_t min_abs_index(const double* x, size_t n);
+    size_t min_abs_index(const std::complex<float>* x, size_t n);
+    size_t min_abs_index(const std::complex<double>* x, size_t n);
+
+    /**
+     * Coil combination with per-pixel weights, as in GRAPPA unmixing:
+     * result[p] = sum over c of weights[c * stride + p] * data[c * stride + p], for p < pixels.
+     * Pixels are processed in blocks that stay in L1 cache while the coils are accumulated.
+     */
+    void unmix(const std::complex<float>* weights, const std::complex<float>* data, std::complex<float>* result,
+               size_t coils, size_t pixels, size_t stride);
+    void unmix(const std::complex<double>* weights, const std::complex<double>* data, std::complex<double>* result,
+               size_t coils, size_t pixels, size_t stride);
+
+    /// r += |x - y|^2, as in patch distances
+    void add_squared_difference(const float* x, const float* y, float* r, size_t n);
+    void add_squared_difference(const std::complex<float>* x, const std::complex<float>* y, float* r, size_t n);
+
+    /// The instruction set the kernels run with on this CPU; "avx512f", "avx2" or "default".
+    std::string instruction_set();
+}
@@ -1,5 +1,8 @@
 #include "hoNDArray_reductions.h"
 #include "hoArmadillo.h"
+#include "hoNDArray_kernels.h"
+
+#include <functional>
 
 #ifndef lapack_int
 #define lapack_int int
@@ -15,6 +18,28 @@
 
 #define NumElementsUseThreading 64 * 1024
 
+namespace {
+    using namespace Gadgetron;
+
+    // Searches each chunk with the vectorized kernel, in parallel, then picks the best of the chunks.
+    // Ties go to the lowest index, as they would in a plain loop.
+    template <class T, class Search, class Better>
+    size_t find_absolute(const hoNDArray<T>& x, Search&& search, Better&& better) {
+        const T* pX = x.begin();
+        std::vector<size_t> candidates((x.size() + Kernels::chunk_size - 1) / Kernels::chunk_size);
+        Kernels::parallel_chunks(x.size(), [&](size_t begin, size_t end) {
+            candidates[begin / Kernels::chunk_size] = begin + search(pX + begin, end - begin);
+        });
+
+        size_t ind = candidates[0];
+        for (auto candidate : candidates) {
+            if (better(std::norm(pX[candidate]), std::norm(pX[ind])))
+                ind = candidate;
+        }
+        return ind;
+    }
+}
+
 namespace Gadgetron {
 
     // --------------------------------------------------------------------------------
@@ -94,28 +119,12 @@ namespace Gadgetron {
     // --------------------------------------------------------------------------------
 
     template <typename T> void minAbsolute(const hoNDArray<T>& x, T& r, size_t& ind) {
-        size_t N    = x.get_number_of_elements();
-        const T* pX = x.begin();
-
         ind = 0;
-        if (N == 0)
+        if (x.size() == 0)
             return;
 
-        long long n;
-
-        typename realType<T>::Type v = abs(pX[0]);
-        typename realType<T>::Type v2;
-
-        ind = 0;
-        for (n = 1; n < (long long)N; n++) {
-            v2 = std::abs(pX[n]);
-            if (v2 < v) {
-                v   = v2;
-                ind = n;
-            }
-        }
-
-        r = pX[ind];
+        ind = find_absolute(x, [](const T* data, size_t n) { return Kernels::min_abs_index(data, n); }, std::less<>());
+        r   = x[ind];
     }
 
     template  void minAbsolute(const hoNDArray<float>& x, float& r, size_t& ind);
@@ -139,28 +148,12 @@ namespace Gadgetron {
     // --------------------------------------------------------------------------------
 
     template <typename T> void maxAbsolute(const hoNDArray<T>& x, T& r, size_t& ind) {
-        size_t N    = x.get_number_of_elements();
-        const T* pX = x.begin();
-
         ind = 0;
-        if (N == 0)
+        if (x.size() == 0)
             return;
 
-        long long n;
-
-        typename realType<T>::Type v = abs(pX[0]);
-        typename realType<T>::Type v2;
-
-        ind = 0;
-        for (n = 1; n < (long long)N; n++) {
-            v2 = std::abs(pX[n]);
-            if (v2 > v) {
-                v   = v2;
-                ind = n;
-            }
-        }
-
-        r = pX[ind];
+        ind = find_absolute(x, [](const T* data, size_t n) { return Kernels::max_abs_index(data, n); }, std::greater<>());
+        r   = x[ind];
     }
 
     template  void maxAbsolute(const hoNDArray<float>& x, float& r, size_t& ind);
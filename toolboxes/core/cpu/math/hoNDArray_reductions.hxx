@@ -2,23 +2,36 @@
 
 #include "cpp_blas.h"
 #include "hoNDArray.h"
+#include "hoNDArray_kernels.h"
+
+#include <algorithm>
+#include <cmath>
 #include <complex>
+#include <vector>
 
 namespace Gadgetron {
     template<class T>
      T dot(const hoNDArray<T> *x, const hoNDArray<T> *y, bool cc) {
-        return BLAS::dot(x->get_number_of_elements(), x->get_data_ptr(), 1, y->get_data_ptr(), 1);
+        auto px = x->get_data_ptr();
+        auto py = y->get_data_ptr();
+        return Kernels::sum_chunks<T>(x->get_number_of_elements(), [&](size_t begin, size_t end) {
+            return BLAS::dot(end - begin, px + begin, 1, py + begin, 1);
+        });
     }
 
     template<class T>
      std::complex<T>
     dot(const hoNDArray<std::complex<T>> *x, const hoNDArray<std::complex<T>> *y,
                              bool cc) {
-        if (cc) {
-            return BLAS::dotc(x->get_number_of_elements(), x->get_data_ptr(), 1, y->get_data_ptr(), 1);
-        } else {
-            return BLAS::dotu(x->get_number_of_elements(), x->get_data_ptr(), 1, y->get_data_ptr(), 1);
-        }
+        auto px = x->get_data_ptr();
+        auto py = y->get_data_ptr();
+        return Kernels::sum_chunks<std::complex<T>>(x->get_number_of_elements(), [&](size_t begin, size_t end) {
+            if (cc) {
+                return BLAS::dotc(end - begin, px + begin, 1, py + begin, 1);
+            } else {
+                return BLAS::dotu(end - begin, px + begin, 1, py + begin, 1);
+            }
+        });
     }
 
 
@@ -28,7 +41,9 @@ namespace Gadgetron {
 
     template<class T>
      typename realType<T>::Type asum(const hoNDArray<T> *x) {
-        return BLAS::asum(x->get_number_of_elements(), x->get_data_ptr(), 1);
+        auto px = x->get_data_ptr();
+        return Kernels::sum_chunks<typename realType<T>::Type>(x->get_number_of_elements(),
+            [&](size_t begin, size_t end) { return BLAS::asum(end - begin, px + begin, 1); });
     }
 
     template<class T>
@@ -48,7 +63,26 @@ namespace Gadgetron {
 
     template<class T>
      typename realType<T>::Type nrm2(const hoNDArray<T> *x) {
-        return BLAS::nrm2(x->get_number_of_elements(), x->get_data_ptr(), 1);
+        using REAL = typename realType<T>::Type;
+        size_t N   = x->get_number_of_elements();
+        auto px    = x->get_data_ptr();
+        if (N < Kernels::parallel_threshold)
+            return BLAS::nrm2(N, px, 1);
+
+        // Combine the norms of the chunks, scaled by the largest of them to avoid overflow, as BLAS does.
+        std::vector<REAL> norms((N + Kernels::chunk_size - 1) / Kernels::chunk_size);
+        Kernels::parallel_chunks(N, [&](size_t begin, size_t end) {
+            norms[begin / Kernels::chunk_size] = BLAS::nrm2(end - begin, px + begin, 1);
+        });
+
+        REAL scale = *std::max_element(norms.begin(), norms.end());
+        if (scale == REAL(0))
+            return scale;
+
+        REAL sum = 0;
+        for (auto norm : norms)
+            sum += (norm / scale) * (norm / scale);
+        return scale * std::sqrt(sum);
     }
 
     template<class T>
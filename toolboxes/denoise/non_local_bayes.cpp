@@ -1,234 +1,352 @@
 #include "non_local_bayes.h"
 #include "hoNDArray.h"
-#include "vector_td_utilities.h"
-#include <GadgetronTimer.h>
+#include "hoNDArray_kernels.h"
 #include "hoArmadillo.h"
+#include <algorithm>
 #include <numeric>
+#include <stdexcept>
+
+#ifdef USE_OMP
+#include "omp.h"
+#endif // USE_OMP
 
 namespace Gadgetron {
     namespace Denoise {
 
         namespace {
 
-            template<class T>
-            arma::Col<T> get_patch(const hoNDArray<T> &image, int x, int y, int patch_size,
-                                   const vector_td<int, 2> &image_dims) {
+            int max_threads() {
+#ifdef USE_OMP
+                return omp_get_max_threads();
+#else
+                return 1;
+#endif // USE_OMP
+            }
 
-                const int N = patch_size * patch_size;
-                arma::Col<T> window = arma::Col<T>(N);
-                for (int ky = 0; ky < patch_size; ky++) {
-                    for (int kx = 0; kx < patch_size; kx++) {
-                        window[kx + ky * patch_size] = image(
-                                ((kx - patch_size / 2) + x + image_dims[0]) % image_dims[0],
-                                ((ky - patch_size / 2) + y + image_dims[1]) % image_dims[1]);
+            int wrap(int index, int size) {
+                return ((index % size) + size) % size;
+            }
 
+            // The image, periodically extended by margin pixels on every side. Patches near the edges, and candidate
+            // patches up to half a search window away, are then read as plain rows without wrapping any indices.
+            template<class T>
+            class PaddedImage {
+            public:
+                PaddedImage(const hoNDArray<T> &image, int margin) : margin(margin) {
+                    const int X = image.get_size(0), Y = image.get_size(1);
+                    width = X + 2 * margin;
+                    data.resize(size_t(width) * (Y + 2 * margin));
+
+                    for (int y = -margin; y < Y + margin; y++) {
+                        const T *source = &image(0, wrap(y, Y));
+                        T *destination = data.data() + size_t(y + margin) * width;
+                        for (int x = -margin; x < X + margin; x++) destination[x + margin] = source[wrap(x, X)];
                     }
                 }
-                return window;
-            };
-
 
+                const T *row(int x, int y) const {
+                    return data.data() + size_t(y + margin) * width + x + margin;
+                }
 
-            template<class T>
-            struct ImagePatch {
-                arma::Col<T> patch;
-                int center_x, center_y;
+            private:
+                int margin, width;
+                std::vector<T> data;
             };
 
+            // The positions of the reference patches along one dimension; every step'th pixel, and always the last.
+            struct ReferenceGrid {
+                std::vector<int> positions;
+                std::vector<int> index_of; // Index into positions of each pixel, or -1 if it is not a reference.
 
-            template<class T>
-            std::vector<ImagePatch<T>>
-            create_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window,
-                           const vector_td<int, 2> &image_dims) {
-
-                std::vector<ImagePatch<T>> result;
-                result.reserve(search_window);
-
-                for (int dy = std::max(ky - search_window / 2, 0);
-                     dy < std::min(search_window / 2 + ky, image_dims[1]); dy++) {
-                    for (int dx = std::max(kx - search_window / 2, 0);
-                         dx < std::min(search_window / 2 + kx, image_dims[0]); dx++) {
-
-                        result.push_back(ImagePatch<T>{get_patch(image, dx, dy, patch_size, image_dims), dx, dy});
-                    }
+                ReferenceGrid(int size, int step) : index_of(size, -1) {
+                    for (int position = 0; position < size; position += step) positions.push_back(position);
+                    if (positions.back() != size - 1) positions.push_back(size - 1);
+                    for (size_t i = 0; i < positions.size(); i++) index_of[positions[i]] = int(i);
                 }
-
-                return result;
-
             };
 
+            struct Tile {
+                int x0, x1, y0, y1; // Reference grid indices, [x0, x1) by [y0, y1).
+            };
 
             template<class T>
-            void add_patch(ImagePatch<T> &patch, hoNDArray<T> &image, hoNDArray<int> &count, int patch_size,
-                           const vector_td<int, 2> &image_dims) {
+            struct Accumulator {
+                std::vector<T> sum;
+                std::vector<float> count;
 
+                explicit Accumulator(size_t elements) : sum(elements, T(0)), count(elements, 0.0f) {}
 
-                for (int ky = 0; ky < patch_size; ky++) {
-                    auto output_ky = (patch.center_y + ky - patch_size / 2 + image_dims[1]) % image_dims[1];
-                    for (int kx = 0; kx < patch_size; kx++) {
-                        auto output_kx = (patch.center_x + kx - patch_size / 2 + image_dims[0]) % image_dims[0];
-                        image(output_kx, output_ky) += patch.patch[kx + ky * patch_size];
-                        count(output_kx, output_ky)++;
-                    }
+                Accumulator &operator+=(const Accumulator &other) {
+                    for (size_t i = 0; i < sum.size(); i++) sum[i] += other.sum[i];
+                    for (size_t i = 0; i < count.size(); i++) count[i] += other.count[i];
+                    return *this;
                 }
-
             };
 
-
             template<class T>
-            float distance(const arma::Col<T> &patch1, const arma::Col<T> &patch2) {
-                arma::Col<T> diff = patch1 - patch2;
+            class NonLocalBayes {
+            public:
+                NonLocalBayes(const hoNDArray<T> &image, float noise_std, const NonLocalBayesSettings &settings)
+                        : settings(settings),
+                          noise_std(noise_std),
+                          X(image.get_size(0)),
+                          Y(image.get_size(1)),
+                          half_patch(settings.patch_size / 2),
+                          search_begin(-int(settings.search_window / 2)),
+                          search_width(settings.search_window),
+                          padded(image, settings.search_window / 2 + settings.patch_size),
+                          grid_x(X, settings.reference_step),
+                          grid_y(Y, settings.reference_step) {}
+
+                hoNDArray<T> operator()(const hoNDArray<T> &image, bool parallel) const {
+
+                    std::vector<Tile> tiles;
+                    const int tile_size = settings.tile_size;
+                    for (int y0 = 0; y0 < int(grid_y.positions.size()); y0 += tile_size) {
+                        for (int x0 = 0; x0 < int(grid_x.positions.size()); x0 += tile_size) {
+                            tiles.push_back(Tile{
+                                    x0, std::min<int>(x0 + tile_size, grid_x.positions.size()),
+                                    y0, std::min<int>(y0 + tile_size, grid_y.positions.size())
+                            });
+                        }
+                    }
 
-                float result = 0;
-                for (auto d : diff) result += std::norm(d);
+                    Accumulator<T> total(size_t(X) * Y);
 
-                result /= patch1.size() * patch1.size();
-                return result;
-            };
+                    // Every thread aggregates its patch groups on its own, and the results are added up in the end.
+#pragma omp parallel if (parallel)
+                    {
+                        Accumulator<T> accumulator(size_t(X) * Y);
+                        Workspace workspace;
 
-            template<class T>
-            arma::Col<T> get_mean_patch(const std::vector<ImagePatch<T>> &patches) {
+#pragma omp for schedule(dynamic)
+                        for (int tile = 0; tile < int(tiles.size()); tile++) {
+                            process_tile(tiles[tile], workspace, accumulator);
+                        }
 
-                auto mean_patch = arma::Col<T>(patches.front().patch.size(), arma::fill::zeros);
+#pragma omp critical
+                        total += accumulator;
+                    }
 
-                for (auto &patch : patches) {
-                    mean_patch += patch.patch;
+                    hoNDArray<T> result(image.dimensions());
+                    for (size_t i = 0; i < result.get_number_of_elements(); i++) {
+                        result[i] = total.count[i] > 0 ? total.sum[i] / total.count[i] : image[i];
+                    }
+                    return result;
                 }
 
-                mean_patch /= patches.size();
-
-                return mean_patch;
-            }
-
-            template<class T>
-            arma::Mat<T>
-            get_covariance_matrix(const std::vector<ImagePatch<T>> &patches, const arma::Col<T> &mean_patch) {
-
-                auto covariance_matrix = arma::Mat<T>(mean_patch.size(), mean_patch.size(), arma::fill::zeros);
+            private:
+                struct Workspace {
+                    std::vector<float> distances;
+                    std::vector<float> squares;
+                    std::vector<float> columns;
+                    std::vector<std::pair<float, int>> candidates;
+                    std::vector<int> offsets;
+                    std::vector<char> done;
+                };
+
+                // Distances from every reference patch of the tile to the candidate patches at every offset in the
+                // search window, as [offset, reference]. For each offset, the squared differences over the tile are
+                // computed only once, and the column sums of a row of patches are shared by the neighbouring ones.
+                void compute_distances(const Tile &tile, Workspace &workspace) const {
+
+                    const int patch_size = settings.patch_size;
+                    const int references_x = tile.x1 - tile.x0, references_y = tile.y1 - tile.y0;
+                    const int references = references_x * references_y;
+
+                    const int xa = grid_x.positions[tile.x0] - half_patch;
+                    const int xb = grid_x.positions[tile.x1 - 1] - half_patch + patch_size;
+                    const int ya = grid_y.positions[tile.y0] - half_patch;
+                    const int yb = grid_y.positions[tile.y1 - 1] - half_patch + patch_size;
+                    const int width = xb - xa;
+
+                    workspace.distances.resize(size_t(search_width) * search_width * references);
+                    workspace.squares.resize(size_t(width) * (yb - ya));
+                    workspace.columns.resize(width);
+
+                    for (int oy = 0; oy < search_width; oy++) {
+                        for (int ox = 0; ox < search_width; ox++) {
+                            const int dx = search_begin + ox, dy = search_begin + oy;
+
+                            std::fill(workspace.squares.begin(), workspace.squares.end(), 0.0f);
+                            for (int y = ya; y < yb; y++) {
+                                Kernels::add_squared_difference(padded.row(xa, y), padded.row(xa + dx, y + dy),
+                                                                workspace.squares.data() + size_t(y - ya) * width,
+                                                                width);
+                            }
 
-                for (auto &patch : patches) {
-                    covariance_matrix += (patch.patch - mean_patch) * (patch.patch - mean_patch).t();
+                            float *distances = workspace.distances.data()
+                                               + (size_t(oy) * search_width + ox) * references;
+
+                            for (int ry = 0; ry < references_y; ry++) {
+                                const int top = grid_y.positions[tile.y0 + ry] - half_patch - ya;
+
+                                float *columns = workspace.columns.data();
+                                std::fill(columns, columns + width, 0.0f);
+                                for (int v = 0; v < patch_size; v++) {
+                                    const float *squares = workspace.squares.data() + size_t(top + v) * width;
+#pragma omp simd
+                                    for (int x = 0; x < width; x++) columns[x] += squares[x];
+                                }
+
+                                for (int rx = 0; rx < references_x; rx++) {
+                                    const int left = grid_x.positions[tile.x0 + rx] - half_patch - xa;
+                                    float distance = 0;
+                                    for (int u = 0; u < patch_size; u++) distance += columns[left + u];
+                                    distances[ry * references_x + rx] = distance;
+                                }
+                            }
+                        }
+                    }
                 }
-                covariance_matrix /= patches.size() - 1;
 
-                return covariance_matrix;
-            }
+                void process_tile(const Tile &tile, Workspace &workspace, Accumulator<T> &accumulator) const {
 
+                    compute_distances(tile, workspace);
 
-            template<class T>
-            void
-            filter_patches(std::vector<ImagePatch<T>> &patches, int max_n_patches, const arma::Col<T> &reference_patch) {
+                    const int references_x = tile.x1 - tile.x0, references_y = tile.y1 - tile.y0;
+                    const int references = references_x * references_y;
 
-                auto distances = std::vector<float>(patches.size());
-                transform(patches.begin(), patches.end(), distances.begin(),
-                          [&](auto patch) { return distance(patch.patch, reference_patch); });
+                    // Reference patches already denoised as part of a group are skipped, as in the original algorithm.
+                    workspace.done.assign(references, 0);
 
-                std::vector<size_t> patch_indices(patches.size());
-                std::iota(patch_indices.begin(), patch_indices.end(), 0);
+                    for (int ry = 0; ry < references_y; ry++) {
+                        for (int rx = 0; rx < references_x; rx++) {
+                            if (workspace.done[ry * references_x + rx]) continue;
 
-                sort(patch_indices.begin(), patch_indices.end(),
-                     [&](auto v1, auto v2) { return distances[v1] < distances[v2]; });
+                            const int x = grid_x.positions[tile.x0 + rx], y = grid_y.positions[tile.y0 + ry];
+                            const float *distances = workspace.distances.data() + ry * references_x + rx;
 
-                int n_patches = std::min<int>(patches.size(),max_n_patches);
-                std::vector<ImagePatch<T>> best_patches(n_patches);
-
-                for (int i = 0; i < n_patches; i++) {
-                    best_patches[i] = std::move(patches[patch_indices[i]]);
-                }
-
-                patches = std::move(best_patches);
-            }
-
-            template<class T>
-            bool is_homogenous_area(std::vector<ImagePatch<T>> &patches, float noise_std) {
+                            // Candidates are the patches centered inside the image, by distance and then offset.
+                            auto &candidates = workspace.candidates;
+                            candidates.clear();
+                            for (int oy = 0; oy < search_width; oy++) {
+                                const int cy = y + search_begin + oy;
+                                if (cy < 0 || cy >= Y) continue;
+                                for (int ox = 0; ox < search_width; ox++) {
+                                    const int cx = x + search_begin + ox;
+                                    if (cx < 0 || cx >= X) continue;
+                                    const int offset = oy * search_width + ox;
+                                    candidates.emplace_back(distances[size_t(offset) * references], offset);
+                                }
+                            }
 
-                float std2 = std::accumulate(patches.begin(), patches.end(), 0.0f,
-                                             [](auto cur, auto patch) {
-                                                 float std = arma::stddev(patch.patch);
-                                                 return cur + std * std;
-                                             }
-                ) * patches.size() / float(patches.size() - 1);
+                            const size_t n_patches = std::min<size_t>(candidates.size(), settings.max_patches);
+                            std::nth_element(candidates.begin(), candidates.begin() + n_patches - 1, candidates.end());
+                            std::sort(candidates.begin(), candidates.begin() + n_patches);
 
-                return std2 < noise_std * noise_std * 1.1;
-            }
+                            auto &offsets = workspace.offsets;
+                            offsets.resize(n_patches);
+                            for (size_t k = 0; k < n_patches; k++) offsets[k] = candidates[k].second;
 
+                            auto group = gather_patches(x, y, offsets);
+                            denoise_patches(group);
+                            add_patches(x, y, offsets, group, accumulator);
 
-            template<class T>
-            void denoise_patches(std::vector<ImagePatch<T>> &patches, float noise_std) {
-                auto mean_patch = get_mean_patch(patches);
-
-                if (is_homogenous_area(patches, noise_std)) {
-                    auto mean_value = arma::mean(mean_patch);
-                    for (auto &patch: patches) patch.patch.fill(mean_value);
-                    return;
+                            for (auto offset : offsets) {
+                                const int cx = x + search_begin + offset % search_width;
+                                const int cy = y + search_begin + offset / search_width;
+                                const int gx = grid_x.index_of[cx], gy = grid_y.index_of[cy];
+                                if (gx < tile.x0 || gx >= tile.x1 || gy < tile.y0 || gy >= tile.y1) continue;
+                                workspace.done[(gy - tile.y0) * references_x + gx - tile.x0] = 1;
+                            }
+                        }
+                    }
                 }
 
-                auto covariance_matrix = get_covariance_matrix(patches, mean_patch);
-                arma::Mat<T> noise_covariance = covariance_matrix + noise_std * noise_std * arma::eye<arma::Mat<T>>(
-                        arma::size(covariance_matrix));
-                auto inv_cov = arma::Mat<T>(arma::size(covariance_matrix));
-                if (inv(inv_cov, noise_covariance)) {
-                    for (auto &patch : patches) {
-                        patch.patch = mean_patch + inv_cov * covariance_matrix * (patch.patch - mean_patch);
+                // The patches of a group, one per column.
+                arma::Mat<T> gather_patches(int x, int y, const std::vector<int> &offsets) const {
+                    const int patch_size = settings.patch_size;
+                    arma::Mat<T> group(patch_size * patch_size, offsets.size());
+
+                    for (size_t k = 0; k < offsets.size(); k++) {
+                        const int cx = x + search_begin + offsets[k] % search_width;
+                        const int cy = y + search_begin + offsets[k] / search_width;
+                        T *patch = group.colptr(k);
+                        for (int v = 0; v < patch_size; v++) {
+                            const T *source = padded.row(cx - half_patch, cy - half_patch + v);
+                            std::copy(source, source + patch_size, patch + v * patch_size);
+                        }
                     }
+                    return group;
                 }
 
-            }
-
-            template<class T>
-            hoNDArray<T> non_local_bayes_single_image(const hoNDArray<T> &image, float noise_std, int search_window) {
-
-
-                if (image.get_number_of_dimensions() != 2)
-                    throw std::invalid_argument("non_local_bayes: image must be 2 dimensional");
-
-                constexpr int patch_size = 5;
-                constexpr int n_patches = 50;
-
-                hoNDArray<T> result(image.dimensions());
-                result.fill(0);
+                bool is_homogenous_area(const arma::Mat<T> &group) const {
+                    float std2 = 0;
+                    for (size_t k = 0; k < group.n_cols; k++) {
+                        float std = arma::stddev(group.col(k));
+                        std2 += std * std;
+                    }
+                    std2 *= group.n_cols / float(group.n_cols - 1);
 
-                hoNDArray<bool> mask(image.dimensions());
-                mask.fill(true);
+                    return std2 < noise_std * noise_std * 1.1;
+                }
 
-                hoNDArray<int> count(image.dimensions());
-                count.fill(0);
+                void denoise_patches(arma::Mat<T> &group) const {
+                    if (group.n_cols < 2) return;
 
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions())
-                );
+                    arma::Col<T> mean_patch = arma::mean(group, 1);
 
-#pragma omp parallel for num_threads(4)
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
+                    if (is_homogenous_area(group)) {
+                        group.fill(arma::mean(mean_patch));
+                        return;
+                    }
 
-                        if (mask(kx, ky)) {
-                            auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
-                            auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
+                    arma::Mat<T> centered = group.each_col() - mean_patch;
+                    arma::Mat<T> covariance_matrix = centered * centered.t() / T(group.n_cols - 1);
+                    arma::Mat<T> noise_covariance = covariance_matrix + noise_std * noise_std * arma::eye<arma::Mat<T>>(
+                            arma::size(covariance_matrix));
 
-                            filter_patches(patches, n_patches, reference_patch);
-                            denoise_patches(patches, noise_std);
+                    // mean + N^-1 C (P - mean) with N = C + s^2 I is the same as P - s^2 N^-1 (P - mean); a single
+                    // solve for the whole group takes the place of the inverse and the products with it.
+                    arma::Mat<T> correction;
+                    if (arma::solve(correction, noise_covariance, centered, arma::solve_opts::fast)) {
+                        group -= T(noise_std * noise_std) * correction;
+                    }
+                }
 
-                            for (auto &patch : patches) {
-                                #pragma omp critical
-                                add_patch(patch, result, count, patch_size, image_dims);
-                                mask(patch.center_x, patch.center_y) = false;
+                void add_patches(int x, int y, const std::vector<int> &offsets, const arma::Mat<T> &group,
+                                 Accumulator<T> &accumulator) const {
+                    const int patch_size = settings.patch_size;
+
+                    for (size_t k = 0; k < offsets.size(); k++) {
+                        const int cx = x + search_begin + offsets[k] % search_width;
+                        const int cy = y + search_begin + offsets[k] / search_width;
+                        const T *patch = group.colptr(k);
+
+                        for (int v = 0; v < patch_size; v++) {
+                            const size_t row = size_t(wrap(cy - half_patch + v, Y)) * X;
+                            for (int u = 0; u < patch_size; u++) {
+                                const size_t index = row + wrap(cx - half_patch + u, X);
+                                accumulator.sum[index] += patch[u + v * patch_size];
+                                accumulator.count[index] += 1;
                             }
                         }
                     }
                 }
 
-                for (size_t i = 0; i < result.get_number_of_elements(); i++) {
-                    result[i] /= count[i];
-                }
-
-                return result;
+                const NonLocalBayesSettings settings;
+                const float noise_std;
+                const int X, Y;
+                const int half_patch;
+                const int search_begin, search_width;
+                const PaddedImage<T> padded;
+                const ReferenceGrid grid_x, grid_y;
+            };
 
+            void validate(const NonLocalBayesSettings &settings) {
+                if (settings.patch_size == 0 || settings.search_window == 0 || settings.max_patches == 0 || settings.tile_size == 0)
+                    throw std::invalid_argument("non_local_bayes: patch size, search window, patches and tile size must be positive");
+                if (settings.reference_step == 0 || settings.reference_step > settings.patch_size)
+                    throw std::invalid_argument("non_local_bayes: reference step must be between 1 and the patch size");
             }
 
-
             template<class T>
-            hoNDArray<T> non_local_bayes_T(const hoNDArray<T> &image, float noise_std, unsigned int search_window) {
+            hoNDArray<T> non_local_bayes_T(const hoNDArray<T> &image, float noise_std, const NonLocalBayesSettings &settings) {
+
+                validate(settings);
+                if (image.get_number_of_dimensions() < 2)
+                    throw std::invalid_argument("non_local_bayes: image must be at least 2 dimensional");
 
                 size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
 
@@ -237,28 +355,43 @@ namespace Gadgetron {
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                hoNDArray<T> result_view;
-                result_view.create(image_dims);
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
+                // A series of images keeps every thread busy with images of its own; a few images are split in tiles.
+                const bool parallel_images = n_images >= size_t(max_threads());
+
+#pragma omp parallel for schedule(dynamic) if (parallel_images)
+                for (long long i = 0; i < (long long)n_images; i++) {
 
                     auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
+                    auto result_view = NonLocalBayes<T>(image_view, noise_std, settings)(image_view, !parallel_images);
 
-                    memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
+                    std::copy(result_view.begin(), result_view.end(), result.begin() + i * image_elements);
                 }
                 return result;
             }
+
+            NonLocalBayesSettings settings_from_search_window(unsigned int search_window) {
+                NonLocalBayesSettings settings;
+                settings.search_window = search_window;
+                return settings;
+            }
         }
 
+        hoNDArray<float> non_local_bayes(const hoNDArray<float> &image, float noise_std, const NonLocalBayesSettings &settings) {
+            return non_local_bayes_T(image, noise_std, settings);
+        }
+
+        hoNDArray<std::complex<float>>
+        non_local_bayes(const hoNDArray<std::complex<float>> &image, float noise_std, const NonLocalBayesSettings &settings) {
+            return non_local_bayes_T(image, noise_std, settings);
+        }
 
         hoNDArray<float> non_local_bayes(const hoNDArray<float> &image, float noise_std, unsigned int search_window) {
-            return non_local_bayes_T(image, noise_std, search_window);
+            return non_local_bayes_T(image, noise_std, settings_from_search_window(search_window));
         }
 
         hoNDArray<std::complex<float>>
         non_local_bayes(const hoNDArray<std::complex<float>> &image, float noise_std, unsigned int search_window) {
-            return non_local_bayes_T(image, noise_std, search_window);
+            return non_local_bayes_T(image, noise_std, settings_from_search_window(search_window));
         }
     }
 
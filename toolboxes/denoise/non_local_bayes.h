@@ -4,10 +4,31 @@
 #pragma once
 
 #include "hoNDArray.h"
+#include "denoise_export.h"
 
 namespace Gadgetron {
     namespace Denoise {
-        hoNDArray<float> non_local_bayes(const hoNDArray<float>& image, float noise_std=1.0f, unsigned int search_radius=25);
-        hoNDArray<std::complex<float>> non_local_bayes(const hoNDArray<std::complex<float>>& image, float noise_std=1.0f, unsigned int search_radius=25);
+
+        /**
+         * Settings of the non-local Bayes denoiser. The defaults reproduce the classic algorithm; for real-time use,
+         * a smaller search window, fewer patches per group or a reference step above 1 trade quality for speed.
+         */
+        struct NonLocalBayesSettings {
+            /// Similar patches are searched for in a window of this width, centered on the reference patch.
+            unsigned int search_window = 25;
+            unsigned int patch_size = 5;
+            /// Number of similar patches, including the reference itself, that are denoised together.
+            unsigned int max_patches = 50;
+            /// Only every reference_step'th pixel along each dimension is a reference patch; at most patch_size.
+            unsigned int reference_step = 1;
+            /// Images are split into tiles of tile_size x tile_size reference patches, which are processed in parallel.
+            unsigned int tile_size = 32;
+        };
+
+        EXPORTDENOISE hoNDArray<float> non_local_bayes(const hoNDArray<float>& image, float noise_std, const NonLocalBayesSettings& settings);
+        EXPORTDENOISE hoNDArray<std::complex<float>> non_local_bayes(const hoNDArray<std::complex<float>>& image, float noise_std, const NonLocalBayesSettings& settings);
+
+        EXPORTDENOISE hoNDArray<float> non_local_bayes(const hoNDArray<float>& image, float noise_std=1.0f, unsigned int search_radius=25);
+        EXPORTDENOISE hoNDArray<std::complex<float>> non_local_bayes(const hoNDArray<std::complex<float>>& image, float noise_std=1.0f, unsigned int search_radius=25);
     }
 }
@@ -2,9 +2,12 @@
 // Created by dchansen on 6/19/18.
 //
 
-#include <vector_td_utilities.h>
 #include <GadgetronTimer.h>
 #include "non_local_means.h"
+#include "hoNDArray_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 
 namespace Gadgetron {
@@ -12,98 +15,212 @@ namespace Gadgetron {
 
         namespace {
 
+            int wrap(int index, int size) {
+                return ((index % size) + size) % size;
+            }
 
-            template<class T, int D>
-            vector_td<T, D * D> get_patch(const hoNDArray<T> &image, int x, int y,
-                                          const vector_td<int, 2> &image_dims) {
-
-                constexpr int N = D * D;
-                vector_td<T, N> window;
-                for (int ky = 0; ky < D; ky++) {
-                    for (int kx = 0; kx < D; kx++) {
-                        window[kx + ky * D] = image(((kx - D / 2) + x + image_dims[0]) % image_dims[0],
-                                                    ((ky - D / 2) + y + image_dims[1]) % image_dims[1]);
-
+            // A frame, periodically extended by margin pixels on every side, so offset patches are read as plain rows.
+            template<class T>
+            class PaddedFrame {
+            public:
+                PaddedFrame(const T *frame, int X, int Y, int margin) : margin(margin), width(X + 2 * margin) {
+                    data.resize(size_t(width) * (Y + 2 * margin));
+
+                    for (int y = -margin; y < Y + margin; y++) {
+                        const T *source = frame + size_t(wrap(y, Y)) * X;
+                        T *destination = data.data() + size_t(y + margin) * width;
+                        for (int x = -margin; x < X + margin; x++) destination[x + margin] = source[wrap(x, X)];
                     }
                 }
-                return window;
+
+                const T *row(int x, int y) const {
+                    return data.data() + size_t(y + margin) * width + x + margin;
+                }
+
+            private:
+                int margin, width;
+                std::vector<T> data;
             };
 
+            struct Offset {
+                int frame, dx, dy;
+            };
 
+            // Non-local means over a series of frames. Rather than comparing every pair of patches on its own, the
+            // squared differences between a frame and a candidate frame at one offset are summed up in an integral
+            // image, from which the distance of every patch pair at that offset is read with four lookups.
             template<class T>
-            hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
+            class NonLocalMeans {
+            public:
+                NonLocalMeans(const T *frames, int n_frames, int X, int Y, float noise_std,
+                              const NonLocalMeansSettings &settings)
+                        : settings(settings),
+                          X(X),
+                          Y(Y),
+                          half_patch(settings.patch_size / 2),
+                          scale(1.0f / (noise_std * noise_std * settings.patch_size * settings.patch_size)) {
+                    const int margin = settings.search_radius + half_patch;
+                    for (int f = 0; f < n_frames; f++) padded.emplace_back(frames + size_t(f) * X * Y, X, Y, margin);
+                }
 
-                constexpr int D = 5;
+                void operator()(int frame, T *result) const {
 
-                hoNDArray<T> result(image.dimensions());
-                const float noise_std2 = noise_std * noise_std;
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions()));
+                    const int radius = settings.search_radius, temporal_radius = settings.temporal_radius;
+                    const int n_frames = padded.size();
 
-#pragma omp parallel for
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
-                        float sum_weight = 0;
-                        T sum_value = 0;
-                        auto window = get_patch<T, D>(image, kx, ky, image_dims);
+                    std::vector<Offset> offsets;
+                    for (int f = std::max(frame - temporal_radius, 0); f < std::min(frame + temporal_radius + 1, n_frames); f++)
+                        for (int dy = -radius; dy < radius; dy++)
+                            for (int dx = -radius; dx < radius; dx++)
+                                offsets.push_back(Offset{ f, dx, dy });
 
-                        for (int dy = -int(search_radius); dy < search_radius; dy++) {
-                            for (int dx = -int(search_radius); dx < search_radius; dx++) {
+                    std::vector<float> total_weights(size_t(X) * Y, 0.0f);
+                    std::vector<T> total_values(size_t(X) * Y, T(0));
 
-                                auto window2 = get_patch<T, D>(image, kx + dx, ky + dy, image_dims);
-                                auto diff = window - window2;
-                                auto weight = std::exp(-norm_squared(diff) / (noise_std2 * D * D));
+                    // Every thread sums up the weighted values of its own offsets, and the sums are added up in the end.
+#pragma omp parallel
+                    {
+                        Workspace workspace(X, Y, settings.patch_size);
 
-                                sum_weight += weight;
-                                sum_value += weight * window2[D / 2 + D * (D / 2)];
+#pragma omp for schedule(dynamic)
+                        for (int i = 0; i < int(offsets.size()); i++) {
+                            add_offset(frame, offsets[i], workspace);
+                        }
 
-                            }
+#pragma omp critical
+                        {
+                            for (size_t i = 0; i < total_weights.size(); i++) total_weights[i] += workspace.weights[i];
+                            for (size_t i = 0; i < total_values.size(); i++) total_values[i] += workspace.values[i];
                         }
+                    }
 
-                        result(kx, ky) = sum_value / sum_weight;
+                    for (size_t i = 0; i < total_values.size(); i++) result[i] = total_values[i] / total_weights[i];
+                }
 
+            private:
+                struct Workspace {
+                    std::vector<float> squares;
+                    std::vector<double> integral;
+                    std::vector<float> weights;
+                    std::vector<T> values;
+
+                    Workspace(int X, int Y, int patch_size)
+                            : squares(X + patch_size - 1),
+                              integral(size_t(X + patch_size) * (Y + patch_size), 0.0),
+                              weights(size_t(X) * Y, 0.0f),
+                              values(size_t(X) * Y, T(0)) {}
+                };
+
+                void add_offset(int frame, const Offset &offset, Workspace &workspace) const {
+
+                    const int patch_size = settings.patch_size;
+                    const PaddedFrame<T> &reference = padded[frame], &candidate = padded[offset.frame];
+
+                    // Squared differences over every pixel covered by a patch, [-half_patch, X + half_patch) by
+                    // [-half_patch, Y + half_patch). Row y + 1 of the integral image holds the sums over rows [0, y].
+                    // Double precision keeps the differences of the large sums exact enough.
+                    const int width = X + patch_size - 1, height = Y + patch_size - 1;
+                    const int stride = width + 1;
+                    float *squares = workspace.squares.data();
+
+                    for (int y = 0; y < height; y++) {
+                        std::fill(workspace.squares.begin(), workspace.squares.end(), 0.0f);
+                        Kernels::add_squared_difference(reference.row(-half_patch, y - half_patch),
+                                                        candidate.row(offset.dx - half_patch, y - half_patch + offset.dy),
+                                                        squares, width);
+
+                        const double *above = workspace.integral.data() + size_t(y) * stride;
+                        double *row = workspace.integral.data() + size_t(y + 1) * stride;
+                        double running = 0;
+                        for (int x = 0; x < width; x++) {
+                            running += squares[x];
+                            row[x + 1] = above[x + 1] + running;
+                        }
+                    }
+
+                    for (int y = 0; y < Y; y++) {
+                        const double *top = workspace.integral.data() + size_t(y) * stride;
+                        const double *bottom = workspace.integral.data() + size_t(y + patch_size) * stride;
+                        const T *centers = candidate.row(offset.dx, y + offset.dy);
+                        float *weights = workspace.weights.data() + size_t(y) * X;
+                        T *values = workspace.values.data() + size_t(y) * X;
+
+#pragma omp simd
+                        for (int x = 0; x < X; x++) {
+                            const float distance = float(bottom[x + patch_size] - bottom[x] - top[x + patch_size] + top[x]);
+                            const float weight = std::exp(-distance * scale);
+                            weights[x] += weight;
+                            values[x] += weight * centers[x];
+                        }
                     }
                 }
 
-                return result;
+                const NonLocalMeansSettings settings;
+                const int X, Y;
+                const int half_patch;
+                const float scale;
+                std::vector<PaddedFrame<T>> padded;
+            };
 
+            void validate(const NonLocalMeansSettings &settings) {
+                if (settings.search_radius == 0)
+                    throw std::invalid_argument("non_local_means: search radius must be positive");
+                if (settings.patch_size % 2 == 0)
+                    throw std::invalid_argument("non_local_means: patch size must be odd");
             }
 
             template<class T>
-            hoNDArray<T> non_local_means_T(const hoNDArray<T> &image, float noise_std, unsigned int search_radius) {
+            hoNDArray<T> non_local_means_T(const hoNDArray<T> &image, float noise_std, const NonLocalMeansSettings &settings) {
 
+                validate(settings);
+                if (image.get_number_of_dimensions() < 2)
+                    throw std::invalid_argument("non_local_means: image must be at least 2 dimensional");
 
                 GadgetronTimer timer("Non local means");
-                             size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
 
-                std::vector<size_t> image_dims = {image.get_size(0), image.get_size(1)};
-                size_t image_elements = image_dims[0] * image_dims[1];
+                const int X = image.get_size(0), Y = image.get_size(1);
+                const int n_frames = settings.temporal_radius > 0 && image.get_number_of_dimensions() > 2 ? image.get_size(2) : 1;
+                const size_t series_elements = size_t(X) * Y * n_frames;
+                const size_t n_series = image.get_number_of_elements() / series_elements;
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
-
-                    auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    auto result_view = non_local_means_single_image(image_view, noise_std,search_radius) ;
-
-                    memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
-                    GDEBUG_STREAM("I finished one");
+                // The offsets of each frame are spread over the threads, which keeps them all busy even for one image.
+                for (size_t s = 0; s < n_series; s++) {
+                    NonLocalMeans<T> non_local_means(image.get_data_ptr() + s * series_elements, n_frames, X, Y,
+                                                     noise_std, settings);
+                    for (int f = 0; f < n_frames; f++) {
+                        non_local_means(f, result.get_data_ptr() + s * series_elements + size_t(f) * X * Y);
+                    }
                 }
                 return result;
 
             }
+
+            NonLocalMeansSettings settings_from_search_radius(unsigned int search_radius) {
+                NonLocalMeansSettings settings;
+                settings.search_radius = search_radius;
+                return settings;
+            }
         }
 
 
+        hoNDArray<float> non_local_means(const hoNDArray<float> &image, float noise_std, const NonLocalMeansSettings &settings) {
+            return non_local_means_T(image, noise_std, settings);
+        }
+
+        hoNDArray<std::complex<float>>
+        non_local_means(const hoNDArray<std::complex<float>> &image, float noise_std, const NonLocalMeansSettings &settings) {
+            return non_local_means_T(image, noise_std, settings);
+        }
 
         hoNDArray<float> non_local_means(const hoNDArray<float> &image, float noise_std, unsigned int search_radius) {
-            return non_local_means_T(image, noise_std, search_radius);
+            return non_local_means_T(image, noise_std, settings_from_search_radius(search_radius));
         }
 
         hoNDArray<std::complex<float>>
         non_local_means(const hoNDArray<std::complex<float>> &image, float noise_std, unsigned int search_radius) {
-            return non_local_means_T(image, noise_std, search_radius);
+            return non_local_means_T(image, noise_std, settings_from_search_radius(search_radius));
         }
 
 
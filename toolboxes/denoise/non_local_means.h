@@ -6,6 +6,24 @@
 
 namespace Gadgetron {
     namespace Denoise {
+
+        /**
+         * Settings of the non-local means denoiser. Patch distances are computed from an integral image of the squared
+         * differences at each search offset, so their cost does not depend on the patch size.
+         */
+        struct NonLocalMeansSettings {
+            /// Candidate patches are offset by [-search_radius, search_radius) pixels along each dimension.
+            unsigned int search_radius = 25;
+            /// Width of the patches; must be odd.
+            unsigned int patch_size = 5;
+            /// For a dynamic series, with the frames along dimension 2, candidate patches are also taken from the
+            /// temporal_radius frames before and after. With 0, every image is denoised on its own.
+            unsigned int temporal_radius = 0;
+        };
+
+        EXPORTDENOISE hoNDArray<float> non_local_means(const hoNDArray<float>& image, float noise_std, const NonLocalMeansSettings& settings);
+        EXPORTDENOISE hoNDArray<std::complex<float>> non_local_means(const hoNDArray<std::complex<float>>& image, float noise_std, const NonLocalMeansSettings& settings);
+
         EXPORTDENOISE hoNDArray<float> non_local_means(const hoNDArray<float>& image, float noise_std, unsigned int search_radius);
         EXPORTDENOISE hoNDArray<std::complex<float>> non_local_means(const hoNDArray<std::complex<float>>& image, float noise_std, unsigned int search_radius);
     }
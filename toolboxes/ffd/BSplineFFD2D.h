@@ -568,8 +568,7 @@ bool BSplineFFD2D<T, CoordType, DOut>::refine()
 
         for ( d=0; d<DOut; d++ )
         {
-            this->ctrl_pt_[d].create(dim, spacing, origin, axis, new_ctrl_pt[d].begin(), true);
-            new_ctrl_pt[d].delete_data_on_destruct(false);
+            this->ctrl_pt_[d] = new_ctrl_pt[d];
         }
     }
     catch(...)
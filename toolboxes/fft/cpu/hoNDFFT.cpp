@@ -2,6 +2,7 @@
 // Include for Visual studio, 'cos reasons.
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstdio>
 #include <numeric>
 #include <set>
 
@@ -9,7 +10,11 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
 #include "hoNDFFT.h"
+#include "log.h"
+#include <atomic>
 #include <boost/container/flat_set.hpp>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace Gadgetron {
 
@@ -26,51 +31,131 @@ namespace Gadgetron {
         template <class T> struct fftw_types {};
 
         template <> struct fftw_types<float> {
-            using complex                      = fftwf_complex;
-            using plan                         = fftwf_plan_s;
-            static constexpr auto plan_guru    = fftwf_plan_guru64_dft;
-            static constexpr auto plan_dft     = fftwf_plan_dft;
-            static constexpr auto execute_dft  = fftwf_execute_dft;
-            static constexpr auto destroy_plan = fftwf_destroy_plan;
+            using complex                        = fftwf_complex;
+            using plan                           = fftwf_plan_s;
+            static constexpr auto plan_guru      = fftwf_plan_guru64_dft;
+            static constexpr auto plan_dft       = fftwf_plan_dft;
+            static constexpr auto execute_dft    = fftwf_execute_dft;
+            static constexpr auto destroy_plan   = fftwf_destroy_plan;
+            static constexpr auto alignment_of   = fftwf_alignment_of;
+            static constexpr auto malloc         = fftwf_malloc;
+            static constexpr auto free           = fftwf_free;
+            static constexpr auto import_wisdom  = fftwf_import_wisdom_from_filename;
+            static constexpr auto export_wisdom  = fftwf_export_wisdom_to_filename;
         };
 
         template <> struct fftw_types<double> {
-            using complex                      = fftw_complex;
-            using plan                         = fftw_plan_s;
-            static constexpr auto plan_guru    = fftw_plan_guru64_dft;
-            static constexpr auto plan_dft     = fftw_plan_dft;
-            static constexpr auto execute_dft  = fftw_execute_dft;
-            static constexpr auto destroy_plan = fftw_destroy_plan;
+            using complex                        = fftw_complex;
+            using plan                           = fftw_plan_s;
+            static constexpr auto plan_guru      = fftw_plan_guru64_dft;
+            static constexpr auto plan_dft       = fftw_plan_dft;
+            static constexpr auto execute_dft    = fftw_execute_dft;
+            static constexpr auto destroy_plan   = fftw_destroy_plan;
+            static constexpr auto alignment_of   = fftw_alignment_of;
+            static constexpr auto malloc         = fftw_malloc;
+            static constexpr auto free           = fftw_free;
+            static constexpr auto import_wisdom  = fftw_import_wisdom_from_filename;
+            static constexpr auto export_wisdom  = fftw_export_wisdom_to_filename;
         };
+
+        /**
+         * The FFTW planner is not thread safe, so all planning, plan destruction and wisdom handling is serialized
+         * through this lock. Executing an existing plan on new arrays is thread safe, and does not take the lock.
+         */
         class FFTLock {
         protected:
             static std::mutex lock;
         };
         std::mutex FFTLock::lock;
-        template <class T> class SingleFFTPlan : FFTLock {
+
+        unsigned int fftw_planning_flag(FFTPlanningRigor rigor) {
+            switch (rigor) {
+            case FFTPlanningRigor::Estimate: return FFTW_ESTIMATE;
+            case FFTPlanningRigor::Measure: return FFTW_MEASURE;
+            case FFTPlanningRigor::Patient: return FFTW_PATIENT;
+            }
+            throw std::runtime_error("Unknown FFT planning rigor");
+        }
+
+        /**
+         * Identifies a plan completely; two transforms with equal keys can share an FFTW plan.
+         * Alignment is reduced to a single flag - either every array the plan is executed on is SIMD aligned,
+         * or the plan is created with FFTW_UNALIGNED.
+         */
+        struct FFTPlanKey {
+            std::vector<int64_t> dims; // (n, is, os) triplets, in FFTW order.
+            bool forward;
+            bool in_place;
+            bool aligned;
+
+            bool operator==(const FFTPlanKey& other) const {
+                return forward == other.forward && in_place == other.in_place && aligned == other.aligned
+                    && dims == other.dims;
+            }
+        };
+
+        struct FFTPlanKeyHash {
+            size_t operator()(const FFTPlanKey& key) const {
+                size_t seed = (size_t(key.forward) << 2) | (size_t(key.in_place) << 1) | size_t(key.aligned);
+                for (auto d : key.dims)
+                    seed ^= std::hash<int64_t>()(d) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+
+        template <class T> class FFTPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
 
-            SingleFFTPlan(int dimension, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output,
-                bool forward) {
+            FFTPlan(const FFTPlanKey& key, const std::complex<T>* input, std::complex<T>* output,
+                FFTPlanningRigor rigor) {
                 std::lock_guard<std::mutex> guard(lock);
 
-                const auto& dimensions = input.dimensions();
-                size_t stride
-                    = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+                auto rank = key.dims.size() / 3;
+                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+                for (size_t i = 0; i < rank; i++) {
+                    fftw_dimensions[i] = { key.dims[3 * i], key.dims[3 * i + 1], key.dims[3 * i + 2] };
+                }
 
-                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+                unsigned int flags = fftw_planning_flag(rigor);
+                if (!key.aligned)
+                    flags |= FFTW_UNALIGNED;
+
+                if (rigor == FFTPlanningRigor::Estimate) {
+                    // FFTW_ESTIMATE never touches the arrays, so we can plan directly on the data.
+                    plan = fftw_types<T>::plan_guru(int(rank), fftw_dimensions.data(), 0, nullptr,
+                        (FFTWComplex*)input, (FFTWComplex*)output, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+                } else {
+                    // Measuring overwrites the arrays, so we plan on scratch buffers spanning the same elements.
+                    int64_t span = 1;
+                    for (auto& d : fftw_dimensions)
+                        span += (d.n - 1) * std::max(d.is, d.os);
+
+                    auto scratch_in = (FFTWComplex*)fftw_types<T>::malloc(sizeof(FFTWComplex) * span);
+                    auto scratch_out
+                        = key.in_place ? scratch_in : (FFTWComplex*)fftw_types<T>::malloc(sizeof(FFTWComplex) * span);
+
+                    plan = fftw_types<T>::plan_guru(int(rank), fftw_dimensions.data(), 0, nullptr, scratch_in,
+                        scratch_out, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+
+                    if (!key.in_place)
+                        fftw_types<T>::free(scratch_out);
+                    fftw_types<T>::free(scratch_in);
+                }
 
-                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                if (plan == nullptr)
+                    throw std::runtime_error("Illegal FFT plan created");
             }
 
-            ~SingleFFTPlan() {
+            ~FFTPlan() {
                 std::lock_guard<std::mutex> guard(lock);
                 fftw_types<T>::destroy_plan(plan);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
+            FFTPlan(const FFTPlan&) = delete;
+            FFTPlan& operator=(const FFTPlan&) = delete;
+
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
                 fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
             }
 
@@ -78,43 +163,257 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
-        template <class T> class ContigousFFTPlan : FFTLock {
+        /**
+         * Plans by key, holding at most a given number. Past that, the least recently used plan is dropped; the plan
+         * itself lives on as long as a thread still holds it.
+         *
+         * Use is stamped from a counter rather than kept in order, so a hit costs a single store, and is safe under a
+         * reader lock. Racing stamps may tie, which only makes the choice of plan to drop approximate. Finding the
+         * oldest plan takes a scan, but only when a plan is added - which costs a planning anyway.
+         */
+        template <class Plan> class FFTPlanMap {
         public:
-            using FFTWComplex = typename fftw_types<T>::complex;
-            ContigousFFTPlan(
-                int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            Plan find(const FFTPlanKey& key) const {
+                auto it = plans.find(key);
+                if (it == plans.end())
+                    return nullptr;
+                it->second.used.store(tick(), std::memory_order_relaxed);
+                return it->second.plan;
+            }
+
+            Plan insert(const FFTPlanKey& key, Plan plan, size_t max_plans) {
+                auto it = plans.find(key);
+                if (it != plans.end())
+                    return it->second.plan;
 
-                const auto& dimensions = input.dimensions();
+                trim(max_plans ? max_plans - 1 : 0);
+                plans.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                    std::forward_as_tuple(plan, tick()));
+                return plan;
+            }
+
+            void trim(size_t max_plans) {
+                while (plans.size() > max_plans) {
+                    auto oldest = std::min_element(plans.begin(), plans.end(), [](const auto& a, const auto& b) {
+                        return a.second.used.load(std::memory_order_relaxed)
+                             < b.second.used.load(std::memory_order_relaxed);
+                    });
+                    plans.erase(oldest);
+                }
+            }
 
-                auto strides = std::vector<size_t>(rank + 1, 1);
-                std::partial_sum(
-                    dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+            void clear() {
+                plans.clear();
+            }
 
-                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+            size_t size() const {
+                return plans.size();
+            }
+
+        private:
+            struct Entry {
+                Entry(Plan plan, uint64_t used) : plan(std::move(plan)), used(used) {}
+                Plan plan;
+                mutable std::atomic<uint64_t> used;
+            };
+
+            uint64_t tick() const {
+                auto now = clock.load(std::memory_order_relaxed) + 1;
+                clock.store(now, std::memory_order_relaxed);
+                return now;
+            }
 
-                for (int i = 0; i < rank; i++) {
-                    fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
+            mutable std::atomic<uint64_t> clock{ 0 };
+            std::unordered_map<FFTPlanKey, Entry, FFTPlanKeyHash> plans;
+        };
+
+        /**
+         * Process wide cache of FFTW plans. Each thread keeps a private map in front of the shared one, so repeated
+         * transforms of the same shape neither plan nor take any lock. The shared map is only consulted (under a
+         * reader lock) on a thread local miss, and the planner lock is only taken when a plan has to be created.
+         * Both maps hold at most max_plans plans, dropping the least recently used. The shared map only sees the
+         * misses of the thread local ones, so a plan used by a thread is dropped from it first; the thread keeps it.
+         *
+         * With a wisdom file set, the wisdom is saved there whenever a plan is measured, so a restarted process need
+         * not measure again; estimated plans add no wisdom.
+         */
+        template <class T> class FFTPlanCache : FFTLock {
+        public:
+            using Plan = std::shared_ptr<const FFTPlan<T>>;
+
+            static constexpr size_t default_max_plans = 256;
+
+            static FFTPlanCache& instance() {
+                static FFTPlanCache cache;
+                return cache;
+            }
+
+            Plan get(const FFTPlanKey& key, const std::complex<T>* input, std::complex<T>* output) {
+                thread_local FFTPlanMap<Plan> local_plans;
+                thread_local size_t local_generation = 0;
+
+                auto current_generation = generation.load(std::memory_order_acquire);
+                if (local_generation != current_generation) {
+                    local_plans.clear();
+                    local_generation = current_generation;
                 }
-                std::reverse(fftw_dimensions.begin(),fftw_dimensions.end());
-                plan = fftw_types<T>::plan_guru(rank, fftw_dimensions.data(), 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
 
-                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
+                if (auto local = local_plans.find(key))
+                    return local;
+
+                return local_plans.insert(key, get_shared(key, input, output), max_plans.load());
+            }
+
+            void clear() {
+                std::unique_lock<std::shared_mutex> guard(plans_mutex);
+                plans.clear();
+                generation.fetch_add(1, std::memory_order_release);
+            }
+
+            size_t size() const {
+                std::shared_lock<std::shared_mutex> guard(plans_mutex);
+                return plans.size();
+            }
+
+            // The thread local maps are dropped, rather than trimmed from another thread.
+            void set_max_plans(size_t new_max_plans) {
+                max_plans.store(new_max_plans);
+                std::unique_lock<std::shared_mutex> guard(plans_mutex);
+                plans.trim(new_max_plans);
+                generation.fetch_add(1, std::memory_order_release);
+            }
+
+            size_t get_max_plans() const {
+                return max_plans.load();
+            }
+
+            void set_rigor(FFTPlanningRigor new_rigor) {
+                rigor.store(new_rigor);
+                clear();
+            }
+
+            FFTPlanningRigor get_rigor() const {
+                return rigor.load();
             }
-            ~ContigousFFTPlan() {
+
+            bool import_wisdom(const std::string& filename) {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!fftw_types<T>::import_wisdom(filename.c_str()))
+                        return false;
+                }
+                clear();
+                return true;
+            }
+
+            bool export_wisdom(const std::string& filename) const {
                 std::lock_guard<std::mutex> guard(lock);
-                fftw_types<T>::destroy_plan(plan);
+                return export_wisdom_locked(filename);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
-                fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
+            void set_wisdom_file(const std::string& filename) {
+                std::lock_guard<std::mutex> guard(lock);
+                wisdom_file = filename;
             }
 
         private:
-            typename fftw_types<T>::plan* plan;
+            FFTPlanCache() = default;
+
+            Plan get_shared(const FFTPlanKey& key, const std::complex<T>* input, std::complex<T>* output) {
+                {
+                    std::shared_lock<std::shared_mutex> guard(plans_mutex);
+                    if (auto plan = plans.find(key))
+                        return plan;
+                }
+
+                auto plan_rigor = rigor.load();
+                auto plan       = std::make_shared<const FFTPlan<T>>(key, input, output, plan_rigor);
+                if (plan_rigor != FFTPlanningRigor::Estimate)
+                    save_wisdom();
+
+                std::unique_lock<std::shared_mutex> guard(plans_mutex);
+                return plans.insert(key, std::move(plan), max_plans.load());
+            }
+
+            // Written aside and renamed into place, so a reader never sees half the wisdom.
+            void save_wisdom() {
+                std::lock_guard<std::mutex> guard(lock);
+                if (wisdom_file.empty())
+                    return;
+
+                auto partial = wisdom_file + ".partial";
+                if (!export_wisdom_locked(partial) || std::rename(partial.c_str(), wisdom_file.c_str()) != 0)
+                    GWARN_STREAM("Failed to save FFTW wisdom to " << wisdom_file);
+            }
+
+            static bool export_wisdom_locked(const std::string& filename) {
+                return fftw_types<T>::export_wisdom(filename.c_str()) != 0;
+            }
+
+            mutable std::shared_mutex plans_mutex;
+            FFTPlanMap<Plan> plans;
+            std::atomic<size_t> generation{ 1 };
+            std::atomic<size_t> max_plans{ default_max_plans };
+            std::atomic<FFTPlanningRigor> rigor{ FFTPlanningRigor::Estimate };
+            std::string wisdom_file; // Guarded by the planner lock.
         };
 
+        template <class T> bool is_simd_aligned(const std::complex<T>* ptr) {
+            return fftw_types<T>::alignment_of(reinterpret_cast<T*>(const_cast<std::complex<T>*>(ptr))) == 0;
+        }
+
+        /**
+         * True if every pointer base + k * offset the plan will be executed on shares the alignment of the first.
+         */
+        template <class T>
+        bool batches_aligned(const std::complex<T>* input, const std::complex<T>* output,
+            std::initializer_list<size_t> batch_offsets) {
+            if (!is_simd_aligned(input) || !is_simd_aligned(output))
+                return false;
+            return std::all_of(batch_offsets.begin(), batch_offsets.end(), [&](auto offset) {
+                return is_simd_aligned(input + offset) && is_simd_aligned(output + offset);
+            });
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> single_fft_plan(int dimension, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+            size_t stride
+                = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, size_t(1), std::multiplies<>());
+            size_t outer_batchsize = stride * dimensions[dimension];
+
+            FFTPlanKey key;
+            key.dims     = { static_cast<int64_t>(dimensions[dimension]), static_cast<int64_t>(stride),
+                static_cast<int64_t>(stride) };
+            key.forward  = forward;
+            key.in_place = input.data() == output.data();
+            key.aligned  = batches_aligned(input.data(), output.data(),
+                { stride > 1 ? size_t(1) : size_t(0), outer_batchsize < input.size() ? outer_batchsize : 0 });
+
+            return FFTPlanCache<T>::instance().get(key, input.data(), output.data());
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> contigous_fft_plan(
+            int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+
+            auto strides = std::vector<size_t>(rank + 1, 1);
+            std::partial_sum(dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+
+            FFTPlanKey key;
+            for (int i = rank - 1; i >= 0; i--) {
+                key.dims.insert(key.dims.end(),
+                    { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] });
+            }
+            key.forward  = forward;
+            key.in_place = input.data() == output.data();
+            key.aligned  = batches_aligned(
+                input.data(), output.data(), { strides[rank] < input.size() ? strides[rank] : size_t(0) });
+
+            return FFTPlanCache<T>::instance().get(key, input.data(), output.data());
+        }
 
         int contigous_rank(const boost::container::flat_set<int>& dimensions) {
             if (!dimensions.count(0))
@@ -130,7 +429,7 @@ namespace Gadgetron {
         static void contigous_fftn(const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank,
             bool forward, bool normalize) {
 
-            auto plan = ContigousFFTPlan<T>(rank, input, output, forward);
+            auto plan = contigous_fft_plan<T>(rank, input, output, forward);
             size_t batch_size
                 = std::accumulate(input.dimensions().begin(), input.dimensions().begin() + rank, 1, std::multiplies<>());
             size_t batches = input.size() / batch_size;
@@ -138,7 +437,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan,  input, output, batches, batch_size)
             for (long long i = 0; i < batches; i++) {
 
-                plan.execute(input.data() + i * batch_size, output.data() + i * batch_size);
+                plan->execute(input.data() + i * batch_size, output.data() + i * batch_size);
             }
 
             if (normalize)
@@ -149,7 +448,7 @@ namespace Gadgetron {
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
             assert(dimension >= 0);
-            auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
+            auto plan              = single_fft_plan<T>(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
             size_t inner_batches
                 = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
@@ -160,7 +459,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan, a, r , outer_batches, inner_batches, outer_batchsize ) collapse(2)
             for (long long outer = 0; outer < outer_batches; outer++) {
                 for (long long inner = 0; inner < inner_batches; inner++) {
-                    plan.execute(
+                    plan->execute(
                         a.data() + inner + outer * outer_batchsize, r.data() + inner + outer * outer_batchsize);
                 }
             }
@@ -786,6 +1085,42 @@ namespace Gadgetron {
         }
     }
 
+    template <typename T> void hoNDFFT<T>::set_planning_rigor(FFTPlanningRigor rigor) {
+        FFTPlanCache<T>::instance().set_rigor(rigor);
+    }
+
+    template <typename T> FFTPlanningRigor hoNDFFT<T>::get_planning_rigor() const {
+        return FFTPlanCache<T>::instance().get_rigor();
+    }
+
+    template <typename T> bool hoNDFFT<T>::import_wisdom(const std::string& filename) {
+        return FFTPlanCache<T>::instance().import_wisdom(filename);
+    }
+
+    template <typename T> bool hoNDFFT<T>::export_wisdom(const std::string& filename) const {
+        return FFTPlanCache<T>::instance().export_wisdom(filename);
+    }
+
+    template <typename T> void hoNDFFT<T>::set_wisdom_file(const std::string& filename) {
+        FFTPlanCache<T>::instance().set_wisdom_file(filename);
+    }
+
+    template <typename T> void hoNDFFT<T>::set_max_cached_plans(size_t max_plans) {
+        FFTPlanCache<T>::instance().set_max_plans(max_plans);
+    }
+
+    template <typename T> size_t hoNDFFT<T>::max_cached_plans() const {
+        return FFTPlanCache<T>::instance().get_max_plans();
+    }
+
+    template <typename T> void hoNDFFT<T>::clear_plan_cache() {
+        FFTPlanCache<T>::instance().clear();
+    }
+
+    template <typename T> size_t hoNDFFT<T>::plan_cache_size() const {
+        return FFTPlanCache<T>::instance().size();
+    }
+
     template <typename T> void hoNDFFT<T>::fft(hoNDArray<ComplexType>* input, unsigned int dim_to_transform) {
         single_fft(dim_to_transform, *input, *input, true, true);
     }
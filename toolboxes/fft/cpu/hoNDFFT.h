@@ -13,6 +13,7 @@
 #include <fftw3.h>
 #include <iostream>
 #include <mutex>
+#include <string>
 
 #ifdef USE_OMP
 #include "omp.h"
@@ -20,6 +21,12 @@
 
 namespace Gadgetron {
 
+  /**
+   * How much effort FFTW spends on finding a plan. Plans are cached, so anything above Estimate
+   * only pays off for transform shapes that are repeated - which is the common case in reconstructions.
+   */
+  enum class FFTPlanningRigor { Estimate, Measure, Patient };
+
   namespace FFT {
 
 /**
@@ -124,6 +131,22 @@ dimensions Access using e.g. FFT<float>::instance()
 
         static hoNDFFT<T>* instance();
 
+        // Plans are cached per transform shape, direction, placement and alignment, and shared between threads.
+        // Changing the rigor or importing wisdom drops the cached plans. Past the maximum number of plans, the least
+        // recently used are dropped.
+        void set_planning_rigor(FFTPlanningRigor rigor);
+        FFTPlanningRigor get_planning_rigor() const;
+
+        bool import_wisdom(const std::string& filename);
+        bool export_wisdom(const std::string& filename) const;
+        // Saves the wisdom to the file whenever a plan is measured; an empty name stops saving.
+        void set_wisdom_file(const std::string& filename);
+
+        void set_max_cached_plans(size_t max_plans);
+        size_t max_cached_plans() const;
+        void clear_plan_cache();
+        size_t plan_cache_size() const;
+
         void fft(hoNDArray<ComplexType>* input, unsigned int dim_to_transform);
         void ifft(hoNDArray<ComplexType>* input, unsigned int dim_to_transform);
 
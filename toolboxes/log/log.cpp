@@ -6,10 +6,244 @@
 #include <time.h>
 #include <cstring>
 #include <chrono>
+#include <array>
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <new>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 
 namespace Gadgetron
 {
+  namespace {
+
+    struct LogRecord {
+      unsigned long long sequence;
+      std::string line;
+    };
+
+    /**
+       Ring buffer of formatted log lines from a single thread. Only the owning thread pushes and only the
+       writer thread pops, so neither side takes a lock.
+     */
+    class LogRing {
+    public:
+      static constexpr size_t capacity = 1024;
+
+      bool push(LogRecord&& record) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == capacity) return false;
+
+        slots_[head % capacity] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+      }
+
+      template<class F> size_t drain(F&& f) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+
+        for (size_t n = tail; n < head; n++) f(std::move(slots_[n % capacity]));
+        tail_.store(head, std::memory_order_release);
+        return head - tail;
+      }
+
+      ///Set when the owning thread exits; the writer drops the ring once it is empty
+      std::atomic<bool> abandoned{false};
+
+    private:
+      std::array<LogRecord, capacity> slots_;
+      std::atomic<size_t> head_{0};
+      std::atomic<size_t> tail_{0};
+    };
+  }
+
+  /**
+     Drains the rings of all logging threads, and writes their lines to stdout in the order they were logged.
+   */
+  class GadgetronLogger::Writer {
+  public:
+    Writer() : thread_(std::make_unique<std::thread>([this]() { this->run(); })) {
+#ifndef _WIN32
+      pthread_atfork(&Writer::prepare_fork, &Writer::parent_fork, &Writer::child_fork);
+#endif
+    }
+
+    ///Stops the background thread and writes what is left; anything pushed after this is written at once
+    void stop() {
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (stopped_) return;
+        stopped_ = true;
+      }
+      wake_.notify_one();
+      thread_->join();
+
+      synchronous_.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      write_pending();
+    }
+
+    void push(std::string&& line) {
+      auto& ring = *this->ring();
+
+      LogRecord record{ sequence_.fetch_add(1, std::memory_order_relaxed), std::move(line) };
+      while (!ring.push(std::move(record))) {
+        // The writer has fallen behind; wait for it rather than lose the message.
+        if (synchronous_.load()) write_pending();
+        wake_.notify_one();
+        std::this_thread::yield();
+      }
+      pushed_.fetch_add(1, std::memory_order_release);
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (synchronous_.load()) {
+        write_pending();
+      } else if (idle_.load(std::memory_order_relaxed) && idle_.exchange(false)) {
+        // Only the first line after the writer went idle wakes it
+        wake_.notify_one();
+      }
+    }
+
+    void flush() {
+      auto target = pushed_.load(std::memory_order_acquire);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (written_ >= target || stopped_) return;
+      wake_.notify_one();
+      flushed_.wait(lock, [&]() { return written_ >= target || stopped_; });
+    }
+
+  private:
+    struct RingHolder {
+      std::shared_ptr<LogRing> ring;
+      ~RingHolder() { if (ring) ring->abandoned = true; }
+    };
+
+    static std::shared_ptr<LogRing>& thread_ring() {
+      thread_local RingHolder holder;
+      return holder.ring;
+    }
+
+    std::shared_ptr<LogRing>& ring() {
+      auto& ring = thread_ring();
+      if (!ring) {
+        ring = std::make_shared<LogRing>();
+        std::lock_guard<std::mutex> guard(rings_mutex_);
+        rings_.push_back(ring);
+      }
+      return ring;
+    }
+
+    size_t write_pending() {
+      std::lock_guard<std::mutex> write_guard(write_mutex_);
+
+      batch_.clear();
+      {
+        std::lock_guard<std::mutex> guard(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [&](auto& ring) {
+          // A ring seen abandoned before it is drained will not be pushed to again.
+          bool abandoned = ring->abandoned.load();
+          ring->drain([&](LogRecord&& record) { batch_.push_back(std::move(record)); });
+          return abandoned;
+        }), rings_.end());
+      }
+
+      std::sort(batch_.begin(), batch_.end(), [](auto& a, auto& b) { return a.sequence < b.sequence; });
+      for (auto& record : batch_) fwrite(record.line.data(), 1, record.line.size(), stdout);
+      if (!batch_.empty()) fflush(stdout);
+
+      return batch_.size();
+    }
+
+    void run() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!stopped_) {
+        lock.unlock();
+        size_t count = write_pending();
+        lock.lock();
+
+        written_ += count;
+        flushed_.notify_all();
+
+        // While lines keep coming, let them gather for a moment rather than write them one at a time; a flush
+        // or a full ring cuts this short.
+        if (count) {
+          wake_.wait_for(lock, std::chrono::milliseconds(1));
+          continue;
+        }
+
+        idle_ = true;
+        wake_.wait_for(lock, std::chrono::milliseconds(100));
+        idle_ = false;
+      }
+    }
+
+#ifndef _WIN32
+    // A forked child has none of the threads of its parent. The writer's locks are held across the fork, so the
+    // child gets them in a consistent state, and the child starts a writer of its own. Lines still buffered at the
+    // fork are written by the parent.
+    static Writer* forking() { return GadgetronLogger::instance()->writer_.get(); }
+
+    static void prepare_fork() {
+      auto writer = forking();
+      writer->write_mutex_.lock();
+      writer->rings_mutex_.lock();
+      writer->mutex_.lock();
+    }
+
+    static void parent_fork() {
+      auto writer = forking();
+      writer->mutex_.unlock();
+      writer->rings_mutex_.unlock();
+      writer->write_mutex_.unlock();
+    }
+
+    static void child_fork() {
+      auto writer = forking();
+      writer->rings_.clear();
+      thread_ring() = nullptr;
+      writer->written_ = writer->pushed_.load();
+      writer->idle_ = false;
+
+      // Threads of the parent may have been waiting on these.
+      new (&writer->wake_) std::condition_variable();
+      new (&writer->flushed_) std::condition_variable();
+
+      writer->mutex_.unlock();
+      writer->rings_mutex_.unlock();
+      writer->write_mutex_.unlock();
+
+      if (writer->stopped_) return;
+      writer->thread_.release(); // Not a thread of this process; it can be neither joined nor detached.
+      writer->thread_ = std::make_unique<std::thread>([writer]() { writer->run(); });
+    }
+#endif
+
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::mutex rings_mutex_;
+
+    std::vector<LogRecord> batch_;
+    std::mutex write_mutex_;
+
+    std::atomic<unsigned long long> sequence_{0};
+    std::atomic<unsigned long long> pushed_{0};
+    std::atomic<bool> idle_{false};
+    std::atomic<bool> synchronous_{false};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    unsigned long long written_ = 0;
+    bool stopped_ = false;
+
+    std::unique_ptr<std::thread> thread_;
+  };
+
   GadgetronLogger* GadgetronLogger::instance()
   {
     if (!instance_) instance_ = new GadgetronLogger();
@@ -19,9 +253,15 @@ namespace Gadgetron
   GadgetronLogger* GadgetronLogger::instance_ = NULL;
 
   GadgetronLogger::GadgetronLogger()
-    : level_mask_(GADGETRON_LOG_LEVEL_MAX,false)
-    , print_mask_(GADGETRON_LOG_PRINT_MAX, false)
+    : level_mask_(0)
+    , print_mask_(0)
   {
+    // Messages are written from a background thread, unless asked not to
+    if (getenv(GADGETRON_LOG_SYNCHRONOUS_ENVIRONMENT) == NULL) {
+      writer_ = std::make_unique<Writer>();
+      atexit(&GadgetronLogger::shutdown);
+    }
+
     char* log_mask = getenv(GADGETRON_LOG_MASK_ENVIRONMENT);
     if ( log_mask != NULL) {
 
@@ -77,31 +317,64 @@ namespace Gadgetron
   }
 
 
+  void GadgetronLogger::shutdown()
+  {
+    // Writes out anything still buffered; messages logged after this are written synchronously
+    instance_->writer_->stop();
+  }
+
+  void GadgetronLogger::flush()
+  {
+    if (writer_) writer_->flush();
+  }
+
+  void GadgetronLogger::write(GadgetronLogLevel LEVEL, std::string&& line)
+  {
+    if (writer_) {
+      writer_->push(std::move(line));
+      if (LEVEL == GADGETRON_LOG_LEVEL_ERROR) writer_->flush();
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(m);
+    fwrite(line.data(), 1, line.size(), stdout);
+    fflush(stdout);
+  }
+
   void GadgetronLogger::log(GadgetronLogLevel LEVEL, const char* filename, int lineno, const char* cformatting, ...)
   {
     //Check if we should log this message
     if (!isLevelEnabled(LEVEL)) return;
 
-    std::unique_lock<std::mutex> lock(m);
     const char* fmt = cformatting;
     std::string fmt_str;
     bool append_cformatting_needed = false; //Will be set to true if we add any additional labels
 
     if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_DATETIME)) {
-      time_t rawtime;
-      struct tm * timeinfo;
-
       auto curtime= std::chrono::system_clock::now();
-      rawtime = std::chrono::system_clock::to_time_t(curtime);
-      timeinfo = localtime ( &rawtime );
+      time_t rawtime = std::chrono::system_clock::to_time_t(curtime);
+
+      // Converting to local time is slow, and the date only changes once a second
+      thread_local time_t formatted_time = -1;
+      thread_local char datestr[32];
+      if (rawtime != formatted_time) {
+        struct tm timeinfo;
+#ifdef _WIN32
+        localtime_s(&timeinfo, &rawtime);
+#else
+        localtime_r(&rawtime, &timeinfo);
+#endif
+        snprintf(datestr, sizeof(datestr), "%02d-%02d %02d:%02d:%02d",
+                 timeinfo.tm_mon+1, timeinfo.tm_mday,
+                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+        formatted_time = rawtime;
+      }
 
       auto duration = curtime.time_since_epoch();
       int micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() % 1000000;
 
       //Time the format MM-DD HH:MM:SS.uuu
-      char timestr[22];sprintf(timestr, "%02d-%02d %02d:%02d:%02d.%03d ",
-			       timeinfo->tm_mon+1, timeinfo->tm_mday,
-			       timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, micros/1000);
+      char timestr[48];snprintf(timestr, sizeof(timestr), "%s.%03d ", datestr, micros/1000);
 
       fmt_str += std::string(timestr);
       append_cformatting_needed = true;
@@ -153,73 +426,73 @@ namespace Gadgetron
       fmt = fmt_str.c_str();
     }
 
+    // Format on the calling thread, so the writer only has to copy bytes
+    char buffer[512];
     va_list args;
     va_start (args, cformatting);
-    vprintf(fmt, args);
+    int length = vsnprintf(buffer, sizeof(buffer), fmt, args);
     va_end (args);
-    fflush(stdout);
+    if (length < 0) return;
 
+    std::string line;
+    if (size_t(length) < sizeof(buffer)) {
+      line.assign(buffer, length);
+    } else {
+      line.resize(length + 1);
+      va_start (args, cformatting);
+      vsnprintf(&line[0], line.size(), fmt, args);
+      va_end (args);
+      line.resize(length);
+    }
+
+    write(LEVEL, std::move(line));
   }
 
   void GadgetronLogger::enableLogLevel(GadgetronLogLevel LEVEL)
   {
-    if (LEVEL < level_mask_.size()) {
-      level_mask_[LEVEL] = true;
+    if (LEVEL < GADGETRON_LOG_LEVEL_MAX) {
+      level_mask_ |= (1u << LEVEL);
     }
   }
 
   void GadgetronLogger::disableLogLevel(GadgetronLogLevel LEVEL)
   {
-    if (LEVEL < level_mask_.size()) {
-      level_mask_[LEVEL] = false;
+    if (LEVEL < GADGETRON_LOG_LEVEL_MAX) {
+      level_mask_ &= ~(1u << LEVEL);
     }
   }
 
-  bool GadgetronLogger::isLevelEnabled(GadgetronLogLevel LEVEL)
-  {
-    if (LEVEL >= level_mask_.size()) return false;
-    return level_mask_[LEVEL];
-  }
-
   void GadgetronLogger::enableAllLogLevels()
   {
-    level_mask_.assign(GADGETRON_LOG_LEVEL_MAX,true);
+    level_mask_ = (1u << GADGETRON_LOG_LEVEL_MAX) - 1;
   }
 
   void GadgetronLogger::disableAllLogLevels()
   {
-    level_mask_.assign(GADGETRON_LOG_LEVEL_MAX,false);
+    level_mask_ = 0;
   }
 
   void GadgetronLogger::enableOutputOption(GadgetronLogOutput OUTPUT)
   {
-    if (OUTPUT < print_mask_.size()) {
-      print_mask_[OUTPUT] = true;
+    if (OUTPUT < GADGETRON_LOG_PRINT_MAX) {
+      print_mask_ |= (1u << OUTPUT);
     }
   }
 
   void GadgetronLogger::disableOutputOption(GadgetronLogOutput OUTPUT)
   {
-    if (OUTPUT < print_mask_.size()) {
-      print_mask_[OUTPUT] = false;
-    }
-  }
-
-  bool GadgetronLogger::isOutputOptionEnabled(GadgetronLogOutput OUTPUT)
-  {
-    if (OUTPUT < print_mask_.size()) {
-      return print_mask_[OUTPUT];
+    if (OUTPUT < GADGETRON_LOG_PRINT_MAX) {
+      print_mask_ &= ~(1u << OUTPUT);
     }
-    return false;
   }
 
   void GadgetronLogger::enableAllOutputOptions()
   {
-    print_mask_.assign(GADGETRON_LOG_PRINT_MAX, true);
+    print_mask_ = (1u << GADGETRON_LOG_PRINT_MAX) - 1;
   }
 
   void GadgetronLogger::disableAllOutputOptions()
   {
-    print_mask_.assign(GADGETRON_LOG_PRINT_MAX, false);
+    print_mask_ = 0;
   }
 }
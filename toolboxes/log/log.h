@@ -3,13 +3,21 @@
 
 #include "log_export.h"
 
-#include <vector> //For mask fields
-
+#include <vector>
 #include <sstream> //For deprecated macros
 #include <mutex>
+#include <atomic>
+#include <memory>
 
 #define GADGETRON_LOG_MASK_ENVIRONMENT "GADGETRON_LOG_MASK"
 #define GADGETRON_LOG_FILE_ENVIRONMENT "GADGETRON_LOG_FILE"
+#define GADGETRON_LOG_SYNCHRONOUS_ENVIRONMENT "GADGETRON_LOG_SYNCHRONOUS"
+
+/// Log statements with a level below this are compiled out entirely (0 debug, 1 info, 2 warning, 3 error).
+/// Verbose statements are kept only when debug statements are.
+#ifndef GADGETRON_LOG_MIN_LEVEL
+#define GADGETRON_LOG_MIN_LEVEL 0
+#endif
 
 namespace Gadgetron
 {
@@ -39,6 +47,14 @@ namespace Gadgetron
     GADGETRON_LOG_PRINT_MAX           //!< All print options must have lower values than this
   };
 
+  /**
+     Whether statements of a log level are compiled in at all, see GADGETRON_LOG_MIN_LEVEL
+   */
+  constexpr bool isLogLevelCompiled(GadgetronLogLevel LEVEL)
+  {
+    return (LEVEL == GADGETRON_LOG_LEVEL_VERBOSE) ? (GADGETRON_LOG_MIN_LEVEL <= GADGETRON_LOG_LEVEL_DEBUG) : (LEVEL >= GADGETRON_LOG_MIN_LEVEL);
+  }
+
   /**
      Main logging utility class for the Gadgetron and associated toolboxes. 
 
@@ -86,6 +102,19 @@ namespace Gadgetron
      
      Any (or no) seperator is allowed between the levels and ourput options.
 
+     The macros check the log level before the message is formatted, so disabled statements
+     cost a single load. Levels below GADGETRON_LOG_MIN_LEVEL are removed at compile time.
+
+     Messages are formatted on the calling thread and handed to a background writer through
+     a lock free ring buffer per thread, so logging does not wait on stdout. Errors are
+     flushed before the log call returns, as they are often followed by a throw or an abort.
+     Setting the environment variable GADGETRON_LOG_SYNCHRONOUS writes every message directly
+     from the calling thread instead.
+
+     For structured output, the field macros append key=value pairs to the message:
+
+     GDEBUG_FIELDS("Pushed message", "peer", address, "emitted", count);
+
    */
   class EXPORTGADGETRONLOG GadgetronLogger
   {
@@ -96,32 +125,102 @@ namespace Gadgetron
     ///Generic log function. Use the logging macros for easy access to this function
     void log(GadgetronLogLevel LEVEL, const char* filename, int lineno, const char* cformatting, ...);
 
+    ///Log a message followed by key=value pairs, given as alternating keys and values. Use the field macros for easy access to this function
+    template <typename... FIELDS>
+    void log_fields(GadgetronLogLevel LEVEL, const char* filename, int lineno, const char* message, const FIELDS&... fields);
+
+    ///Wait until all messages logged so far have been written
+    void flush();
+
     void enableLogLevel(GadgetronLogLevel LEVEL);
     void disableLogLevel(GadgetronLogLevel LEVEL);
-    bool isLevelEnabled(GadgetronLogLevel LEVEL);
+    bool isLevelEnabled(GadgetronLogLevel LEVEL) const
+    {
+      return LEVEL < GADGETRON_LOG_LEVEL_MAX && ((level_mask_.load(std::memory_order_relaxed) >> LEVEL) & 1u);
+    }
     void enableAllLogLevels();
     void disableAllLogLevels();
 
     void enableOutputOption(GadgetronLogOutput OUTPUT);
     void disableOutputOption(GadgetronLogOutput OUTPUT);
-    bool isOutputOptionEnabled(GadgetronLogOutput OUTPUT);
+    bool isOutputOptionEnabled(GadgetronLogOutput OUTPUT) const
+    {
+      return OUTPUT < GADGETRON_LOG_PRINT_MAX && ((print_mask_.load(std::memory_order_relaxed) >> OUTPUT) & 1u);
+    }
     void enableAllOutputOptions();
     void disableAllOutputOptions();
 
   protected:
     GadgetronLogger();
     static GadgetronLogger* instance_;
-    std::vector<bool> level_mask_;
-    std::vector<bool> print_mask_;
+    std::atomic<unsigned int> level_mask_;
+    std::atomic<unsigned int> print_mask_;
     std::mutex m;
+
+    ///Background writer, null when logging synchronously
+    class Writer;
+    std::unique_ptr<Writer> writer_;
+
+    void write(GadgetronLogLevel LEVEL, std::string&& line);
+    static void shutdown();
+
+    static void append_fields(std::ostream& os) {}
+
+    template <typename KEY, typename VALUE, typename... FIELDS>
+    static void append_fields(std::ostream& os, const KEY& key, const VALUE& value, const FIELDS&... fields)
+    {
+      std::ostringstream str;
+      str << value;
+      const std::string& value_str = str.str();
+
+      os << ' ' << key << '=';
+      if (value_str.empty() || value_str.find_first_of(" \t\"=") != std::string::npos) {
+        os << '"';
+        for (char c : value_str) {
+          if (c == '"' || c == '\\') os << '\\';
+          os << c;
+        }
+        os << '"';
+      } else {
+        os << value_str;
+      }
+
+      append_fields(os, fields...);
+    }
   };
+
+  template <typename... FIELDS>
+  void GadgetronLogger::log_fields(GadgetronLogLevel LEVEL, const char* filename, int lineno, const char* message, const FIELDS&... fields)
+  {
+    static_assert(sizeof...(FIELDS) % 2 == 0, "Log fields must be given as key, value pairs");
+
+    std::ostringstream os;
+    os << message;
+    append_fields(os, fields...);
+    os << '\n';
+
+    log(LEVEL, filename, lineno, "%s", os.str().c_str());
+  }
 }
 
-#define GDEBUG(...)   Gadgetron::GadgetronLogger::instance()->log(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG,   __FILE__, __LINE__, __VA_ARGS__)
-#define GINFO(...)    Gadgetron::GadgetronLogger::instance()->log(Gadgetron::GADGETRON_LOG_LEVEL_INFO,    __FILE__, __LINE__, __VA_ARGS__)
-#define GWARN(...)    Gadgetron::GadgetronLogger::instance()->log(Gadgetron::GADGETRON_LOG_LEVEL_WARNING, __FILE__, __LINE__, __VA_ARGS__)
-#define GERROR(...)   Gadgetron::GadgetronLogger::instance()->log(Gadgetron::GADGETRON_LOG_LEVEL_ERROR,   __FILE__, __LINE__, __VA_ARGS__)
-#define GVERBOSE(...) Gadgetron::GadgetronLogger::instance()->log(Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE,   __FILE__, __LINE__, __VA_ARGS__)
+///True if statements of this log level should be formatted and logged
+#define GADGETRON_LOG_ENABLED(LEVEL) (Gadgetron::isLogLevelCompiled(LEVEL) && Gadgetron::GadgetronLogger::instance()->isLevelEnabled(LEVEL))
+
+#define GADGETRON_LOG(LEVEL, ...) (GADGETRON_LOG_ENABLED(LEVEL) ? Gadgetron::GadgetronLogger::instance()->log(LEVEL, __FILE__, __LINE__, __VA_ARGS__) : void())
+#define GADGETRON_LOG_FIELDS(LEVEL, ...) (GADGETRON_LOG_ENABLED(LEVEL) ? Gadgetron::GadgetronLogger::instance()->log_fields(LEVEL, __FILE__, __LINE__, __VA_ARGS__) : void())
+
+#define GDEBUG(...)   GADGETRON_LOG(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG,   __VA_ARGS__)
+#define GINFO(...)    GADGETRON_LOG(Gadgetron::GADGETRON_LOG_LEVEL_INFO,    __VA_ARGS__)
+#define GWARN(...)    GADGETRON_LOG(Gadgetron::GADGETRON_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define GERROR(...)   GADGETRON_LOG(Gadgetron::GADGETRON_LOG_LEVEL_ERROR,   __VA_ARGS__)
+#define GVERBOSE(...) GADGETRON_LOG(Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE, __VA_ARGS__)
+
+//Structured log functions, a message followed by key, value pairs
+#define GDEBUG_FIELDS(...)   GADGETRON_LOG_FIELDS(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG,   __VA_ARGS__)
+#define GINFO_FIELDS(...)    GADGETRON_LOG_FIELDS(Gadgetron::GADGETRON_LOG_LEVEL_INFO,    __VA_ARGS__)
+#define GWARN_FIELDS(...)    GADGETRON_LOG_FIELDS(Gadgetron::GADGETRON_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define GERROR_FIELDS(...)   GADGETRON_LOG_FIELDS(Gadgetron::GADGETRON_LOG_LEVEL_ERROR,   __VA_ARGS__)
+#define GVERBOSE_FIELDS(...) GADGETRON_LOG_FIELDS(Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE, __VA_ARGS__)
 
 #define GEXCEPTION(err, message);	  \
   {					  \
@@ -134,39 +233,49 @@ namespace Gadgetron
 //Stream syntax log level functions
 #define GINFO_STREAM(message)				\
   {							\
-    std::stringstream gadget_msg_dep_str;		\
-    gadget_msg_dep_str  << message << std::endl;	\
-    GINFO(gadget_msg_dep_str.str().c_str());		\
+    if (GADGETRON_LOG_ENABLED(Gadgetron::GADGETRON_LOG_LEVEL_INFO)) {		\
+      std::stringstream gadget_msg_dep_str;		\
+      gadget_msg_dep_str  << message << std::endl;	\
+      GINFO(gadget_msg_dep_str.str().c_str());		\
+    }		\
   }
 
 #define GVERBOSE_STREAM(message)					\
   {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GVERBOSE(gadget_msg_dep_str.str().c_str());			\
+    if (GADGETRON_LOG_ENABLED(Gadgetron::GADGETRON_LOG_LEVEL_VERBOSE)) {			\
+      std::stringstream gadget_msg_dep_str;			\
+      gadget_msg_dep_str  << message << std::endl;		\
+      GVERBOSE(gadget_msg_dep_str.str().c_str());			\
+    }			\
   }
 
 #ifndef MATLAB_MEX_COMPILE
 
 #define GDEBUG_STREAM(message)				\
 {							\
-    std::stringstream gadget_msg_dep_str;		\
-    gadget_msg_dep_str  << message << std::endl;	\
-    GDEBUG(gadget_msg_dep_str.str().c_str());		\
+    if (GADGETRON_LOG_ENABLED(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG)) {		\
+      std::stringstream gadget_msg_dep_str;		\
+      gadget_msg_dep_str  << message << std::endl;	\
+      GDEBUG(gadget_msg_dep_str.str().c_str());		\
+    }		\
 }
 
 #define GWARN_STREAM(message)					\
   {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GWARN(gadget_msg_dep_str.str().c_str());			\
+    if (GADGETRON_LOG_ENABLED(Gadgetron::GADGETRON_LOG_LEVEL_WARNING)) {			\
+      std::stringstream gadget_msg_dep_str;			\
+      gadget_msg_dep_str  << message << std::endl;		\
+      GWARN(gadget_msg_dep_str.str().c_str());			\
+    }			\
   }
 
 #define GERROR_STREAM(message)					\
   {								\
-    std::stringstream gadget_msg_dep_str;			\
-    gadget_msg_dep_str  << message << std::endl;		\
-    GERROR(gadget_msg_dep_str.str().c_str());			\
+    if (GADGETRON_LOG_ENABLED(Gadgetron::GADGETRON_LOG_LEVEL_ERROR)) {			\
+      std::stringstream gadget_msg_dep_str;			\
+      gadget_msg_dep_str  << message << std::endl;		\
+      GERROR(gadget_msg_dep_str.str().c_str());			\
+    }			\
   }
 
 #else
@@ -0,0 +1,225 @@
+/** \file   mri_core_calibration_cache.cpp
+    \brief  Implementation of the cache of parallel imaging calibration results
+*/
+
+#include "mri_core_calibration_cache.h"
+#include "io/primitives.h"
+#include "log.h"
+
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace Gadgetron {
+
+    namespace {
+        constexpr uint64_t file_magic = 0x3142494c41435447ull; // "GTCALIB1"
+
+        inline uint64_t mix(uint64_t hash, uint64_t word) {
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+            return hash ^ (hash >> 29);
+        }
+    }
+
+    CalibrationFingerprint& CalibrationFingerprint::add(const void* data, size_t bytes) {
+        auto pData = static_cast<const unsigned char*>(data);
+
+        // Word at a time; the reference data is megabytes, and hashing it must stay cheap next to a calibration.
+        size_t n;
+        for (n = 0; n + sizeof(uint64_t) <= bytes; n += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, pData + n, sizeof(uint64_t));
+            hash = mix(hash, word);
+        }
+
+        uint64_t tail = 0;
+        if (n < bytes)
+            std::memcpy(&tail, pData + n, bytes - n);
+        hash = mix(hash, tail ^ (uint64_t(bytes) << 56));
+        return *this;
+    }
+
+    uint64_t CalibrationFingerprint::value() const {
+        uint64_t h = hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // ------------------------------------------------------------------------
+
+    CalibrationCache& CalibrationCache::instance() {
+        static CalibrationCache cache;
+        return cache;
+    }
+
+    CalibrationCache::CalibrationCache(size_t capacity, std::string folder) : max_entries(capacity) {
+        set_folder(std::move(folder));
+    }
+
+    void CalibrationCache::set_capacity(size_t capacity) {
+        std::lock_guard<std::mutex> guard(mutex);
+        max_entries = capacity;
+        evict();
+    }
+
+    size_t CalibrationCache::capacity() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return max_entries;
+    }
+
+    bool CalibrationCache::enabled() const {
+        return capacity() > 0;
+    }
+
+    void CalibrationCache::set_folder(std::string new_folder) {
+        if (!new_folder.empty()) {
+            boost::system::error_code error;
+            boost::filesystem::create_directories(new_folder, error);
+            if (error) {
+                GWARN_STREAM("Calibration cache folder " << new_folder << " could not be created: " << error.message());
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        folder = std::move(new_folder);
+    }
+
+    bool CalibrationCache::lookup(uint64_t key, CalibrationResult& result) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (max_entries == 0)
+            return false;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            result = it->second->second;
+            hits++;
+            return true;
+        }
+
+        lock.unlock();
+        bool found = load(key, result);
+        lock.lock();
+
+        if (!found) {
+            misses++;
+            return false;
+        }
+
+        disk_hits++;
+        remember(key, result);
+        return true;
+    }
+
+    void CalibrationCache::insert(uint64_t key, const CalibrationResult& result) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (max_entries == 0)
+            return;
+
+        remember(key, result);
+
+        lock.unlock();
+        store(key, result);
+    }
+
+    void CalibrationCache::clear() {
+        std::lock_guard<std::mutex> guard(mutex);
+        entries.clear();
+        index.clear();
+    }
+
+    CalibrationCache::Statistics CalibrationCache::statistics() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return { hits, disk_hits, misses, evictions, entries.size() };
+    }
+
+    void CalibrationCache::remember(uint64_t key, const CalibrationResult& result) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            it->second->second = result;
+            return;
+        }
+
+        entries.emplace_front(key, result);
+        index[key] = entries.begin();
+        evict();
+    }
+
+    void CalibrationCache::evict() {
+        while (entries.size() > max_entries) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+            evictions++;
+        }
+    }
+
+    std::string CalibrationCache::filename(uint64_t key) const {
+        std::stringstream os;
+        os << folder << "/calibration_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return os.str();
+    }
+
+    bool CalibrationCache::load(uint64_t key, CalibrationResult& result) const {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (folder.empty())
+                return false;
+            name = filename(key);
+        }
+
+        std::ifstream file(name, std::ios::in | std::ios::binary);
+        if (!file.good())
+            return false;
+
+        try {
+            file.exceptions(std::ios::failbit | std::ios::badbit);
+            if (Core::IO::read<uint64_t>(file) != file_magic || Core::IO::read<uint64_t>(file) != key) {
+                GWARN_STREAM("Ignoring calibration cache file " << name << "; it does not belong to this key");
+                return false;
+            }
+            Core::IO::read(file, result.complex_arrays);
+            Core::IO::read(file, result.real_arrays);
+        } catch (const std::exception& e) {
+            GWARN_STREAM("Ignoring unreadable calibration cache file " << name << ": " << e.what());
+            return false;
+        }
+        return true;
+    }
+
+    void CalibrationCache::store(uint64_t key, const CalibrationResult& result) const {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (folder.empty())
+                return;
+            name = filename(key);
+        }
+
+        // Written under a temporary name and renamed, so readers in other processes never see half a file.
+        auto temporary = boost::filesystem::path(name + ".%%%%-%%%%-%%%%.tmp");
+        temporary      = boost::filesystem::unique_path(temporary);
+
+        try {
+            std::ofstream file(temporary.string(), std::ios::out | std::ios::binary);
+            file.exceptions(std::ios::failbit | std::ios::badbit);
+            Core::IO::write(file, file_magic);
+            Core::IO::write(file, key);
+            Core::IO::write(file, result.complex_arrays);
+            Core::IO::write(file, result.real_arrays);
+            file.close();
+            boost::filesystem::rename(temporary.string(), name);
+        } catch (const std::exception& e) {
+            GWARN_STREAM("Failed to write calibration cache file " << name << ": " << e.what());
+            boost::system::error_code ignored;
+            boost::filesystem::remove(temporary.string(), ignored);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/** \file   mri_core_calibration_cache.h
+    \brief  Cache of parallel imaging calibration results, keyed by a fingerprint of everything the calibration used.
+
+            Repeated protocols, like localizer re-runs or multi-repetition series, often send the very same reference
+            lines. Rather than recomputing kernels and unmixing coefficients, the recon can look them up here.
+*/
+
+#pragma once
+
+#include "mri_core_export.h"
+#include "hoNDArray.h"
+
+#include <complex>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron {
+
+    /// 64 bit hash of the reference data, geometry and parameters a calibration depends on.
+    class EXPORTMRICORE CalibrationFingerprint {
+    public:
+        CalibrationFingerprint& add(const void* data, size_t bytes);
+
+        template <class T, class = std::enable_if_t<std::is_arithmetic<T>::value>>
+        CalibrationFingerprint& add(T value) {
+            return add(&value, sizeof(T));
+        }
+
+        template <class T> CalibrationFingerprint& add(const hoNDArray<T>& array) {
+            add(array.get_number_of_dimensions());
+            for (auto d : array.dimensions()) add(d);
+            return add(array.data(), array.get_number_of_bytes());
+        }
+
+        uint64_t value() const;
+
+    private:
+        uint64_t hash = 0xcbf29ce484222325ull;
+    };
+
+    /// The arrays produced by one calibration. Which arrays, and in which order, is up to the caller.
+    struct EXPORTMRICORE CalibrationResult {
+        std::vector<hoNDArray<std::complex<float>>> complex_arrays;
+        std::vector<hoNDArray<float>> real_arrays;
+    };
+
+    /**
+     * Least recently used cache of calibration results, optionally backed by a folder on disk.
+     *
+     * The cache is off until given a capacity. Results are kept in memory up to that number of entries; if a folder
+     * is set, they are also written there, so they survive restarts of the server and can be shared between
+     * processes. All functions are thread safe.
+     */
+    class EXPORTMRICORE CalibrationCache {
+    public:
+        struct Statistics {
+            size_t hits;      /// Lookups answered from memory.
+            size_t disk_hits; /// Lookups answered from the folder on disk.
+            size_t misses;    /// Lookups that found nothing.
+            size_t evictions; /// Entries dropped from memory to stay within the capacity.
+            size_t entries;   /// Entries currently held in memory.
+        };
+
+        /// The cache shared by all gadgets in this process.
+        static CalibrationCache& instance();
+
+        explicit CalibrationCache(size_t capacity = 0, std::string folder = "");
+
+        /// Number of results kept in memory; 0 disables the cache.
+        void set_capacity(size_t entries);
+        size_t capacity() const;
+        bool enabled() const;
+
+        /// Folder results are written to and read from; empty to keep results in memory only.
+        void set_folder(std::string folder);
+
+        /// Copies the cached result for key into result, if there is one.
+        bool lookup(uint64_t key, CalibrationResult& result);
+        void insert(uint64_t key, const CalibrationResult& result);
+
+        void clear();
+        Statistics statistics() const;
+
+    private:
+        using Entries = std::list<std::pair<uint64_t, CalibrationResult>>;
+
+        std::string filename(uint64_t key) const;
+        bool load(uint64_t key, CalibrationResult& result) const;
+        void store(uint64_t key, const CalibrationResult& result) const;
+        void remember(uint64_t key, const CalibrationResult& result);
+        void evict();
+
+        mutable std::mutex mutex;
+        size_t max_entries;
+        std::string folder;
+
+        Entries entries;
+        std::unordered_map<uint64_t, Entries::iterator> index;
+
+        size_t hits = 0, disk_hits = 0, misses = 0, evictions = 0;
+    };
+}
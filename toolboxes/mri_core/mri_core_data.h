@@ -6,6 +6,8 @@
 #include "ismrmrd/meta.h"
 #include <vector>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include "hoNDArray.h"
 #include <boost/optional.hpp>
 #include "Types.h"
@@ -117,6 +119,11 @@ namespace Gadgetron
 
     SamplingDescription sampling_;
 
+    // data_ is in hybrid space: inverse Fourier transformed (centered) along E0, readout by readout, and still in
+    // k-space along E1 and E2. Set by AcquisitionAccumulateToBufferGadget; it is not serialized, so consumers that
+    // take data_ to be k-space, or pass it on where the flag is lost, check it with require_kspace.
+    bool hybrid_space_ = false;
+
     [[deprecated]]
     void clear()
     {
@@ -129,6 +136,16 @@ namespace Gadgetron
         if (this->headers_.delete_data_on_destruct()) headers_.clear();
     }
   };
+
+
+  /**
+     Throws if the data is in hybrid space, naming the consumer that cannot take it.
+   */
+  inline void require_kspace(const IsmrmrdDataBuffered& buffer, const std::string& consumer)
+  {
+      if (buffer.hybrid_space_)
+          throw std::runtime_error(consumer + " needs data in k-space; turn off transform_readouts in the accumulating gadget");
+  }
   
 
   /**
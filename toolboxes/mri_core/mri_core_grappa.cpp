@@ -28,6 +28,7 @@
 #include "hoNDArray_linalg.h"
 #include "hoNDFFT.h"
 #include "hoNDArray_utils.h"
+#include "hoNDArray_kernels.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
 #include "ImageIOAnalyze.h"
@@ -823,31 +824,18 @@ void grappa2d_image_domain_unwrapping_aliased_image(const hoNDArray<T>& aliasedI
 
         size_t num = aliasedIm.get_number_of_elements() / (RO*E1*srcCHA);
 
-        long long n;
+        // every unwrapped channel of every image is a coil combination with its own weights
+        long long tasks = (long long)(num*dstCHA);
+        long long ii;
 
-#pragma omp parallel default(none) private(n) shared(kerIm, num, aliasedIm, RO, E1, srcCHA, dstCHA, complexIm) if(num>=16)
+#pragma omp parallel for default(none) private(ii) shared(kerIm, tasks, aliasedIm, RO, E1, srcCHA, dstCHA, complexIm) if(tasks>=16)
+        for (ii = 0; ii < tasks; ii++)
         {
-            hoNDArray<T> unwrappedBuffer;
-            unwrappedBuffer.create(RO, E1, srcCHA);
-
-            hoNDArray<T> unwrappedIm2D;
-            unwrappedIm2D.create(RO, E1, 1);
+            size_t n = ii / dstCHA;
+            size_t dcha = ii - n*dstCHA;
 
-#pragma omp for 
-            for (n = 0; n < (long long)num; n++)
-            {
-                hoNDArray<T> bufIm(RO, E1, srcCHA, const_cast<T*>(aliasedIm.begin() + n*RO*E1*srcCHA));
-
-                for (size_t dcha = 0; dcha < dstCHA; dcha++)
-                {
-                    hoNDArray<T> kerSrcCha(RO, E1, srcCHA, const_cast<T*>(kerIm.begin() + dcha*RO*E1*srcCHA));
-
-                    Gadgetron::multiply(kerSrcCha, bufIm, unwrappedBuffer);
-                    Gadgetron::sum_over_dimension(unwrappedBuffer, unwrappedIm2D, 2);
-
-                    memcpy(complexIm.begin() + n*RO*E1*dstCHA + dcha*RO*E1, unwrappedIm2D.begin(), sizeof(T)*RO*E1);
-                }
-            }
+            Kernels::unmix(kerIm.begin() + dcha*RO*E1*srcCHA, aliasedIm.begin() + n*RO*E1*srcCHA,
+                complexIm.begin() + n*RO*E1*dstCHA + dcha*RO*E1, srcCHA, RO*E1, RO*E1);
         }
     }
     catch (...)
@@ -914,10 +902,21 @@ void apply_unmix_coeff_aliased_image(const hoNDArray<T>& aliasedIm, const hoNDAr
             complexIm.create(dim);
         }
 
-        hoNDArray<T> buffer2DT(aliasedIm);
+        size_t pixels = aliasedIm.get_size(0)*aliasedIm.get_size(1);
+        size_t CHA = aliasedIm.get_size(2);
+        size_t num = aliasedIm.get_number_of_elements() / (pixels*CHA);
+        size_t numCoeff = unmixCoeff.get_number_of_elements() / (pixels*CHA);
 
-        Gadgetron::multiply(aliasedIm, unmixCoeff, buffer2DT);
-        Gadgetron::sum_over_dimension(buffer2DT, complexIm, 2);
+        GADGET_CHECK_THROW(numCoeff > 0 && num % numCoeff == 0);
+
+        long long n;
+
+#pragma omp parallel for default(none) private(n) shared(aliasedIm, unmixCoeff, complexIm, pixels, CHA, num, numCoeff) if(num>=4)
+        for (n = 0; n < (long long)num; n++)
+        {
+            Kernels::unmix(unmixCoeff.begin() + (n % numCoeff)*pixels*CHA, aliasedIm.begin() + n*pixels*CHA,
+                complexIm.begin() + n*pixels, CHA, pixels, pixels);
+        }
     }
     catch (...)
     {
@@ -1819,15 +1818,21 @@ void apply_unmix_coeff_aliased_image_3D(const hoNDArray<T>& aliasedIm, const hoN
             complexIm.create(RO, E1, E2, N);
         }
 
-        hoNDArray<T> buffer;
-        buffer.create(dim);
+        size_t pixels = RO*E1*E2;
+        size_t num = N;
+        size_t numCoeff = unmixCoeff.get_number_of_elements() / (pixels*srcCHA);
 
-        Gadgetron::multiply(aliasedIm, unmixCoeff, buffer);
+        GADGET_CHECK_THROW(aliasedIm.get_number_of_elements() == pixels*srcCHA*N);
+        GADGET_CHECK_THROW(numCoeff > 0 && num % numCoeff == 0);
 
-        hoNDArray<T> bufferIm;
-        bufferIm.create(RO, E1, E2, 1, N, complexIm.begin());
+        long long n;
 
-        Gadgetron::sum_over_dimension(buffer, bufferIm, 3);
+#pragma omp parallel for default(none) private(n) shared(aliasedIm, unmixCoeff, complexIm, pixels, srcCHA, num, numCoeff) if(num>=4)
+        for (n = 0; n < (long long)num; n++)
+        {
+            Kernels::unmix(unmixCoeff.begin() + (n % numCoeff)*pixels*srcCHA, aliasedIm.begin() + n*pixels*srcCHA,
+                complexIm.begin() + n*pixels, srcCHA, pixels, pixels);
+        }
     }
     catch (...)
     {
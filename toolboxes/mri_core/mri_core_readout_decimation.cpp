@@ -0,0 +1,120 @@
+#include "mri_core_readout_decimation.h"
+#include "log.h"
+
+#include <cmath>
+
+namespace Gadgetron {
+
+    namespace {
+        // modified Bessel function of the first kind, order zero
+        double bessel_i0(double x) {
+            double sum = 1, term = 1;
+            for (int k = 1; k < 50; k++) {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum += term;
+                if (term < sum * 1e-16) break;
+            }
+            return sum;
+        }
+
+        const double kaiser_beta = 8.0;
+    }
+
+    ReadoutDecimator::ReadoutDecimator(size_t factor, size_t length) : factor_(factor), radius_(length / 2) {
+        GADGET_CHECK_THROW(factor >= 1);
+        GADGET_CHECK_THROW(length >= 2);
+
+        // Lowpass with its cutoff at the edge of the kept field of view. The filter is symmetric, so only the
+        // center and the taps at positive offsets are kept. For factor 2 this is a half-band filter, where every
+        // other tap is zero; those are left out too.
+        std::vector<double> h;
+        double total = 0;
+        for (long long n = 0; n <= radius_; n++) {
+            double x = double(n) / factor;
+            double sinc = (n == 0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+            double r = double(n) / (radius_ + 1);
+            double window = bessel_i0(kaiser_beta * std::sqrt(1 - r * r)) / bessel_i0(kaiser_beta);
+
+            double tap = sinc * window;
+            total += (n == 0) ? tap : 2 * tap;
+            if (n > 0 && std::abs(tap) < 1e-12) continue;
+
+            h.push_back(tap);
+            offsets_.push_back(n);
+        }
+
+        // Unit gain at the k-space center, times sqrt(factor) for the unitary FFTs of the shorter readout.
+        double scale = std::sqrt(double(factor)) / total;
+        for (auto tap : h) taps_.push_back(float(tap * scale));
+    }
+
+    void ReadoutDecimator::operator()(const hoNDArray<std::complex<float>>& data, hoNDArray<std::complex<float>>& res) {
+        const long long M = factor_;
+        const long long RO = data.get_size(0);
+        GADGET_CHECK_THROW(RO > 0 && RO % M == 0);
+
+        const long long dRO = RO / M;
+        const size_t CHA = data.get_number_of_elements() / RO;
+
+        std::vector<size_t> dims = data.dimensions();
+        dims[0] = dRO;
+        if (!res.dimensions_equal(&dims)) res.create(dims);
+
+        // Output sample m is at k-space position m - dRO/2 of the shorter readout, which is input sample
+        // RO/2 + M*(m - dRO/2). That is M*m + shift, where the shift is 0 for even dRO; for odd dRO it is not.
+        const long long shift = RO / 2 - M * (dRO / 2);
+        auto wrapped = [&](long long n) { return ((n + shift) % RO + RO) % RO; };
+
+        // Polyphase form: phase p holds the input samples M*k+p+shift, padded periodically by Q samples at both
+        // ends. Input sample M*m+n+shift is then sample m+q of phase p, with n = M*q+p, so every tap is applied
+        // to all outputs of a channel in one contiguous pass.
+        const long long Q = radius_ / M + 1;
+        const long long phase_length = dRO + 2 * Q;
+        buffer_.resize(2 * M * phase_length);
+
+        auto phase = [&](long long n) {
+            long long q = (n >= 0) ? n / M : -((-n + M - 1) / M);
+            long long p = n - q * M;
+            return &buffer_[2 * (p * phase_length + Q + q)];
+        };
+
+        const size_t num_taps = taps_.size();
+        std::vector<const float*> before(num_taps), after(num_taps);
+        for (size_t j = 0; j < num_taps; j++) {
+            before[j] = phase(-offsets_[j]);
+            after[j] = phase(offsets_[j]);
+        }
+
+        const long long length = 2 * dRO;
+
+        for (size_t c = 0; c < CHA; c++) {
+            const std::complex<float>* in = data.begin() + c * RO;
+
+            for (long long p = 0; p < M; p++) {
+                std::complex<float>* ph = reinterpret_cast<std::complex<float>*>(&buffer_[2 * p * phase_length]);
+                for (long long k = 0; k < dRO; k++) ph[k + Q] = in[wrapped(M * k + p)];
+
+                for (long long k = 0; k < Q; k++) {
+                    ph[k] = in[wrapped(M * (k - Q) + p)];
+                    ph[dRO + Q + k] = in[wrapped(M * (dRO + k) + p)];
+                }
+            }
+
+            float* out = reinterpret_cast<float*>(res.begin() + c * dRO);
+
+            const float center_tap = taps_[0];
+            const float* center = after[0];
+#pragma omp simd
+            for (long long f = 0; f < length; f++) out[f] = center_tap * center[f];
+
+            for (size_t j = 1; j < num_taps; j++) {
+                const float tap = taps_[j];
+                const float* b = before[j];
+                const float* a = after[j];
+
+#pragma omp simd
+                for (long long f = 0; f < length; f++) out[f] += tap * (b[f] + a[f]);
+            }
+        }
+    }
+}
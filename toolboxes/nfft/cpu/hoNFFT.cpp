@@ -317,19 +317,46 @@ namespace Gadgetron {
 
 
     namespace {
-        template<class REAL> void
-        matrix_vector_multiply(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL>& matrix, const complext<REAL>* vector, complext<REAL>* result) {
+        template<class REAL> complext<REAL>
+        column_dot(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL>& matrix, size_t column, const complext<REAL>* vector) {
 
-            for (size_t i = 0; i < matrix.n_cols; i++) {
-                auto &row_indices = matrix.indices[i];
-                auto &weights = matrix.weights[i];
+            const auto begin = matrix.offsets[column];
+            const auto end = matrix.offsets[column + 1];
+            const uint32_t* row_indices = matrix.indices.data();
+            const REAL* weights = matrix.weights.data();
+            const REAL* values = reinterpret_cast<const REAL*>(vector);
 
+            REAL real = 0;
+            REAL imag = 0;
 #ifndef WIN32
-    #pragma omp simd
+    #pragma omp simd reduction(+:real,imag)
 #endif // WIN32
-                for (size_t n = 0; n < row_indices.size(); n++) {
-                    result[i] += vector[row_indices[n]] * weights[n];
-                }
+            for (size_t n = begin; n < end; n++) {
+                const size_t row = row_indices[n];
+                real += values[2 * row] * weights[n];
+                imag += values[2 * row + 1] * weights[n];
+            }
+            return complext<REAL>(real, imag);
+        }
+
+        /**
+         * Computes result += matrix * vector for every batch. The work is split over both batches and columns,
+         * so a single large frame keeps all threads busy just as well as many small ones.
+         */
+        template<class REAL> void
+        batched_matrix_vector_multiply(const std::vector<Gadgetron::NFFT_internal::NFFT_Matrix<REAL>>& matrices,
+                                       const complext<REAL>* vectors, size_t vector_stride,
+                                       complext<REAL>* results, size_t result_stride, size_t nbatches) {
+
+            const long long n_cols = matrices.front().n_cols;
+            const long long total = n_cols * nbatches;
+
+#pragma omp parallel for schedule(static, 256)
+            for (long long k = 0; k < total; k++) {
+                const size_t b = k / n_cols;
+                const size_t i = k % n_cols;
+                const auto& matrix = matrices[b % matrices.size()];
+                results[b * result_stride + i] += column_dot(matrix, i, vectors + b * vector_stride);
             }
         }
 
@@ -340,19 +367,16 @@ namespace Gadgetron {
             hoNDArray<ComplexType> &non_cartesian, bool accumulate
     ) {
 
-        size_t nbatches = cartesian.get_number_of_elements()/convolution_matrix.front().n_rows;
-        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrix.front().n_cols);
+        const size_t n_rows = convolution_matrix.front().n_rows;
+        const size_t n_cols = convolution_matrix.front().n_cols;
+        size_t nbatches = cartesian.get_number_of_elements()/n_rows;
+        assert(nbatches == non_cartesian.get_number_of_elements()/n_cols);
 
         if (!accumulate) clear(&non_cartesian);
 
-#pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++) {
-
-            const ComplexType* cartesian_view = cartesian.get_data_ptr()+b*convolution_matrix.front().n_rows;
-            ComplexType* non_cartesian_view = non_cartesian.get_data_ptr()+b*convolution_matrix.front().n_cols;
-            size_t matrix_index = b%convolution_matrix.size();
-            matrix_vector_multiply(convolution_matrix[matrix_index],(complext<REAL>*)cartesian_view,(complext<REAL>*)non_cartesian_view);
-        }
+        batched_matrix_vector_multiply(convolution_matrix,
+                                       (const complext<REAL>*)cartesian.get_data_ptr(), n_rows,
+                                       (complext<REAL>*)non_cartesian.get_data_ptr(), n_cols, nbatches);
 
     }
 
@@ -361,18 +385,15 @@ namespace Gadgetron {
             const hoNDArray<ComplexType> &non_cartesian,
             hoNDArray<ComplexType> &cartesian, bool accumulate
     ) {
-                size_t nbatches = cartesian.get_number_of_elements()/convolution_matrix.front().n_rows;
-        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrix.front().n_cols);
+        const size_t n_rows = convolution_matrix.front().n_rows;
+        const size_t n_cols = convolution_matrix.front().n_cols;
+        size_t nbatches = cartesian.get_number_of_elements()/n_rows;
+        assert(nbatches == non_cartesian.get_number_of_elements()/n_cols);
         if (!accumulate) clear(&cartesian);
-#pragma omp parallel for
-        for (int b = 0; b < (int)nbatches; b++) {
 
-            ComplexType *cartesian_view = cartesian.get_data_ptr() + b * convolution_matrix.front().n_rows;
-            const ComplexType *non_cartesian_view = non_cartesian.get_data_ptr() + b * convolution_matrix.front().n_cols;
-            size_t matrix_index = b%convolution_matrix.size();
-            matrix_vector_multiply(convolution_matrix_T[matrix_index], (complext<REAL>*)non_cartesian_view, (complext<REAL>*)cartesian_view);
-
-        }
+        batched_matrix_vector_multiply(convolution_matrix_T,
+                                       (const complext<REAL>*)non_cartesian.get_data_ptr(), n_cols,
+                                       (complext<REAL>*)cartesian.get_data_ptr(), n_rows, nbatches);
     }
 
 
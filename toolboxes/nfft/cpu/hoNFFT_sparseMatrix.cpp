@@ -3,7 +3,10 @@
 //
 
 #include <GadgetronTimer.h>
+#include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <tuple>
 #include "hoNFFT_sparseMatrix.h"
 #include "KaiserBessel_kernel.h"
 #include "vector_td_utilities.h"
@@ -20,27 +23,45 @@ namespace {
     struct iteration_counter {
     };
 
+    template<class REAL>
+    int window_start(REAL point, REAL W) {
+        return std::ceil(point - W * 0.5);
+    }
+
+    template<class REAL>
+    int window_end(REAL point, REAL W) {
+        return std::floor(point + W * 0.5);
+    }
+
+    template<class REAL, unsigned int D>
+    size_t count_indices(const vector_td<REAL, D> &point, REAL W) {
+        size_t count = 1;
+        for (unsigned int d = 0; d < D; d++) {
+            count *= std::max(0, window_end(point[d], W) - window_start(point[d], W) + 1);
+        }
+        return count;
+    }
 
     template<class REAL, unsigned int D>
     void iterate_body(const vector_td<REAL, D> &point,
                       const vector_td<size_t, D> &matrix_size, REAL W, const vector_td<REAL, D> &beta,
-                      std::vector<size_t> &indices,
-                      std::vector<REAL> &weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<-1>) {
+                      uint32_t *&indices,
+                      REAL *&weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<-1>) {
 
-        indices.push_back(index);
-        weights.push_back(KaiserBessel(abs(image_point - point), vector_td<REAL,D>(matrix_size), REAL(1) / W, beta));
+        *indices++ = static_cast<uint32_t>(index);
+        *weights++ = KaiserBessel(abs(image_point - point), vector_td<REAL,D>(matrix_size), REAL(1) / W, beta);
 
     }
 
     template<class REAL, unsigned int D, int N>
     void iterate_body(const vector_td<REAL, D> &point,
                       const vector_td<size_t, D> &matrix_size, REAL W, const vector_td<REAL, D> &beta,
-                      std::vector<size_t> &indices,
-                      std::vector<REAL> &weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<N>) {
+                      uint32_t *&indices,
+                      REAL *&weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<N>) {
 
-        size_t frame_offset = std::accumulate(&matrix_size[0], &matrix_size[N], 1, std::multiplies<size_t>());
+        size_t frame_offset = std::accumulate(&matrix_size[0], &matrix_size[N], size_t(1), std::multiplies<size_t>());
 
-        for (int i = std::ceil(point[N] - W * 0.5); i <= std::floor(point[N] + W * 0.5); i++) {
+        for (int i = window_start(point[N], W); i <= window_end(point[N], W); i++) {
             auto wrapped_i = (i + matrix_size[N]) % matrix_size[N];
             size_t index2 = index + frame_offset * wrapped_i;
             image_point[N] = i;
@@ -50,24 +71,18 @@ namespace {
     }
 
     template<class REAL, unsigned int D>
-    std::tuple<std::vector<size_t>, std::vector<REAL>>
-    get_indices(const vector_td<REAL, D> &point, const vector_td<size_t, D> &matrix_size,
-                REAL W, const vector_td<REAL, D> &beta) {
-
-        std::vector<size_t> indices;
-        indices.reserve(size_t(std::pow(std::ceil(W), D)));
-
-        std::vector<REAL> weights;
-        weights.reserve(size_t(std::pow(std::ceil(W), D)));
+    void fill_indices(const vector_td<REAL, D> &point, const vector_td<size_t, D> &matrix_size,
+                      REAL W, const vector_td<REAL, D> &beta, uint32_t *indices, REAL *weights) {
 
         vector_td<REAL, D> image_point;
         size_t index = 0;
         iterate_body(point, matrix_size, W, beta, indices, weights, image_point, index, iteration_counter<D - 1>());
-
-        return std::make_tuple(std::move(indices), std::move(weights));
     }
 
-
+    // Exclusive prefix sum of the counts stored in offsets[1..n], leaving offsets[i] as the start of column i.
+    void accumulate_offsets(std::vector<size_t> &offsets) {
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    }
 }
 
 
@@ -77,10 +92,22 @@ Gadgetron::NFFT_internal::make_NFFT_matrix(const Gadgetron::hoNDArray<Gadgetron:
                                   const Gadgetron::vector_td<size_t, D> &image_dims, REAL W,
                                   const Gadgetron::vector_td<REAL, D> &beta) {
 
-    NFFT_Matrix<REAL> matrix(trajectories.get_number_of_elements(),prod(image_dims));
-#pragma omp parallel for 
-    for (int i = 0; i < (int)trajectories.get_number_of_elements(); i++) {
-        std::tie(matrix.indices[i], matrix.weights[i]) = get_indices(trajectories[i], image_dims, W, beta);
+    const long long n_samples = trajectories.get_number_of_elements();
+    NFFT_Matrix<REAL> matrix(n_samples, prod(image_dims));
+
+#pragma omp parallel for
+    for (long long i = 0; i < n_samples; i++) {
+        matrix.offsets[i + 1] = count_indices(trajectories[i], W);
+    }
+
+    accumulate_offsets(matrix.offsets);
+    matrix.indices.resize(matrix.non_zeros());
+    matrix.weights.resize(matrix.non_zeros());
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (long long i = 0; i < n_samples; i++) {
+        fill_indices(trajectories[i], image_dims, W, beta,
+                     matrix.indices.data() + matrix.offsets[i], matrix.weights.data() + matrix.offsets[i]);
     }
     return matrix;
 }
@@ -91,32 +118,60 @@ template<class REAL>
 Gadgetron::NFFT_internal::NFFT_Matrix<REAL>
 Gadgetron::NFFT_internal::transpose(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL> &matrix) {
 
-    auto work_index = boost::irange(size_t(0),matrix.n_cols);
-
     NFFT_Matrix<REAL> transposed(matrix.n_rows, matrix.n_cols);
 
-    std::vector<int> counts(matrix.n_rows, 0);
+    const long long n_cols = matrix.n_cols;
+    const long long n_rows = matrix.n_rows;
 
+    std::vector<std::atomic<size_t>> counts(n_rows);
 
-    for (size_t i : work_index) {
-        auto &rows = matrix.indices[i];
-        for (auto &row : rows) {
-            counts[row]++;
+#pragma omp parallel for
+    for (long long row = 0; row < n_rows; row++) {
+        counts[row].store(0, std::memory_order_relaxed);
+    }
+
+#pragma omp parallel for
+    for (long long i = 0; i < n_cols; i++) {
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++) {
+            counts[matrix.indices[n]].fetch_add(1, std::memory_order_relaxed);
         }
     }
 
-    for (size_t i = 0; i < counts.size(); i++) {
-        transposed.indices[i].reserve(counts[i]);
-        transposed.weights[i].reserve(counts[i]);
+    for (long long row = 0; row < n_rows; row++) {
+        transposed.offsets[row + 1] = counts[row].load(std::memory_order_relaxed);
+    }
+    accumulate_offsets(transposed.offsets);
+    transposed.indices.resize(transposed.non_zeros());
+    transposed.weights.resize(transposed.non_zeros());
+
+    // Reuse the counts as insertion cursors.
+#pragma omp parallel for
+    for (long long row = 0; row < n_rows; row++) {
+        counts[row].store(transposed.offsets[row], std::memory_order_relaxed);
     }
 
+#pragma omp parallel for
+    for (long long i = 0; i < n_cols; i++) {
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++) {
+            auto position = counts[matrix.indices[n]].fetch_add(1, std::memory_order_relaxed);
+            transposed.indices[position] = static_cast<uint32_t>(i);
+            transposed.weights[position] = matrix.weights[n];
+        }
+    }
 
-    for (size_t i : work_index ) {
-        auto &rows = matrix.indices[i];
-        auto &weights = matrix.weights[i];
-        for (size_t n = 0; n < rows.size(); n++) {
-            transposed.indices[rows[n]].push_back(i);
-            transposed.weights[rows[n]].push_back(weights[n]);
+    // The parallel fill leaves each column in arbitrary order. Sorting restores the order of the serial
+    // transpose, which keeps the summation order - and thus the result - independent of the thread count.
+#pragma omp parallel
+    {
+        std::vector<std::pair<uint32_t, REAL>> column;
+#pragma omp for schedule(dynamic, 1024)
+        for (long long row = 0; row < n_rows; row++) {
+            auto begin = transposed.offsets[row];
+            auto end = transposed.offsets[row + 1];
+            column.clear();
+            for (auto n = begin; n < end; n++) column.emplace_back(transposed.indices[n], transposed.weights[n]);
+            std::sort(column.begin(), column.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+            for (auto n = begin; n < end; n++) std::tie(transposed.indices[n], transposed.weights[n]) = column[n - begin];
         }
     }
 
@@ -4,19 +4,37 @@
 #include "hoNDArray.h"
 #include "vector_td.h"
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
 namespace Gadgetron {
     namespace NFFT_internal {
 
+        /**
+         * Sparse convolution matrix in compressed sparse column form.
+         *
+         * The entries of column i are indices[offsets[i]] ... indices[offsets[i+1]-1], with matching weights.
+         * All columns share three contiguous arrays, and row indices are 32 bit, which keeps both the number of
+         * allocations and the memory traffic of the matrix vector products down.
+         */
         template<class REAL> struct NFFT_Matrix {
 
-            NFFT_Matrix(size_t cols, size_t rows) : n_cols(cols),n_rows(rows) {
-                weights = std::vector<std::vector<REAL>>(n_cols);
-                indices = std::vector<std::vector<size_t>>(n_cols);
+            NFFT_Matrix(size_t cols, size_t rows) : offsets(cols + 1, 0), n_cols(cols), n_rows(rows) {
+                if (rows > std::numeric_limits<uint32_t>::max())
+                    throw std::runtime_error("NFFT_Matrix: number of rows exceeds 32 bit index range");
             }
             NFFT_Matrix(){}
-            std::vector<std::vector<REAL>> weights;
-            std::vector<std::vector<size_t>> indices;
-            size_t n_cols, n_rows;
+
+            size_t non_zeros() const { return offsets.empty() ? 0 : offsets.back(); }
+            size_t memory_usage() const {
+                return offsets.size() * sizeof(size_t) + indices.size() * sizeof(uint32_t) + weights.size() * sizeof(REAL);
+            }
+
+            std::vector<size_t> offsets;
+            std::vector<uint32_t> indices;
+            std::vector<REAL> weights;
+            size_t n_cols = 0, n_rows = 0;
         };
 
 
@@ -20,6 +20,7 @@ public:
 
     auto pyReconData = bp::list();
     for (auto & reconBit : reconData.rbit_ ){
+      require_kspace(reconBit.data_, "Python gadgets");
       auto data = DataBufferedToPython(reconBit.data_);
       auto ref = 	reconBit.ref_ ? DataBufferedToPython(*reconBit.ref_) : bp::object();
 
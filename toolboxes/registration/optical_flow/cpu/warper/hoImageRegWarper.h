@@ -104,6 +104,21 @@ namespace Gadgetron {
 
     protected:
 
+        typedef typename InterpolatorType::coord_type interp_coord_type;
+
+        /// buffers for warping one line of the target, one set per thread
+        struct LineBuffer
+        {
+            std::vector<interp_coord_type> pos;
+            std::vector<size_t> ind;
+            std::vector<ValueType> values;
+        };
+
+        /// interpolate the source at all pixels [offset, offset+num) of the target which are not background, in one batch
+        /// position(x, pt) computes the source image coordinates pt of the target pixel offset+x
+        template <typename PositionFunction>
+        void warpLine(const TargetType& target, size_t offset, size_t num, PositionFunction position, TargetType& warped, LineBuffer& buf);
+
         TransformationType* transform_;
         InterpolatorType* interp_;
 
@@ -176,30 +191,27 @@ namespace Gadgetron {
                 {
                     // #pragma omp parallel private(y) shared(sx, sy, target, source, warped) num_threads(2)
                     {
-                        typename TargetType::coord_type px, py, px_source, py_source, ix_source, iy_source;
+                        LineBuffer buf;
 
                         // #pragma omp for 
                         for ( y=0; y<(long long)sy; y++ )
                         {
-                            for ( size_t x=0; x<sx; x++ )
+                            this->warpLine(target, y*sx, sx, [&](size_t x, interp_coord_type* pt)
                             {
-                                size_t offset = x + y*sx;
+                                typename TargetType::coord_type px, py, px_source, py_source, ix_source, iy_source;
 
-                                if ( target( offset ) != bg_value_ )
-                                {
-                                    // target to world
-                                    target.image_to_world(x, size_t(y), px, py);
+                                // target to world
+                                target.image_to_world(x, size_t(y), px, py);
 
-                                    // transform the point
-                                    transform_->transform(px, py, px_source, py_source);
+                                // transform the point
+                                transform_->transform(px, py, px_source, py_source);
 
-                                    // world to source
-                                    source.world_to_image(px_source, py_source, ix_source, iy_source);
+                                // world to source
+                                source.world_to_image(px_source, py_source, ix_source, iy_source);
 
-                                    // interpolate the source
-                                    warped( offset ) = (*interp_)(ix_source, iy_source);
-                                }
-                            }
+                                pt[0] = ix_source;
+                                pt[1] = iy_source;
+                            }, warped, buf);
                         }
                     }
                 }
@@ -207,24 +219,21 @@ namespace Gadgetron {
                 {
                     // #pragma omp parallel private(y) shared(sx, sy, target, source, warped) num_threads(2)
                     {
-                        typename TargetType::coord_type ix_source, iy_source;
+                        LineBuffer buf;
 
                         // #pragma omp for 
                         for ( y=0; y<(long long)sy; y++ )
                         {
-                            for ( size_t x=0; x<sx; x++ )
+                            this->warpLine(target, y*sx, sx, [&](size_t x, interp_coord_type* pt)
                             {
-                                size_t offset = x + y*sx;
+                                typename TargetType::coord_type ix_source, iy_source;
 
-                                if ( target( offset ) != bg_value_ )
-                                {
-                                    // transform the point
-                                    transform_->transform(x, size_t(y), ix_source, iy_source);
+                                // transform the point
+                                transform_->transform(x, size_t(y), ix_source, iy_source);
 
-                                    // interpolate the source
-                                    warped( offset ) = (*interp_)(ix_source, iy_source);
-                                }
-                            }
+                                pt[0] = ix_source;
+                                pt[1] = iy_source;
+                            }, warped, buf);
                         }
                     }
                 }
@@ -241,7 +250,7 @@ namespace Gadgetron {
                 {
                     #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
                     {
-                        typename TargetType::coord_type px, py, pz, px_source, py_source, pz_source, ix_source, iy_source, iz_source;
+                        LineBuffer buf;
 
                         #pragma omp for 
                         for ( z=0; z<(long long)sz; z++ )
@@ -250,23 +259,23 @@ namespace Gadgetron {
                             {
                                 size_t offset = y*sx + z*sx*sy;
 
-                                for ( size_t x=0; x<sx; x++ )
+                                this->warpLine(target, offset, sx, [&](size_t x, interp_coord_type* pt)
                                 {
-                                    if ( target( x+offset ) != bg_value_ )
-                                    {
-                                        // target to world
-                                        target.image_to_world(x, y, size_t(z), px, py, pz);
+                                    typename TargetType::coord_type px, py, pz, px_source, py_source, pz_source, ix_source, iy_source, iz_source;
+
+                                    // target to world
+                                    target.image_to_world(x, y, size_t(z), px, py, pz);
 
-                                        // transform the point
-                                        transform_->transform(px, py, pz, px_source, py_source, pz_source);
+                                    // transform the point
+                                    transform_->transform(px, py, pz, px_source, py_source, pz_source);
 
-                                        // world to source
-                                        source.world_to_image(px_source, py_source, pz_source, ix_source, iy_source, iz_source);
+                                    // world to source
+                                    source.world_to_image(px_source, py_source, pz_source, ix_source, iy_source, iz_source);
 
-                                        // interpolate the source
-                                        warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
-                                    }
-                                }
+                                    pt[0] = ix_source;
+                                    pt[1] = iy_source;
+                                    pt[2] = iz_source;
+                                }, warped, buf);
                             }
                         }
                     }
@@ -275,7 +284,7 @@ namespace Gadgetron {
                 {
                     #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
                     {
-                        typename TargetType::coord_type ix_source, iy_source, iz_source;
+                        LineBuffer buf;
 
                         #pragma omp for 
                         for ( z=0; z<(long long)sz; z++ )
@@ -284,17 +293,17 @@ namespace Gadgetron {
                             {
                                 size_t offset = y*sx + z*sx*sy;
 
-                                for ( size_t x=0; x<sx; x++ )
+                                this->warpLine(target, offset, sx, [&](size_t x, interp_coord_type* pt)
                                 {
-                                    if ( target( x+offset ) != bg_value_ )
-                                    {
-                                        // transform the point
-                                        transform_->transform(x, y, size_t(z), ix_source, iy_source, iz_source);
-
-                                        // interpolate the source
-                                        warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
-                                    }
-                                }
+                                    typename TargetType::coord_type ix_source, iy_source, iz_source;
+
+                                    // transform the point
+                                    transform_->transform(x, y, size_t(z), ix_source, iy_source, iz_source);
+
+                                    pt[0] = ix_source;
+                                    pt[1] = iy_source;
+                                    pt[2] = iz_source;
+                                }, warped, buf);
                             }
                         }
                     }
@@ -398,30 +407,27 @@ namespace Gadgetron {
 
                 // #pragma omp parallel private(y) shared(sx, sy, target, source, warped) num_threads(2)
                 {
-                    coord_type px, py, dx, dy, ix_source, iy_source;
+                    LineBuffer buf;
 
                     // #pragma omp for 
                     for ( y=0; y<(long long)sy; y++ )
                     {
-                        for ( size_t x=0; x<sx; x++ )
+                        this->warpLine(target, y*sx, sx, [&](size_t x, interp_coord_type* pt)
                         {
-                            size_t offset = x + y*sx;
+                            coord_type px, py, dx, dy, ix_source, iy_source;
 
-                            if ( target( offset ) != bg_value_ )
-                            {
-                                // target to world
-                                target.image_to_world(x, size_t(y), px, py);
+                            // target to world
+                            target.image_to_world(x, size_t(y), px, py);
 
-                                // transform the point
-                                transformDeformField->get(x, size_t(y), dx, dy);
+                            // transform the point
+                            transformDeformField->get(x, size_t(y), dx, dy);
 
-                                // world to source
-                                source.world_to_image(px+dx, py+dy, ix_source, iy_source);
+                            // world to source
+                            source.world_to_image(px+dx, py+dy, ix_source, iy_source);
 
-                                // interpolate the source
-                                warped( offset ) = (*interp_)(ix_source, iy_source);
-                            }
-                        }
+                            pt[0] = ix_source;
+                            pt[1] = iy_source;
+                        }, warped, buf);
                     }
                 }
             }
@@ -435,7 +441,7 @@ namespace Gadgetron {
 
                 #pragma omp parallel private(z) shared(sx, sy, sz, target, source, warped)
                 {
-                    coord_type px, py, pz, dx, dy, dz, ix_source, iy_source, iz_source;
+                    LineBuffer buf;
 
                     #pragma omp for 
                     for ( z=0; z<(long long)sz; z++ )
@@ -444,23 +450,23 @@ namespace Gadgetron {
                         {
                             size_t offset = y*sx + z*sx*sy;
 
-                            for ( size_t x=0; x<sx; x++ )
+                            this->warpLine(target, offset, sx, [&](size_t x, interp_coord_type* pt)
                             {
-                                if ( target( x+offset ) != bg_value_ )
-                                {
-                                    // target to world
-                                    target.image_to_world(x, y, size_t(z), px, py, pz);
+                                coord_type px, py, pz, dx, dy, dz, ix_source, iy_source, iz_source;
 
-                                    // transform the point
-                                    transformDeformField->get(x, y, size_t(z), dx, dy, dz);
+                                // target to world
+                                target.image_to_world(x, y, size_t(z), px, py, pz);
 
-                                    // world to source
-                                    source.world_to_image(px+dx, py+dy, pz+dz, ix_source, iy_source, iz_source);
+                                // transform the point
+                                transformDeformField->get(x, y, size_t(z), dx, dy, dz);
 
-                                    // interpolate the source
-                                    warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
-                                }
-                            }
+                                // world to source
+                                source.world_to_image(px+dx, py+dy, pz+dz, ix_source, iy_source, iz_source);
+
+                                pt[0] = ix_source;
+                                pt[1] = iy_source;
+                                pt[2] = iz_source;
+                            }, warped, buf);
                         }
                     }
                 }
@@ -518,6 +524,37 @@ namespace Gadgetron {
         return true;
     }
 
+    template<typename TargetType, typename SourceType, typename CoordType> 
+    template <typename PositionFunction>
+    inline void hoImageRegWarper<TargetType, SourceType, CoordType>::
+    warpLine(const TargetType& target, size_t offset, size_t num, PositionFunction position, TargetType& warped, LineBuffer& buf)
+    {
+        buf.pos.resize(num*DOut);
+        buf.ind.resize(num);
+        buf.values.resize(num);
+
+        // gather the source positions of the pixels to warp
+        size_t count = 0;
+        for ( size_t x=0; x<num; x++ )
+        {
+            if ( target( offset+x ) != bg_value_ )
+            {
+                position(x, &buf.pos[count*DOut]);
+                buf.ind[count++] = offset+x;
+            }
+        }
+
+        if ( count == 0 ) return;
+
+        // interpolate the source
+        interp_->interpolate(&buf.pos[0], count, &buf.values[0]);
+
+        for ( size_t n=0; n<count; n++ )
+        {
+            warped( buf.ind[n] ) = buf.values[n];
+        }
+    }
+
     template<typename TargetType, typename SourceType, typename CoordType> 
     void hoImageRegWarper<TargetType, SourceType, CoordType>::print(std::ostream& os) const
     {
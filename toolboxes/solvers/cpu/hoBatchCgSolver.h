@@ -0,0 +1,390 @@
+/** \file   hoBatchCgSolver.h
+    \brief  Conjugate gradient solver for a batch of independent systems, cpu instantiation.
+
+    Multi-slice and multi-frame reconstructions solve the same kind of system once per slice, set or frame.
+    hoBatchCgSolver stacks these K systems in one hoNDArray, with the systems along the trailing dimensions,
+    and runs them together: the encoding and regularization operators are applied once per iteration to the
+    whole batch (so FFTs and other operators batch naturally), while step sizes, residuals and termination
+    are tracked for every system on its own. Systems that have converged stop updating; the solver returns
+    when all systems have converged or the maximal number of iterations is reached.
+
+    The operators must act on every system independently, i.e. be block diagonal over the batch.
+*/
+
+#pragma once
+
+#include "linearOperatorSolver.h"
+#include "cgPreconditioner.h"
+#include "hoNDArray_math.h"
+#include "hoNDArray_kernels.h"
+#include "real_utilities.h"
+
+#include <complex>
+#include <limits>
+#include <vector>
+
+namespace Gadgetron{
+
+    template <class T> class hoBatchCgSolver;
+
+    /** \class hoBatchCgTerminationCallback
+        \brief Termination criterion of hoBatchCgSolver, evaluated for every system in the batch.
+    */
+    template <class T> class hoBatchCgTerminationCallback
+    {
+    public:
+
+        typedef typename realType<T>::Type REAL;
+
+        hoBatchCgTerminationCallback() : cg_(nullptr) {}
+        virtual ~hoBatchCgTerminationCallback() {}
+
+        virtual void initialize( hoBatchCgSolver<T> *cg ) { cg_ = cg; }
+
+        /// Called after every iteration for each system that has not yet converged; returns true when system has.
+        virtual bool iterate( size_t system, unsigned int iteration, REAL *tc_metric ) = 0;
+
+    protected:
+
+        REAL get_rq( size_t system ) { return cg_->rq_[system]; }
+        REAL get_rq0( size_t system ) { return cg_->rq0_[system]; }
+        REAL get_alpha( size_t system ) { return cg_->alpha_[system]; }
+
+        hoBatchCgSolver<T> *cg_;
+    };
+
+    /** \class hoBatchRelativeResidualTCB
+        \brief Stops a system once its residual, relative to that of its right hand side, drops below the tolerance.
+    */
+    template <class T> class hoBatchRelativeResidualTCB : public hoBatchCgTerminationCallback<T>
+    {
+    public:
+
+        typedef hoBatchCgTerminationCallback<T> BaseClass;
+        typedef typename BaseClass::REAL REAL;
+
+        virtual bool iterate( size_t system, unsigned int iteration, REAL *tc_metric )
+        {
+            *tc_metric = BaseClass::get_rq0(system) > REAL(0) ? BaseClass::get_rq(system) / BaseClass::get_rq0(system) : REAL(0);
+
+            if( this->cg_->get_output_mode() >= hoBatchCgSolver<T>::OUTPUT_VERBOSE ){
+                GDEBUG_STREAM("Iteration " << iteration << ", system " << system << ". rq/rq_0 = " << *tc_metric << std::endl);
+            }
+
+            return *tc_metric < this->cg_->get_tc_tolerance();
+        }
+    };
+
+    /** \class hoBatchCgSolver
+        \brief Conjugate gradient solver for K independent systems stacked in one hoNDArray.
+
+        By default every index of the last dimension is one system; set_system_dimensions(n) makes the first n
+        dimensions one system instead, and all remaining dimensions the batch.
+    */
+    template <class T> class hoBatchCgSolver : public linearOperatorSolver< hoNDArray<T> >
+    {
+    public:
+
+        typedef hoNDArray<T> ARRAY_TYPE;
+        typedef typename realType<T>::Type REAL;
+        friend class hoBatchCgTerminationCallback<T>;
+
+        hoBatchCgSolver() : linearOperatorSolver<ARRAY_TYPE>()
+        {
+            iterations_ = 10;
+            tc_tolerance_ = (REAL)1e-3;
+            system_dimensions_ = 0;
+            cb_ = boost::shared_ptr< hoBatchCgTerminationCallback<T> >( new hoBatchRelativeResidualTCB<T>() );
+        }
+
+        virtual ~hoBatchCgSolver() {}
+
+        virtual void set_preconditioner( boost::shared_ptr< cgPreconditioner<ARRAY_TYPE> > precond ) { precond_ = precond; }
+        virtual void set_termination_callback( boost::shared_ptr< hoBatchCgTerminationCallback<T> > cb ) { cb_ = cb; }
+
+        virtual void set_max_iterations( unsigned int iterations ) { iterations_ = iterations; }
+        virtual unsigned int get_max_iterations() { return iterations_; }
+
+        virtual void set_tc_tolerance( REAL tolerance ) { tc_tolerance_ = tolerance; }
+        virtual REAL get_tc_tolerance() { return tc_tolerance_; }
+
+        /// Number of leading dimensions making up one system; 0 means all but the last dimension.
+        virtual void set_system_dimensions( size_t dims ) { system_dimensions_ = dims; }
+        virtual size_t get_system_dimensions() { return system_dimensions_; }
+
+        /// Iterations each system of the last solve ran before converging (or the maximum, if it did not).
+        const std::vector<unsigned int>& get_iterations_used() const { return iterations_used_; }
+
+        virtual boost::shared_ptr<ARRAY_TYPE> solve( ARRAY_TYPE *d )
+        {
+            boost::shared_ptr<ARRAY_TYPE> rhs = compute_rhs( d );
+            return solve_from_rhs( rhs.get() );
+        }
+
+        virtual boost::shared_ptr<ARRAY_TYPE> solve_from_rhs( ARRAY_TYPE *rhs )
+        {
+            if( iterations_ == 0 ){
+                return boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*rhs) );
+            }
+
+            initialize( rhs );
+
+            for( unsigned int it = 0; it < iterations_; it++ ){
+                if( !iterate( it ) )
+                    break;
+            }
+
+            boost::shared_ptr<ARRAY_TYPE> x = x_;
+            deinitialize();
+            return x;
+        }
+
+        virtual boost::shared_ptr<ARRAY_TYPE> compute_rhs( ARRAY_TYPE *d )
+        {
+            if( this->encoding_operator_.get() == 0 ){
+                throw std::runtime_error( "Error: hoBatchCgSolver::compute_rhs : no encoding operator is set" );
+            }
+
+            boost::shared_ptr< std::vector<size_t> > image_dims = this->encoding_operator_->get_domain_dimensions();
+            if( image_dims->size() == 0 ){
+                throw std::runtime_error( "Error: hoBatchCgSolver::compute_rhs : encoding operator has not set domain dimension" );
+            }
+
+            boost::shared_ptr<ARRAY_TYPE> result( new ARRAY_TYPE(*image_dims) );
+            this->encoding_operator_->mult_MH( d, result.get() );
+            *result *= T(this->encoding_operator_->get_weight());
+            return result;
+        }
+
+    protected:
+
+        // Splits the batch into systems, and every system into spans of Kernels::chunk_size elements,
+        // then calls f(system, begin, end) for all spans, in parallel if the batch is large enough.
+        // The returned vector holds the sum of the values f returned, per system.
+        //
+        template <class F> std::vector<double> for_each_span( F&& f )
+        {
+            size_t spans = (system_size_ + Kernels::chunk_size - 1) / Kernels::chunk_size;
+            long long tasks = (long long)(spans * systems_);
+
+            std::vector<double> parts(tasks, 0.0);
+
+#pragma omp parallel for schedule(static) if (system_size_ * systems_ >= Kernels::parallel_threshold)
+            for( long long task = 0; task < tasks; task++ ){
+                size_t k = task / spans;
+                if( !active_[k] ) continue;
+
+                size_t begin = k * system_size_ + (task % spans) * Kernels::chunk_size;
+                size_t end = std::min( (k + 1) * system_size_, begin + Kernels::chunk_size );
+                parts[task] = f( k, begin, end );
+            }
+
+            std::vector<double> sums(systems_, 0.0);
+            for( size_t k = 0; k < systems_; k++ ){
+                for( size_t s = 0; s < spans; s++ ) sums[k] += parts[k * spans + s];
+            }
+            return sums;
+        }
+
+        // Real part of conj(a) * b; std::conj would promote real types to complex
+        template <class S> static double inner( const S& a, const S& b ) { return a * b; }
+        template <class S> static double inner( const std::complex<S>& a, const std::complex<S>& b ) { return std::real( std::conj(a) * b ); }
+
+        // Applies the preconditioner twice, as cgSolver does; out = r when there is none.
+        //
+        void precondition( ARRAY_TYPE *r, ARRAY_TYPE *out )
+        {
+            if( precond_.get() ){
+                precond_->apply( r, out );
+                precond_->apply( out, out );
+            }
+            else{
+                *out = *r;
+            }
+        }
+
+        virtual void initialize( ARRAY_TYPE *rhs )
+        {
+            if( !rhs || rhs->get_number_of_elements() == 0 ){
+                throw std::runtime_error( "Error: hoBatchCgSolver::initialize : empty or NULL rhs provided" );
+            }
+
+            size_t dims = system_dimensions_ > 0 ? system_dimensions_ : rhs->get_number_of_dimensions() - 1;
+            if( dims > rhs->get_number_of_dimensions() ){
+                throw std::runtime_error( "Error: hoBatchCgSolver::initialize : more system dimensions than the rhs has" );
+            }
+
+            system_size_ = 1;
+            for( size_t d = 0; d < dims; d++ ) system_size_ *= rhs->get_size(d);
+            systems_ = rhs->get_number_of_elements() / system_size_;
+
+            active_.assign( systems_, true );
+            iterations_used_.assign( systems_, iterations_ );
+            alpha_.assign( systems_, REAL(0) );
+
+            x_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(rhs->dimensions()) );
+            r_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*rhs) );
+            p_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(rhs->dimensions()) );
+            q_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(rhs->dimensions()) );
+
+            precondition( r_.get(), p_.get() );
+            rq0_ = to_real( dots( r_.get(), p_.get() ) );
+
+            if( this->get_x0().get() ){
+
+                if( !this->get_x0()->dimensions_equal( rhs ) ){
+                    throw std::runtime_error( "Error: hoBatchCgSolver::initialize : RHS and initial guess must have same dimensions" );
+                }
+
+                *x_ = *(this->get_x0());
+                mult_MH_M( x_.get(), q_.get() );
+                *r_ -= *q_;
+                precondition( r_.get(), p_.get() );
+            }
+            else{
+                clear( x_.get() );
+            }
+
+            rq_ = to_real( dots( r_.get(), p_.get() ) );
+
+            // Systems with a zero right hand side are solved already
+            for( size_t k = 0; k < systems_; k++ ){
+                if( !(rq_[k] > REAL(0)) ){
+                    active_[k] = false;
+                    iterations_used_[k] = 0;
+                }
+            }
+
+            cb_->initialize(this);
+        }
+
+        virtual void deinitialize()
+        {
+            q_.reset();
+            p_.reset();
+            r_.reset();
+            x_.reset();
+        }
+
+        // One iteration for all systems still active; returns false once none are.
+        //
+        virtual bool iterate( unsigned int iteration )
+        {
+            T* x = x_->begin();
+            T* r = r_->begin();
+            T* p = p_->begin();
+            T* q = q_->begin();
+
+            // The only operator application of the iteration, for the whole batch
+            mult_MH_M( p_.get(), q_.get() );
+
+            auto pq = dots( p_.get(), q_.get() );
+            for( size_t k = 0; k < systems_; k++ ){
+                alpha_[k] = active_[k] ? REAL( rq_[k] / pq[k] ) : REAL(0);
+            }
+
+            // x += alpha p and r -= alpha q in one pass, which also yields |r|^2 when there is no preconditioner
+            auto rr = for_each_span( [&]( size_t k, size_t begin, size_t end ){
+                REAL alpha = alpha_[k];
+                double sum = 0;
+                for( size_t i = begin; i < end; i++ ){
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * q[i];
+                    sum += inner( r[i], r[i] );
+                }
+                return sum;
+            });
+
+            std::vector<double> rz = rr;
+            if( precond_.get() ){
+                precondition( r_.get(), q_.get() );
+                rz = dots( r_.get(), q_.get() );
+            }
+
+            const T* z = precond_.get() ? q : r;
+            std::vector<REAL> beta( systems_ );
+            for( size_t k = 0; k < systems_; k++ ){
+                beta[k] = active_[k] ? REAL( rz[k] / rq_[k] ) : REAL(0);
+                if( active_[k] ) rq_[k] = REAL( rz[k] );
+            }
+
+            // p = z + beta p
+            for_each_span( [&]( size_t k, size_t begin, size_t end ){
+                REAL b = beta[k];
+                for( size_t i = begin; i < end; i++ ){
+                    p[i] = z[i] + b * p[i];
+                }
+                return 0.0;
+            });
+
+            // Evaluate the termination criterion of every system still iterating
+            bool any_active = false;
+            for( size_t k = 0; k < systems_; k++ ){
+                if( !active_[k] ) continue;
+
+                REAL tc_metric;
+                if( cb_->iterate( k, iteration, &tc_metric ) || !(rq_[k] > REAL(0)) ){
+                    active_[k] = false;
+                    iterations_used_[k] = iteration + 1;
+
+                    // The operators still run over this system with the rest of the batch; its x, r and p are
+                    // no longer updated, and what they compute for it is ignored
+                }
+                else{
+                    any_active = true;
+                }
+            }
+
+            return any_active;
+        }
+
+        // Per system inner products of a and b, over the systems still active
+        //
+        std::vector<double> dots( ARRAY_TYPE *a, ARRAY_TYPE *b )
+        {
+            const T* pa = a->begin();
+            const T* pb = b->begin();
+            return for_each_span( [&]( size_t, size_t begin, size_t end ){
+                double sum = 0;
+                for( size_t i = begin; i < end; i++ ) sum += inner( pa[i], pb[i] );
+                return sum;
+            });
+        }
+
+        static std::vector<REAL> to_real( const std::vector<double>& values )
+        {
+            return std::vector<REAL>( values.begin(), values.end() );
+        }
+
+        void mult_MH_M( ARRAY_TYPE *in, ARRAY_TYPE *out )
+        {
+            ARRAY_TYPE tmp( in->dimensions() );
+
+            this->encoding_operator_->mult_MH_M( in, out, false );
+            if( this->encoding_operator_->get_weight() != REAL(1) ) *out *= T(this->encoding_operator_->get_weight());
+
+            for( unsigned int i = 0; i < this->regularization_operators_.size(); i++ ){
+                this->regularization_operators_[i]->mult_MH_M( in, &tmp, false );
+                axpy( T(this->regularization_operators_[i]->get_weight()), &tmp, out );
+            }
+        }
+
+    protected:
+
+        boost::shared_ptr< cgPreconditioner<ARRAY_TYPE> > precond_;
+        boost::shared_ptr< hoBatchCgTerminationCallback<T> > cb_;
+
+        REAL tc_tolerance_;
+        unsigned int iterations_;
+        size_t system_dimensions_;
+
+        // Per system state
+        size_t system_size_;
+        size_t systems_;
+        std::vector<bool> active_;
+        std::vector<unsigned int> iterations_used_;
+        std::vector<REAL> rq_, rq0_, alpha_;
+
+        boost::shared_ptr<ARRAY_TYPE> x_, p_, r_, q_;
+    };
+}